@@ -0,0 +1,338 @@
+#include <pch.h>
+#include <core/cache/pakindex.h>
+#include <core/utils/crc32.h>
+
+#include <game/rtech/cpakfile.h>
+#include <game/rtech/utils/utils.h>
+
+// crc is at the same place in every header version, so the key can be read without knowing the version
+static_assert(offsetof(PakHdr_v6_t, crc) == offsetof(PakHdr_v8_t, crc) && offsetof(PakHdr_v7_t, crc) == offsetof(PakHdr_v8_t, crc));
+
+bool CPakIndex::ReadSourceFileKey(SourceFile_t& file)
+{
+	std::error_code error;
+
+	file.fileSize = std::filesystem::file_size(file.path, error);
+	if (error)
+		return false;
+
+	file.writeTime = std::filesystem::last_write_time(file.path, error).time_since_epoch().count();
+	if (error)
+		return false;
+
+	// the header isn't compressed, nothing past it needs to be read
+	std::ifstream ifs(file.path, std::ios::in | std::ios::binary);
+
+	char header[offsetof(PakHdr_v8_t, crc) + sizeof(uint64_t)] = {};
+	if (!ifs.read(header, sizeof(header)))
+		return false;
+
+	if (*reinterpret_cast<const int*>(header) != pakFileMagic)
+		return false;
+
+	file.crc = *reinterpret_cast<const uint64_t*>(header + offsetof(PakHdr_v8_t, crc));
+
+	return true;
+}
+
+bool CPakIndex::BuildFromPak(CPakFile* const pak)
+{
+	m_containerFileName = pak->getPakStem() + ".rpak";
+
+	m_sourceFiles.clear();
+	m_assets.clear();
+	m_dependencies.clear();
+	m_starPaks.clear();
+	m_optStarPaks.clear();
+
+	// absolute, snapshots are looked up by the absolute path of the requested pak
+	const std::filesystem::path pakPath = std::filesystem::absolute(pak->GetFilePath());
+
+	// the same paths LoadAndPatchPakFileData loads the patch files from
+	m_sourceFiles.push_back({ pakPath.string() });
+
+	for (int i = 0; i < pak->patchCount(); ++i)
+	{
+		const uint16_t pakPatchFileIndex = pak->header()->GetPatchFileIndices()[i];
+
+		const std::string patchSuffix = pakPatchFileIndex == 0 ? "" : std::format("({:02})", pakPatchFileIndex);
+		m_sourceFiles.push_back({ std::filesystem::path(pakPath).replace_filename(std::format("{}{}.rpak", pak->getPakStem(), patchSuffix)).string() });
+	}
+
+	// patch_master decides which patch a requested pak resolves to, once it changes this might not be the highest patch anymore
+	const std::filesystem::path patchMasterPath = pakPath.parent_path() / "patch_master.rpak";
+	if (std::filesystem::exists(patchMasterPath))
+		m_sourceFiles.push_back({ patchMasterPath.string() });
+
+	for (SourceFile_t& file : m_sourceFiles)
+	{
+		if (!ReadSourceFileKey(file))
+			return false;
+	}
+
+	// assets are processed on several threads, go back to asset table order so the snapshot is the same every time
+	std::unordered_map<uint64_t, CPakAsset*> assetsByGuid;
+	for (CAsset* const asset : pak->GetProcessedAssets())
+		assetsByGuid.emplace(asset->GetAssetGUID(), static_cast<CPakAsset*>(asset));
+
+	std::vector<AssetGuid_t> dependencies;
+
+	for (int i = 0; i < pak->assetCount(); ++i)
+	{
+		const auto it = assetsByGuid.find(pak->internalAssets()[i].guid);
+
+		// rejected when the pak was loaded
+		if (it == assetsByGuid.end())
+			continue;
+
+		CPakAsset* const asset = it->second;
+		asset->getDependencies(dependencies);
+
+		PakIndexAssetEntry_t& entry = m_assets.emplace_back();
+		entry.guid = asset->GetAssetGUID();
+		entry.type = asset->GetAssetType();
+		entry.version = asset->GetAssetVersion();
+		entry.name = asset->GetAssetName();
+		entry.firstDependency = static_cast<uint32_t>(m_dependencies.size());
+		entry.numDependencies = static_cast<uint32_t>(dependencies.size());
+		entry.starpakOffset = asset->data()->starpakOffset;
+		entry.optStarpakOffset = asset->data()->optStarpakOffset;
+
+		for (const AssetGuid_t& dependency : dependencies)
+			m_dependencies.push_back(dependency.guid);
+	}
+
+	for (int i = 0; const StarPak_t* const starpak = pak->getStarPak(i, false); ++i)
+		m_starPaks.push_back(starpak->filePath);
+
+	for (int i = 0; const StarPak_t* const starpak = pak->getStarPak(i, true); ++i)
+		m_optStarPaks.push_back(starpak->filePath);
+
+	return true;
+}
+
+bool CPakIndex::SaveToFile(const std::filesystem::path& path) const
+{
+	std::string strings(1, '\0'); // offset 0 is an empty string
+
+	auto addString = [&strings](const std::string& str) -> uint32_t
+		{
+			const uint32_t offset = static_cast<uint32_t>(strings.length());
+			strings.append(str.c_str(), str.length() + 1);
+
+			return offset;
+		};
+
+	const uint32_t containerNameOffset = addString(m_containerFileName);
+
+	std::vector<PakIndexSourceFile_t> sourceFiles(m_sourceFiles.size());
+	for (size_t i = 0; i < m_sourceFiles.size(); ++i)
+	{
+		const SourceFile_t& file = m_sourceFiles[i];
+		sourceFiles[i] = { file.fileSize, file.writeTime, file.crc, addString(file.path), 0u };
+	}
+
+	std::vector<PakIndexAsset_t> assets(m_assets.size());
+	for (size_t i = 0; i < m_assets.size(); ++i)
+	{
+		const PakIndexAssetEntry_t& entry = m_assets[i];
+		assets[i] = { entry.guid, entry.type, entry.version.majorVer, entry.version.minorVer, addString(entry.name), entry.firstDependency, entry.numDependencies, entry.starpakOffset, entry.optStarpakOffset };
+	}
+
+	std::vector<PakIndexStarPak_t> starpaks;
+	for (const std::string& starpak : m_starPaks)
+		starpaks.push_back({ addString(starpak), 0u });
+
+	for (const std::string& starpak : m_optStarPaks)
+		starpaks.push_back({ addString(starpak), 1u });
+
+	const size_t sourceFilesSize = sourceFiles.size() * sizeof(PakIndexSourceFile_t);
+	const size_t assetsSize = assets.size() * sizeof(PakIndexAsset_t);
+	const size_t dependenciesSize = m_dependencies.size() * sizeof(uint64_t);
+	const size_t starpaksSize = starpaks.size() * sizeof(PakIndexStarPak_t);
+
+	const size_t stringTableOffset = sizeof(PakIndexHeader_t) + sourceFilesSize + assetsSize + dependenciesSize + starpaksSize;
+	const size_t fileSize = stringTableOffset + strings.length();
+
+	std::unique_ptr<char[]> fileBuf = std::make_unique<char[]>(fileSize);
+	char* cur = fileBuf.get() + sizeof(PakIndexHeader_t);
+
+	auto writeArray = [&cur](const void* const data, const size_t size)
+		{
+			if (size)
+				memcpy(cur, data, size);
+
+			cur += size;
+		};
+
+	writeArray(sourceFiles.data(), sourceFilesSize);
+	writeArray(assets.data(), assetsSize);
+	writeArray(m_dependencies.data(), dependenciesSize);
+	writeArray(starpaks.data(), starpaksSize);
+	writeArray(strings.data(), strings.length());
+
+	PakIndexHeader_t* const hdr = reinterpret_cast<PakIndexHeader_t*>(fileBuf.get());
+	hdr->fileVersion = PAK_INDEX_FILE_VERSION;
+	hdr->numSourceFiles = static_cast<uint32_t>(sourceFiles.size());
+	hdr->numAssets = static_cast<uint32_t>(assets.size());
+	hdr->numDependencies = static_cast<uint32_t>(m_dependencies.size());
+	hdr->numStarPaks = static_cast<uint32_t>(starpaks.size());
+	hdr->containerNameOffset = containerNameOffset;
+	hdr->stringTableOffset = stringTableOffset;
+	hdr->fileCRC = crc32::byteLevel(reinterpret_cast<const uint8_t*>(&hdr[1]), fileSize - sizeof(PakIndexHeader_t));
+
+	std::error_code error;
+	std::filesystem::create_directories(path.parent_path(), error);
+
+	// written next to the real file and moved over it, so another instance never reads half a snapshot
+	std::filesystem::path tempPath = path;
+	tempPath += ".tmp";
+
+	{
+		std::ofstream ofs(tempPath, std::ios::out | std::ios::binary | std::ios::trunc);
+
+		if (!ofs.write(fileBuf.get(), fileSize))
+			return false;
+	}
+
+	std::filesystem::rename(tempPath, path, error);
+
+	return !error;
+}
+
+bool CPakIndex::LoadFromFile(const std::filesystem::path& path, const std::filesystem::path& pakPath)
+{
+	std::error_code error;
+	const size_t fileSize = std::filesystem::file_size(path, error);
+
+	if (error || fileSize <= sizeof(PakIndexHeader_t))
+		return false;
+
+	std::unique_ptr<char[]> fileBuf = std::make_unique<char[]>(fileSize);
+
+	{
+		std::ifstream ifs(path, std::ios::in | std::ios::binary);
+
+		if (!ifs.read(fileBuf.get(), fileSize))
+			return false;
+	}
+
+	const PakIndexHeader_t* const hdr = reinterpret_cast<const PakIndexHeader_t*>(fileBuf.get());
+
+	if (hdr->fileVersion != PAK_INDEX_FILE_VERSION)
+		return false;
+
+	if (hdr->fileCRC != crc32::byteLevel(reinterpret_cast<const uint8_t*>(&hdr[1]), fileSize - sizeof(PakIndexHeader_t)))
+		return false;
+
+	const size_t stringTableSize = fileSize - std::min(hdr->stringTableOffset, fileSize);
+	const size_t arraysSize = (hdr->numSourceFiles * sizeof(PakIndexSourceFile_t)) + (hdr->numAssets * sizeof(PakIndexAsset_t))
+		+ (hdr->numDependencies * sizeof(uint64_t)) + (hdr->numStarPaks * sizeof(PakIndexStarPak_t));
+
+	// the crc matched so this is only a problem for files from a broken build, but the offsets get followed without checks below
+	if (hdr->numSourceFiles == 0u || sizeof(PakIndexHeader_t) + arraysSize != hdr->stringTableOffset || stringTableSize == 0ull || fileBuf[fileSize - 1] != '\0')
+		return false;
+
+	auto getString = [hdr, stringTableSize](const uint32_t offset) -> const char*
+		{
+			return offset < stringTableSize ? hdr->GetString(offset) : "";
+		};
+
+	const PakIndexSourceFile_t* const sourceFiles = reinterpret_cast<const PakIndexSourceFile_t*>(&hdr[1]);
+	const PakIndexAsset_t* const assets = reinterpret_cast<const PakIndexAsset_t*>(&sourceFiles[hdr->numSourceFiles]);
+	const uint64_t* const dependencies = reinterpret_cast<const uint64_t*>(&assets[hdr->numAssets]);
+	const PakIndexStarPak_t* const starpaks = reinterpret_cast<const PakIndexStarPak_t*>(&dependencies[hdr->numDependencies]);
+
+	// a snapshot for a different pak that ended up with the same name
+	if (std::filesystem::path(getString(sourceFiles[0].pathOffset)) != pakPath)
+		return false;
+
+	m_sourceFiles.resize(hdr->numSourceFiles);
+	for (uint32_t i = 0; i < hdr->numSourceFiles; ++i)
+	{
+		SourceFile_t& file = m_sourceFiles[i];
+		file.path = getString(sourceFiles[i].pathOffset);
+
+		if (!ReadSourceFileKey(file))
+			return false;
+
+		if (file.fileSize != sourceFiles[i].fileSize || file.writeTime != sourceFiles[i].writeTime || file.crc != sourceFiles[i].crc)
+			return false;
+	}
+
+	m_containerFileName = getString(hdr->containerNameOffset);
+
+	m_assets.resize(hdr->numAssets);
+	for (uint32_t i = 0; i < hdr->numAssets; ++i)
+	{
+		const PakIndexAsset_t& asset = assets[i];
+
+		if (static_cast<uint64_t>(asset.firstDependency) + asset.numDependencies > hdr->numDependencies)
+			return false;
+
+		m_assets[i] = { asset.guid, asset.type, AssetVersion_t(asset.majorVersion, asset.minorVersion), getString(asset.nameOffset), asset.firstDependency, asset.numDependencies, asset.starpakOffset, asset.optStarpakOffset };
+	}
+
+	m_dependencies.assign(dependencies, dependencies + hdr->numDependencies);
+
+	m_starPaks.clear();
+	m_optStarPaks.clear();
+	for (uint32_t i = 0; i < hdr->numStarPaks; ++i)
+		(starpaks[i].isOptional ? m_optStarPaks : m_starPaks).push_back(getString(starpaks[i].pathOffset));
+
+	return true;
+}
+
+std::filesystem::path CPakIndex::GetSnapshotPath(const std::filesystem::path& pakPath)
+{
+	std::string pathString = std::filesystem::absolute(pakPath).lexically_normal().string();
+	std::transform(pathString.begin(), pathString.end(), pathString.begin(), [](const unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+	// named after the pak so the directory is readable, the path hash keeps paks with the same name in different folders apart
+	return std::filesystem::current_path() / "rsx_pak_index" / std::format("{}_{:016X}.bin", pakPath.stem().string(), RTech::StringToGuid(pathString.c_str()));
+}
+
+bool PakIndex_LoadAll(const std::vector<std::string>& pakPaths, std::vector<CPakIndex>& indices)
+{
+	indices.clear();
+	indices.resize(pakPaths.size());
+
+	for (size_t i = 0; i < pakPaths.size(); ++i)
+	{
+		const std::filesystem::path pakPath = std::filesystem::absolute(pakPaths[i]);
+
+		if (!indices[i].LoadFromFile(CPakIndex::GetSnapshotPath(pakPath), pakPath))
+		{
+			Log("PAKINDEX: No valid snapshot for '%s'\n", pakPath.filename().string().c_str());
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void PakIndex_SaveLoadedPaks()
+{
+	uint32_t numSaved = 0u;
+
+	for (CAssetContainer* const container : g_assetData.v_assetContainers)
+	{
+		if (container->GetContainerType() != CAsset::ContainerType::PAK)
+			continue;
+
+		CPakFile* const pak = static_cast<CPakFile*>(container);
+
+		// saved under the patch that was loaded, lookups resolve the requested path through patch_master the same way
+		CPakIndex index;
+		if (!index.BuildFromPak(pak) || !index.SaveToFile(CPakIndex::GetSnapshotPath(pak->GetFilePath())))
+		{
+			Log("PAKINDEX: Failed to write a snapshot for '%s'\n", pak->GetFileName().c_str());
+			continue;
+		}
+
+		numSaved++;
+	}
+
+	if (numSaved)
+		Log("PAKINDEX: Wrote %u pak snapshot%s\n", numSaved, numSaved == 1 ? "" : "s");
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+// per pak snapshots of the asset table, so listing and dependency queries on an unchanged set of paks don't have to load them.
+// a snapshot is only used while the pak, every patch file it was built from and patch_master still have the same size, write time and crc.
+// snapshots are saved under the highest patch that was loaded, so requested paths go through ResolvePakPatchPath before looking them up.
+
+// v1: initial revision
+// v2: patch_master is part of the key, source paths are absolute
+constexpr int PAK_INDEX_FILE_VERSION = 2;
+
+#pragma pack(push, 1)
+struct PakIndexHeader_t
+{
+	uint32_t fileVersion;
+	uint32_t fileCRC; // crc of everything after the header
+
+	uint32_t numSourceFiles; // the pak itself first, then its patch files, then patch_master if the pak's directory has one
+	uint32_t numAssets;
+	uint32_t numDependencies;
+	uint32_t numStarPaks;
+
+	uint32_t containerNameOffset; // what CPakAsset::GetContainerFileName returns for the pak's assets
+	uint32_t reserved;
+
+	uint64_t stringTableOffset;
+
+	const char* GetString(uint64_t offset) const
+	{
+		return reinterpret_cast<const char*>(this) + stringTableOffset + offset;
+	}
+};
+
+struct PakIndexSourceFile_t
+{
+	uint64_t fileSize;
+	int64_t writeTime;
+	uint64_t crc; // PakHdr_t::crc
+	uint32_t pathOffset;
+	uint32_t reserved;
+};
+
+struct PakIndexAsset_t
+{
+	uint64_t guid;
+	uint32_t type;
+	int32_t majorVersion;
+	int32_t minorVersion;
+
+	uint32_t nameOffset;
+	uint32_t firstDependency;
+	uint32_t numDependencies;
+
+	// raw values from the asset table, the low 12 bits are the starpak index
+	int64_t starpakOffset;
+	int64_t optStarpakOffset;
+};
+
+struct PakIndexStarPak_t
+{
+	uint32_t pathOffset;
+	uint32_t isOptional;
+};
+#pragma pack(pop)
+
+struct PakIndexAssetEntry_t
+{
+	uint64_t guid;
+	uint32_t type;
+	AssetVersion_t version;
+	std::string name;
+
+	uint32_t firstDependency; // into CPakIndex::dependencies
+	uint32_t numDependencies;
+
+	int64_t starpakOffset;
+	int64_t optStarpakOffset;
+};
+
+class CPakFile;
+
+class CPakIndex
+{
+public:
+	// builds the snapshot from a loaded pak, its assets must be done loading so they have their final names
+	bool BuildFromPak(CPakFile* const pak);
+
+	bool SaveToFile(const std::filesystem::path& path) const;
+
+	// fails if the file is damaged, from another version, or any file the pak was built from has changed since
+	bool LoadFromFile(const std::filesystem::path& path, const std::filesystem::path& pakPath);
+
+	const std::string& GetContainerFileName() const { return m_containerFileName; }
+	const std::vector<PakIndexAssetEntry_t>& GetAssets() const { return m_assets; }
+	const std::vector<uint64_t>& GetDependencies() const { return m_dependencies; }
+	const std::vector<std::string>& GetStarPaks(const bool opt) const { return opt ? m_optStarPaks : m_starPaks; }
+
+	// where the snapshot for a pak path lives in the cache directory
+	static std::filesystem::path GetSnapshotPath(const std::filesystem::path& pakPath);
+
+private:
+	struct SourceFile_t
+	{
+		std::string path;
+		uint64_t fileSize;
+		int64_t writeTime;
+		uint64_t crc;
+	};
+
+	static bool ReadSourceFileKey(SourceFile_t& file);
+
+	std::string m_containerFileName;
+
+	std::vector<SourceFile_t> m_sourceFiles;
+	std::vector<PakIndexAssetEntry_t> m_assets;
+	std::vector<uint64_t> m_dependencies;
+	std::vector<std::string> m_starPaks;
+	std::vector<std::string> m_optStarPaks;
+};
+
+// loads the snapshots of every path, only succeeds if all of them are valid. paths should already be resolved through patch_master
+bool PakIndex_LoadAll(const std::vector<std::string>& pakPaths, std::vector<CPakIndex>& indices);
+
+// writes a snapshot for every loaded pak
+void PakIndex_SaveLoadedPaks();
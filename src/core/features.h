@@ -3,6 +3,7 @@
 // [ASSET FEATURES]
 //#define HAS_ODL_ASSET
 #define HAS_QC
+//#define HAS_BSP_SUPPORT // parses .bsp wrap assets on load for preview, world geometry export works without it
 
 // [GENERAL FEATURES]
 //#define HAS_ITEMFLAV_WINDOW
@@ -1,15 +1,25 @@
 #pragma once
 #include <game/rtech/cpakfile.h>
 
+class CPakIndex;
+
 // rpak.cpp
 FORCEINLINE void HandleExportBindingForAsset(CAsset* const asset, const bool exportDependencies, const bool exportDependents);
 void HandlePakAssetExportList(std::deque<CAsset*> selectedAssets, const bool exportDependencies, const bool exportDependents);
 void HandleExportAllPakAssets(std::vector<CGlobalAssetData::AssetLookup_t>* const pakAssets, const bool exportDependencies, const bool exportDependents);
 void HandleExportSelectedAssetType(std::vector<CGlobalAssetData::AssetLookup_t> pakAssets, const bool exportDependencies, const bool exportDependents);
 
+// mbnk.cpp
+void HandleExportAudioSources(std::vector<CAsset*> audioAssets);
+
 // list.cpp
 void ExportAssetListCSVToFileStream(std::vector<CGlobalAssetData::AssetLookup_t>* assets, std::ofstream* ofs);
 void ExportAssetListTXTToFileStream(std::vector<CGlobalAssetData::AssetLookup_t>* assets, std::ofstream* ofs);
 void ExportDependenciesToFileStream_AdjList(std::vector<CGlobalAssetData::AssetLookup_t>* assets, std::ofstream* ofs);
+
+// same output as above from pak snapshots, assets are in pak and then asset table order
+void ExportPakIndexListCSVToFileStream(const std::vector<CPakIndex>& indices, std::ofstream* ofs);
+void ExportPakIndexListTXTToFileStream(const std::vector<CPakIndex>& indices, std::ofstream* ofs);
+void ExportPakIndexDependenciesToFileStream_AdjList(const std::vector<CPakIndex>& indices, std::ofstream* ofs);
 void HandleListExportPakAssets(const HWND handle, std::vector<CGlobalAssetData::AssetLookup_t>* assets);
 void HandleListExport(const HWND handle, std::vector<std::string> listElements);
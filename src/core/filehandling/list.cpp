@@ -1,5 +1,6 @@
 #include <pch.h>
 #include <core/filehandling/export.h>
+#include <core/cache/pakindex.h>
 #include <core/render/dx.h>
 
 extern CBufferManager g_BufferManager;
@@ -66,6 +67,85 @@ void ExportDependenciesToFileStream_AdjList(std::vector<CGlobalAssetData::AssetL
     }
 }
 
+// snapshot assets in the order a load would list them: v_assets is sorted by post load order after every pak,
+// so assets are grouped by that and otherwise left in pak and asset table order
+static std::vector<std::pair<const CPakIndex*, const PakIndexAssetEntry_t*>> PakIndex_GetListOrder(const std::vector<CPakIndex>& indices)
+{
+    std::vector<std::pair<const CPakIndex*, const PakIndexAssetEntry_t*>> rows;
+
+    for (const CPakIndex& index : indices)
+    {
+        for (const PakIndexAssetEntry_t& asset : index.GetAssets())
+            rows.emplace_back(&index, &asset);
+    }
+
+    std::stable_sort(rows.begin(), rows.end(), [](const auto& a, const auto& b)
+        {
+            return GetPakAssetPostLoadOrder(a.second->type) < GetPakAssetPostLoadOrder(b.second->type);
+        });
+
+    return rows;
+}
+
+void ExportPakIndexListCSVToFileStream(const std::vector<CPakIndex>& indices, std::ofstream* ofs)
+{
+    const std::ios_base::fmtflags flags = ofs->flags();
+
+    *ofs << "type,guid,file_name,asset_name";
+    for (const auto& [index, asset] : PakIndex_GetListOrder(indices))
+        *ofs << "\n" << fourCCToString(asset->type, true) << "," << std::hex << asset->guid << "," << index->GetContainerFileName() << "," << asset->name;
+
+    ofs->flags(flags);
+}
+
+void ExportPakIndexListTXTToFileStream(const std::vector<CPakIndex>& indices, std::ofstream* ofs)
+{
+    bool firstAsset = true;
+    for (const auto& [index, asset] : PakIndex_GetListOrder(indices))
+    {
+        if (!firstAsset)
+            *ofs << "\n";
+
+        *ofs << asset->name;
+        firstAsset = false;
+    }
+}
+
+void ExportPakIndexDependenciesToFileStream_AdjList(const std::vector<CPakIndex>& indices, std::ofstream* ofs)
+{
+    const std::vector<std::pair<const CPakIndex*, const PakIndexAssetEntry_t*>> rows = PakIndex_GetListOrder(indices);
+
+    // first asset in list order wins for duplicate guids, like FindAssetByGUID on loaded paks
+    std::unordered_map<uint64_t, const std::string*> namesByGuid;
+
+    for (const auto& [index, asset] : rows)
+        namesByGuid.emplace(asset->guid, &asset->name);
+
+    Log("DEPS: Writing dependencies as an adjacency list for %lld assets from pak snapshots\n", rows.size());
+
+    bool firstAsset = true;
+    for (const auto& [index, asset] : rows)
+    {
+        const std::vector<uint64_t>& dependencies = index->GetDependencies();
+
+        if (!firstAsset)
+            *ofs << "\n";
+
+        firstAsset = false;
+        *ofs << asset->name;
+
+        for (uint32_t depIdx = 0; depIdx < asset->numDependencies; ++depIdx)
+        {
+            const uint64_t depGuid = dependencies[asset->firstDependency + depIdx];
+
+            if (const auto it = namesByGuid.find(depGuid); it != namesByGuid.end())
+                *ofs << "," << *it->second;
+            else
+                *ofs << "," << std::format("{:016X}*", depGuid);
+        }
+    }
+}
+
 void HandleListExportPakAssets(const HWND handle, std::vector<CGlobalAssetData::AssetLookup_t>* assets)
 {
     std::vector<std::string> assetNames(assets->size());
@@ -2,6 +2,17 @@
 #include <core/filehandling/load.h>
 #include <core/filehandling/export.h>
 #include <core/utils/cli_parser.h>
+#include <core/cache/pakindex.h>
+
+#include <game/rtech/utils/bvh/bvhquery.h>
+#include <game/rtech/assets/settings.h>
+#include <game/rtech/assets/rson.h>
+#include <game/rtech/assets/localization.h>
+#include <game/bluepoint/bp_pakfile.h>
+#include <game/audio/miles.h>
+#include <game/rtech/cpakfile.h>
+
+#include <chrono>
 
 extern CBufferManager g_BufferManager;
 
@@ -64,6 +75,63 @@ static void HandleFileLoad(std::vector<std::string> filePaths, HandleFileLoadCal
     }
 }
 
+// times the text writers on the largest loaded settings, rson and localization assets
+static void RunTextExportBenchmark(const uint32_t numIterations)
+{
+    CTextBuilder text;
+
+    auto writeAsset = [&text](CPakAsset* const asset) -> bool
+        {
+            switch (static_cast<AssetType_t>(asset->GetAssetType()))
+            {
+            case AssetType_t::STGS:
+                return WriteSettingsAssetText(asset, text);
+            case AssetType_t::RSON:
+                WriteRSONAssetText(asset->extraData<const RSONAsset*>(), text);
+                return true;
+            case AssetType_t::LOCL:
+                WriteLocalizationAssetText(asset->extraData<const LocalizationAsset*>(), text);
+                return true;
+            default:
+                return false;
+            }
+        };
+
+    for (const AssetType_t type : { AssetType_t::STGS, AssetType_t::RSON, AssetType_t::LOCL })
+    {
+        CPakAsset* largestAsset = nullptr;
+        size_t largestLength = 0ull;
+
+        for (const CGlobalAssetData::AssetLookup_t& it : g_assetData.v_assets)
+        {
+            if (it.m_asset->GetAssetContainerType() != CAsset::ContainerType::PAK || it.m_asset->GetAssetType() != static_cast<uint32_t>(type))
+                continue;
+
+            CPakAsset* const asset = static_cast<CPakAsset*>(it.m_asset);
+
+            if (!asset->hasExtraData() || !writeAsset(asset) || text.Length() <= largestLength)
+                continue;
+
+            largestAsset = asset;
+            largestLength = text.Length();
+        }
+
+        if (!largestAsset)
+            continue;
+
+        const auto startTime = std::chrono::high_resolution_clock::now();
+
+        for (uint32_t i = 0; i < numIterations; ++i)
+            writeAsset(largestAsset);
+
+        const double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - startTime).count();
+        const double totalMiB = static_cast<double>(largestLength) * numIterations / (1024.0 * 1024.0);
+
+        printf("TEXT BENCHMARK: %s \"%s\", %llu bytes, %u iterations, %.3f ms each, %.1f MiB/s\n", s_AssetTypePaths.find(type)->second, largestAsset->GetAssetName().c_str(),
+            largestLength, numIterations, seconds * 1000.0 / numIterations, totalMiB / seconds);
+    }
+}
+
 void OnCLILoadComplete(const CCommandLine* const cli)
 {
     // Hold this thread until asset loading is done on the newly spawned threads
@@ -77,6 +145,10 @@ void OnCLILoadComplete(const CCommandLine* const cli)
     {
         std::vector<CGlobalAssetData::AssetLookup_t>& assets = g_assetData.v_assets;
 
+        // store everything in a single archive instead of writing loose files
+        if (!g_ExportSettings.exportArchivePath.empty() && !g_ExportArchive.Open(g_ExportSettings.exportArchivePath, g_ExportSettings.GetExportDirectory()))
+            printf("\nEXPORT: Failed to open export archive \"%s\", writing loose files instead\n", g_ExportSettings.exportArchivePath.string().c_str());
+
         std::vector<uint32_t> filterTypes = GetExportFilterTypes(cli);
 
         if (filterTypes.size() != 0)
@@ -105,8 +177,15 @@ void OnCLILoadComplete(const CCommandLine* const cli)
         }
         else
             CThread(HandleExportAllPakAssets, &g_assetData.v_assets, g_ExportSettings.exportAssetDeps, g_ExportSettings.exportAssetDependents).join();
+
+        if (g_ExportArchive.IsOpen())
+            g_ExportArchive.Close();
     }
 
+    // snapshots for the next run, written once every asset has its final name
+    if (cli->HasParam("-pakindex"))
+        PakIndex_SaveLoadedPaks();
+
     if (const char* const listPathStr = cli->GetParamValue("--list"))
     {
         std::ofstream ofs(listPathStr, std::ios::out | std::ios::binary);
@@ -129,6 +208,104 @@ void OnCLILoadComplete(const CCommandLine* const cli)
         if (!depFileFormat || !_stricmp(depFileFormat, "adjlist"))
             ExportDependenciesToFileStream_AdjList(&g_assetData.v_assets, &ofs);
     }
+
+    // Runs raycasts and overlaps from a query file against loaded models' bvh collision
+    if (const char* const queryPath = cli->GetParamValue("--collisionquery"))
+        HandleCollisionQueryFile(queryPath, cli->GetParamValue("--collisionqueryout"), cli->HasParam("-collisionbenchmark"));
+
+    if (cli->HasParam("-textbenchmark"))
+        RunTextExportBenchmark(100u);
+
+    // decodes every loaded bluepoint file like a bulk export would, without writing anything
+    if (cli->HasParam("-bpkbenchmark"))
+        RunBluepointDecodeBenchmark();
+
+    // sorts and buckets the pointer headers of every loaded pak the way loading does, and checks the radix sort against std::sort
+    if (cli->HasParam("-pakfixupbenchmark"))
+        RunPakFixupBenchmark();
+
+    // reloads every patched pak with the decoded op list and with the old patch interpreter, and compares what they patched
+    if (cli->HasParam("-pakpatchverify"))
+        RunPakPatchVerify();
+
+    // encodes every loaded audio source to flac, decodes it again and checks the samples match
+    if (cli->HasParam("-flacverify"))
+        RunFlacExportVerify();
+
+    if (cli->HasParam("-memstats"))
+        g_MemoryTracker.PrintSummary();
+}
+
+// answers --list and --depfilepath from pak snapshots when every file is an rpak with a valid snapshot and nothing else needs the assets loaded
+static bool HandlePakIndexQueries(const CCommandLine* const cli, const std::vector<std::string>& filePaths)
+{
+    static const char* const s_loadedAssetParams[] = { "-export", "--collisionquery", "-textbenchmark", "-bpkbenchmark", "-pakfixupbenchmark", "-pakpatchverify", "-flacverify", "-memstats" };
+
+    if (!cli->HasParam("-nogui") || filePaths.empty())
+        return false;
+
+    const char* const listPathStr = cli->GetParamValue("--list");
+    const char* const depFilePath = cli->GetParamValue("--depfilepath");
+
+    if (!listPathStr && !depFilePath)
+        return false;
+
+    for (const char* const param : s_loadedAssetParams)
+    {
+        if (cli->HasParam(param))
+            return false;
+    }
+
+    for (const std::string& path : filePaths)
+    {
+        if (std::filesystem::path(path).extension().string() != ".rpak")
+            return false;
+    }
+
+    const auto startTime = std::chrono::high_resolution_clock::now();
+
+    // snapshots are saved under the patch that was loaded, so look them up the way HandlePakLoad finds it
+    std::vector<std::string> pakPaths;
+    std::unordered_set<std::string> resolvedPaths;
+
+    for (const std::string& path : filePaths)
+    {
+        std::string pakPath = ResolvePakPatchPath(path);
+
+        if (resolvedPaths.emplace(pakPath).second)
+            pakPaths.push_back(std::move(pakPath));
+    }
+
+    std::vector<CPakIndex> indices;
+    if (!PakIndex_LoadAll(pakPaths, indices))
+        return false;
+
+    if (listPathStr)
+    {
+        std::ofstream ofs(listPathStr, std::ios::out | std::ios::binary);
+
+        const char* const listFormat = cli->GetParamValue("--listformat");
+
+        if (!listFormat || !_stricmp(listFormat, "txt"))
+            ExportPakIndexListTXTToFileStream(indices, &ofs);
+        else if (!_stricmp(listFormat, "csv"))
+            ExportPakIndexListCSVToFileStream(indices, &ofs);
+    }
+
+    if (depFilePath)
+    {
+        std::ofstream ofs(depFilePath, std::ios::out | std::ios::binary);
+
+        const char* depFileFormat = cli->GetParamValue("--depfileformat");
+
+        if (!depFileFormat || !_stricmp(depFileFormat, "adjlist"))
+            ExportPakIndexDependenciesToFileStream_AdjList(indices, &ofs);
+    }
+
+    const double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - startTime).count();
+    Log("PAKINDEX: Answered from %lld pak snapshots in %.1f ms\n", indices.size(), seconds * 1000.0);
+
+    return true;
 }
 
 void HandleLoadFromCommandLine(const CCommandLine* const cli)
@@ -145,6 +322,10 @@ void HandleLoadFromCommandLine(const CCommandLine* const cli)
         }
     }
 
+    // unchanged paks don't need to be loaded just to list them, snapshots are written by any -pakindex run that loads them
+    if (cli->HasParam("-pakindex") && HandlePakIndexQueries(cli, filePaths))
+        return;
+
     CThread thread = CThread(HandleFileLoad, std::move(filePaths), OnCLILoadComplete, cli);
 
     // If this gets detached when running without the usual windows msg loop to hold up main thread, the main thread will exit
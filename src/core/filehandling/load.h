@@ -6,4 +6,7 @@ void HandleLoadFromCommandLine(const CCommandLine* const cli);
 void HandlePakLoad(std::vector<std::string> filePaths);
 void HandleMBNKLoad(std::vector<std::string> filePaths);
 void HandleMDLLoad(std::vector<std::string> filePaths);
-void HandleBPKLoad(std::vector<std::string> filePaths);
\ No newline at end of file
+void HandleBPKLoad(std::vector<std::string> filePaths);
+
+// the highest patch of a pak that patch_master lists, or the path itself if it doesn't list the pak
+std::string ResolvePakPatchPath(const std::string& path);
@@ -30,4 +30,79 @@ void HandleMBNKLoad(std::vector<std::string> filePaths)
 	}
 
 	g_pImGuiHandler->FinishProgressBarEvent(bankLoadProgressBar);
-}
\ No newline at end of file
+}
+
+void HandleExportAudioSources(std::vector<CAsset*> audioAssets)
+{
+	TRACE_ZONE("HandleExportAudioSources");
+
+	if (audioAssets.empty())
+		return;
+
+	const auto exportBinding = g_assetData.m_assetTypeBindings.find(static_cast<uint32_t>(AssetType_t::ASRC));
+	if (exportBinding == g_assetData.m_assetTypeBindings.end() || !exportBinding->second.e.exportFunc)
+		return;
+
+	// read each stream file front to back, sources from the same file are then decoded close together
+	std::sort(audioAssets.begin(), audioAssets.end(), [](CAsset* const a, CAsset* const b)
+		{
+			const CMilesAudioAsset* const audioA = static_cast<const CMilesAudioAsset*>(a);
+			const CMilesAudioAsset* const audioB = static_cast<const CMilesAudioAsset*>(b);
+
+			if (a->GetContainerFile<CMilesAudioBank>() != b->GetContainerFile<CMilesAudioBank>())
+				return a->GetContainerFile<CMilesAudioBank>() < b->GetContainerFile<CMilesAudioBank>();
+
+			const int streamCompare = audioA->GetContainerFileName().compare(audioB->GetContainerFileName());
+			if (streamCompare != 0)
+				return streamCompare < 0;
+
+			return reinterpret_cast<const MilesSource_t*>(a->GetAssetData())->streamHeaderOffset < reinterpret_cast<const MilesSource_t*>(b->GetAssetData())->streamHeaderOffset;
+		});
+
+	std::unordered_map<CMilesAudioBank*, double> startAudioSeconds;
+	for (CAsset* const asset : audioAssets)
+	{
+		CMilesAudioBank* const bank = asset->GetContainerFile<CMilesAudioBank>();
+		startAudioSeconds.emplace(bank, bank->GetDecodedAudioSeconds());
+	}
+
+	CParallelTask parallelProcessTask(UtilsConfig->exportThreadCount);
+
+	for (CAsset* const asset : audioAssets)
+	{
+		std::function<void()> task = [asset, &exportBinding]
+		{
+			TRACE_ZONE_TYPE("Export", exportBinding->first);
+			MEMORY_TYPE_SCOPE(exportBinding->first);
+
+			const bool exported = exportBinding->second.e.exportFunc(asset, exportBinding->second.e.exportSetting);
+			asset->SetExportedStatus(exported);
+		};
+		parallelProcessTask.addTask(task, 1u);
+	}
+
+	const auto startTime = std::chrono::high_resolution_clock::now();
+
+	const ProgressBarEvent_t* const exportAudioEvent = g_pImGuiHandler->AddProgressBarEvent(
+		"Exporting audio sources...",
+		parallelProcessTask.getRemainingTasks(),
+		&parallelProcessTask,
+		PB_FNCLASS_TO_VOID(&CParallelTask::getRemainingTasks));
+	parallelProcessTask.execute();
+	parallelProcessTask.wait();
+	g_pImGuiHandler->FinishProgressBarEvent(exportAudioEvent);
+
+	const double wallSeconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - startTime).count();
+
+	double totalAudioSeconds = 0.0;
+	for (const auto& [bank, startSeconds] : startAudioSeconds)
+	{
+		const double audioSeconds = bank->GetDecodedAudioSeconds() - startSeconds;
+		totalAudioSeconds += audioSeconds;
+
+		Log("MBNK: Decoded %.1f seconds of audio from bank \"%s\"\n", audioSeconds, bank->GetBankStem());
+	}
+
+	Log("MBNK: Exported %lld audio sources, %.1f seconds of audio in %.2f seconds (%.1f audio seconds per second)\n",
+		audioAssets.size(), totalAudioSeconds, wallSeconds, wallSeconds > 0.0 ? totalAudioSeconds / wallSeconds : 0.0);
+}
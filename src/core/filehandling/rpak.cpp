@@ -2,92 +2,237 @@
 
 #include <thirdparty/imgui/misc/imgui_utility.h>
 
+#include <chrono>
+#include <condition_variable>
+
 #include <core/filehandling/load.h>
 #include <core/filehandling/export.h>
 
 #include <game/rtech/cpakfile.h>
+#include <core/shaderexp/shaderstore.h>
+#include <game/rtech/assets/material.h>
+
+// marks the pak and the patch files that were combined into it as loaded, so they don't get loaded a second time
+static void RecordPakAsLoaded(const CPakFile* const pak)
+{
+    if (pak->header()->crc != 0)
+        g_assetData.m_pakLoadStatusMap.emplace(pak->header()->crc, true);
+
+    for (const uint64_t crc : pak->GetPatchFileCrcs())
+        g_assetData.m_pakLoadStatusMap.emplace(crc, true);
+}
+
+// limits how many paks are loading at the same time, once we are over the memory budget paks are loaded one at a time
+// so we never hold more than loading them one after another would
+class CPakLoadGate
+{
+public:
+    CPakLoadGate() : m_numLoading(0u) {};
+
+    void Enter()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_condition.wait(lock, [this] { return m_numLoading == 0u || !IsOverBudget(); });
+
+        m_numLoading++;
+    }
+
+    void Leave()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_numLoading--;
+        }
+
+        m_condition.notify_all();
+    }
+
+private:
+    static const bool IsOverBudget()
+    {
+        const size_t budget = g_MemoryTracker.GetBudget();
+
+        return budget != 0ull && g_MemoryTracker.GetTotalStats().current >= static_cast<int64_t>(budget);
+    }
+
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    uint32_t m_numLoading;
+};
+
+// parses patch_master from the pak's directory the first time it's needed
+std::string ResolvePakPatchPath(const std::string& path)
+{
+    std::filesystem::path fsPath = path;
+
+    // If pak is not located in drive root (shouldn't happen but we might as well check)
+    if (!g_assetData.m_pakPatchMaster && fsPath.has_parent_path())
+    {
+        const std::filesystem::path dirPath = fsPath.parent_path();
+        const std::filesystem::path patchMasterPath = dirPath / "patch_master.rpak";
+
+        if (std::filesystem::exists(patchMasterPath))
+        {
+            // [rika]: prevent double load on patch_master and catch if it fails to load
+            g_assetData.m_pakPatchMaster = new CPakFile();
+            if (static_cast<CPakFile*>(g_assetData.m_pakPatchMaster)->ParseFileBuffer(patchMasterPath.string()))
+            {
+                RecordPakAsLoaded(static_cast<CPakFile*>(g_assetData.m_pakPatchMaster));
+            }
+            else
+            {
+                assertm(false, "Parsing patch_master from file failed.");
+                delete g_assetData.m_pakPatchMaster;
+                g_assetData.m_pakPatchMaster = nullptr;
+            }
+
+            //Log("[PTCH] Found %lld patch entries.\n", g_assetData.m_patchMasterEntries.size());           
+        }
+    }
+
+    if (g_assetData.m_pakPatchMaster)
+    {
+        const std::string pakStem = GetPakFileStemNoPatchNum(path);
+        const std::string basePakName = pakStem + ".rpak";
+
+        auto& patchMap = g_assetData.m_patchMasterEntries;
+        auto it = patchMap.find(basePakName);
+
+        if (it != patchMap.end())
+        {
+            const uint8_t patchVersion = patchMap.at(basePakName);
+
+            const std::string topPatchFileName = std::format("{}({:02}).rpak", pakStem, patchVersion);
+            fsPath.replace_filename(topPatchFileName);
+        }
+    }
+
+    return fsPath.string();
+}
+
+struct PakLoadJob_t
+{
+    std::string path; // the highest patch of the requested pak
+    CPakFile* pak;
+    double loadSeconds;
+    bool loaded;
+};
 
 void HandlePakLoad(std::vector<std::string> filePaths)
 {
-    std::atomic<uint32_t> pakLoadingProgress = 0;
-    const ProgressBarEvent_t* const pakLoadProgress = g_pImGuiHandler->AddProgressBarEvent("Loading Paks..", static_cast<uint32_t>(filePaths.size()), &pakLoadingProgress, true);
+    TRACE_ZONE("HandlePakLoad");
+
+    const auto startTime = std::chrono::high_resolution_clock::now();
 
     // If post-load has already been done when this function is called, then an ODL pak has been requested
     if (!g_assetData.m_donePostLoad)
     {
         if (g_assetData.m_pakPatchMaster)
+        {
             delete g_assetData.m_pakPatchMaster;
+            g_assetData.m_pakPatchMaster = nullptr;
+        }
 
         g_assetData.m_patchMasterEntries.clear();
         g_assetData.m_pakLoadStatusMap.clear();
     }
+
+    std::vector<PakLoadJob_t> loadJobs;
+    loadJobs.reserve(filePaths.size());
+
+    std::unordered_set<std::string> requestedPaths;
     
     for (const std::string& path : filePaths)
     {
-        std::filesystem::path fsPath = path;
+        const std::string pakPath = ResolvePakPatchPath(path);
 
-        // If pak is not located in drive root (shouldn't happen but we might as well check)
-        if (!g_assetData.m_pakPatchMaster && fsPath.has_parent_path())
-        {
-            const std::filesystem::path dirPath = fsPath.parent_path();
-            const std::filesystem::path patchMasterPath = dirPath / "patch_master.rpak";
+        if (pakPath != path)
+            Log("Loading highest patch '%s' instead of requested file '%s'\n", std::filesystem::path(pakPath).filename().string().c_str(), path.c_str());
 
-            if (std::filesystem::exists(patchMasterPath))
-            {
-                // [rika]: prevent double load on patch_master and catch if it fails to load
-                g_assetData.m_pakPatchMaster = new CPakFile();
-                if (static_cast<CPakFile*>(g_assetData.m_pakPatchMaster)->ParseFileBuffer(patchMasterPath.string()))
-                {
-                    const CPakFile* const pak = static_cast<CPakFile*>(g_assetData.m_pakPatchMaster);
+        // several patches of the same pak all end up at the highest one, only load it once
+        if (!requestedPaths.emplace(pakPath).second)
+            continue;
 
-                    if (pak->header()->crc != 0)
-                        g_assetData.m_pakLoadStatusMap.emplace(pak->header()->crc, true);
-                }
-                else
-                {
-                    assertm(false, "Parsing patch_master from file failed.");
-                    delete g_assetData.m_pakPatchMaster;
-                    g_assetData.m_pakPatchMaster = nullptr;
-                }
+        loadJobs.push_back({ pakPath, nullptr, 0.0, false });
+    }
 
-                //Log("[PTCH] Found %lld patch entries.\n", g_assetData.m_patchMasterEntries.size());           
-            }
-        }
+    if (loadJobs.empty())
+        return;
 
-        if (g_assetData.m_pakPatchMaster)
-        {
-            const std::string pakStem = GetPakFileStemNoPatchNum(path);
-            const std::string basePakName = pakStem + ".rpak";
+    // decompress and patch the paks in parallel, nothing is registered yet so the paks don't touch any shared asset data
+    std::atomic<uint32_t> pakLoadingProgress = 0;
+    const ProgressBarEvent_t* const pakLoadProgress = g_pImGuiHandler->AddProgressBarEvent("Loading Paks..", static_cast<uint32_t>(loadJobs.size()), &pakLoadingProgress, true);
 
-            auto& patchMap = g_assetData.m_patchMasterEntries;
-            auto it = patchMap.find(basePakName);
+    const uint32_t numThreads = static_cast<uint32_t>(std::min(static_cast<size_t>(std::max(UtilsConfig->pakLoadThreadCount, 1u)), loadJobs.size()));
 
-            if (it != patchMap.end())
-            {
-                const uint8_t patchVersion = patchMap.at(basePakName);
+    CPakLoadGate loadGate;
 
-                const std::string topPatchFileName = std::format("{}({:02}).rpak", pakStem, patchVersion);
-                fsPath.replace_filename(topPatchFileName);
+    ParallelFor(loadJobs.size(), numThreads, [&loadJobs, &loadGate, &pakLoadingProgress](const size_t i)
+    {
+        PakLoadJob_t& job = loadJobs[i];
 
-                Log("Loading highest patch '%s' instead of requested file '%s'\n", topPatchFileName.c_str(), path.c_str());
-            }
-        }
+        loadGate.Enter();
+
+        const auto loadStartTime = std::chrono::high_resolution_clock::now();
+
+        job.pak = new CPakFile();
+        job.loaded = job.pak->LoadFileBuffer(job.path);
+        job.loadSeconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - loadStartTime).count();
+
+        loadGate.Leave();
+
+        ++pakLoadingProgress;
+    });
+
+    g_pImGuiHandler->FinishProgressBarEvent(pakLoadProgress);
+
+    const double loadSeconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - startTime).count();
+
+    // register the assets in the order the paks were requested, so the asset list doesn't depend on which pak finished loading first.
+    // post-load runs once for all of them after this returns
+    uint32_t numLoadedPaks = 0u;
+    for (PakLoadJob_t& job : loadJobs)
+    {
+        CPakFile* const pak = job.pak;
 
-        if (CPakFile* const pak = new CPakFile(); pak->ParseFileBuffer(fsPath.string()))
+        if (!job.loaded)
         {
-            if(pak->header()->crc != 0)
-                g_assetData.m_pakLoadStatusMap.emplace(pak->header()->crc, true);
+            Log("PAK: Pak '%s' failed to load\n", job.path.c_str());
+            delete pak;
 
-            g_assetData.v_assetContainers.emplace_back(pak);
+            continue;
         }
-        else
+
+        // a pak requested earlier in this batch can be the same file, or have it as one of its patches
+        if (pak->header()->crc != 0 && g_assetData.m_pakLoadStatusMap.contains(pak->header()->crc))
         {
-            //assertm(false, "Parsing pak from file failed.");
+            Log("Pakfile '%s' failed to load because its CRC was already recorded as being loaded.\n", job.path.c_str());
             delete pak;
+
+            continue;
         }
-        ++pakLoadingProgress;
+
+        const auto registerStartTime = std::chrono::high_resolution_clock::now();
+
+        RecordPakAsLoaded(pak);
+        pak->ProcessAssets();
+
+        g_assetData.v_assetContainers.emplace_back(pak);
+
+        const double registerSeconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - registerStartTime).count();
+
+        Log("PAK: Loaded '%s' in %.1f ms, %d assets processed in %.1f ms\n", pak->GetFileName().c_str(), job.loadSeconds * 1000.0, pak->assetCount(), registerSeconds * 1000.0);
+
+        numLoadedPaks++;
+
+        // drop cached parsed data if we are getting close to the memory budget, only from this thread since the load workers can't know what's being read
+        g_MemoryTracker.EnforceBudget();
     }
-    g_pImGuiHandler->FinishProgressBarEvent(pakLoadProgress);
+
+    const double totalSeconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - startTime).count();
+
+    Log("PAK: Loaded %u of %lld paks on %u threads in %.2f seconds (%.2f seconds loading, %.2f seconds processing assets)\n",
+        numLoadedPaks, loadJobs.size(), numThreads, totalSeconds, loadSeconds, totalSeconds - loadSeconds);
 }
 
 static void TraverseAssetDependencies(CPakAsset* const asset, std::deque<CPakAsset*>& cpyAssets)
@@ -118,12 +263,29 @@ static void TraverseAssetDependencies(CPakAsset* const asset, std::deque<CPakAss
         cpyAssets.emplace_back(asset);
 }
 
+// number of list/all exports running, these write out shared export data (e.g. the shader blob manifest) once they are done
+// instead of it being written after every asset
+static std::atomic<uint32_t> s_numExportBatches = 0u;
+
+// writes out shared export data and forgets what has been exported, once nothing else is being exported
+static void FinishExportRun()
+{
+    if (s_numExportBatches.load() != 0u)
+        return;
+
+    g_ShaderBlobStore.WriteManifest();
+    g_MaterialExportCache.ResetExportedTextures();
+}
+
 static void HandleExportBindingForAssetEx(CAsset* const asset)
 {
     if (auto it = g_assetData.m_assetTypeBindings.find(asset->GetAssetType()); it != g_assetData.m_assetTypeBindings.end())
     {
         if (it->second.e.exportFunc)
         {
+            TRACE_ZONE_TYPE("Export", it->first);
+            MEMORY_TYPE_SCOPE(it->first);
+
             const bool exported = it->second.e.exportFunc(asset, it->second.e.exportSetting);
             asset->SetExportedStatus(exported);
         }
@@ -193,60 +355,145 @@ FORCEINLINE void HandleExportBindingForAsset(CAsset* const asset, const bool exp
     }
     else
         HandleExportBindingForAssetEx(asset);
+
+    FinishExportRun();
+}
+
+// creates the directories we know an export plan will write to before any workers start
+static void PrecreateExportDirectories(const std::vector<const CAsset*>& assets)
+{
+    // directories may have been removed since the last export
+    FileSystem::ClearDirectoryCache();
+
+    // only full paths can be derived from the asset name alone, truncated paths are decided by each asset type
+    if (!g_ExportSettings.exportPathsFull)
+        return;
+
+    std::vector<std::filesystem::path> directories;
+    directories.reserve(assets.size());
+
+    for (const CAsset* const asset : assets)
+    {
+        if (asset->GetAssetContainerType() != CAsset::ContainerType::PAK)
+            continue;
+
+        const std::filesystem::path assetPath(asset->GetAssetName());
+        if (assetPath.has_parent_path())
+            directories.emplace_back(g_ExportSettings.GetExportDirectory() / assetPath.parent_path());
+    }
+
+    FileSystem::PrecreateDirectories(directories);
+}
+
+// exports the assets in chunks when there is a memory budget, so it can be enforced between them on this thread while no worker is exporting.
+// evictors free parsed data that exporters read without holding a reference, so the budget can't be enforced from the workers themselves.
+static void ExportAssetsInChunks(const std::vector<CAsset*>& assets, const bool exportDependencies, const bool exportDependents, const char* const eventName)
+{
+    const uint32_t numThreads = std::max(UtilsConfig->exportThreadCount, 1u);
+    const size_t chunkSize = g_MemoryTracker.GetBudget() ? static_cast<size_t>(numThreads) * 16ull : assets.size();
+
+    std::atomic<uint32_t> numExported = 0u;
+    const ProgressBarEvent_t* const exportEvent = g_pImGuiHandler->AddProgressBarEvent(eventName, static_cast<uint32_t>(assets.size()), &numExported, true);
+
+    for (size_t chunkStart = 0ull; chunkStart < assets.size(); chunkStart += chunkSize)
+    {
+        const size_t chunkEnd = std::min(chunkStart + chunkSize, assets.size());
+
+        CParallelTask parallelProcessTask(numThreads);
+
+        for (size_t i = chunkStart; i < chunkEnd; i++)
+        {
+            CAsset* const asset = assets[i];
+
+            std::function<void()> task = [asset, exportDependencies, exportDependents, &numExported]
+            {
+                HandleExportBindingForAsset(asset, exportDependencies, exportDependents);
+                ++numExported;
+            };
+            parallelProcessTask.addTask(task, 1u);
+        }
+
+        parallelProcessTask.execute();
+        parallelProcessTask.wait();
+
+        // another batch's workers could still be reading data we'd evict
+        if (s_numExportBatches.load() == 1u)
+            g_MemoryTracker.EnforceBudget();
+    }
+
+    g_pImGuiHandler->FinishProgressBarEvent(exportEvent);
 }
 
 void HandlePakAssetExportList(std::deque<CAsset*> selectedAssets, const bool exportDependencies, const bool exportDependents)
 {
+    TRACE_ZONE("HandlePakAssetExportList");
+
     assertm(selectedAssets.size() > 0, "selectedAssets is empty.");
 
-    CParallelTask parallelProcessTask(UtilsConfig->exportThreadCount);
+    PrecreateExportDirectories(std::vector<const CAsset*>(selectedAssets.begin(), selectedAssets.end()));
+
+    s_numExportBatches++;
+
+    // audio sources get exported per bank after everything else
+    std::vector<CAsset*> exportAssets;
+    std::vector<CAsset*> audioAssets;
 
     for (auto& asset : selectedAssets)
     {
-        std::function<void()> task = [asset, exportDependencies, exportDependents]
-        {
-            HandleExportBindingForAsset(asset, exportDependencies, exportDependents);
-        };
-        parallelProcessTask.addTask(task, 1u);
+        if (asset->GetAssetContainerType() == CAsset::ContainerType::AUDIO)
+            audioAssets.push_back(asset);
+        else
+            exportAssets.push_back(asset);
     }
 
-    const ProgressBarEvent_t* const exportAssetListEvent = g_pImGuiHandler->AddProgressBarEvent(
-        "Exporting asset list...",
-        parallelProcessTask.getRemainingTasks(),
-        &parallelProcessTask,
-        PB_FNCLASS_TO_VOID(&CParallelTask::getRemainingTasks));
-    parallelProcessTask.execute();
-    parallelProcessTask.wait();
-    g_pImGuiHandler->FinishProgressBarEvent(exportAssetListEvent);
+    ExportAssetsInChunks(exportAssets, exportDependencies, exportDependents, "Exporting asset list...");
+
+    HandleExportAudioSources(std::move(audioAssets));
+
+    s_numExportBatches--;
+    FinishExportRun();
+
+    FileSystem::LogDirectoryCacheStats();
 }
 
 
 
 void HandleExportAllPakAssets(std::vector<CGlobalAssetData::AssetLookup_t>* const pakAssets, const bool exportDependencies, const bool exportDependents)
 {
+    TRACE_ZONE("HandleExportAllPakAssets");
+
     assertm(g_assetData.v_assetContainers.size() > 0, "No paks loaded.");
     assertm(pakAssets->size() > 0, "No assets?");
 
-    CParallelTask parallelProcessTask(UtilsConfig->exportThreadCount);
+    std::vector<const CAsset*> planAssets;
+    planAssets.reserve(pakAssets->size());
+    for (const auto& asset : *pakAssets)
+        planAssets.push_back(asset.m_asset);
+
+    PrecreateExportDirectories(planAssets);
+
+    s_numExportBatches++;
+
+    // audio sources get exported per bank after everything else
+    std::vector<CAsset*> exportAssets;
+    std::vector<CAsset*> audioAssets;
 
     for (auto& asset : *pakAssets)
     {
-        std::function<void()> task = [asset, exportDependencies, exportDependents]
-        {
-            HandleExportBindingForAsset(asset.m_asset, exportDependencies, exportDependents);
-        };
-        parallelProcessTask.addTask(task, 1u);
+        if (asset.m_asset->GetAssetContainerType() == CAsset::ContainerType::AUDIO)
+            audioAssets.push_back(asset.m_asset);
+        else
+            exportAssets.push_back(asset.m_asset);
     }
 
-    const ProgressBarEvent_t* const exportAllAssetsEvent = g_pImGuiHandler->AddProgressBarEvent(
-        "Exporting all assets...",
-        parallelProcessTask.getRemainingTasks(),
-        &parallelProcessTask,
-        PB_FNCLASS_TO_VOID(&CParallelTask::getRemainingTasks)
-    );
-    parallelProcessTask.execute();
-    parallelProcessTask.wait();
-    g_pImGuiHandler->FinishProgressBarEvent(exportAllAssetsEvent);
+    ExportAssetsInChunks(exportAssets, exportDependencies, exportDependents, "Exporting all assets...");
+
+    HandleExportAudioSources(std::move(audioAssets));
+
+    s_numExportBatches--;
+    FinishExportRun();
+
+    FileSystem::LogDirectoryCacheStats();
 }
 
 void HandleExportSelectedAssetType(std::vector<CGlobalAssetData::AssetLookup_t> pakAssets, const bool exportDependencies, const bool exportDependents)
@@ -0,0 +1,309 @@
+#include <pch.h>
+#include <core/logging/logbuffer.h>
+
+CLogger g_Logger;
+
+// owns this thread's buffer, marks it as orphaned when the thread exits so the consumer can free it
+struct ThreadLogBufferHandle_t
+{
+	~ThreadLogBufferHandle_t()
+	{
+		if (buffer)
+			buffer->orphaned.store(true, std::memory_order_release);
+	}
+
+	CLogRingBuffer* buffer = nullptr;
+};
+
+static thread_local ThreadLogBufferHandle_t s_threadLogBuffer;
+
+void CLogger::Init(const uint8_t outputs, const char* const logFilePath)
+{
+	m_outputs = outputs;
+
+	if (logFilePath)
+	{
+		if (fopen_s(&m_outputFile, logFilePath, "wb") != 0)
+		{
+			m_outputFile = nullptr;
+			printf("LOG: failed to open log file \"%s\", logging to stdout\n", logFilePath);
+		}
+	}
+
+	if (m_running.exchange(true))
+		return;
+
+	m_consumerThread = std::thread(&CLogger::ConsumerThread, this);
+}
+
+void CLogger::Shutdown()
+{
+	if (m_running.exchange(false))
+		m_consumerThread.join();
+
+	// pick up anything written after the consumer stopped
+	Flush();
+
+	if (const uint64_t numDropped = GetNumDropped())
+	{
+		FILE* const outFile = m_outputFile ? m_outputFile : stdout;
+		fprintf(outFile, "LOG: %llu messages were dropped\n", numDropped);
+	}
+
+	if (m_outputFile)
+	{
+		fclose(m_outputFile);
+		m_outputFile = nullptr;
+	}
+}
+
+CLogRingBuffer* const CLogger::GetThreadBuffer()
+{
+	if (!s_threadLogBuffer.buffer)
+	{
+		std::lock_guard<std::mutex> lock(m_bufferMutex);
+		s_threadLogBuffer.buffer = m_buffers.emplace_back(std::make_unique<CLogRingBuffer>()).get();
+	}
+
+	return s_threadLogBuffer.buffer;
+}
+
+void CLogger::Write(const eLogSeverity severity, const char* const source, const uint64_t assetGuid, const uint32_t code, const char* fmt, va_list args)
+{
+	CLogRingBuffer* const buffer = GetThreadBuffer();
+
+	LogRecord_t* record = buffer->BeginWrite();
+
+	// buffer is full, give the consumer a moment to catch up
+	for (int i = 0; !record && i < 64; ++i)
+	{
+		std::this_thread::yield();
+		record = buffer->BeginWrite();
+	}
+
+	// the consumer is falling behind (or isn't running), drain the buffers on this thread instead of dropping the message
+	if (!record)
+	{
+		Flush();
+		record = buffer->BeginWrite();
+	}
+
+	// only this thread writes to its buffer, so it can't still be full after draining
+	if (!record)
+	{
+		m_numDropped.fetch_add(1ull, std::memory_order_relaxed);
+		return;
+	}
+
+	record->assetGuid = assetGuid;
+	record->timestamp = static_cast<int64_t>(std::time(nullptr));
+	record->code = code;
+	record->severity = severity;
+
+	strncpy_s(record->source, source ? source : "N/A", _TRUNCATE);
+	vsnprintf(record->message, sizeof(record->message), fmt, args);
+
+	buffer->EndWrite();
+}
+
+void CLogger::Flush()
+{
+	std::lock_guard<std::mutex> lock(m_bufferMutex);
+
+	for (auto it = m_buffers.begin(); it != m_buffers.end();)
+	{
+		CLogRingBuffer* const buffer = it->get();
+
+		// read the orphaned flag before draining, anything written before the thread exited is then guaranteed to be drained
+		const bool orphaned = buffer->orphaned.load(std::memory_order_acquire);
+
+		while (const LogRecord_t* const record = buffer->BeginRead())
+		{
+			OutputRecord(record);
+			buffer->EndRead();
+		}
+
+		if (orphaned && buffer->IsEmpty())
+			it = m_buffers.erase(it);
+		else
+			++it;
+	}
+
+	if (m_outputFile)
+		fflush(m_outputFile);
+	else if (m_outputs & (LOG_OUTPUT_TEXT | LOG_OUTPUT_JSON))
+		fflush(stdout);
+}
+
+void CLogger::ConsumerThread()
+{
+	while (m_running.load(std::memory_order_relaxed))
+	{
+		Flush();
+		std::this_thread::sleep_for(std::chrono::milliseconds(5));
+	}
+}
+
+static void WriteJSONString(std::string& out, const char* str)
+{
+	out.push_back('"');
+
+	for (; *str; ++str)
+	{
+		const char c = *str;
+		switch (c)
+		{
+		case '"':
+			out.append("\\\"");
+			break;
+		case '\\':
+			out.append("\\\\");
+			break;
+		case '\n':
+			out.append("\\n");
+			break;
+		case '\r':
+			out.append("\\r");
+			break;
+		case '\t':
+			out.append("\\t");
+			break;
+		default:
+		{
+			if (static_cast<unsigned char>(c) < 0x20)
+			{
+				char escaped[8];
+				snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+				out.append(escaped);
+			}
+			else
+				out.push_back(c);
+
+			break;
+		}
+		}
+	}
+
+	out.push_back('"');
+}
+
+void CLogger::OutputRecord(const LogRecord_t* const record)
+{
+	const uint8_t outputs = m_outputs.load(std::memory_order_relaxed);
+	if (outputs == LOG_OUTPUT_NONE)
+		return;
+
+	const uint8_t severityIdx = static_cast<uint8_t>(record->severity) < static_cast<uint8_t>(eLogSeverity::LOG_SEV_COUNT) ? static_cast<uint8_t>(record->severity) : 0u;
+
+	char timestampStr[16] = {};
+	const time_t t = static_cast<time_t>(record->timestamp);
+	tm tm;
+	if (!localtime_s(&tm, &t))
+		strftime(timestampStr, sizeof(timestampStr), "%H:%M:%S", &tm);
+
+	// strip the trailing new line, the outputs add their own
+	size_t messageLength = strnlen_s(record->message, sizeof(record->message));
+	while (messageLength > 0 && record->message[messageLength - 1] == '\n')
+		messageLength--;
+
+	const std::string message(record->message, messageLength);
+
+	FILE* const outFile = m_outputFile ? m_outputFile : stdout;
+
+	if (outputs & LOG_OUTPUT_TEXT)
+	{
+		switch (record->severity)
+		{
+		case eLogSeverity::LOG_SEV_INFO:
+			fprintf(outFile, "[%s] %s\n", record->source, message.c_str());
+			break;
+		default:
+			fprintf(outFile, "%s [%s]: %s\n", s_LogLevelNames[severityIdx], record->source, message.c_str());
+			break;
+		}
+	}
+
+	if (outputs & LOG_OUTPUT_JSON)
+	{
+		std::string line;
+		line.reserve(128 + messageLength);
+
+		line.append("{\"time\":");
+		line.append(std::to_string(record->timestamp));
+		line.append(",\"level\":\"");
+		line.append(s_LogLevelNames[severityIdx]);
+		line.append("\",\"source\":");
+		WriteJSONString(line, record->source);
+		line.append(std::format(",\"guid\":\"0x{:016X}\",\"code\":{},\"message\":", record->assetGuid, record->code));
+		WriteJSONString(line, message.c_str());
+		line.append("}\n");
+
+		fwrite(line.data(), sizeof(char), line.size(), outFile);
+	}
+
+	if (outputs & LOG_OUTPUT_UI)
+	{
+		std::lock_guard<std::mutex> lock(m_uiMutex);
+		m_uiMessages.push_back({ record->severity, record->code, record->assetGuid, timestampStr, record->source, message });
+	}
+}
+
+void RunLogStressBenchmark(const uint32_t numThreads, const uint32_t numMessagesPerThread)
+{
+	// only measure the producer side, the consumer still drains but doesn't output anything
+	const uint8_t prevOutputs = g_Logger.GetOutputs();
+	g_Logger.SetOutputs(LOG_OUTPUT_NONE);
+
+	const uint64_t prevDropped = g_Logger.GetNumDropped();
+
+	std::vector<uint64_t> threadTimes(numThreads);
+	std::vector<std::thread> threads;
+	threads.reserve(numThreads);
+
+	auto logMessage = [](const uint64_t guid, const uint32_t i, ...)
+		{
+			va_list args;
+			va_start(args, i);
+			g_Logger.Write(eLogSeverity::LOG_SEV_WARNING, "benchmark.rpak", guid, i, "Failed to export asset '%llX': unsupported version %u", args);
+			va_end(args);
+		};
+
+	const auto startTime = std::chrono::high_resolution_clock::now();
+
+	for (uint32_t t = 0; t < numThreads; ++t)
+	{
+		threads.emplace_back([&threadTimes, &logMessage, t, numMessagesPerThread]
+			{
+				const auto threadStart = std::chrono::high_resolution_clock::now();
+
+				for (uint32_t i = 0; i < numMessagesPerThread; ++i)
+				{
+					const uint64_t guid = (static_cast<uint64_t>(t) << 32) | i;
+					logMessage(guid, i, guid, i);
+				}
+
+				threadTimes[t] = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::high_resolution_clock::now() - threadStart).count();
+			});
+	}
+
+	for (std::thread& thread : threads)
+		thread.join();
+
+	const uint64_t wallTime = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::high_resolution_clock::now() - startTime).count();
+
+	g_Logger.Flush();
+	g_Logger.SetOutputs(prevOutputs);
+
+	uint64_t totalThreadTime = 0ull;
+	for (const uint64_t time : threadTimes)
+		totalThreadTime += time;
+
+	const uint64_t totalMessages = static_cast<uint64_t>(numThreads) * numMessagesPerThread;
+	const uint64_t dropped = g_Logger.GetNumDropped() - prevDropped;
+
+	printf("LOG BENCHMARK: %u threads, %llu messages, %.1f ms wall time\n", numThreads, totalMessages, static_cast<double>(wallTime) / 1000000.0);
+	printf("LOG BENCHMARK: %.1f ns per message (producer), %.0f messages/s, %llu dropped\n",
+		totalMessages ? static_cast<double>(totalThreadTime) / static_cast<double>(totalMessages) : 0.0,
+		wallTime ? static_cast<double>(totalMessages) / (static_cast<double>(wallTime) / 1000000000.0) : 0.0,
+		dropped);
+}
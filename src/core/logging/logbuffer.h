@@ -0,0 +1,160 @@
+#pragma once
+
+// structured logging for asset containers
+// each thread writes fixed size records into its own lock free ring buffer, a consumer thread drains
+// the buffers and does the actual formatting/output, so logging never allocates or takes a lock on the hot path.
+
+enum class eLogSeverity : int8_t
+{
+	LOG_SEV_INVALID = -1,
+	LOG_SEV_INFO = 0,
+	LOG_SEV_WARNING,
+	LOG_SEV_ERROR,
+
+	LOG_SEV_COUNT,
+};
+
+static const char* s_LogLevelNames[] = {
+	"INFO",
+	"WARNING",
+	"ERROR",
+};
+
+static uint32_t s_LogLevelColours[] = {
+	0xFFFFFFFF,
+	0xFFFF00FF,
+	0xFF0000FF,
+};
+
+enum eLogOutput : uint8_t
+{
+	LOG_OUTPUT_NONE = 0,
+	LOG_OUTPUT_UI = (1 << 0),	// log window
+	LOG_OUTPUT_TEXT = (1 << 1),	// plain text lines
+	LOG_OUTPUT_JSON = (1 << 2),	// json lines
+};
+
+static constexpr size_t logRecordSize = 512;
+static constexpr size_t logRecordSourceSize = 64;
+static constexpr uint32_t logRingBufferCapacity = 1024; // records per thread, must be a power of two
+
+struct LogRecord_t
+{
+	uint64_t assetGuid; // 0 if this record is not about a specific asset
+	int64_t timestamp;
+	uint32_t code;
+	eLogSeverity severity;
+
+	char source[logRecordSourceSize];
+	char message[logRecordSize - logRecordSourceSize - 24]; // formatted by the producer, truncated if too long
+};
+static_assert(sizeof(LogRecord_t) == logRecordSize);
+
+// message as stored for the log window
+struct LogMessage_t
+{
+	eLogSeverity severity;
+	uint32_t code;
+	uint64_t assetGuid;
+
+	std::string timestampStr;
+	std::string sourceName;
+	std::string message;
+};
+
+// single producer (owning thread), single consumer (log thread)
+class CLogRingBuffer
+{
+public:
+	CLogRingBuffer() : records(new LogRecord_t[logRingBufferCapacity]), head(0u), tail(0u), orphaned(false) {};
+
+	inline LogRecord_t* const BeginWrite()
+	{
+		const uint32_t writePos = head.load(std::memory_order_relaxed);
+		if (writePos - tail.load(std::memory_order_acquire) >= logRingBufferCapacity)
+			return nullptr; // full
+
+		return &records[writePos & (logRingBufferCapacity - 1)];
+	}
+
+	inline void EndWrite()
+	{
+		head.store(head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+	}
+
+	inline const LogRecord_t* const BeginRead() const
+	{
+		const uint32_t readPos = tail.load(std::memory_order_relaxed);
+		if (readPos == head.load(std::memory_order_acquire))
+			return nullptr; // empty
+
+		return &records[readPos & (logRingBufferCapacity - 1)];
+	}
+
+	inline void EndRead()
+	{
+		tail.store(tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+	}
+
+	inline const bool IsEmpty() const { return tail.load(std::memory_order_acquire) == head.load(std::memory_order_acquire); }
+
+	std::unique_ptr<LogRecord_t[]> records;
+
+	alignas(64) std::atomic<uint32_t> head; // written by the producer
+	alignas(64) std::atomic<uint32_t> tail; // written by the consumer
+
+	std::atomic<bool> orphaned; // owning thread has exited, free once drained
+};
+
+class CLogger
+{
+public:
+	CLogger() : m_outputs(LOG_OUTPUT_UI), m_outputFile(nullptr), m_running(false), m_numDropped(0ull) {};
+	~CLogger()
+	{
+		Shutdown();
+	}
+
+	void Init(const uint8_t outputs, const char* const logFilePath = nullptr);
+	void Shutdown();
+
+	// thread safe and lock free unless this thread has never logged before, or its buffer is full and has to be drained here
+	void Write(const eLogSeverity severity, const char* const source, const uint64_t assetGuid, const uint32_t code, const char* fmt, va_list args);
+
+	// drains every thread's buffer, safe to call from any thread
+	void Flush();
+
+	inline void SetOutputs(const uint8_t outputs) { m_outputs = outputs; }
+	inline const uint8_t GetOutputs() const { return m_outputs; }
+
+	// log window access, hold the lock for as long as the messages are used
+	inline std::unique_lock<std::mutex> LockUIMessages() { return std::unique_lock<std::mutex>(m_uiMutex); }
+	inline const std::vector<LogMessage_t>& GetUIMessages() const { return m_uiMessages; }
+
+	inline const uint64_t GetNumDropped() const { return m_numDropped.load(std::memory_order_relaxed); }
+
+private:
+	CLogRingBuffer* const GetThreadBuffer();
+
+	void ConsumerThread();
+	void OutputRecord(const LogRecord_t* const record);
+
+	std::vector<std::unique_ptr<CLogRingBuffer>> m_buffers;
+	std::mutex m_bufferMutex; // guards m_buffers, only taken when a thread registers and while draining
+
+	std::vector<LogMessage_t> m_uiMessages;
+	std::mutex m_uiMutex;
+
+	std::atomic<uint8_t> m_outputs;
+	FILE* m_outputFile; // text/json output, stdout if no file was provided
+
+	std::thread m_consumerThread;
+	std::atomic<bool> m_running;
+
+	std::atomic<uint64_t> m_numDropped;
+};
+
+extern CLogger g_Logger;
+
+// measures producer side cost of logging from multiple threads, results are printed to stdout
+void RunLogStressBenchmark(const uint32_t numThreads, const uint32_t numMessagesPerThread);
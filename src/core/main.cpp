@@ -14,6 +14,7 @@
 #include <core/utils/exportsettings.h>
 #include <core/utils/autoupdater.h>
 #include <core/filehandling/load.h>
+#include <core/logging/logbuffer.h>
 
 #include <core/window.h>
 #include <core/render.h>
@@ -28,7 +29,7 @@ CBufferManager g_BufferManager; // called constructor on init.
 ExportSettings_t g_ExportSettings{ .exportNormalRecalcSetting = eNormalExportRecalc::NML_RECALC_NONE, .exportTextureNameSetting = eTextureExportName::TXTR_NAME_TEXT,
     .exportMaterialTextures = true, .exportPathsFull = false, .exportAssetDeps = false, .exportAssetDependents = false, .disableCachedNames = false, .previewedSkinIndex = 0,
     .qcMajorVersion = 49, .qcMinorVersion = 0, .exportRigSequences = true, .exportModelSkin = false, .exportModelMatsTruncated = false,
-    .exportQCIFiles = false, .exportPhysicsContentsFilter = static_cast<uint32_t>(TRACE_MASK_ALL), .exportDirectory = ""
+    .exportQCIFiles = false, .exportPhysicsContentsFilter = static_cast<uint32_t>(TRACE_MASK_ALL), .exportFlacCompressionLevel = 5, .exportDirectory = ""
 };
 
 // Handle CLI to only init certain asset types.
@@ -237,6 +238,23 @@ int main(int argc, char* argv[])
     if (noGui)
         g_ExportSettings.SetFromCLI(&cli);
 
+    // container/asset logs go to the log window, CLI gets text (or json lines) on stdout or in the provided log file
+    {
+        const char* const logFormat = cli.GetParamValue("--logformat");
+        const uint8_t streamOutput = (logFormat && !_stricmp(logFormat, "json")) ? LOG_OUTPUT_JSON : LOG_OUTPUT_TEXT;
+
+        uint8_t logOutputs = noGui ? streamOutput : LOG_OUTPUT_UI;
+#if defined(_DEBUG)
+        logOutputs |= streamOutput;
+#endif
+
+        g_Logger.Init(logOutputs, cli.GetParamValue("--logfile"));
+    }
+
+    // records load/post-load/export zones, written out as a chrome trace on exit
+    if (const char* const tracePath = cli.GetParamValue("--trace"))
+        g_Profiler.Enable(tracePath);
+
 #if defined(_WIN32)
     // https://github.com/microsoft/DirectXTex/wiki/DirectXTex#initialization
     // [rika]: supposed to be done per thread but it Just Works so I'm not messing with it
@@ -315,6 +333,16 @@ int main(int argc, char* argv[])
 
         if (const char* const numExportThreads = cli.GetParamValue("--exportthreads"))
             UtilsConfig->exportThreadCount = clamp(static_cast<uint32_t>(atoi(numExportThreads)), 1u, totalThreadCount);
+
+        if (const char* const numPakLoadThreads = cli.GetParamValue("--pakloadthreads"))
+            UtilsConfig->pakLoadThreadCount = clamp(static_cast<uint32_t>(atoi(numPakLoadThreads)), 1u, totalThreadCount);
+
+        // cached parsed data gets evicted to stay under this many MiB
+        if (const char* const memoryBudget = cli.GetParamValue("--memorybudget"))
+            g_MemoryTracker.SetBudget(static_cast<size_t>(atoll(memoryBudget)) * 1024ull * 1024ull);
+
+        if (cli.HasParam("-logbenchmark"))
+            RunLogStressBenchmark(UtilsConfig->exportThreadCount, 100000u);
     }
 
     // call after initializing dx and gui otherwise you will crash
@@ -356,6 +384,10 @@ int main(int argc, char* argv[])
 
     delete g_dxHandler;
 
+    g_Profiler.Dump();
+
+    g_Logger.Shutdown();
+
 	return EXIT_SUCCESS;
 }
 
@@ -39,13 +39,14 @@ namespace animqc
 	// Write consolidated QC file
 	bool WriteQCFile(const QCModelData& model, const std::filesystem::path& outputPath)
 	{
-		std::ofstream out(outputPath);
-		if (!out)
+		StreamIO outFile(outputPath, eStreamIOMode::Write, true);
+		if (!outFile.W())
 		{
 			Log("ANIMQC: Failed to open output file: %s\n", outputPath.string().c_str());
 			return false;
 		}
 
+		std::ofstream& out = *outFile.W();
 		out << std::fixed << std::setprecision(6);
 
 		if (model.hasRrig)
@@ -175,7 +176,7 @@ namespace animqc
 			out << "}\n\n";
 		}
 
-		out.close();
+		outFile.close();
 		Log("ANIMQC: Exported QC file to: %s\n", outputPath.string().c_str());
 		return true;
 	}
@@ -640,6 +641,10 @@ namespace animqc
 
 				// Export this animseq as SMD
 				std::filesystem::path smdPath = animsDir / std::filesystem::path(seq->szlabel).replace_extension(".smd");
+
+				AcquireAnimSeqAnimations(animSeqAsset);
+				const CEvictableDataRef animDataRef(&animSeqAsset->animData);
+
 				ExportSeqDesc(eAnimSeqExportSetting::ANIMSEQ_SMD, seq, smdPath, animRigAsset->name, &parsedData->bones, guid);
 
 				// Add sequence data to QC
@@ -416,7 +416,7 @@ ModelSeq_t::ModelSeq_t(const r2::mstudioseqdesc_t* const seqdesc) : baseptr(rein
 	entryphase(seqdesc->entryphase), exitphase(seqdesc->exitphase), lastframe(seqdesc->lastframe), nextseq(seqdesc->nextseq), pose(seqdesc->pose), autolayers(nullptr), numautolayers(seqdesc->numautolayers), weights(seqdesc->pBoneweight(0)),
 	posekeys(seqdesc->posekeyindex ? seqdesc->pPoseKey(0, 0) : nullptr), keyvalues(seqdesc->pKeyValues()), iklocks(nullptr), numiklocks(seqdesc->numiklocks), cycleposeindex(seqdesc->cycleposeindex), activitymodifiers(nullptr), numactivitymodifiers(seqdesc->numactivitymodifiers),
 	ikResetMask(seqdesc->ikResetMask),
-	anims(nullptr), parsedData(seqdesc->AnimCount())
+	anims(nullptr), parsedData(seqdesc->AnimCount(), eMemoryCategory::MEM_ANIM_DATA)
 {
 	paramindex[0] = seqdesc->paramindex[0];
 	paramindex[1] = seqdesc->paramindex[1];
@@ -492,7 +492,7 @@ ModelSeq_t::ModelSeq_t(const r5::mstudioseqdesc_v8_t* const seqdesc) : baseptr(r
 	entryphase(seqdesc->entryphase), exitphase(seqdesc->exitphase), lastframe(seqdesc->lastframe), nextseq(seqdesc->nextseq), pose(seqdesc->pose), autolayers(nullptr), numautolayers(seqdesc->numautolayers), weights(seqdesc->pBoneweight(0)),
 	posekeys(seqdesc->posekeyindex ? seqdesc->pPoseKey(0, 0) : nullptr), keyvalues(seqdesc->pKeyValues()), iklocks(nullptr), numiklocks(seqdesc->numiklocks), cycleposeindex(seqdesc->cycleposeindex), activitymodifiers(nullptr), numactivitymodifiers(seqdesc->numactivitymodifiers),
 	ikResetMask(seqdesc->ikResetMask),
-	anims(nullptr), parsedData(seqdesc->AnimCount())
+	anims(nullptr), parsedData(seqdesc->AnimCount(), eMemoryCategory::MEM_ANIM_DATA)
 {
 	paramindex[0] = seqdesc->paramindex[0];
 	paramindex[1] = seqdesc->paramindex[1];
@@ -571,7 +571,7 @@ ModelSeq_t::ModelSeq_t(const r5::mstudioseqdesc_v8_t* const seqdesc, const char*
 	entryphase(seqdesc->entryphase), exitphase(seqdesc->exitphase), lastframe(seqdesc->lastframe), nextseq(seqdesc->nextseq), pose(seqdesc->pose), autolayers(nullptr), numautolayers(seqdesc->numautolayers), weights(seqdesc->pBoneweight(0)),
 	posekeys(seqdesc->posekeyindex ? seqdesc->pPoseKey(0, 0) : nullptr), keyvalues(seqdesc->pKeyValues()), iklocks(nullptr), numiklocks(seqdesc->numiklocks), cycleposeindex(seqdesc->cycleposeindex), activitymodifiers(nullptr), numactivitymodifiers(seqdesc->numactivitymodifiers),
 	ikResetMask(seqdesc->ikResetMask),
-	anims(nullptr), parsedData(seqdesc->AnimCount())
+	anims(nullptr), parsedData(seqdesc->AnimCount(), eMemoryCategory::MEM_ANIM_DATA)
 {
 	paramindex[0] = seqdesc->paramindex[0];
 	paramindex[1] = seqdesc->paramindex[1];
@@ -663,7 +663,7 @@ ModelSeq_t::ModelSeq_t(const r5::mstudioseqdesc_v16_t* const seqdesc, const char
 	entryphase(0), exitphase(0), lastframe(0), nextseq(0), pose(0), autolayers(nullptr), numautolayers(seqdesc->numautolayers), weights(seqdesc->pBoneweight(0)),
 	posekeys(seqdesc->posekeyindex ? seqdesc->pPoseKey(0, 0) : nullptr), keyvalues(nullptr), iklocks(nullptr), numiklocks(seqdesc->numiklocks), cycleposeindex(seqdesc->cycleposeindex), activitymodifiers(nullptr), numactivitymodifiers(seqdesc->numactivitymodifiers),
 	ikResetMask(seqdesc->ikResetMask),
-	anims(nullptr), parsedData(seqdesc->AnimCount())
+	anims(nullptr), parsedData(seqdesc->AnimCount(), eMemoryCategory::MEM_ANIM_DATA)
 {
 	paramindex[0] = seqdesc->paramindex[0];
 	paramindex[1] = seqdesc->paramindex[1];
@@ -742,7 +742,7 @@ ModelSeq_t::ModelSeq_t(const r5::mstudioseqdesc_v18_t* const seqdesc, const char
 	entryphase(0), exitphase(0), lastframe(0), nextseq(0), pose(0), autolayers(nullptr), numautolayers(seqdesc->numautolayers), weights(seqdesc->pBoneweight(0)),
 	posekeys(seqdesc->posekeyindex ? seqdesc->pPoseKey(0, 0) : nullptr), keyvalues(nullptr), iklocks(nullptr), numiklocks(seqdesc->numiklocks), cycleposeindex(seqdesc->cycleposeindex), activitymodifiers(nullptr), numactivitymodifiers(seqdesc->numactivitymodifiers),
 	ikResetMask(seqdesc->ikResetMask),
-	anims(nullptr), parsedData(seqdesc->AnimCount())
+	anims(nullptr), parsedData(seqdesc->AnimCount(), eMemoryCategory::MEM_ANIM_DATA)
 {
 	paramindex[0] = seqdesc->paramindex[0];
 	paramindex[1] = seqdesc->paramindex[1];
@@ -529,7 +529,7 @@ struct ModelSeq_t
 	int ikResetMask;
 
 	ModelAnim_t* anims;
-	CRamen parsedData;
+	CRamen parsedData{ eMemoryCategory::MEM_ANIM_DATA };
 
 	inline const ModelAnim_t* const Anim(const int i) const { return anims + i; }
 	inline const int AnimCount() const { return numblends; }
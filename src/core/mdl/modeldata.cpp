@@ -683,7 +683,7 @@ struct ModelMaterialExport_t
 {
 	ModelMaterialExport_t(MaterialAsset* const material, const int materialId) : asset(material), id(materialId) {}
 
-	std::unordered_map<uint32_t, MaterialTextureExportInfo_s> textures;
+	std::shared_ptr<const MaterialTextureExportMap_t> textures; // shared with every other export of this material
 	MaterialAsset* asset;
 	int id;
 };
@@ -733,7 +733,7 @@ void HandleModelMaterials(const ModelParsedData_t* const parsedData, std::unorde
 			continue;
 		}
 
-		ParseMaterialTextureExportInfo(material.textures, material.asset, exportPath, eTextureExportName::TXTR_NAME_TEXT, useFullPaths);
+		material.textures = g_MaterialExportCache.GetTextureExportInfo(material.asset, exportPath, eTextureExportName::TXTR_NAME_TEXT, useFullPaths);
 
 		materials.emplace(baseId, material);
 	}
@@ -765,7 +765,7 @@ void HandleModelMaterials(const ModelParsedData_t* const parsedData, std::unorde
 
 		// enable exporting other image formats! (would if blender didn't smell)
 		// [rika]: the extension also needs to be altered in model export formats if we do this!
-		ExportMaterialTextures(eTextureExportSetting::PNG_HM, matlAsset, material.textures); // NOTE: LOOK INTO MAKING A FOLDER PER MATERIAL ?
+		ExportMaterialTextures(eTextureExportSetting::PNG_HM, matlAsset, *material.textures); // NOTE: LOOK INTO MAKING A FOLDER PER MATERIAL ?
 
 	}
 	g_pImGuiHandler->FinishProgressBarEvent(materialExportProgress);
@@ -837,7 +837,7 @@ bool ExportModelRMAX(const ModelParsedData_t* const parsedData, std::filesystem:
 			for (const TextureAssetEntry_t& entry : matlAsset->txtrAssets)
 			{
 				// [rika]: we don't have a resource binding or we don't have a name for the texture
-				if (!matlAsset->resourceBindings.count(entry.index) || !materialExport.textures.contains(entry.index))
+				if (!matlAsset->resourceBindings.count(entry.index) || !materialExport.textures || !materialExport.textures->contains(entry.index))
 					continue;
 
 				const std::string resource = matlAsset->resourceBindings.find(entry.index)->second.name;
@@ -846,7 +846,7 @@ bool ExportModelRMAX(const ModelParsedData_t* const parsedData, std::filesystem:
 				if (!rmax::s_TextureTypeMap.count(resource))
 					continue;
 
-				const MaterialTextureExportInfo_s& info = materialExport.textures.find(entry.index)->second;
+				const MaterialTextureExportInfo_s& info = materialExport.textures->find(entry.index)->second;
 				const std::string path = std::format("{}/{}", info.exportPath.string(), info.exportName);
 
 				matl->AddTexture(path.c_str(), rmax::s_TextureTypeMap.find(resource)->second);
@@ -1029,7 +1029,7 @@ bool ExportModelCast(const ModelParsedData_t* const parsedData, std::filesystem:
 					continue;
 
 				// [rika]: if MaterialTextureExportInfo_s doesn't exist for this texture it's not loaded, and by extension is not exported
-				if (!material.textures.contains(entry.index))
+				if (!material.textures || !material.textures->contains(entry.index))
 				{
 					// todo: store a name in parsed data
 					//Log("Material %s for model %s did not have a valid texture pointer for res idx %i\n", materialAsset->name, name, entry.index);
@@ -1037,7 +1037,7 @@ bool ExportModelCast(const ModelParsedData_t* const parsedData, std::filesystem:
 					continue;
 				}
 
-				const MaterialTextureExportInfo_s& info = material.textures.find(entry.index)->second;
+				const MaterialTextureExportInfo_s& info = material.textures->find(entry.index)->second;
 
 				const uint64_t textureGuid = entry.asset->data()->guid; // texture guid
 
@@ -562,7 +562,7 @@ public:
 		return *this;
 	}
 
-	CRamen meshVertexData;
+	CRamen meshVertexData{ eMemoryCategory::MEM_VERTEX_DATA };
 
 	std::vector<ModelBone_t> bones;
 	std::vector<ModelAttachment_t> attachments;
@@ -780,6 +780,8 @@ enum eModelExportSetting : int
 	// rmdl only for now, but can support sourcemodelasset in the future
 	MODEL_STL_VALVE_PHYSICS,
 	MODEL_STL_RESPAWN_PHYSICS,
+	MODEL_PLY_RESPAWN_PHYSICS, // indexed, with contents per face
+	MODEL_OBJ_RESPAWN_PHYSICS, // indexed
 
 	MODEL_COUNT,
 };
@@ -791,7 +793,9 @@ static const char* s_ModelExportSettingNames[] =
 	"RMDL",
 	"SMD",
 	"STL (Valve Physics)", 
-	"STL (Respawn Physics)"
+	"STL (Respawn Physics)",
+	"PLY (Respawn Physics)",
+	"OBJ (Respawn Physics)",
 };
 
 static const char* s_ModelExportExtensions[] =
@@ -77,7 +77,15 @@ namespace smd
 		outPath.append(exportName);
 		outPath.replace_extension(".smd");
 
+#ifndef STREAMIO
 		std::ofstream out(outPath, std::ios::out);
+#else
+		StreamIO outFile(outPath, eStreamIOMode::Write);
+		if (!outFile.W())
+			return;
+
+		std::ofstream& out = *outFile.W();
+#endif // !STREAMIO
 
 		out << "version " << s_outputVersion << "\n";
 
@@ -383,6 +383,8 @@ void ApplySelectionRequests(ImGuiMultiSelectIO* ms_io, std::deque<CAsset*>& sele
 void DrawSettingsWindow(CUIState* uiState)
 {
     constexpr uint32_t minThreads = 1u;
+    constexpr uint32_t minFlacLevel = 0u;
+    constexpr uint32_t maxFlacLevel = 8u;
 
     ImGui::SetNextWindowSize(ImVec2(850, 600), ImGuiCond_FirstUseEver);
     if (ImGui::Begin("Settings", &uiState->settingsWindowVisible))
@@ -493,6 +495,13 @@ void DrawSettingsWindow(CUIState* uiState)
         ImGui::SameLine();
         g_pImGuiHandler->HelpMarker("Filter only physics meshes containing all specified contents.");
 
+        // ===============================================================================================================
+        ImGui::SeparatorText("Audio");
+
+        ImGui::SliderScalar("FLAC Compression Level", ImGuiDataType_U32, &g_ExportSettings.exportFlacCompressionLevel, &minFlacLevel, &maxFlacLevel);
+        ImGui::SameLine();
+        g_pImGuiHandler->HelpMarker("Compression level used when exporting audio as FLAC.\n\n0 is the fastest to encode, 8 produces the smallest files. Higher levels take longer to export.");
+
         // ===============================================================================================================
         ImGui::SeparatorText("Parsing");
 
@@ -504,6 +513,10 @@ void DrawSettingsWindow(CUIState* uiState)
         ImGui::SameLine();
         g_pImGuiHandler->HelpMarker("The number of CPU threads that will be used for loading files.\n\nIn general, the higher the number, the faster RSX will be able to load the selected files.");
 
+        ImGui::SliderScalar("Pak Load Threads", ImGuiDataType_U32, &UtilsConfig->pakLoadThreadCount, &minThreads, reinterpret_cast<int*>(&maxConcurrentThreads));
+        ImGui::SameLine();
+        g_pImGuiHandler->HelpMarker("The number of pak files that will be decompressed and patched at the same time when loading multiple paks.\n\nOnce the memory budget set with --memorybudget is reached, paks are loaded one at a time.");
+
         ImGui::SliderScalar("Export Threads", ImGuiDataType_U32, &UtilsConfig->exportThreadCount, &minThreads, reinterpret_cast<int*>(&maxConcurrentThreads));
         ImGui::SameLine();
         g_pImGuiHandler->HelpMarker("The number of CPU threads that will be used for exporting assets.\n\nA higher number of threads will usually make RSX export assets more quickly, however the increased disk usage may cause decreased performance.");
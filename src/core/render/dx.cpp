@@ -134,8 +134,7 @@ bool CTexture::ExportAsPng(const std::filesystem::path& exportPath)
         }
     }
 
-    const HRESULT res = DirectX::SaveToWICFile(*ToScratchImage->GetImages(), DirectX::WIC_FLAGS::WIC_FLAGS_FORCE_SRGB, DirectX::GetWICCodec(DirectX::WICCodecs::WIC_CODEC_PNG), exportPath.wstring().c_str(), nullptr, 
-        [](IPropertyBag2* props)
+    const auto setPngOptions = [](IPropertyBag2* props)
         {
             PROPBAG2 options{};
             VARIANT varValues{};
@@ -144,13 +143,33 @@ bool CTexture::ExportAsPng(const std::filesystem::path& exportPath)
             varValues.bVal = WICPngFilterOption::WICPngFilterUp;
 
             props->Write(1u, &options, &varValues);
-        });
+        };
+
+    if (FileSystem::IsArchivedPath(exportPath))
+    {
+        DirectX::Blob blob;
+        if (FAILED(DirectX::SaveToWICMemory(*ToScratchImage->GetImages(), DirectX::WIC_FLAGS::WIC_FLAGS_FORCE_SRGB, DirectX::GetWICCodec(DirectX::WICCodecs::WIC_CODEC_PNG), blob, nullptr, setPngOptions)))
+            return false;
+
+        return g_ExportArchive.AddFile(exportPath, blob.GetBufferPointer(), blob.GetBufferSize());
+    }
+
+    const HRESULT res = DirectX::SaveToWICFile(*ToScratchImage->GetImages(), DirectX::WIC_FLAGS::WIC_FLAGS_FORCE_SRGB, DirectX::GetWICCodec(DirectX::WICCodecs::WIC_CODEC_PNG), exportPath.wstring().c_str(), nullptr, setPngOptions);
 
     return SUCCEEDED(res);
 }
 
 bool CTexture::ExportAsDds(const std::filesystem::path& exportPath)
 {
+    if (FileSystem::IsArchivedPath(exportPath))
+    {
+        DirectX::Blob blob;
+        if (FAILED(DirectX::SaveToDDSMemory(ToScratchImage->GetImages(), ToScratchImage->GetImageCount(), ToScratchImage->GetMetadata(), DirectX::DDS_FLAGS::DDS_FLAGS_NONE, blob)))
+            return false;
+
+        return g_ExportArchive.AddFile(exportPath, blob.GetBufferPointer(), blob.GetBufferSize());
+    }
+
     return SUCCEEDED(DirectX::SaveToDDSFile(ToScratchImage->GetImages(), ToScratchImage->GetImageCount(), ToScratchImage->GetMetadata(), DirectX::DDS_FLAGS::DDS_FLAGS_NONE, exportPath.wstring().c_str()));
 }
 
@@ -45,29 +45,32 @@ void LogWindow_Draw(CUIState* uiState)
 
 			ImGui::TableHeadersRow();
 
-			for (size_t i = 0; i < g_assetData.GetNumLogMessages(); ++i)
+			const std::unique_lock<std::mutex> lock = g_Logger.LockUIMessages();
+			const std::vector<LogMessage_t>& messages = g_Logger.GetUIMessages();
+
+			for (size_t i = 0; i < messages.size(); ++i)
 			{
-				const ContainerMessage_t* msg = &g_assetData.GetLogMessages()[i];
+				const LogMessage_t* msg = &messages[i];
 
 				ImGui::PushID(static_cast<int>(i));
 
 				ImGui::TableNextRow(ImGuiTableRowFlags_None, 0.f);
 
 				if (ImGui::TableSetColumnIndex(eLogMessageColumnID::LMC_LOG_TIME))
-					ImGui::TextUnformatted(msg->timestampStr);
+					ImGui::TextUnformatted(msg->timestampStr.c_str());
 
 #define HEX_TO_IMVEC4(hex) ImVec4(((hex & 0xFF000000) >> 24) / 255.f, ((hex & 0x00FF0000) >> 16) / 255.f, ((hex & 0x0000FF00) >> 8) / 255.f, (hex & 0xFF) / 255.f)
-				ImGui::PushStyleColor(ImGuiCol_Text, HEX_TO_IMVEC4(s_LogLevelColours[static_cast<uint8_t>(msg->type)]));
+				ImGui::PushStyleColor(ImGuiCol_Text, HEX_TO_IMVEC4(s_LogLevelColours[static_cast<uint8_t>(msg->severity)]));
 				if (ImGui::TableSetColumnIndex(eLogMessageColumnID::LMC_LOG_LEVEL))
-					ImGui::TextUnformatted(s_LogLevelNames[static_cast<uint8_t>(msg->type)]);
+					ImGui::TextUnformatted(s_LogLevelNames[static_cast<uint8_t>(msg->severity)]);
 				ImGui::PopStyleColor();
 #undef HEX_TO_IMVEC4
 
 				if (ImGui::TableSetColumnIndex(eLogMessageColumnID::LMC_LOG_SOURCE))
-					ImGui::TextUnformatted(msg->sourceName);
+					ImGui::TextUnformatted(msg->sourceName.c_str());
 
 				if (ImGui::TableSetColumnIndex(eLogMessageColumnID::LMC_LOG_MSG))
-					ImGui::TextWrapped(msg->message);
+					ImGui::TextWrapped("%s", msg->message.c_str());
 
 				ImGui::PopID();
 			}
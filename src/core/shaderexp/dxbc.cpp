@@ -0,0 +1,516 @@
+#include <pch.h>
+#include <core/shaderexp/dxbc.h>
+
+// https://github.com/microsoft/D3D12TranslationLayer/blob/master/DxbcParser/include/BlobContainer.h
+struct DXBCContainerHeader_t
+{
+	uint32_t fourCC;
+	uint8_t hash[16];
+	uint16_t versionMajor;
+	uint16_t versionMinor;
+	uint32_t containerSize; // including this header
+	uint32_t numParts;
+};
+static_assert(sizeof(DXBCContainerHeader_t) == 32);
+
+struct DXBCPartHeader_t
+{
+	uint32_t fourCC;
+	uint32_t size; // not including this header
+};
+static_assert(sizeof(DXBCPartHeader_t) == 8);
+
+// D3D11_RDEF_Header (minus the shader model 5 extension, which we don't use)
+struct RDEFHeader_t
+{
+	uint32_t numConstantBuffers;
+	uint32_t constantBufferOffset;
+	uint32_t numResourceBindings;
+	uint32_t resourceBindingOffset;
+	uint8_t versionMinor;
+	uint8_t versionMajor;
+	uint16_t programType;
+	uint32_t compilerFlags;
+	uint32_t creatorOffset;
+};
+static_assert(sizeof(RDEFHeader_t) == 28);
+
+struct RDEFResourceBinding_t
+{
+	uint32_t nameOffset;
+	uint32_t type;
+	uint32_t returnType;
+	uint32_t dimension;
+	uint32_t numSamples;
+	uint32_t bindPoint;
+	uint32_t bindCount;
+	uint32_t flags;
+
+	// shader model 5.1+
+	uint32_t space;
+	uint32_t id;
+};
+static constexpr uint32_t s_RDEFResourceBindingSize = 32u;
+static constexpr uint32_t s_RDEFResourceBindingSize_51 = 40u;
+
+struct RDEFConstantBuffer_t
+{
+	uint32_t nameOffset;
+	uint32_t numVariables;
+	uint32_t variableOffset;
+	uint32_t size;
+	uint32_t flags;
+	uint32_t type;
+};
+static_assert(sizeof(RDEFConstantBuffer_t) == 24);
+
+struct RDEFVariable_t
+{
+	uint32_t nameOffset;
+	uint32_t startOffset;
+	uint32_t size;
+	uint32_t flags;
+	uint32_t typeOffset;
+	uint32_t defaultValueOffset;
+
+	// shader model 5+
+	uint32_t startTexture;
+	uint32_t textureSize;
+	uint32_t startSampler;
+	uint32_t samplerSize;
+};
+static constexpr uint32_t s_RDEFVariableSize = 24u;
+static constexpr uint32_t s_RDEFVariableSize_50 = 40u;
+
+struct RDEFType_t
+{
+	uint16_t typeClass;
+	uint16_t type;
+	uint16_t rows;
+	uint16_t columns;
+	uint16_t elements;
+	uint16_t members;
+	uint32_t memberOffset;
+};
+static_assert(sizeof(RDEFType_t) == 16);
+static constexpr uint32_t s_RDEFTypeNameOffset_50 = 32u; // offset of the type's name offset in shader model 5+
+
+struct SignatureHeader_t
+{
+	uint32_t numElements;
+	uint32_t elementOffset; // always 8
+};
+
+// ISGN/OSGN/PCSG
+struct SignatureElement_t
+{
+	uint32_t nameOffset;
+	uint32_t semanticIndex;
+	uint32_t systemValue;
+	uint32_t componentType;
+	uint32_t registerIndex;
+	uint8_t mask;
+	uint8_t readWriteMask;
+	uint16_t pad;
+};
+static_assert(sizeof(SignatureElement_t) == 24);
+
+// ISG1/OSG1/PSG1
+struct SignatureElement1_t
+{
+	uint32_t stream;
+	uint32_t nameOffset;
+	uint32_t semanticIndex;
+	uint32_t systemValue;
+	uint32_t componentType;
+	uint32_t registerIndex;
+	uint8_t mask;
+	uint8_t readWriteMask;
+	uint16_t pad;
+	uint32_t minPrecision;
+};
+static_assert(sizeof(SignatureElement1_t) == 32);
+
+// bounds checked reads from the data of one part, offsets are relative to the start of the part's data
+class CDXBCPartReader
+{
+public:
+	CDXBCPartReader(const char* const data, const uint32_t size) : m_data(data), m_size(size) {};
+
+	template<typename T>
+	inline bool Read(const uint32_t offset, T& out, const uint32_t readSize = sizeof(T)) const
+	{
+		assert(readSize <= sizeof(T));
+
+		if (offset > m_size || readSize > m_size - offset)
+			return false;
+
+		memcpy(&out, m_data + offset, readSize);
+		return true;
+	}
+
+	// strings have to be null terminated inside the part
+	inline bool ReadString(const uint32_t offset, std::string_view& out) const
+	{
+		if (offset >= m_size)
+			return false;
+
+		const char* const str = m_data + offset;
+		const char* const end = static_cast<const char*>(memchr(str, '\0', m_size - offset));
+		if (!end)
+			return false;
+
+		out = std::string_view(str, static_cast<size_t>(end - str));
+		return true;
+	}
+
+	inline bool CheckArray(const uint32_t offset, const uint32_t count, const uint32_t stride) const
+	{
+		return static_cast<uint64_t>(offset) + (static_cast<uint64_t>(count) * stride) <= m_size;
+	}
+
+private:
+	const char* m_data;
+	uint32_t m_size;
+};
+
+bool CDXBCContainer::Init(const void* const data, const size_t size)
+{
+	m_data = nullptr;
+	m_size = 0u;
+	m_numParts = 0u;
+
+	if (!data || size < sizeof(DXBCContainerHeader_t))
+		return false;
+
+	DXBCContainerHeader_t header;
+	memcpy(&header, data, sizeof(DXBCContainerHeader_t));
+
+	if (header.fourCC != DXBC::FOURCC_CONTAINER || header.containerSize > size || header.containerSize < sizeof(DXBCContainerHeader_t))
+		return false;
+
+	const char* const bytes = static_cast<const char*>(data);
+	const uint64_t partOffsetsEnd = sizeof(DXBCContainerHeader_t) + (static_cast<uint64_t>(header.numParts) * sizeof(uint32_t));
+	if (partOffsetsEnd > header.containerSize)
+		return false;
+
+	for (uint32_t i = 0; i < header.numParts; i++)
+	{
+		uint32_t partOffset;
+		memcpy(&partOffset, bytes + sizeof(DXBCContainerHeader_t) + (i * sizeof(uint32_t)), sizeof(uint32_t));
+
+		if (static_cast<uint64_t>(partOffset) + sizeof(DXBCPartHeader_t) > header.containerSize)
+			return false;
+
+		DXBCPartHeader_t partHeader;
+		memcpy(&partHeader, bytes + partOffset, sizeof(DXBCPartHeader_t));
+
+		if (static_cast<uint64_t>(partOffset) + sizeof(DXBCPartHeader_t) + partHeader.size > header.containerSize)
+			return false;
+	}
+
+	m_data = bytes;
+	m_size = header.containerSize;
+	m_numParts = header.numParts;
+
+	return true;
+}
+
+bool CDXBCContainer::GetPart(const uint32_t idx, uint32_t& fourCC, const char*& partData, uint32_t& partSize) const
+{
+	assertm(IsValid(), "container was not initialised");
+	assertm(idx < m_numParts, "part index out of range");
+
+	// already validated in Init
+	uint32_t partOffset;
+	memcpy(&partOffset, m_data + sizeof(DXBCContainerHeader_t) + (idx * sizeof(uint32_t)), sizeof(uint32_t));
+
+	DXBCPartHeader_t partHeader;
+	memcpy(&partHeader, m_data + partOffset, sizeof(DXBCPartHeader_t));
+
+	fourCC = partHeader.fourCC;
+	partData = m_data + partOffset + sizeof(DXBCPartHeader_t);
+	partSize = partHeader.size;
+
+	return true;
+}
+
+bool CDXBCContainer::FindPart(const uint32_t fourCC, const char*& partData, uint32_t& partSize) const
+{
+	for (uint32_t i = 0; i < m_numParts; i++)
+	{
+		uint32_t partFourCC;
+		if (GetPart(i, partFourCC, partData, partSize) && partFourCC == fourCC)
+			return true;
+	}
+
+	partData = nullptr;
+	partSize = 0u;
+
+	return false;
+}
+
+void DXBCReflection_t::Clear()
+{
+	isDXIL = false;
+
+	versionMajor = 0u;
+	versionMinor = 0u;
+	programType = 0u;
+	creator = {};
+
+	resourceBindings.clear();
+	constantBuffers.clear();
+	variables.clear();
+
+	inputs.clear();
+	outputs.clear();
+	patchConstants.clear();
+}
+
+const DXBCConstantBuffer_t* DXBCReflection_t::FindConstantBuffer(const std::string_view name) const
+{
+	for (const DXBCConstantBuffer_t& constantBuffer : constantBuffers)
+	{
+		if (constantBuffer.name == name)
+			return &constantBuffer;
+	}
+
+	return nullptr;
+}
+
+static bool ParseRDEF(const CDXBCPartReader& rdef, DXBCReflection_t& out)
+{
+	RDEFHeader_t header;
+	if (!rdef.Read(0u, header))
+		return false;
+
+	out.versionMajor = header.versionMajor;
+	out.versionMinor = header.versionMinor;
+	out.programType = header.programType;
+
+	if (!rdef.ReadString(header.creatorOffset, out.creator))
+		return false;
+
+	const bool isSM50 = header.versionMajor >= 5u;
+	const bool isSM51 = header.versionMajor > 5u || (header.versionMajor == 5u && header.versionMinor >= 1u);
+
+	// resource bindings
+	const uint32_t bindingSize = isSM51 ? s_RDEFResourceBindingSize_51 : s_RDEFResourceBindingSize;
+	if (!rdef.CheckArray(header.resourceBindingOffset, header.numResourceBindings, bindingSize))
+		return false;
+
+	out.resourceBindings.resize(header.numResourceBindings);
+	for (uint32_t i = 0; i < header.numResourceBindings; i++)
+	{
+		RDEFResourceBinding_t binding = {};
+		if (!rdef.Read(header.resourceBindingOffset + (i * bindingSize), binding, bindingSize))
+			return false;
+
+		DXBCResourceBinding_t& outBinding = out.resourceBindings[i];
+		if (!rdef.ReadString(binding.nameOffset, outBinding.name))
+			return false;
+
+		outBinding.type = binding.type;
+		outBinding.returnType = binding.returnType;
+		outBinding.dimension = binding.dimension;
+		outBinding.numSamples = binding.numSamples;
+		outBinding.bindPoint = binding.bindPoint;
+		outBinding.bindCount = binding.bindCount;
+		outBinding.flags = binding.flags;
+		outBinding.space = binding.space;
+	}
+
+	// constant buffers and their variables
+	if (!rdef.CheckArray(header.constantBufferOffset, header.numConstantBuffers, sizeof(RDEFConstantBuffer_t)))
+		return false;
+
+	const uint32_t variableSize = isSM50 ? s_RDEFVariableSize_50 : s_RDEFVariableSize;
+
+	out.constantBuffers.resize(header.numConstantBuffers);
+	for (uint32_t i = 0; i < header.numConstantBuffers; i++)
+	{
+		RDEFConstantBuffer_t constantBuffer;
+		if (!rdef.Read(header.constantBufferOffset + (i * static_cast<uint32_t>(sizeof(RDEFConstantBuffer_t))), constantBuffer))
+			return false;
+
+		if (!rdef.CheckArray(constantBuffer.variableOffset, constantBuffer.numVariables, variableSize))
+			return false;
+
+		DXBCConstantBuffer_t& outConstantBuffer = out.constantBuffers[i];
+		if (!rdef.ReadString(constantBuffer.nameOffset, outConstantBuffer.name))
+			return false;
+
+		outConstantBuffer.size = constantBuffer.size;
+		outConstantBuffer.type = constantBuffer.type;
+		outConstantBuffer.flags = constantBuffer.flags;
+		outConstantBuffer.firstVariable = static_cast<uint32_t>(out.variables.size());
+		outConstantBuffer.numVariables = constantBuffer.numVariables;
+
+		for (uint32_t varIdx = 0; varIdx < constantBuffer.numVariables; varIdx++)
+		{
+			RDEFVariable_t variable = {};
+			if (!rdef.Read(constantBuffer.variableOffset + (varIdx * variableSize), variable, variableSize))
+				return false;
+
+			RDEFType_t type;
+			if (!rdef.Read(variable.typeOffset, type))
+				return false;
+
+			DXBCVariable_t& outVariable = out.variables.emplace_back();
+			if (!rdef.ReadString(variable.nameOffset, outVariable.name))
+				return false;
+
+			// type names were added in shader model 5, a null offset means the type has no name
+			uint32_t typeNameOffset = 0u;
+			if (isSM50 && rdef.Read(variable.typeOffset + s_RDEFTypeNameOffset_50, typeNameOffset) && typeNameOffset != 0u)
+			{
+				if (!rdef.ReadString(typeNameOffset, outVariable.typeName))
+					return false;
+			}
+
+			outVariable.startOffset = variable.startOffset;
+			outVariable.size = variable.size;
+			outVariable.flags = variable.flags;
+
+			outVariable.typeClass = type.typeClass;
+			outVariable.type = type.type;
+			outVariable.rows = type.rows;
+			outVariable.columns = type.columns;
+			outVariable.elements = type.elements;
+			outVariable.members = type.members;
+		}
+	}
+
+	return true;
+}
+
+static bool ParseSignature(const CDXBCPartReader& signature, const uint32_t fourCC, std::vector<DXBCSignatureElement_t>& out)
+{
+	SignatureHeader_t header;
+	if (!signature.Read(0u, header))
+		return false;
+
+	const bool hasStream = fourCC == DXBC::FOURCC_OSG5 || fourCC == DXBC::FOURCC_ISG1 || fourCC == DXBC::FOURCC_OSG1 || fourCC == DXBC::FOURCC_PSG1;
+	const bool hasMinPrecision = fourCC == DXBC::FOURCC_ISG1 || fourCC == DXBC::FOURCC_OSG1 || fourCC == DXBC::FOURCC_PSG1;
+
+	// OSG5 is the old element with a stream index in front of it
+	const uint32_t elementSize = hasMinPrecision ? static_cast<uint32_t>(sizeof(SignatureElement1_t)) : static_cast<uint32_t>(sizeof(SignatureElement_t)) + (hasStream ? 4u : 0u);
+
+	if (!signature.CheckArray(header.elementOffset, header.numElements, elementSize))
+		return false;
+
+	out.resize(header.numElements);
+	for (uint32_t i = 0; i < header.numElements; i++)
+	{
+		const uint32_t elementOffset = header.elementOffset + (i * elementSize);
+
+		SignatureElement1_t element = {};
+		if (hasMinPrecision)
+		{
+			if (!signature.Read(elementOffset, element))
+				return false;
+		}
+		else
+		{
+			if (hasStream && !signature.Read(elementOffset, element.stream))
+				return false;
+
+			SignatureElement_t oldElement;
+			if (!signature.Read(elementOffset + (hasStream ? 4u : 0u), oldElement))
+				return false;
+
+			element.nameOffset = oldElement.nameOffset;
+			element.semanticIndex = oldElement.semanticIndex;
+			element.systemValue = oldElement.systemValue;
+			element.componentType = oldElement.componentType;
+			element.registerIndex = oldElement.registerIndex;
+			element.mask = oldElement.mask;
+			element.readWriteMask = oldElement.readWriteMask;
+		}
+
+		DXBCSignatureElement_t& outElement = out[i];
+		if (!signature.ReadString(element.nameOffset, outElement.semanticName))
+			return false;
+
+		outElement.semanticIndex = element.semanticIndex;
+		outElement.systemValue = element.systemValue;
+		outElement.componentType = element.componentType;
+		outElement.registerIndex = element.registerIndex;
+		outElement.stream = element.stream;
+		outElement.minPrecision = element.minPrecision;
+		outElement.mask = element.mask;
+		outElement.readWriteMask = element.readWriteMask;
+	}
+
+	return true;
+}
+
+// parses the first signature part found out of fourCCs, which are in order of preference
+static bool ParseSignaturePart(const CDXBCContainer& container, const std::initializer_list<uint32_t> fourCCs, std::vector<DXBCSignatureElement_t>& out)
+{
+	for (const uint32_t fourCC : fourCCs)
+	{
+		const char* partData = nullptr;
+		uint32_t partSize = 0u;
+
+		if (container.FindPart(fourCC, partData, partSize))
+			return ParseSignature(CDXBCPartReader(partData, partSize), fourCC, out);
+	}
+
+	// not having a signature is fine
+	return true;
+}
+
+bool ParseDXBCReflection(const void* const data, const size_t size, DXBCReflection_t& out)
+{
+	out.Clear();
+
+	CDXBCContainer container;
+	if (!container.Init(data, size))
+		return false;
+
+	const char* partData = nullptr;
+	uint32_t partSize = 0u;
+
+	out.isDXIL = container.FindPart(DXBC::FOURCC_DXIL, partData, partSize);
+
+	bool valid = true;
+
+	if (container.FindPart(DXBC::FOURCC_RDEF, partData, partSize))
+		valid &= ParseRDEF(CDXBCPartReader(partData, partSize), out);
+
+	valid &= ParseSignaturePart(container, { DXBC::FOURCC_ISG1, DXBC::FOURCC_ISGN }, out.inputs);
+	valid &= ParseSignaturePart(container, { DXBC::FOURCC_OSG1, DXBC::FOURCC_OSG5, DXBC::FOURCC_OSGN }, out.outputs);
+	valid &= ParseSignaturePart(container, { DXBC::FOURCC_PSG1, DXBC::FOURCC_PCSG }, out.patchConstants);
+
+	if (!valid)
+	{
+		out.Clear();
+		return false;
+	}
+
+	return true;
+}
+
+const std::string_view GetDXBCCreator(const void* const data, const size_t size)
+{
+	CDXBCContainer container;
+	if (!container.Init(data, size))
+		return {};
+
+	const char* partData = nullptr;
+	uint32_t partSize = 0u;
+
+	if (!container.FindPart(DXBC::FOURCC_RDEF, partData, partSize))
+		return {};
+
+	const CDXBCPartReader rdef(partData, partSize);
+
+	RDEFHeader_t header;
+	std::string_view creator;
+	if (!rdef.Read(0u, header) || !rdef.ReadString(header.creatorOffset, creator))
+		return {};
+
+	return creator;
+}
@@ -0,0 +1,143 @@
+#pragma once
+
+// Portable DXBC/DXIL container and reflection parser
+// Reads resource bindings and constant buffers (RDEF) and input/output/patch constant signatures straight from shader bytecode,
+// without going through the D3D reflection APIs. Every offset and count read from the bytecode is checked against the
+// container, so malformed shaders fail to parse instead of reading out of bounds.
+// Names are views into the bytecode, the bytecode has to outlive any reflection parsed from it.
+//
+// DXIL containers (dxc) only have their signatures parsed, the rest of their reflection is stored as llvm bitcode.
+
+namespace DXBC
+{
+	constexpr uint32_t MakeFourCC(const char a, const char b, const char c, const char d)
+	{
+		return static_cast<uint32_t>(a) | (static_cast<uint32_t>(b) << 8) | (static_cast<uint32_t>(c) << 16) | (static_cast<uint32_t>(d) << 24);
+	}
+
+	constexpr uint32_t FOURCC_CONTAINER = MakeFourCC('D', 'X', 'B', 'C');
+	constexpr uint32_t FOURCC_RDEF = MakeFourCC('R', 'D', 'E', 'F');
+	constexpr uint32_t FOURCC_ISGN = MakeFourCC('I', 'S', 'G', 'N');
+	constexpr uint32_t FOURCC_ISG1 = MakeFourCC('I', 'S', 'G', '1');
+	constexpr uint32_t FOURCC_OSGN = MakeFourCC('O', 'S', 'G', 'N');
+	constexpr uint32_t FOURCC_OSG1 = MakeFourCC('O', 'S', 'G', '1');
+	constexpr uint32_t FOURCC_OSG5 = MakeFourCC('O', 'S', 'G', '5');
+	constexpr uint32_t FOURCC_PCSG = MakeFourCC('P', 'C', 'S', 'G');
+	constexpr uint32_t FOURCC_PSG1 = MakeFourCC('P', 'S', 'G', '1');
+	constexpr uint32_t FOURCC_DXIL = MakeFourCC('D', 'X', 'I', 'L');
+}
+
+// D3D_SHADER_INPUT_BIND_DESC
+struct DXBCResourceBinding_t
+{
+	std::string_view name;
+
+	uint32_t type; // D3D_SHADER_INPUT_TYPE
+	uint32_t returnType; // D3D_RESOURCE_RETURN_TYPE
+	uint32_t dimension; // D3D_SRV_DIMENSION
+	uint32_t numSamples;
+	uint32_t bindPoint;
+	uint32_t bindCount;
+	uint32_t flags; // D3D_SHADER_INPUT_FLAGS
+	uint32_t space; // always 0 before shader model 5.1
+};
+
+// D3D_SHADER_VARIABLE_DESC + D3D_SHADER_TYPE_DESC
+struct DXBCVariable_t
+{
+	std::string_view name;
+	std::string_view typeName; // empty before shader model 5
+
+	uint32_t startOffset;
+	uint32_t size;
+	uint32_t flags; // D3D_SHADER_VARIABLE_FLAGS
+
+	uint16_t typeClass; // D3D_SHADER_VARIABLE_CLASS
+	uint16_t type; // D3D_SHADER_VARIABLE_TYPE
+	uint16_t rows;
+	uint16_t columns;
+	uint16_t elements;
+	uint16_t members;
+};
+
+// D3D_SHADER_BUFFER_DESC
+struct DXBCConstantBuffer_t
+{
+	std::string_view name;
+
+	uint32_t size;
+	uint32_t type; // D3D_CBUFFER_TYPE
+	uint32_t flags; // D3D_SHADER_CBUFFER_FLAGS
+
+	// range in DXBCReflection_t::variables
+	uint32_t firstVariable;
+	uint32_t numVariables;
+};
+
+// D3D_SIGNATURE_PARAMETER_DESC
+struct DXBCSignatureElement_t
+{
+	std::string_view semanticName;
+
+	uint32_t semanticIndex;
+	uint32_t systemValue; // D3D_NAME
+	uint32_t componentType; // D3D_REGISTER_COMPONENT_TYPE
+	uint32_t registerIndex;
+	uint32_t stream;
+	uint32_t minPrecision; // D3D_MIN_PRECISION
+
+	uint8_t mask;
+	uint8_t readWriteMask;
+};
+
+struct DXBCReflection_t
+{
+	bool isDXIL;
+
+	// from RDEF
+	uint8_t versionMajor;
+	uint8_t versionMinor;
+	uint16_t programType; // 0xFFFF pixel, 0xFFFE vertex, 'GS', 'HS', 'DS', 'CS'
+	std::string_view creator;
+
+	std::vector<DXBCResourceBinding_t> resourceBindings;
+	std::vector<DXBCConstantBuffer_t> constantBuffers;
+	std::vector<DXBCVariable_t> variables;
+
+	std::vector<DXBCSignatureElement_t> inputs;
+	std::vector<DXBCSignatureElement_t> outputs;
+	std::vector<DXBCSignatureElement_t> patchConstants;
+
+	void Clear();
+
+	const DXBCConstantBuffer_t* FindConstantBuffer(const std::string_view name) const;
+};
+
+// bounds checked view of the parts in a DXBC container
+class CDXBCContainer
+{
+public:
+	CDXBCContainer() : m_data(nullptr), m_size(0u), m_numParts(0u) {};
+
+	// checks the header and that every part lies inside the container, nothing is copied
+	bool Init(const void* const data, const size_t size);
+
+	inline const bool IsValid() const { return m_data != nullptr; }
+	inline const uint32_t GetNumParts() const { return m_numParts; }
+
+	// returns false if the container has no part with this fourcc
+	bool FindPart(const uint32_t fourCC, const char*& partData, uint32_t& partSize) const;
+
+private:
+	bool GetPart(const uint32_t idx, uint32_t& fourCC, const char*& partData, uint32_t& partSize) const;
+
+	const char* m_data;
+	uint32_t m_size;
+	uint32_t m_numParts;
+};
+
+// parses all reflection data from a shader, returns false (and leaves out cleared) if the bytecode is malformed
+bool ParseDXBCReflection(const void* const data, const size_t size, DXBCReflection_t& out);
+
+// only reads the compiler string from RDEF, for when nothing else is needed
+const std::string_view GetDXBCCreator(const void* const data, const size_t size);
@@ -433,6 +433,21 @@ public:
 	}
 
 	__forceinline bool WriteFile(const char* filePath)
+	{
+		FILE* f = NULL;
+
+		if (fopen_s(&f, filePath, "wb") == 0)
+		{
+			const bool written = WriteFile(f);
+
+			fclose(f);
+			return written;
+		}
+		return false;
+	}
+
+	// writes the wrapper into an already opened file, the file is not closed
+	__forceinline bool WriteFile(FILE* f)
 	{
 		if (!writtenAnything && (_fileType == MultiShaderWrapperFileType_e::SHADER))
 		{
@@ -440,28 +455,21 @@ public:
 			return false;
 		}
 
-		FILE* f = NULL;
-
-		if (fopen_s(&f, filePath, "wb") == 0)
+		MultiShaderWrapper_Header_t fileHeader =
 		{
-			MultiShaderWrapper_Header_t fileHeader =
-			{
-				.magic = MSW_FILE_MAGIC,
-				.version = MSW_FILE_VER,
-				.fileType = this->_fileType
-			};
+			.magic = MSW_FILE_MAGIC,
+			.version = MSW_FILE_VER,
+			.fileType = this->_fileType
+		};
 
-			fwrite(&fileHeader, sizeof(MultiShaderWrapper_Header_t), 1, f);
+		fwrite(&fileHeader, sizeof(MultiShaderWrapper_Header_t), 1, f);
 
-			if (_fileType == MultiShaderWrapperFileType_e::SHADER)
-				WriteShader(f, _storedShaders.shader);
-			else if (_fileType == MultiShaderWrapperFileType_e::SHADERSET)
-				WriteShaderSet(f);
+		if (_fileType == MultiShaderWrapperFileType_e::SHADER)
+			WriteShader(f, _storedShaders.shader);
+		else if (_fileType == MultiShaderWrapperFileType_e::SHADERSET)
+			WriteShaderSet(f);
 
-			fclose(f);
-			return true;
-		}
-		return false;
+		return true;
 	}
 
 private:
@@ -0,0 +1,141 @@
+#include <pch.h>
+#include <core/shaderexp/shaderstore.h>
+#include <core/utils/textbuilder.h>
+
+#include <game/asset.h>
+
+extern ExportSettings_t g_ExportSettings;
+
+CShaderBlobStore g_ShaderBlobStore;
+
+std::filesystem::path CShaderBlobStore::GetStoreDirectory()
+{
+	std::filesystem::path storeDirectory = g_ExportSettings.GetExportDirectory();
+	storeDirectory.append(s_AssetTypePaths.find(AssetType_t::SHDR)->second);
+	storeDirectory.append("blobs");
+
+	return storeDirectory;
+}
+
+void CShaderBlobStore::CheckStoreDirectory(const std::filesystem::path& storeDirectory)
+{
+	if (m_storeDirectory == storeDirectory)
+		return;
+
+	m_storeDirectory = storeDirectory;
+	m_storedBlobs.clear();
+	m_manifest.clear();
+
+	m_numReferences = 0ull;
+	m_numBytesReferenced = 0ull;
+	m_numBytesWritten = 0ull;
+
+	m_manifestDirty = false;
+
+	if (!CreateDirectories(m_storeDirectory))
+		assertm(false, "Failed to create shader blob directory.");
+}
+
+const ShaderBlobRef_t CShaderBlobStore::StoreBlob(const char* const buffer, const size_t bufferSize)
+{
+	if (!buffer || bufferSize == 0ull)
+		return { {}, false };
+
+	const ShaderBlobRef_t blobRef = { Hash128::HashBuffer(buffer, bufferSize), true };
+	const std::filesystem::path storeDirectory = GetStoreDirectory();
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		CheckStoreDirectory(storeDirectory);
+
+		m_numReferences++;
+		m_numBytesReferenced += bufferSize;
+
+		// already stored (or being stored by another thread)
+		if (!m_storedBlobs.insert(blobRef.hash).second)
+			return blobRef;
+	}
+
+	std::filesystem::path blobPath = storeDirectory;
+	blobPath.append(std::format("{}.fxc", blobRef.hash.ToString()));
+
+	// blobs written by a previous session don't need writing again
+	std::error_code ec;
+	if (!FileSystem::IsArchivedPath(blobPath) && std::filesystem::file_size(blobPath, ec) == bufferSize && !ec)
+		return blobRef;
+
+	StreamIO out(blobPath, eStreamIOMode::Write);
+	out.write(buffer, bufferSize);
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_numBytesWritten += bufferSize;
+
+	return blobRef;
+}
+
+void CShaderBlobStore::AddShader(const uint64_t guid, const std::string& name, const char* const type, std::vector<ShaderBlobRef_t>&& blobs)
+{
+	const std::filesystem::path storeDirectory = GetStoreDirectory();
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	CheckStoreDirectory(storeDirectory);
+
+	m_manifest[guid] = { name, type, std::move(blobs) };
+	m_manifestDirty = true;
+}
+
+void CShaderBlobStore::WriteManifest()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	if (!m_manifestDirty)
+		return;
+
+	CTextBuilder manifest(m_manifest.size() * 256);
+
+	manifest.Append("{\n");
+	manifest.Append("\t\"shaders\": [\n");
+
+	size_t shaderIdx = 0;
+	for (const auto& [guid, entry] : m_manifest)
+	{
+		manifest.Append("\t\t{\n");
+		manifest.Append(std::format("\t\t\t\"guid\": \"0x{:X}\",\n", guid));
+
+		// shader names come from the pak, they can contain anything
+		manifest.Append("\t\t\t\"name\": \"");
+		manifest.AppendEscapedJSON(entry.name);
+		manifest.Append("\",\n");
+
+		manifest.Append(std::format("\t\t\t\"type\": \"{}\",\n", entry.type));
+		manifest.Append("\t\t\t\"blobs\": [");
+
+		for (size_t i = 0; i < entry.blobs.size(); i++)
+		{
+			const ShaderBlobRef_t& blobRef = entry.blobs[i];
+
+			manifest.Append(i == 0 ? "" : ", ");
+			manifest.Append(blobRef.valid ? std::format("\"{}\"", blobRef.hash.ToString()) : "null");
+		}
+
+		manifest.Append("]\n");
+		manifest.Append(++shaderIdx != m_manifest.size() ? "\t\t},\n" : "\t\t}\n");
+	}
+
+	manifest.Append("\t]\n");
+	manifest.Append("}\n");
+
+	std::filesystem::path manifestPath = m_storeDirectory;
+	manifestPath.append("manifest.json");
+
+	StreamIO out(manifestPath, eStreamIOMode::Write);
+	out.write(manifest.Data(), manifest.Length());
+
+	m_manifestDirty = false;
+
+	Log("SHDR: %llu shaders in blob store, %llu blob references, %llu unique blobs (%.1f MiB written, %.1f MiB deduplicated)\n",
+		m_manifest.size(), m_numReferences, m_storedBlobs.size(),
+		static_cast<double>(m_numBytesWritten) / (1024.0 * 1024.0), static_cast<double>(m_numBytesReferenced - m_numBytesWritten) / (1024.0 * 1024.0));
+}
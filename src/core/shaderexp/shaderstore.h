@@ -0,0 +1,56 @@
+#pragma once
+#include <core/utils/hash128.h>
+
+// Content addressed store for exported shader bytecode
+// The same DXBC/DXIL blobs are shared by a huge number of shader assets across paks and patches, so instead of writing
+// every copy out, each unique blob is written once as "<hash>.fxc" and shaders reference blobs by hash.
+// A manifest maps every shader exported this way to the blobs it uses.
+
+struct ShaderBlobRef_t
+{
+	Hash128_t hash;
+	bool valid; // false for buffers that reference another shader or have no data
+};
+
+class CShaderBlobStore
+{
+public:
+	CShaderBlobStore() : m_numReferences(0ull), m_numBytesReferenced(0ull), m_numBytesWritten(0ull), m_manifestDirty(false) {};
+
+	// directory blobs and the manifest are written to, inside the current export directory
+	static std::filesystem::path GetStoreDirectory();
+
+	// hashes the blob and writes it to the store if nothing with the same hash has been stored yet
+	const ShaderBlobRef_t StoreBlob(const char* const buffer, const size_t bufferSize);
+
+	// records which blobs a shader uses for the manifest
+	void AddShader(const uint64_t guid, const std::string& name, const char* const type, std::vector<ShaderBlobRef_t>&& blobs);
+
+	// writes the manifest if any shaders have been added since it was last written
+	void WriteManifest();
+
+private:
+	struct ManifestEntry_t
+	{
+		std::string name;
+		const char* type;
+		std::vector<ShaderBlobRef_t> blobs;
+	};
+
+	// the store is per export directory, forget everything if it has changed
+	void CheckStoreDirectory(const std::filesystem::path& storeDirectory);
+
+	std::mutex m_mutex;
+
+	std::filesystem::path m_storeDirectory;
+	std::unordered_set<Hash128_t, Hash128Hasher_t> m_storedBlobs;
+	std::map<uint64_t, ManifestEntry_t> m_manifest; // ordered so the manifest comes out the same every time
+
+	uint64_t m_numReferences;
+	uint64_t m_numBytesReferenced;
+	uint64_t m_numBytesWritten;
+
+	bool m_manifestDirty;
+};
+
+extern CShaderBlobStore g_ShaderBlobStore;
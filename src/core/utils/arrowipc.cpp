@@ -0,0 +1,502 @@
+#include <pch.h>
+#include <core/utils/arrowipc.h>
+
+// minimal flatbuffers builder for arrow's metadata
+// like the real builder it writes back to front, so objects are created before anything that refers to them and offsets are
+// tracked as distances from the end of the buffer. bytes are kept reversed until Finish.
+class CFlatBufferBuilder
+{
+public:
+	CFlatBufferBuilder() : m_tableStart(0u) {};
+
+	inline const uint32_t Size() const { return static_cast<uint32_t>(m_reversed.size()); }
+
+	uint32_t CreateString(const std::string_view str)
+	{
+		Align(sizeof(uint32_t), str.length() + 1);
+
+		Prepend("", 1); // null terminator
+		Prepend(str.data(), str.length());
+		Push<uint32_t>(static_cast<uint32_t>(str.length()));
+
+		return Size();
+	}
+
+	uint32_t CreateStructVector(const void* const data, const size_t elementSize, const size_t count, const size_t alignment)
+	{
+		Align(std::max(alignment, sizeof(uint32_t)), elementSize * count);
+
+		Prepend(data, elementSize * count);
+		Push<uint32_t>(static_cast<uint32_t>(count));
+
+		return Size();
+	}
+
+	uint32_t CreateOffsetVector(const std::vector<uint32_t>& offsets)
+	{
+		Align(sizeof(uint32_t), offsets.size() * sizeof(uint32_t));
+
+		for (size_t i = offsets.size(); i > 0; --i)
+			PushOffset(offsets[i - 1]);
+
+		Push<uint32_t>(static_cast<uint32_t>(offsets.size()));
+
+		return Size();
+	}
+
+	// children have to be created before their table is started
+	void StartTable()
+	{
+		m_tableFields.clear();
+		m_tableStart = Size();
+	}
+
+	template <typename T>
+	void AddScalar(const uint16_t slot, const T value)
+	{
+		Align(sizeof(T), 0ull);
+		Push<T>(value);
+
+		m_tableFields.emplace_back(slot, Size());
+	}
+
+	void AddOffset(const uint16_t slot, const uint32_t offset)
+	{
+		PushOffset(offset);
+
+		m_tableFields.emplace_back(slot, Size());
+	}
+
+	uint32_t EndTable()
+	{
+		Align(sizeof(int32_t), 0ull);
+		Push<int32_t>(0); // vtable offset, patched once the vtable is written
+
+		const uint32_t tableOffset = Size();
+
+		uint16_t numSlots = 0u;
+		for (const auto& [slot, fieldOffset] : m_tableFields)
+			numSlots = std::max(numSlots, static_cast<uint16_t>(slot + 1));
+
+		std::vector<uint16_t> vtable(numSlots, 0u);
+		for (const auto& [slot, fieldOffset] : m_tableFields)
+			vtable[slot] = static_cast<uint16_t>(tableOffset - fieldOffset);
+
+		for (size_t i = vtable.size(); i > 0; --i)
+			Push<uint16_t>(vtable[i - 1]);
+
+		Push<uint16_t>(static_cast<uint16_t>(tableOffset - m_tableStart)); // table size
+		Push<uint16_t>(static_cast<uint16_t>((2 + numSlots) * sizeof(uint16_t))); // vtable size
+
+		// the vtable sits right in front of its table
+		Patch<int32_t>(tableOffset, static_cast<int32_t>(Size() - tableOffset));
+
+		return tableOffset;
+	}
+
+	// writes the root offset, the finished buffer is a multiple of eight bytes
+	void Finish(const uint32_t rootOffset, std::vector<uint8_t>& out)
+	{
+		Align(8ull, sizeof(uint32_t));
+		PushOffset(rootOffset);
+
+		out.assign(m_reversed.rbegin(), m_reversed.rend());
+	}
+
+private:
+	void Prepend(const void* const data, const size_t size)
+	{
+		const uint8_t* const bytes = reinterpret_cast<const uint8_t*>(data);
+
+		for (size_t i = size; i > 0; --i)
+			m_reversed.push_back(bytes[i - 1]);
+	}
+
+	template <typename T>
+	void Push(const T value)
+	{
+		Prepend(&value, sizeof(T));
+	}
+
+	// pads so the buffer is aligned once size more bytes are written
+	void Align(const size_t alignment, const size_t size)
+	{
+		const size_t padding = (alignment - ((m_reversed.size() + size) % alignment)) % alignment;
+		m_reversed.insert(m_reversed.end(), padding, 0u);
+	}
+
+	void PushOffset(const uint32_t offset)
+	{
+		Align(sizeof(uint32_t), 0ull);
+		Push<uint32_t>(Size() + sizeof(uint32_t) - offset);
+	}
+
+	// overwrites a value written earlier, offset is what Size() was straight after it was pushed
+	template <typename T>
+	void Patch(const uint32_t offset, const T value)
+	{
+		const uint8_t* const bytes = reinterpret_cast<const uint8_t*>(&value);
+
+		for (size_t i = 0; i < sizeof(T); ++i)
+			m_reversed[offset - 1 - i] = bytes[i];
+	}
+
+	std::vector<uint8_t> m_reversed;
+
+	uint32_t m_tableStart;
+	std::vector<std::pair<uint16_t, uint32_t>> m_tableFields;
+};
+
+// from arrow's format/Schema.fbs and format/Message.fbs
+static constexpr int16_t ARROW_METADATA_V5 = 4;
+
+enum eArrowTypeId : uint8_t
+{
+	ARROW_TYPE_INT = 2,
+	ARROW_TYPE_FLOATING_POINT = 3,
+	ARROW_TYPE_UTF8 = 5,
+	ARROW_TYPE_BOOL = 6,
+	ARROW_TYPE_FIXED_SIZE_LIST = 16,
+};
+
+enum eArrowMessageHeader : uint8_t
+{
+	ARROW_MESSAGE_SCHEMA = 1,
+	ARROW_MESSAGE_RECORD_BATCH = 3,
+};
+
+struct ArrowFieldNode_t
+{
+	int64_t length;
+	int64_t nullCount;
+};
+
+struct ArrowBuffer_t
+{
+	int64_t offset;
+	int64_t length;
+};
+
+struct ArrowBlock_t
+{
+	int64_t offset;
+	int32_t metaDataLength;
+	int32_t padding;
+	int64_t bodyLength;
+};
+static_assert(sizeof(ArrowBlock_t) == 24);
+
+// buffers in the message body are aligned for simd reads
+static constexpr size_t s_ArrowBufferAlignment = 64ull;
+
+static const char s_ArrowMagic[8] = { 'A', 'R', 'R', 'O', 'W', '1', '\0', '\0' };
+
+CArrowFileWriter::Column_t& CArrowFileWriter::AddColumn(const std::string& name, const eColumnType type, const int32_t listSize)
+{
+	Column_t& column = m_columns.emplace_back();
+	column.name = name;
+	column.type = type;
+	column.listSize = listSize;
+	column.nullCount = 0ll;
+
+	return column;
+}
+
+void CArrowFileWriter::AddBoolColumn(const std::string& name, const uint8_t* const values)
+{
+	Column_t& column = AddColumn(name, eColumnType::BOOL, 0);
+
+	// arrow bools are packed bits
+	std::vector<char> bits((m_numRows + 7) / 8, 0);
+	for (int64_t i = 0; i < m_numRows; ++i)
+	{
+		if (values[i])
+			bits[i >> 3] |= static_cast<char>(1 << (i & 7));
+	}
+
+	column.buffers.emplace_back();
+	column.buffers.emplace_back(std::move(bits));
+}
+
+void CArrowFileWriter::AddInt32Column(const std::string& name, const int32_t* const values)
+{
+	Column_t& column = AddColumn(name, eColumnType::INT32, 0);
+
+	column.buffers.emplace_back();
+	column.buffers.emplace_back(reinterpret_cast<const char*>(values), reinterpret_cast<const char*>(values + m_numRows));
+}
+
+void CArrowFileWriter::AddFloatColumn(const std::string& name, const float* const values)
+{
+	Column_t& column = AddColumn(name, eColumnType::FLOAT, 0);
+
+	column.buffers.emplace_back();
+	column.buffers.emplace_back(reinterpret_cast<const char*>(values), reinterpret_cast<const char*>(values + m_numRows));
+}
+
+void CArrowFileWriter::AddFloatListColumn(const std::string& name, const float* const values, const int32_t listSize)
+{
+	Column_t& column = AddColumn(name, eColumnType::FLOAT_LIST, listSize);
+
+	// list validity, then the child's validity and values
+	column.buffers.emplace_back();
+	column.buffers.emplace_back();
+	column.buffers.emplace_back(reinterpret_cast<const char*>(values), reinterpret_cast<const char*>(values + (m_numRows * listSize)));
+}
+
+void CArrowFileWriter::AddStringColumn(const std::string& name, const std::string_view* const values, const uint8_t* const valid)
+{
+	Column_t& column = AddColumn(name, eColumnType::STRING, 0);
+
+	std::vector<char> validity;
+	std::vector<char> offsets((m_numRows + 1) * sizeof(int32_t));
+	std::vector<char> data;
+
+	if (valid)
+	{
+		column.nullCount = std::count(valid, valid + m_numRows, static_cast<uint8_t>(0u));
+
+		if (column.nullCount > 0)
+		{
+			validity.resize((m_numRows + 7) / 8, 0);
+
+			for (int64_t i = 0; i < m_numRows; ++i)
+			{
+				if (valid[i])
+					validity[i >> 3] |= static_cast<char>(1 << (i & 7));
+			}
+		}
+	}
+
+	size_t dataSize = 0ull;
+	for (int64_t i = 0; i < m_numRows; ++i)
+		dataSize += (!valid || valid[i]) ? values[i].length() : 0ull;
+
+	assertm(dataSize <= INT32_MAX, "string column is too large for 32 bit offsets");
+	data.reserve(dataSize);
+
+	int32_t* const offsetData = reinterpret_cast<int32_t*>(offsets.data());
+	offsetData[0] = 0;
+
+	for (int64_t i = 0; i < m_numRows; ++i)
+	{
+		if (!valid || valid[i])
+			data.insert(data.end(), values[i].begin(), values[i].end());
+
+		offsetData[i + 1] = static_cast<int32_t>(data.size());
+	}
+
+	column.buffers.emplace_back(std::move(validity));
+	column.buffers.emplace_back(std::move(offsets));
+	column.buffers.emplace_back(std::move(data));
+}
+
+static uint32_t Arrow_CreateField(CFlatBufferBuilder& builder, const std::string_view name, const uint8_t typeId, const uint32_t typeOffset, const std::vector<uint32_t>& children)
+{
+	const uint32_t nameOffset = builder.CreateString(name);
+	const uint32_t childrenOffset = builder.CreateOffsetVector(children); // readers expect this even when it's empty
+
+	builder.StartTable();
+	builder.AddOffset(0, nameOffset);
+	builder.AddScalar<uint8_t>(1, 1u); // nullable
+	builder.AddScalar<uint8_t>(2, typeId);
+	builder.AddOffset(3, typeOffset);
+	builder.AddOffset(5, childrenOffset);
+
+	return builder.EndTable();
+}
+
+const uint32_t CArrowFileWriter::SerializeSchema(CFlatBufferBuilder& builder) const
+{
+	std::vector<uint32_t> fields;
+	fields.reserve(m_columns.size());
+
+	for (const Column_t& column : m_columns)
+	{
+		uint8_t typeId = 0u;
+		uint32_t typeOffset = 0u;
+		std::vector<uint32_t> children;
+
+		switch (column.type)
+		{
+		case eColumnType::BOOL:
+		{
+			builder.StartTable();
+			typeOffset = builder.EndTable();
+
+			typeId = ARROW_TYPE_BOOL;
+			break;
+		}
+		case eColumnType::INT32:
+		{
+			builder.StartTable();
+			builder.AddScalar<int32_t>(0, 32); // bitWidth
+			builder.AddScalar<uint8_t>(1, 1u); // is_signed
+			typeOffset = builder.EndTable();
+
+			typeId = ARROW_TYPE_INT;
+			break;
+		}
+		case eColumnType::FLOAT:
+		{
+			builder.StartTable();
+			builder.AddScalar<int16_t>(0, 1); // precision, SINGLE
+			typeOffset = builder.EndTable();
+
+			typeId = ARROW_TYPE_FLOATING_POINT;
+			break;
+		}
+		case eColumnType::FLOAT_LIST:
+		{
+			// the list's child field, named "item" like arrow's own writers do
+			builder.StartTable();
+			builder.AddScalar<int16_t>(0, 1);
+			const uint32_t childType = builder.EndTable();
+
+			children.push_back(Arrow_CreateField(builder, "item", ARROW_TYPE_FLOATING_POINT, childType, {}));
+
+			builder.StartTable();
+			builder.AddScalar<int32_t>(0, column.listSize);
+			typeOffset = builder.EndTable();
+
+			typeId = ARROW_TYPE_FIXED_SIZE_LIST;
+			break;
+		}
+		case eColumnType::STRING:
+		{
+			builder.StartTable();
+			typeOffset = builder.EndTable();
+
+			typeId = ARROW_TYPE_UTF8;
+			break;
+		}
+		}
+
+		fields.push_back(Arrow_CreateField(builder, column.name, typeId, typeOffset, children));
+	}
+
+	const uint32_t fieldsOffset = builder.CreateOffsetVector(fields);
+
+	builder.StartTable();
+	builder.AddScalar<int16_t>(0, 0); // endianness, little
+	builder.AddOffset(1, fieldsOffset);
+
+	return builder.EndTable();
+}
+
+static uint32_t Arrow_CreateMessage(CFlatBufferBuilder& builder, const eArrowMessageHeader headerType, const uint32_t headerOffset, const int64_t bodyLength)
+{
+	builder.StartTable();
+	builder.AddScalar<int16_t>(0, ARROW_METADATA_V5);
+	builder.AddScalar<uint8_t>(1, headerType);
+	builder.AddOffset(2, headerOffset);
+	builder.AddScalar<int64_t>(3, bodyLength);
+
+	return builder.EndTable();
+}
+
+// continuation marker, metadata size, metadata then body. returns the size of everything before the body
+static int32_t Arrow_WriteMessage(StreamIO& out, const std::vector<uint8_t>& metadata, const std::vector<char>& body)
+{
+	const uint32_t header[2] = { 0xFFFFFFFFu, static_cast<uint32_t>(metadata.size()) };
+
+	out.write(reinterpret_cast<const char*>(header), sizeof(header));
+	out.write(reinterpret_cast<const char*>(metadata.data()), metadata.size());
+
+	if (!body.empty())
+		out.write(body.data(), body.size());
+
+	return static_cast<int32_t>(sizeof(header) + metadata.size());
+}
+
+bool CArrowFileWriter::Write(const std::filesystem::path& path) const
+{
+	// record batch body, every buffer starts aligned
+	std::vector<ArrowFieldNode_t> nodes;
+	std::vector<ArrowBuffer_t> buffers;
+	std::vector<char> body;
+
+	for (const Column_t& column : m_columns)
+	{
+		nodes.push_back({ m_numRows, column.nullCount });
+
+		if (column.type == eColumnType::FLOAT_LIST)
+			nodes.push_back({ m_numRows * column.listSize, 0ll });
+
+		for (const std::vector<char>& buffer : column.buffers)
+		{
+			buffers.push_back({ static_cast<int64_t>(body.size()), static_cast<int64_t>(buffer.size()) });
+
+			body.insert(body.end(), buffer.begin(), buffer.end());
+			body.resize(IALIGN(body.size(), s_ArrowBufferAlignment), 0);
+		}
+	}
+
+	std::vector<uint8_t> schemaMessage;
+	{
+		CFlatBufferBuilder builder;
+		const uint32_t schema = SerializeSchema(builder);
+
+		builder.Finish(Arrow_CreateMessage(builder, ARROW_MESSAGE_SCHEMA, schema, 0ll), schemaMessage);
+	}
+
+	std::vector<uint8_t> batchMessage;
+	{
+		CFlatBufferBuilder builder;
+		const uint32_t nodesOffset = builder.CreateStructVector(nodes.data(), sizeof(ArrowFieldNode_t), nodes.size(), alignof(ArrowFieldNode_t));
+		const uint32_t buffersOffset = builder.CreateStructVector(buffers.data(), sizeof(ArrowBuffer_t), buffers.size(), alignof(ArrowBuffer_t));
+
+		builder.StartTable();
+		builder.AddScalar<int64_t>(0, m_numRows);
+		builder.AddOffset(1, nodesOffset);
+		builder.AddOffset(2, buffersOffset);
+		const uint32_t recordBatch = builder.EndTable();
+
+		builder.Finish(Arrow_CreateMessage(builder, ARROW_MESSAGE_RECORD_BATCH, recordBatch, static_cast<int64_t>(body.size())), batchMessage);
+	}
+
+	StreamIO out;
+	if (!out.open(path.string(), eStreamIOMode::Write))
+	{
+		assertm(false, "Failed to open file for write.");
+		return false;
+	}
+
+	out.write(s_ArrowMagic, sizeof(s_ArrowMagic));
+
+	int64_t fileOffset = sizeof(s_ArrowMagic);
+	fileOffset += Arrow_WriteMessage(out, schemaMessage, {});
+
+	const ArrowBlock_t batchBlock = { fileOffset, Arrow_WriteMessage(out, batchMessage, body), 0, static_cast<int64_t>(body.size()) };
+
+	// end of stream
+	const uint32_t endOfStream[2] = { 0xFFFFFFFFu, 0u };
+	out.write(reinterpret_cast<const char*>(endOfStream), sizeof(endOfStream));
+
+	// the footer repeats the schema and says where each batch is, which is what lets readers map the file
+	std::vector<uint8_t> footer;
+	{
+		CFlatBufferBuilder builder;
+		const uint32_t schema = SerializeSchema(builder);
+		const uint32_t dictionaries = builder.CreateStructVector(nullptr, sizeof(ArrowBlock_t), 0ull, alignof(ArrowBlock_t));
+		const uint32_t recordBatches = builder.CreateStructVector(&batchBlock, sizeof(ArrowBlock_t), 1ull, alignof(ArrowBlock_t));
+
+		builder.StartTable();
+		builder.AddScalar<int16_t>(0, ARROW_METADATA_V5);
+		builder.AddOffset(1, schema);
+		builder.AddOffset(2, dictionaries);
+		builder.AddOffset(3, recordBatches);
+
+		builder.Finish(builder.EndTable(), footer);
+	}
+
+	const int32_t footerSize = static_cast<int32_t>(footer.size());
+
+	out.write(reinterpret_cast<const char*>(footer.data()), footer.size());
+	out.write(reinterpret_cast<const char*>(&footerSize), sizeof(footerSize));
+	out.write(s_ArrowMagic, 6); // no padding at the end
+
+	out.close();
+
+	return true;
+}
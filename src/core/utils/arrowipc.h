@@ -0,0 +1,54 @@
+#pragma once
+
+// arrow ipc file writer (the "feather v2" format)
+// columns are added whole and written as a single uncompressed record batch, so readers can memory map the file and use the
+// column buffers in place. only the handful of types exported tables need are supported.
+
+class CFlatBufferBuilder;
+
+class CArrowFileWriter
+{
+public:
+	CArrowFileWriter(const int64_t numRows) : m_numRows(numRows) {};
+
+	// values are copied, bools are one byte per value
+	void AddBoolColumn(const std::string& name, const uint8_t* const values);
+	void AddInt32Column(const std::string& name, const int32_t* const values);
+	void AddFloatColumn(const std::string& name, const float* const values);
+
+	// fixed size list of floats, listSize values per row (e.g. three for a vector)
+	void AddFloatListColumn(const std::string& name, const float* const values, const int32_t listSize);
+
+	// utf8 strings, valid can be nullptr if there are no nulls. null values are written as empty strings
+	void AddStringColumn(const std::string& name, const std::string_view* const values, const uint8_t* const valid);
+
+	bool Write(const std::filesystem::path& path) const;
+
+private:
+	enum class eColumnType : uint8_t
+	{
+		BOOL,
+		INT32,
+		FLOAT,
+		FLOAT_LIST,
+		STRING,
+	};
+
+	struct Column_t
+	{
+		std::string name;
+		eColumnType type;
+		int32_t listSize;
+
+		int64_t nullCount;
+
+		// in arrow's buffer order for the type, empty validity buffers mean no nulls
+		std::vector<std::vector<char>> buffers;
+	};
+
+	Column_t& AddColumn(const std::string& name, const eColumnType type, const int32_t listSize);
+	const uint32_t SerializeSchema(CFlatBufferBuilder& builder) const;
+
+	int64_t m_numRows;
+	std::vector<Column_t> m_columns;
+};
@@ -6,8 +6,17 @@ static constexpr size_t managedBufferSize = (1024 * 1024 * 32);
 struct CManagedBuffer
 {
 public:
-	CManagedBuffer() : isOpen(true) { buf = new char[managedBufferSize]; };
-	~CManagedBuffer() { delete[] buf; };
+	CManagedBuffer() : isOpen(true)
+	{
+		buf = new char[managedBufferSize];
+		g_MemoryTracker.Alloc(eMemoryCategory::MEM_MANAGED_BUFFER, 0u, managedBufferSize);
+	};
+
+	~CManagedBuffer()
+	{
+		delete[] buf;
+		g_MemoryTracker.Free(eMemoryCategory::MEM_MANAGED_BUFFER, 0u, managedBufferSize);
+	};
 
 	const bool GetStatus() const { return isOpen; };
 	char* const Buffer() const { return buf; };
@@ -0,0 +1,395 @@
+#include <pch.h>
+#include <core/utils/exportarchive.h>
+
+CExportArchive g_ExportArchive;
+
+#pragma pack(push, 1)
+struct ZipLocalFileHeader_t
+{
+	uint32_t signature;
+	uint16_t versionNeeded;
+	uint16_t flags;
+	uint16_t compression;
+	uint16_t modTime;
+	uint16_t modDate;
+	uint32_t crc;
+	uint32_t compressedSize;
+	uint32_t uncompressedSize;
+	uint16_t nameLength;
+	uint16_t extraLength;
+};
+static_assert(sizeof(ZipLocalFileHeader_t) == 30);
+
+struct ZipCentralDirHeader_t
+{
+	uint32_t signature;
+	uint16_t versionMadeBy;
+	uint16_t versionNeeded;
+	uint16_t flags;
+	uint16_t compression;
+	uint16_t modTime;
+	uint16_t modDate;
+	uint32_t crc;
+	uint32_t compressedSize;
+	uint32_t uncompressedSize;
+	uint16_t nameLength;
+	uint16_t extraLength;
+	uint16_t commentLength;
+	uint16_t diskNumberStart;
+	uint16_t internalAttributes;
+	uint32_t externalAttributes;
+	uint32_t localHeaderOffset;
+};
+static_assert(sizeof(ZipCentralDirHeader_t) == 46);
+
+struct ZipEndOfCentralDir64_t
+{
+	uint32_t signature;
+	uint64_t recordSize; // size of the remaining record
+	uint16_t versionMadeBy;
+	uint16_t versionNeeded;
+	uint32_t diskNumber;
+	uint32_t centralDirDisk;
+	uint64_t numEntriesOnDisk;
+	uint64_t numEntries;
+	uint64_t centralDirSize;
+	uint64_t centralDirOffset;
+};
+static_assert(sizeof(ZipEndOfCentralDir64_t) == 56);
+
+struct ZipEndOfCentralDir64Locator_t
+{
+	uint32_t signature;
+	uint32_t endOfCentralDirDisk;
+	uint64_t endOfCentralDirOffset;
+	uint32_t numDisks;
+};
+static_assert(sizeof(ZipEndOfCentralDir64Locator_t) == 20);
+
+struct ZipEndOfCentralDir_t
+{
+	uint32_t signature;
+	uint16_t diskNumber;
+	uint16_t centralDirDisk;
+	uint16_t numEntriesOnDisk;
+	uint16_t numEntries;
+	uint32_t centralDirSize;
+	uint32_t centralDirOffset;
+	uint16_t commentLength;
+};
+static_assert(sizeof(ZipEndOfCentralDir_t) == 22);
+#pragma pack(pop)
+
+static constexpr uint32_t ZIP_SIG_LOCAL_FILE		= 0x04034b50;
+static constexpr uint32_t ZIP_SIG_CENTRAL_DIR		= 0x02014b50;
+static constexpr uint32_t ZIP_SIG_EOCD64			= 0x06064b50;
+static constexpr uint32_t ZIP_SIG_EOCD64_LOCATOR	= 0x07064b50;
+static constexpr uint32_t ZIP_SIG_EOCD				= 0x06054b50;
+
+static constexpr uint16_t ZIP_VERSION_ZIP64		= 45; // 4.5, required for zip64 extensions
+static constexpr uint16_t ZIP_FLAG_UTF8			= (1 << 11);
+static constexpr uint16_t ZIP_EXTRA_ZIP64		= 0x0001;
+
+static constexpr uint32_t ZIP_MAX32 = 0xFFFFFFFF;
+static constexpr uint16_t ZIP_MAX16 = 0xFFFF;
+
+bool CExportArchive::Open(const std::filesystem::path& archivePath, const std::filesystem::path& rootPath)
+{
+	assertm(!IsOpen(), "export archive was already open");
+	if (IsOpen())
+		return false;
+
+	if (archivePath.has_parent_path() && !std::filesystem::exists(archivePath.parent_path()))
+		std::filesystem::create_directories(archivePath.parent_path());
+
+	m_fileHandle = CreateFileW(archivePath.wstring().c_str(), GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (m_fileHandle == INVALID_HANDLE_VALUE)
+	{
+		Log("EXPORT: failed to create export archive %s\n", archivePath.string().c_str());
+		return false;
+	}
+
+	m_archivePath = archivePath;
+
+	m_rootPath = std::filesystem::absolute(rootPath).lexically_normal().make_preferred().string();
+	std::transform(m_rootPath.begin(), m_rootPath.end(), m_rootPath.begin(), [](const char c) { return static_cast<char>(std::tolower(static_cast<unsigned char>(c))); });
+	if (!m_rootPath.empty() && m_rootPath.back() != '\\')
+		m_rootPath.push_back('\\');
+
+	m_entries.clear();
+	m_entryNames.clear();
+	m_writeOffset = 0ull;
+
+	// every entry shares the time the archive was opened
+	const time_t t = std::time(nullptr);
+	tm tm;
+	if (!localtime_s(&tm, &t))
+	{
+		m_dosTime = static_cast<uint16_t>((tm.tm_hour << 11) | (tm.tm_min << 5) | (tm.tm_sec >> 1));
+		m_dosDate = static_cast<uint16_t>(((std::max(tm.tm_year - 80, 0)) << 9) | ((tm.tm_mon + 1) << 5) | tm.tm_mday);
+	}
+
+	return true;
+}
+
+bool CExportArchive::Close()
+{
+	if (!IsOpen())
+		return false;
+
+	std::lock_guard<std::mutex> lock(m_entryMutex);
+
+	// sort the central directory so the listing is stable regardless of which worker finished first
+	std::sort(m_entries.begin(), m_entries.end(), [](const Entry_t& a, const Entry_t& b) { return a.name < b.name; });
+
+	std::string centralDir;
+	centralDir.reserve(m_entries.size() * (sizeof(ZipCentralDirHeader_t) + 28 + 64));
+
+	for (const Entry_t& entry : m_entries)
+	{
+		const bool largeSize = entry.size >= ZIP_MAX32;
+		const bool largeOffset = entry.offset >= ZIP_MAX32;
+
+		uint64_t extra[3] = {};
+		uint16_t numExtra = 0;
+
+		if (largeSize)
+		{
+			extra[numExtra++] = entry.size; // uncompressed
+			extra[numExtra++] = entry.size; // compressed
+		}
+
+		if (largeOffset)
+			extra[numExtra++] = entry.offset;
+
+		const uint16_t extraDataSize = static_cast<uint16_t>(numExtra * sizeof(uint64_t));
+
+		const ZipCentralDirHeader_t header =
+		{
+			.signature = ZIP_SIG_CENTRAL_DIR,
+			.versionMadeBy = ZIP_VERSION_ZIP64,
+			.versionNeeded = ZIP_VERSION_ZIP64,
+			.flags = ZIP_FLAG_UTF8,
+			.compression = 0, // store
+			.modTime = m_dosTime,
+			.modDate = m_dosDate,
+			.crc = entry.crc,
+			.compressedSize = largeSize ? ZIP_MAX32 : static_cast<uint32_t>(entry.size),
+			.uncompressedSize = largeSize ? ZIP_MAX32 : static_cast<uint32_t>(entry.size),
+			.nameLength = static_cast<uint16_t>(entry.name.length()),
+			.extraLength = static_cast<uint16_t>(numExtra ? extraDataSize + 4 : 0),
+			.commentLength = 0,
+			.diskNumberStart = 0,
+			.internalAttributes = 0,
+			.externalAttributes = 0,
+			.localHeaderOffset = largeOffset ? ZIP_MAX32 : static_cast<uint32_t>(entry.offset),
+		};
+
+		centralDir.append(reinterpret_cast<const char*>(&header), sizeof(header));
+		centralDir.append(entry.name);
+
+		if (numExtra)
+		{
+			const uint16_t extraHeader[2] = { ZIP_EXTRA_ZIP64, extraDataSize };
+			centralDir.append(reinterpret_cast<const char*>(extraHeader), sizeof(extraHeader));
+			centralDir.append(reinterpret_cast<const char*>(extra), extraDataSize);
+		}
+	}
+
+	const uint64_t centralDirOffset = m_writeOffset;
+	const uint64_t centralDirSize = centralDir.size();
+	const uint64_t numEntries = m_entries.size();
+
+	bool success = WriteAt(centralDirOffset, centralDir.data(), centralDir.size());
+
+	uint64_t tailOffset = centralDirOffset + centralDirSize;
+
+	const bool needsZip64 = numEntries >= ZIP_MAX16 || centralDirOffset >= ZIP_MAX32 || centralDirSize >= ZIP_MAX32;
+	if (needsZip64)
+	{
+		const ZipEndOfCentralDir64_t eocd64 =
+		{
+			.signature = ZIP_SIG_EOCD64,
+			.recordSize = sizeof(ZipEndOfCentralDir64_t) - 12,
+			.versionMadeBy = ZIP_VERSION_ZIP64,
+			.versionNeeded = ZIP_VERSION_ZIP64,
+			.diskNumber = 0,
+			.centralDirDisk = 0,
+			.numEntriesOnDisk = numEntries,
+			.numEntries = numEntries,
+			.centralDirSize = centralDirSize,
+			.centralDirOffset = centralDirOffset,
+		};
+
+		const ZipEndOfCentralDir64Locator_t locator =
+		{
+			.signature = ZIP_SIG_EOCD64_LOCATOR,
+			.endOfCentralDirDisk = 0,
+			.endOfCentralDirOffset = tailOffset,
+			.numDisks = 1,
+		};
+
+		success &= WriteAt(tailOffset, &eocd64, sizeof(eocd64));
+		tailOffset += sizeof(eocd64);
+
+		success &= WriteAt(tailOffset, &locator, sizeof(locator));
+		tailOffset += sizeof(locator);
+	}
+
+	const ZipEndOfCentralDir_t eocd =
+	{
+		.signature = ZIP_SIG_EOCD,
+		.diskNumber = 0,
+		.centralDirDisk = 0,
+		.numEntriesOnDisk = needsZip64 ? ZIP_MAX16 : static_cast<uint16_t>(numEntries),
+		.numEntries = needsZip64 ? ZIP_MAX16 : static_cast<uint16_t>(numEntries),
+		.centralDirSize = needsZip64 ? ZIP_MAX32 : static_cast<uint32_t>(centralDirSize),
+		.centralDirOffset = needsZip64 ? ZIP_MAX32 : static_cast<uint32_t>(centralDirOffset),
+		.commentLength = 0,
+	};
+
+	success &= WriteAt(tailOffset, &eocd, sizeof(eocd));
+
+	CloseHandle(m_fileHandle);
+	m_fileHandle = INVALID_HANDLE_VALUE;
+
+	Log("EXPORT: wrote %lld files to export archive %s\n", numEntries, m_archivePath.string().c_str());
+
+	m_entries.clear();
+	m_entries.shrink_to_fit();
+	m_entryNames.clear();
+
+	return success;
+}
+
+const bool CExportArchive::ContainsPath(const std::filesystem::path& path) const
+{
+	if (m_rootPath.empty())
+		return false;
+
+	std::string fullPath = std::filesystem::absolute(path).lexically_normal().make_preferred().string();
+	if (fullPath.length() < m_rootPath.length())
+		return false;
+
+	return _strnicmp(fullPath.c_str(), m_rootPath.c_str(), m_rootPath.length()) == 0;
+}
+
+const std::string CExportArchive::GetEntryName(const std::filesystem::path& path) const
+{
+	const std::string fullPath = std::filesystem::absolute(path).lexically_normal().string();
+
+	// keep the original casing of the path, only the prefix is compared case insensitive
+	std::string name = fullPath.substr(m_rootPath.length());
+	std::replace(name.begin(), name.end(), '\\', '/');
+
+	return name;
+}
+
+bool CExportArchive::WriteAt(const uint64_t offset, const void* const data, const size_t size)
+{
+	const char* curData = reinterpret_cast<const char*>(data);
+	uint64_t curOffset = offset;
+	size_t remaining = size;
+
+	// WriteFile can only take 32 bit sizes
+	while (remaining > 0)
+	{
+		const DWORD writeSize = static_cast<DWORD>(std::min(remaining, static_cast<size_t>(1u << 30)));
+
+		OVERLAPPED overlapped = {};
+		overlapped.Offset = static_cast<DWORD>(curOffset & 0xFFFFFFFF);
+		overlapped.OffsetHigh = static_cast<DWORD>(curOffset >> 32);
+
+		DWORD numWritten = 0;
+		if (!WriteFile(m_fileHandle, curData, writeSize, &numWritten, &overlapped) || numWritten != writeSize)
+		{
+			assertm(false, "failed to write to export archive");
+			return false;
+		}
+
+		curData += writeSize;
+		curOffset += writeSize;
+		remaining -= writeSize;
+	}
+
+	return true;
+}
+
+bool CExportArchive::AddFile(const std::filesystem::path& path, const void* const data, const size_t size)
+{
+	assertm(IsOpen(), "export archive was not open");
+	if (!IsOpen())
+		return false;
+
+	const std::string name = GetEntryName(path);
+	if (name.empty() || name.length() >= ZIP_MAX16)
+		return false;
+
+	const uint32_t crc = size > 0 ? crc32::byteLevel(reinterpret_cast<const uint8_t*>(data), size) : 0u;
+	const bool largeSize = size >= ZIP_MAX32;
+
+	const ZipLocalFileHeader_t header =
+	{
+		.signature = ZIP_SIG_LOCAL_FILE,
+		.versionNeeded = ZIP_VERSION_ZIP64,
+		.flags = ZIP_FLAG_UTF8,
+		.compression = 0, // store
+		.modTime = m_dosTime,
+		.modDate = m_dosDate,
+		.crc = crc,
+		.compressedSize = largeSize ? ZIP_MAX32 : static_cast<uint32_t>(size),
+		.uncompressedSize = largeSize ? ZIP_MAX32 : static_cast<uint32_t>(size),
+		.nameLength = static_cast<uint16_t>(name.length()),
+		.extraLength = static_cast<uint16_t>(largeSize ? 20 : 0),
+	};
+
+	std::string localHeader;
+	localHeader.reserve(sizeof(header) + name.length() + header.extraLength);
+	localHeader.append(reinterpret_cast<const char*>(&header), sizeof(header));
+	localHeader.append(name);
+
+	if (largeSize)
+	{
+		const uint16_t extraHeader[2] = { ZIP_EXTRA_ZIP64, 16 };
+		const uint64_t extraSizes[2] = { size, size };
+
+		localHeader.append(reinterpret_cast<const char*>(extraHeader), sizeof(extraHeader));
+		localHeader.append(reinterpret_cast<const char*>(extraSizes), sizeof(extraSizes));
+	}
+
+	// reserve space for this entry, the actual write happens outside of the lock so workers can write in parallel
+	uint64_t entryOffset = 0ull;
+	{
+		std::lock_guard<std::mutex> lock(m_entryMutex);
+
+		entryOffset = m_writeOffset;
+		m_writeOffset += localHeader.size() + size;
+
+		// the loose file writer overwrites an existing file (e.g. textures shared between materials), so the last copy wins.
+		// the older copy stays in the archive as unreferenced data, only the central directory decides what gets extracted.
+		// windows paths are case insensitive, so like an overwritten loose file the entry keeps the name it was first written with
+		std::string key = name;
+		std::transform(key.begin(), key.end(), key.begin(), [](const char c) { return static_cast<char>(std::tolower(static_cast<unsigned char>(c))); });
+
+		const auto [it, inserted] = m_entryNames.try_emplace(std::move(key), m_entries.size());
+		if (inserted)
+		{
+			m_entries.push_back({ name, entryOffset, size, crc });
+		}
+		else
+		{
+			Entry_t& entry = m_entries[it->second];
+			entry.offset = entryOffset;
+			entry.size = size;
+			entry.crc = crc;
+		}
+	}
+
+	if (!WriteAt(entryOffset, localHeader.data(), localHeader.size()))
+		return false;
+
+	if (size > 0 && !WriteAt(entryOffset + localHeader.size(), data, size))
+		return false;
+
+	return true;
+}
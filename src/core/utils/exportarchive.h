@@ -0,0 +1,76 @@
+#pragma once
+
+// single-file export sink
+// writes every exported file into one uncompressed (store-mode) zip instead of loose files on disk.
+// entries are appended in parallel by the export workers and the central directory is written on close.
+// the archive uses zip64 records where required, so archives (and entries) larger than 4GB are fine.
+class CExportArchive
+{
+public:
+	CExportArchive() : m_fileHandle(INVALID_HANDLE_VALUE), m_writeOffset(0ull), m_dosTime(0u), m_dosDate(0u) {};
+	~CExportArchive()
+	{
+		Close();
+	}
+
+	CExportArchive(const CExportArchive&) = delete;
+	CExportArchive& operator=(const CExportArchive&) = delete;
+
+	// opens a new archive at archivePath, any file exported under rootPath will be stored in the archive
+	// relative to rootPath, matching the layout the loose file writer would produce.
+	bool Open(const std::filesystem::path& archivePath, const std::filesystem::path& rootPath);
+
+	// writes the central directory and closes the archive
+	bool Close();
+
+	inline const bool IsOpen() const { return m_fileHandle != INVALID_HANDLE_VALUE; }
+
+	// returns true if a file at this path should be written into the archive
+	const bool ContainsPath(const std::filesystem::path& path) const;
+
+	// thread safe, adds a file to the archive. adding a path that is already in the archive replaces it
+	bool AddFile(const std::filesystem::path& path, const void* const data, const size_t size);
+
+	inline const size_t GetNumEntries()
+	{
+		std::lock_guard<std::mutex> lock(m_entryMutex);
+		return m_entries.size();
+	}
+
+private:
+	struct Entry_t
+	{
+		std::string name;
+		uint64_t offset; // offset of the local file header
+		uint64_t size;
+		uint32_t crc;
+	};
+
+	bool WriteAt(const uint64_t offset, const void* const data, const size_t size);
+	const std::string GetEntryName(const std::filesystem::path& path) const;
+
+	HANDLE m_fileHandle;
+
+	std::filesystem::path m_archivePath;
+	std::string m_rootPath; // normalized, lower case, with a trailing separator
+
+	std::vector<Entry_t> m_entries;
+	std::unordered_map<std::string, size_t> m_entryNames; // lower case entry name to its index in m_entries
+	std::mutex m_entryMutex; // guards m_entries, m_entryNames and m_writeOffset
+
+	uint64_t m_writeOffset;
+
+	uint16_t m_dosTime;
+	uint16_t m_dosDate;
+};
+
+extern CExportArchive g_ExportArchive;
+
+namespace FileSystem
+{
+	// returns true if this path will be stored in the export archive rather than on disk
+	inline const bool IsArchivedPath(const std::filesystem::path& path)
+	{
+		return g_ExportArchive.IsOpen() && g_ExportArchive.ContainsPath(path);
+	}
+}
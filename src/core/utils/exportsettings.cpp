@@ -41,7 +41,13 @@ void ExportSettings_t::SetFromCLI(const CCommandLine* cli)
 	this->exportModelMatsTruncated = cli->HasParam("-truncatemodelmats");
 	this->exportQCIFiles = cli->HasParam("-useqci");
 
+	if (const char* const flacLevelStr = cli->GetParamValue("--flaclevel"))
+		this->exportFlacCompressionLevel = static_cast<uint32_t>(std::clamp(atoi(flacLevelStr), 0, 8));
+
 	// i'm not too happy with this being "--exportdir", so this may change at some point
 	if (const char* const exportPath = cli->GetParamValue("--exportdir"))
 		this->exportDirectory = exportPath;
+
+	if (const char* const archivePath = cli->GetParamValue("--exportarchive"))
+		this->exportArchivePath = archivePath;
 }
\ No newline at end of file
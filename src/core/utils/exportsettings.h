@@ -34,7 +34,11 @@ struct ExportSettings_t
     bool exportPhysicsFilterExclusive;
     bool exportPhysicsFilterAND;
 
+    // audio settings
+    uint32_t exportFlacCompressionLevel; // 0-8, fastest to smallest
+
     std::filesystem::path exportDirectory;
+    std::filesystem::path exportArchivePath; // if set, exported files are stored in this archive instead of being written loose
 
     void SetFromCLI(const CCommandLine* cli);
 
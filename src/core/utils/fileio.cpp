@@ -1,20 +1,272 @@
 #include <pch.h>
 #include <core/utils/fileio.h>
 
-std::mutex dirMutex;
-bool CreateDirectories(const std::filesystem::path& exportPath)
+// cache of directories that are known to exist, so export workers don't have to hit the filesystem for every file.
+// open addressing table of path hashes, lookups and inserts are lock free. a hash of 0 marks an empty slot.
+// each slot also points at the interned key it was inserted with, so a hash collision is a miss rather than a false hit.
+class CDirectoryCache
 {
-    std::lock_guard<std::mutex> lock(dirMutex);
-    if (!std::filesystem::exists(exportPath))
+public:
+    static constexpr size_t tableSize = 1ull << 16;
+    static constexpr size_t maxProbes = 64; // if we can't find a slot in this many probes, don't bother caching
+
+    CDirectoryCache() : generation(1u)
+    {
+        Clear();
+    }
+
+    // normalized, case and separator insensitive form of the path, since windows paths are.
+    // 'a\b', 'a/b/' and 'a\x\..\b' all end up as the same key
+    static std::wstring MakeKey(const std::filesystem::path& path)
     {
-        if (!std::filesystem::create_directories(exportPath))
+        std::wstring key = path.lexically_normal().native();
+
+        for (wchar_t& c : key)
         {
-            return false;
+            if (c == L'/')
+                c = L'\\';
+            else if (c >= L'A' && c <= L'Z')
+                c += (L'a' - L'A');
+        }
+
+        while (!key.empty() && key.back() == L'\\')
+            key.pop_back();
+
+        return key;
+    }
+
+    static const uint64_t HashKey(const std::wstring& key)
+    {
+        // fnv1a over the key
+        uint64_t hash = 0xcbf29ce484222325ull;
+        for (const wchar_t c : key)
+        {
+            hash ^= static_cast<uint64_t>(c);
+            hash *= 0x100000001b3ull;
+        }
+
+        // 0 is reserved for empty slots
+        return hash != 0ull ? hash : 1ull;
+    }
+
+    inline const bool Contains(const std::wstring& key, const uint64_t hash) const
+    {
+        for (size_t i = 0; i < maxProbes; ++i)
+        {
+            const Slot_t& slot = table[(hash + i) & (tableSize - 1)];
+            const uint64_t slotHash = slot.hash.load(std::memory_order_acquire);
+
+            if (slotHash == 0ull)
+                return false;
+
+            // the key is published after the hash, if it isn't there yet treat it as a miss and let the filesystem answer
+            if (slotHash == hash)
+            {
+                const std::wstring* const slotKey = slot.key.load(std::memory_order_acquire);
+
+                if (slotKey && *slotKey == key)
+                    return true;
+            }
+        }
+
+        return false;
+    }
+
+    void Insert(const std::wstring& key, const uint64_t hash)
+    {
+        const std::wstring* const internedKey = Intern(key);
+
+        for (size_t i = 0; i < maxProbes; ++i)
+        {
+            Slot_t& slot = table[(hash + i) & (tableSize - 1)];
+
+            uint64_t expected = 0ull;
+            if (slot.hash.compare_exchange_strong(expected, hash, std::memory_order_acq_rel))
+            {
+                slot.key.store(internedKey, std::memory_order_release);
+                return;
+            }
+
+            // interned, so the same key is always the same pointer
+            if (expected == hash && slot.key.load(std::memory_order_acquire) == internedKey)
+                return;
+        }
+    }
+
+    void Clear()
+    {
+        for (Slot_t& slot : table)
+        {
+            slot.hash.store(0ull, std::memory_order_relaxed);
+            slot.key.store(nullptr, std::memory_order_relaxed);
+        }
+
+        generation++;
+    }
+
+    std::atomic<uint32_t> generation; // bumped on clear, so thread stats from before it get reset
+
+private:
+    struct Slot_t
+    {
+        std::atomic<uint64_t> hash;
+        std::atomic<const std::wstring*> key;
+    };
+
+    // keys are never freed, a reader may still be comparing against one while the table is cleared.
+    // this only grows with the number of distinct directories exported to in a session
+    const std::wstring* Intern(const std::wstring& key)
+    {
+        std::lock_guard<std::mutex> lock(internMutex);
+        return &*internedKeys.insert(key).first;
+    }
+
+    Slot_t table[tableSize];
+
+    std::mutex internMutex;
+    std::unordered_set<std::wstring> internedKeys;
+};
+
+static CDirectoryCache s_DirectoryCache;
+
+// per thread counters, registered while the thread is alive so the hot path never takes a lock.
+// counts from threads that have exited are folded into the retired totals, so short lived export workers don't pile up entries
+static std::mutex s_DirStatsMutex;
+static std::vector<FileSystem::DirectoryCacheStats_t*> s_DirStats;
+static uint64_t s_RetiredDirCacheHits = 0ull;
+static uint64_t s_RetiredDirCacheMisses = 0ull;
+
+class CThreadDirectoryStats
+{
+public:
+    CThreadDirectoryStats()
+    {
+        stats.threadId = std::this_thread::get_id();
+
+        std::lock_guard<std::mutex> lock(s_DirStatsMutex);
+        s_DirStats.push_back(&stats);
+    }
+
+    ~CThreadDirectoryStats()
+    {
+        std::lock_guard<std::mutex> lock(s_DirStatsMutex);
+
+        if (stats.generation.load(std::memory_order_relaxed) == s_DirectoryCache.generation.load(std::memory_order_relaxed))
+        {
+            s_RetiredDirCacheHits += stats.numCacheHits.load(std::memory_order_relaxed);
+            s_RetiredDirCacheMisses += stats.numCacheMisses.load(std::memory_order_relaxed);
         }
+
+        s_DirStats.erase(std::find(s_DirStats.begin(), s_DirStats.end(), &stats));
+    }
+
+    FileSystem::DirectoryCacheStats_t stats;
+};
+
+static FileSystem::DirectoryCacheStats_t* const GetThreadDirectoryStats()
+{
+    thread_local CThreadDirectoryStats threadStats;
+
+    FileSystem::DirectoryCacheStats_t* const stats = &threadStats.stats;
+
+    // the cache has been cleared since this thread last used it, start counting from zero again
+    const uint32_t generation = s_DirectoryCache.generation.load(std::memory_order_relaxed);
+    if (stats->generation.load(std::memory_order_relaxed) != generation)
+    {
+        stats->numCacheHits.store(0ull, std::memory_order_relaxed);
+        stats->numCacheMisses.store(0ull, std::memory_order_relaxed);
+        stats->generation.store(generation, std::memory_order_relaxed);
     }
+
+    return stats;
+}
+
+bool CreateDirectories(const std::filesystem::path& exportPath)
+{
+    // directories are implicit in the export archive
+    if (FileSystem::IsArchivedPath(exportPath))
+        return true;
+
+    FileSystem::DirectoryCacheStats_t* const stats = GetThreadDirectoryStats();
+
+    const std::wstring key = CDirectoryCache::MakeKey(exportPath);
+    const uint64_t hash = CDirectoryCache::HashKey(key);
+    if (s_DirectoryCache.Contains(key, hash))
+    {
+        stats->numCacheHits.fetch_add(1ull, std::memory_order_relaxed);
+        return true;
+    }
+
+    stats->numCacheMisses.fetch_add(1ull, std::memory_order_relaxed);
+
+    // create_directories is fine with another thread creating the same tree at the same time, so no lock is needed here
+    std::error_code error;
+    std::filesystem::create_directories(exportPath, error);
+
+    if (error && !std::filesystem::is_directory(exportPath))
+        return false;
+
+    s_DirectoryCache.Insert(key, hash);
+    return true;
+}
+
+bool CMappedFile::open(const std::filesystem::path& path)
+{
+    close();
+
+    fileHandle = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (fileHandle == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER fileSize = {};
+    if (!GetFileSizeEx(fileHandle, &fileSize) || fileSize.QuadPart == 0)
+    {
+        // can't map an empty file
+        close();
+        return false;
+    }
+
+    mappingHandle = CreateFileMappingW(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mappingHandle)
+    {
+        close();
+        return false;
+    }
+
+    data = reinterpret_cast<const char*>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+    if (!data)
+    {
+        close();
+        return false;
+    }
+
+    dataSize = static_cast<size_t>(fileSize.QuadPart);
     return true;
 }
 
+void CMappedFile::close()
+{
+    if (data)
+    {
+        UnmapViewOfFile(data);
+        data = nullptr;
+    }
+
+    if (mappingHandle)
+    {
+        CloseHandle(mappingHandle);
+        mappingHandle = nullptr;
+    }
+
+    if (fileHandle != INVALID_HANDLE_VALUE)
+    {
+        CloseHandle(fileHandle);
+        fileHandle = INVALID_HANDLE_VALUE;
+    }
+
+    dataSize = 0ull;
+}
+
 bool RestoreCurrentWorkingDirectory()
 {
     wchar_t processDirectory[MAX_PATH];
@@ -103,15 +355,78 @@ FILE* FileFromHandle(HANDLE handle, const eStreamIOMode mode)
 
 namespace FileSystem
 {
+    void PrecreateDirectories(const std::vector<std::filesystem::path>& directories)
+    {
+        // dedupe first, export plans tend to share most of their directories
+        std::unordered_set<std::wstring> seen;
+        seen.reserve(directories.size());
+
+        for (const std::filesystem::path& dir : directories)
+        {
+            if (seen.insert(CDirectoryCache::MakeKey(dir)).second)
+                CreateDirectories(dir);
+        }
+    }
 
-    bool ReadFileData(const std::string& filePath, std::shared_ptr<char[]>* buffer)
+    void ClearDirectoryCache()
+    {
+        std::lock_guard<std::mutex> lock(s_DirStatsMutex);
+
+        s_DirectoryCache.Clear();
+
+        s_RetiredDirCacheHits = 0ull;
+        s_RetiredDirCacheMisses = 0ull;
+    }
+
+    void LogDirectoryCacheStats()
+    {
+        std::lock_guard<std::mutex> lock(s_DirStatsMutex);
+
+        const uint32_t generation = s_DirectoryCache.generation.load(std::memory_order_relaxed);
+
+        uint64_t totalHits = s_RetiredDirCacheHits;
+        uint64_t totalMisses = s_RetiredDirCacheMisses;
+
+        for (const DirectoryCacheStats_t* const stats : s_DirStats)
+        {
+            // counted before the last clear
+            if (stats->generation.load(std::memory_order_relaxed) != generation)
+                continue;
+
+            const uint64_t numCacheHits = stats->numCacheHits.load(std::memory_order_relaxed);
+            const uint64_t numCacheMisses = stats->numCacheMisses.load(std::memory_order_relaxed);
+
+            if (numCacheHits == 0 && numCacheMisses == 0)
+                continue;
+
+            std::ostringstream threadId;
+            threadId << stats->threadId;
+
+            Log("DIRCACHE: thread %s: %lld filesystem calls avoided, %lld directories created/checked\n", threadId.str().c_str(), numCacheHits, numCacheMisses);
+
+            totalHits += numCacheHits;
+            totalMisses += numCacheMisses;
+        }
+
+        if (s_RetiredDirCacheHits != 0 || s_RetiredDirCacheMisses != 0)
+            Log("DIRCACHE: exited threads: %lld filesystem calls avoided, %lld directories created/checked\n", s_RetiredDirCacheHits, s_RetiredDirCacheMisses);
+
+        Log("DIRCACHE: %lld filesystem calls avoided, %lld directories created/checked\n", totalHits, totalMisses);
+    }
+
+
+    bool ReadFileData(const std::string& filePath, std::shared_ptr<char[]>* buffer, size_t* const size)
     {
         StreamIO file;
         if (!file.open(filePath, eStreamIOMode::Read))
             return false;
 
-        *buffer = std::shared_ptr<char[]>(new char[file.size()]);
+        *buffer = MemoryTracker::AllocSharedBuffer(eMemoryCategory::MEM_FILE_BUFFER, file.size());
         file.read(buffer->get(), file.size());
+
+        if (size)
+            *size = file.size();
+
         return true;
     }
 }
\ No newline at end of file
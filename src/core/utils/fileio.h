@@ -10,15 +10,15 @@ enum class eStreamIOMode : uint8_t
 class StreamIO
 {
 public:
-    StreamIO() : writer(), reader(), filePath(), currentMode(eStreamIOMode::None) {};
-    StreamIO(const std::string& path, const eStreamIOMode mode)
+    StreamIO() : writer(), reader(), filePath(), currentMode(eStreamIOMode::None), textMode(false) {};
+    StreamIO(const std::string& path, const eStreamIOMode mode, const bool text = false)
     {
-        open(path, mode);
+        open(path, mode, text);
     }
 
-    StreamIO(const std::filesystem::path& path, const eStreamIOMode mode)
+    StreamIO(const std::filesystem::path& path, const eStreamIOMode mode, const bool text = false)
     {
-        open(path.string(), mode);
+        open(path.string(), mode, text);
     }
 
     StreamIO(FILE* file, const eStreamIOMode mode)
@@ -28,17 +28,31 @@ public:
 
     // opens a file with either read or write mode. Returns whether
     // the open operation was successful
-    bool open(const std::string& path, const eStreamIOMode mode)
+    // text writes translate new lines like a text mode std::ofstream does, in the export archive as well
+    bool open(const std::string& path, const eStreamIOMode mode, const bool text = false)
     {
         // Write mode
         if (mode == eStreamIOMode::Write)
         {
             currentMode = mode;
             // check if we had a previously opened file to close it
-            if (writer.is_open())
-                writer.close();
+            if (writer.is_open() || archiveBuffer)
+                close();
+
+            textMode = text;
+
+            // exported files get buffered in memory and stored in the export archive on close
+            if (FileSystem::IsArchivedPath(path))
+            {
+                filePath = path;
+                archiveBuffer = new std::stringbuf(std::ios::out | std::ios::binary);
+                writer.std::ios::rdbuf(archiveBuffer);
+                writer.clear();
 
-            writer.open(path.c_str(), std::ios::binary);
+                return true;
+            }
+
+            writer.open(path.c_str(), text ? std::ios::out : std::ios::binary);
             if (!writer.is_open())
             {
                 currentMode = eStreamIOMode::None;
@@ -123,11 +137,51 @@ public:
         return currentMode == eStreamIOMode::None ? false : true;
     }
 
+    ~StreamIO()
+    {
+        // files written to the export archive are only committed once closed
+        if (archiveBuffer)
+            close();
+    }
+
     // closes the file
     void close()
     {
         if (currentMode == eStreamIOMode::Write)
         {
+            if (archiveBuffer)
+            {
+                const std::string_view data = archiveBuffer->view();
+
+                if (textMode)
+                {
+                    // what the text mode file stream would have written
+                    std::string translated;
+                    translated.reserve(data.size() + (data.size() / 16));
+
+                    for (const char c : data)
+                    {
+                        if (c == '\n')
+                            translated.push_back('\r');
+
+                        translated.push_back(c);
+                    }
+
+                    g_ExportArchive.AddFile(filePath, translated.data(), translated.size());
+                }
+                else
+                {
+                    g_ExportArchive.AddFile(filePath, data.data(), data.size());
+                }
+
+                // restore the file buffer before the string buffer goes away
+                writer.std::ios::rdbuf(writer.rdbuf());
+                delete archiveBuffer;
+                archiveBuffer = nullptr;
+
+                return;
+            }
+
             writer.close();
         }
         else if (currentMode == eStreamIOMode::Read)
@@ -338,6 +392,50 @@ private:
     std::ifstream reader;
     std::string filePath;
     eStreamIOMode currentMode;
+    bool textMode; // only for writes
+
+    std::stringbuf* archiveBuffer = nullptr; // set when writing into the export archive
+};
+
+// read only view of a whole file, pages are only read in as they are touched so this is cheap to keep open for huge files
+class CMappedFile
+{
+public:
+    CMappedFile() : fileHandle(INVALID_HANDLE_VALUE), mappingHandle(nullptr), data(nullptr), dataSize(0ull) {};
+    ~CMappedFile()
+    {
+        close();
+    }
+
+    CMappedFile(const CMappedFile&) = delete;
+    CMappedFile& operator=(const CMappedFile&) = delete;
+
+    bool open(const std::filesystem::path& path);
+    void close();
+
+    inline const bool isOpen() const { return data != nullptr; }
+
+    inline const char* const get() const { return data; }
+    inline const size_t size() const { return dataSize; }
+
+    // copies out of the view, returns how many bytes could be read
+    inline const size_t read(char* const buf, const size_t offset, const size_t len) const
+    {
+        if (offset >= dataSize)
+            return 0ull;
+
+        const size_t readSize = std::min(len, dataSize - offset);
+        memcpy(buf, data + offset, readSize);
+
+        return readSize;
+    }
+
+private:
+    HANDLE fileHandle;
+    HANDLE mappingHandle;
+
+    const char* data;
+    size_t dataSize;
 };
 
 bool CreateDirectories(const std::filesystem::path& exportPath);
@@ -348,5 +446,21 @@ FILE* FileFromHandle(HANDLE handle, const eStreamIOMode mode);
 
 namespace FileSystem
 {
-    bool ReadFileData(const std::string& filePath, std::shared_ptr<char[]>* buffer);
+    // size is set to the number of bytes read if it isn't nullptr
+    bool ReadFileData(const std::string& filePath, std::shared_ptr<char[]>* buffer, size_t* const size = nullptr);
+
+    // per thread statistics for CreateDirectories
+    struct DirectoryCacheStats_t
+    {
+        // written by the owning thread and read by the logging thread, hence atomic
+        std::thread::id threadId;
+        std::atomic<uint32_t> generation{ 0u };       // directory cache generation these counts are from
+        std::atomic<uint64_t> numCacheHits{ 0ull };   // calls that were served from the cache, without touching the filesystem
+        std::atomic<uint64_t> numCacheMisses{ 0ull }; // calls that had to go to the filesystem
+    };
+
+    // creates a list of directories up front (e.g. from an export plan) so workers only ever hit the cache
+    void PrecreateDirectories(const std::vector<std::filesystem::path>& directories);
+    void ClearDirectoryCache();
+    void LogDirectoryCacheStats();
 }
@@ -0,0 +1,116 @@
+#pragma once
+
+// 128 bit non-cryptographic hash for content addressing (MurmurHash3 x64_128, public domain, Austin Appleby)
+// fast enough to hash every shader/blob we export, wide enough that collisions aren't a concern.
+
+struct Hash128_t
+{
+    uint64_t lo;
+    uint64_t hi;
+
+    inline const bool operator==(const Hash128_t& other) const { return lo == other.lo && hi == other.hi; }
+    inline const bool operator!=(const Hash128_t& other) const { return !(*this == other); }
+
+    // 32 hex characters, high half first
+    inline std::string ToString() const { return std::format("{:016x}{:016x}", hi, lo); }
+};
+
+// for using Hash128_t as a key in unordered containers, the hash is already well distributed
+struct Hash128Hasher_t
+{
+    inline size_t operator()(const Hash128_t& hash) const { return static_cast<size_t>(hash.lo ^ hash.hi); }
+};
+
+namespace Hash128
+{
+    namespace detail
+    {
+        inline uint64_t rotl64(const uint64_t x, const int r)
+        {
+            return (x << r) | (x >> (64 - r));
+        }
+
+        inline uint64_t fmix64(uint64_t k)
+        {
+            k ^= k >> 33;
+            k *= 0xff51afd7ed558ccdull;
+            k ^= k >> 33;
+            k *= 0xc4ceb9fe1a85ec53ull;
+            k ^= k >> 33;
+
+            return k;
+        }
+    }
+
+    inline Hash128_t HashBuffer(const void* const data, const size_t size, const uint64_t seed = 0ull)
+    {
+        using namespace detail;
+
+        constexpr uint64_t c1 = 0x87c37b91114253d5ull;
+        constexpr uint64_t c2 = 0x4cf5ad432745937full;
+
+        const uint8_t* const bytes = reinterpret_cast<const uint8_t*>(data);
+        const size_t numBlocks = size / 16;
+
+        uint64_t h1 = seed;
+        uint64_t h2 = seed;
+
+        // body
+        for (size_t i = 0; i < numBlocks; i++)
+        {
+            uint64_t k1, k2;
+            memcpy(&k1, bytes + (i * 16), sizeof(uint64_t));
+            memcpy(&k2, bytes + (i * 16) + 8, sizeof(uint64_t));
+
+            k1 *= c1; k1 = rotl64(k1, 31); k1 *= c2; h1 ^= k1;
+            h1 = rotl64(h1, 27); h1 += h2; h1 = h1 * 5 + 0x52dce729;
+
+            k2 *= c2; k2 = rotl64(k2, 33); k2 *= c1; h2 ^= k2;
+            h2 = rotl64(h2, 31); h2 += h1; h2 = h2 * 5 + 0x38495ab5;
+        }
+
+        // tail
+        const uint8_t* const tail = bytes + (numBlocks * 16);
+
+        uint64_t k1 = 0ull;
+        uint64_t k2 = 0ull;
+
+        switch (size & 15)
+        {
+        case 15: k2 ^= static_cast<uint64_t>(tail[14]) << 48; [[fallthrough]];
+        case 14: k2 ^= static_cast<uint64_t>(tail[13]) << 40; [[fallthrough]];
+        case 13: k2 ^= static_cast<uint64_t>(tail[12]) << 32; [[fallthrough]];
+        case 12: k2 ^= static_cast<uint64_t>(tail[11]) << 24; [[fallthrough]];
+        case 11: k2 ^= static_cast<uint64_t>(tail[10]) << 16; [[fallthrough]];
+        case 10: k2 ^= static_cast<uint64_t>(tail[9]) << 8; [[fallthrough]];
+        case 9:  k2 ^= static_cast<uint64_t>(tail[8]);
+            k2 *= c2; k2 = rotl64(k2, 33); k2 *= c1; h2 ^= k2;
+            [[fallthrough]];
+        case 8:  k1 ^= static_cast<uint64_t>(tail[7]) << 56; [[fallthrough]];
+        case 7:  k1 ^= static_cast<uint64_t>(tail[6]) << 48; [[fallthrough]];
+        case 6:  k1 ^= static_cast<uint64_t>(tail[5]) << 40; [[fallthrough]];
+        case 5:  k1 ^= static_cast<uint64_t>(tail[4]) << 32; [[fallthrough]];
+        case 4:  k1 ^= static_cast<uint64_t>(tail[3]) << 24; [[fallthrough]];
+        case 3:  k1 ^= static_cast<uint64_t>(tail[2]) << 16; [[fallthrough]];
+        case 2:  k1 ^= static_cast<uint64_t>(tail[1]) << 8; [[fallthrough]];
+        case 1:  k1 ^= static_cast<uint64_t>(tail[0]);
+            k1 *= c1; k1 = rotl64(k1, 31); k1 *= c2; h1 ^= k1;
+            break;
+        }
+
+        // finalization
+        h1 ^= static_cast<uint64_t>(size);
+        h2 ^= static_cast<uint64_t>(size);
+
+        h1 += h2;
+        h2 += h1;
+
+        h1 = fmix64(h1);
+        h2 = fmix64(h2);
+
+        h1 += h2;
+        h2 += h1;
+
+        return { h1, h2 };
+    }
+}
@@ -0,0 +1,195 @@
+#include <pch.h>
+#include <core/utils/memtracker.h>
+
+constinit CMemoryTracker g_MemoryTracker;
+
+static thread_local uint32_t s_threadAssetType = 0u;
+
+// start evicting at this fraction of the budget, and keep going until we are back under the target
+static constexpr double s_MemoryBudgetEvictThreshold = 0.9;
+static constexpr double s_MemoryBudgetEvictTarget = 0.75;
+
+// categories are evicted in this order, cheapest to parse again first
+static constexpr eMemoryCategory s_MemoryEvictOrder[] = {
+	eMemoryCategory::MEM_BP_CHUNKS,
+	eMemoryCategory::MEM_ANIM_DATA,
+	eMemoryCategory::MEM_VERTEX_DATA,
+};
+
+namespace MemoryTracker
+{
+	const uint32_t GetThreadAssetType()
+	{
+		return s_threadAssetType;
+	}
+
+	void SetThreadAssetType(const uint32_t assetType)
+	{
+		s_threadAssetType = assetType;
+	}
+
+	std::shared_ptr<char[]> AllocSharedBuffer(const eMemoryCategory category, const size_t size, const bool zeroed)
+	{
+		const uint32_t assetType = s_threadAssetType;
+
+		g_MemoryTracker.Alloc(category, assetType, size);
+
+		return std::shared_ptr<char[]>(zeroed ? new char[size] {} : new char[size], [category, assetType, size](char* const buf)
+			{
+				delete[] buf;
+				g_MemoryTracker.Free(category, assetType, size);
+			});
+	}
+}
+
+MemoryCounter_t* const CMemoryTracker::GetTypeCounter(const uint32_t assetType)
+{
+	if (assetType == 0u)
+		return nullptr;
+
+	// fourccs are already pretty well distributed, mix them a bit anyway
+	uint32_t slot = ((assetType * 0x9E3779B1u) >> 16) & (memoryTypeSlotCount - 1);
+
+	for (uint32_t i = 0; i < memoryTypeSlotCount; ++i)
+	{
+		TypeSlot_t& typeSlot = m_types[slot];
+
+		uint32_t slotType = typeSlot.type.load(std::memory_order_acquire);
+		if (slotType == assetType)
+			return &typeSlot.counter;
+
+		if (slotType == 0u)
+		{
+			// claim the free slot, if another thread beat us to it check what it was claimed for
+			if (typeSlot.type.compare_exchange_strong(slotType, assetType, std::memory_order_acq_rel) || slotType == assetType)
+				return &typeSlot.counter;
+		}
+
+		slot = (slot + 1) & (memoryTypeSlotCount - 1);
+	}
+
+	return nullptr;
+}
+
+void CMemoryTracker::Alloc(const eMemoryCategory category, const uint32_t assetType, const size_t size)
+{
+	const int64_t sizeSigned = static_cast<int64_t>(size);
+
+	m_total.Add(sizeSigned);
+	m_categories[static_cast<uint8_t>(category)].Add(sizeSigned);
+
+	if (MemoryCounter_t* const typeCounter = GetTypeCounter(assetType))
+		typeCounter->Add(sizeSigned);
+}
+
+void CMemoryTracker::Free(const eMemoryCategory category, const uint32_t assetType, const size_t size)
+{
+	const int64_t sizeSigned = static_cast<int64_t>(size);
+
+	m_total.Remove(sizeSigned);
+	m_categories[static_cast<uint8_t>(category)].Remove(sizeSigned);
+
+	if (MemoryCounter_t* const typeCounter = GetTypeCounter(assetType))
+		typeCounter->Remove(sizeSigned);
+}
+
+const MemoryStats_t CMemoryTracker::GetAssetTypeStats(const uint32_t assetType) const
+{
+	for (const TypeSlot_t& typeSlot : m_types)
+	{
+		if (typeSlot.type.load(std::memory_order_acquire) == assetType)
+			return typeSlot.counter.Get();
+	}
+
+	return {};
+}
+
+void CMemoryTracker::GetAllAssetTypeStats(std::vector<std::pair<uint32_t, MemoryStats_t>>& out) const
+{
+	for (const TypeSlot_t& typeSlot : m_types)
+	{
+		const uint32_t type = typeSlot.type.load(std::memory_order_acquire);
+		if (type != 0u)
+			out.emplace_back(type, typeSlot.counter.Get());
+	}
+
+	std::sort(out.begin(), out.end(), [](const std::pair<uint32_t, MemoryStats_t>& a, const std::pair<uint32_t, MemoryStats_t>& b) { return a.second.peak > b.second.peak; });
+}
+
+static inline const double BytesToMiB(const int64_t bytes)
+{
+	return static_cast<double>(bytes) / (1024.0 * 1024.0);
+}
+
+void CMemoryTracker::PrintSummary() const
+{
+	const MemoryStats_t total = GetTotalStats();
+
+	printf("\nMEMORY: %.1f MiB in use, %.1f MiB peak, %llu allocations", BytesToMiB(total.current), BytesToMiB(total.peak), total.numAllocs);
+	if (const size_t budget = GetBudget())
+		printf(" (budget %.1f MiB)", BytesToMiB(static_cast<int64_t>(budget)));
+	printf("\n");
+
+	printf("MEMORY: %-24s %12s %12s %10s\n", "category", "current MiB", "peak MiB", "allocs");
+	for (uint8_t i = 0; i < static_cast<uint8_t>(eMemoryCategory::MEM_COUNT); ++i)
+	{
+		const MemoryStats_t stats = m_categories[i].Get();
+		printf("MEMORY: %-24s %12.1f %12.1f %10llu\n", s_MemoryCategoryNames[i], BytesToMiB(stats.current), BytesToMiB(stats.peak), stats.numAllocs);
+	}
+
+	std::vector<std::pair<uint32_t, MemoryStats_t>> typeStats;
+	GetAllAssetTypeStats(typeStats);
+
+	if (typeStats.empty())
+		return;
+
+	printf("MEMORY: %-24s %12s %12s %10s\n", "asset type", "current MiB", "peak MiB", "allocs");
+	for (const auto& [type, stats] : typeStats)
+	{
+		char typeStr[5] = {};
+		memcpy(typeStr, &type, sizeof(uint32_t));
+
+		printf("MEMORY: %-24s %12.1f %12.1f %10llu\n", typeStr, BytesToMiB(stats.current), BytesToMiB(stats.peak), stats.numAllocs);
+	}
+}
+
+void CMemoryTracker::RegisterEvictor(const eMemoryCategory category, MemoryEvictFunc_t func)
+{
+	m_evictors[static_cast<uint8_t>(category)] = func;
+}
+
+void CMemoryTracker::EnforceBudget()
+{
+	const size_t budget = GetBudget();
+	if (budget == 0ull)
+		return;
+
+	const int64_t threshold = static_cast<int64_t>(static_cast<double>(budget) * s_MemoryBudgetEvictThreshold);
+	if (m_total.current.load(std::memory_order_relaxed) < threshold)
+		return;
+
+	// someone else is already evicting
+	std::unique_lock<std::mutex> lock(m_evictMutex, std::try_to_lock);
+	if (!lock.owns_lock())
+		return;
+
+	const int64_t target = static_cast<int64_t>(static_cast<double>(budget) * s_MemoryBudgetEvictTarget);
+	const int64_t startSize = m_total.current.load(std::memory_order_relaxed);
+
+	for (const eMemoryCategory category : s_MemoryEvictOrder)
+	{
+		const int64_t current = m_total.current.load(std::memory_order_relaxed);
+		if (current <= target)
+			break;
+
+		if (MemoryEvictFunc_t evictFunc = m_evictors[static_cast<uint8_t>(category)])
+			evictFunc(static_cast<size_t>(current - target));
+	}
+
+	const int64_t endSize = m_total.current.load(std::memory_order_relaxed);
+
+	Log("MEMORY: evicted %.1f MiB of cached data (%.1f MiB in use, budget %.1f MiB)\n", BytesToMiB(startSize - endSize), BytesToMiB(endSize), BytesToMiB(static_cast<int64_t>(budget)));
+
+	if (endSize > static_cast<int64_t>(budget))
+		Log("MEMORY: still over budget after evicting everything we could\n");
+}
@@ -0,0 +1,230 @@
+#pragma once
+
+// memory accounting for the big allocations we make while loading and exporting
+// allocations are tagged with a category and (when known) the asset type being loaded/exported on the current thread.
+// counters are lock free atomics and keep a high water mark, a budget can be set so cached parsed data gets evicted
+// before we run the machine out of memory.
+
+enum class eMemoryCategory : uint8_t
+{
+	MEM_FILE_BUFFER,	// raw file reads
+	MEM_PAK_BUFFER,		// decompressed and patched pak file data
+	MEM_PAK_SEGMENTS,	// segment collections holding patched page data
+	MEM_MANAGED_BUFFER,	// CBufferManager scratch buffers
+	MEM_RAMEN,			// CRamen data not covered by another category
+	MEM_VERTEX_DATA,	// parsed model vertex data
+	MEM_ANIM_DATA,		// parsed animation data
+	MEM_BP_CHUNKS,		// decompressed bluepoint pak chunks
+
+	MEM_COUNT,
+};
+
+static const char* s_MemoryCategoryNames[] = {
+	"File Buffers",
+	"Pak Buffers",
+	"Pak Segments",
+	"Managed Buffers",
+	"Ramen",
+	"Vertex Data",
+	"Animation Data",
+	"Bluepoint Chunks",
+};
+static_assert(std::size(s_MemoryCategoryNames) == static_cast<size_t>(eMemoryCategory::MEM_COUNT));
+
+struct MemoryStats_t
+{
+	int64_t current;
+	int64_t peak;
+	uint64_t numAllocs;
+};
+
+struct MemoryCounter_t
+{
+	constexpr MemoryCounter_t() : current(0ll), peak(0ll), numAllocs(0ull) {};
+
+	inline void Add(const int64_t size)
+	{
+		const int64_t newSize = current.fetch_add(size, std::memory_order_relaxed) + size;
+		numAllocs.fetch_add(1ull, std::memory_order_relaxed);
+
+		int64_t oldPeak = peak.load(std::memory_order_relaxed);
+		while (newSize > oldPeak && !peak.compare_exchange_weak(oldPeak, newSize, std::memory_order_relaxed)) {}
+	}
+
+	inline void Remove(const int64_t size)
+	{
+		current.fetch_sub(size, std::memory_order_relaxed);
+	}
+
+	inline const MemoryStats_t Get() const
+	{
+		return { current.load(std::memory_order_relaxed), peak.load(std::memory_order_relaxed), numAllocs.load(std::memory_order_relaxed) };
+	}
+
+	std::atomic<int64_t> current;
+	std::atomic<int64_t> peak;
+	std::atomic<uint64_t> numAllocs;
+};
+
+// frees cached data in a category, returns the number of bytes that were freed
+typedef size_t(*MemoryEvictFunc_t)(const size_t bytesToFree);
+
+static constexpr uint32_t memoryTypeSlotCount = 256; // must be a power of two, there are nowhere near this many asset types
+
+class CMemoryTracker
+{
+public:
+	constexpr CMemoryTracker() : m_budget(0ull), m_evictors{} {};
+
+	void Alloc(const eMemoryCategory category, const uint32_t assetType, const size_t size);
+	void Free(const eMemoryCategory category, const uint32_t assetType, const size_t size);
+
+	// query api
+	inline const MemoryStats_t GetTotalStats() const { return m_total.Get(); }
+	inline const MemoryStats_t GetCategoryStats(const eMemoryCategory category) const { return m_categories[static_cast<uint8_t>(category)].Get(); }
+	const MemoryStats_t GetAssetTypeStats(const uint32_t assetType) const;
+
+	// every asset type that has had memory attributed to it
+	void GetAllAssetTypeStats(std::vector<std::pair<uint32_t, MemoryStats_t>>& out) const;
+
+	// prints the current usage and high water marks by category and asset type to stdout
+	void PrintSummary() const;
+
+	// budget in bytes, 0 to disable
+	inline void SetBudget(const size_t budget) { m_budget.store(budget, std::memory_order_relaxed); }
+	inline const size_t GetBudget() const { return m_budget.load(std::memory_order_relaxed); }
+
+	void RegisterEvictor(const eMemoryCategory category, MemoryEvictFunc_t func);
+
+	// evicts cached data once we are getting close to the budget, safe to call from any thread.
+	// only call this where nothing can be parsing data that an evictor could free.
+	void EnforceBudget();
+
+private:
+	struct TypeSlot_t
+	{
+		std::atomic<uint32_t> type; // 0 while the slot is free
+		MemoryCounter_t counter;
+	};
+
+	MemoryCounter_t* const GetTypeCounter(const uint32_t assetType);
+
+	MemoryCounter_t m_total;
+	MemoryCounter_t m_categories[static_cast<uint8_t>(eMemoryCategory::MEM_COUNT)];
+	TypeSlot_t m_types[memoryTypeSlotCount];
+
+	std::atomic<size_t> m_budget;
+	MemoryEvictFunc_t m_evictors[static_cast<uint8_t>(eMemoryCategory::MEM_COUNT)];
+
+	std::mutex m_evictMutex; // only one thread evicts at a time
+};
+
+extern CMemoryTracker g_MemoryTracker;
+
+namespace MemoryTracker
+{
+	// asset type that allocations on this thread are attributed to
+	const uint32_t GetThreadAssetType();
+	void SetThreadAssetType(const uint32_t assetType);
+
+	// allocates a buffer that is tracked for as long as it lives
+	std::shared_ptr<char[]> AllocSharedBuffer(const eMemoryCategory category, const size_t size, const bool zeroed = false);
+}
+
+// attributes allocations made on this thread to an asset type until the end of the enclosing scope
+class CMemoryTypeScope
+{
+public:
+	CMemoryTypeScope(const uint32_t assetType) : m_prevType(MemoryTracker::GetThreadAssetType())
+	{
+		MemoryTracker::SetThreadAssetType(assetType);
+	}
+
+	~CMemoryTypeScope()
+	{
+		MemoryTracker::SetThreadAssetType(m_prevType);
+	}
+
+	CMemoryTypeScope(const CMemoryTypeScope&) = delete;
+	CMemoryTypeScope& operator=(const CMemoryTypeScope&) = delete;
+
+private:
+	const uint32_t m_prevType;
+};
+
+#define MEMORY_TYPE_SCOPE_CONCAT_(a, b) a##b
+#define MEMORY_TYPE_SCOPE_CONCAT(a, b) MEMORY_TYPE_SCOPE_CONCAT_(a, b)
+#define MEMORY_TYPE_SCOPE(type) const CMemoryTypeScope MEMORY_TYPE_SCOPE_CONCAT(memoryTypeScope_, __LINE__)(static_cast<uint32_t>(type))
+
+// parsed data that can be dropped when over the memory budget, and parsed again the next time it is needed
+class CEvictableData
+{
+public:
+	CEvictableData() : m_numUsers(0u), m_evicted(false) {};
+
+	CEvictableData(const CEvictableData&) = delete;
+	CEvictableData& operator=(const CEvictableData&) = delete;
+
+	// makes sure the data is resident (calling parseFunc if it was evicted), it will not be evicted until Release is called
+	template<typename ParseFunc_t>
+	void Acquire(const ParseFunc_t& parseFunc)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		if (m_evicted)
+		{
+			parseFunc();
+			m_evicted = false;
+		}
+
+		m_numUsers++;
+	}
+
+	inline void Release()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		assert(m_numUsers > 0u); // released without being acquired
+		m_numUsers--;
+	}
+
+	// calls evictFunc if the data is resident and not in use, returns true if the data was evicted
+	template<typename EvictFunc_t>
+	const bool TryEvict(const EvictFunc_t& evictFunc)
+	{
+		std::unique_lock<std::mutex> lock(m_mutex, std::try_to_lock);
+
+		if (!lock.owns_lock() || m_numUsers > 0u || m_evicted)
+			return false;
+
+		evictFunc();
+		m_evicted = true;
+
+		return true;
+	}
+
+	inline const bool IsEvicted() const { return m_evicted; }
+
+private:
+	std::mutex m_mutex;
+	uint32_t m_numUsers;
+	bool m_evicted;
+};
+
+// releases acquired evictable data at the end of the enclosing scope
+class CEvictableDataRef
+{
+public:
+	CEvictableDataRef(CEvictableData* const data) : m_data(data) {};
+	~CEvictableDataRef()
+	{
+		if (m_data)
+			m_data->Release();
+	}
+
+	CEvictableDataRef(const CEvictableDataRef&) = delete;
+	CEvictableDataRef& operator=(const CEvictableDataRef&) = delete;
+
+private:
+	CEvictableData* const m_data;
+};
@@ -0,0 +1,114 @@
+#include <pch.h>
+#include <core/utils/profiler.h>
+
+CProfiler g_Profiler;
+
+static thread_local CTraceThreadBuffer* s_threadTraceBuffer = nullptr;
+
+void CTraceThreadBuffer::NewChunk()
+{
+	std::lock_guard<std::mutex> lock(chunkMutex);
+
+	chunks.emplace_back(new TraceEvent_t[traceEventChunkSize]);
+	numEventsInChunk.store(0u, std::memory_order_release);
+}
+
+void CProfiler::Enable(const std::filesystem::path& tracePath)
+{
+	m_tracePath = tracePath;
+	m_startTime = std::chrono::steady_clock::now();
+
+	m_enabled.store(true, std::memory_order_release);
+}
+
+CTraceThreadBuffer* const CProfiler::GetThreadBuffer()
+{
+	if (!s_threadTraceBuffer)
+	{
+		std::lock_guard<std::mutex> lock(m_bufferMutex);
+
+		const uint32_t threadId = static_cast<uint32_t>(m_buffers.size());
+		s_threadTraceBuffer = m_buffers.emplace_back(std::make_unique<CTraceThreadBuffer>(threadId)).get();
+	}
+
+	return s_threadTraceBuffer;
+}
+
+static void WriteTraceEvent(FILE* const file, const TraceEvent_t& event, const uint32_t threadId, bool& first)
+{
+	// chrome trace timestamps are in microseconds, keep the ns precision as a fraction
+	const double ts = static_cast<double>(event.start) / 1000.0;
+	const double dur = static_cast<double>(event.duration) / 1000.0;
+
+	fprintf(file, first ? "\n" : ",\n");
+	first = false;
+
+	if (event.assetType)
+	{
+		char type[5] = {};
+		memcpy(type, &event.assetType, sizeof(uint32_t));
+
+		// some types are shorter than four characters and padded with null bytes
+		for (int i = 0; i < 4; ++i)
+		{
+			if (type[i] == '\0')
+				type[i] = ' ';
+		}
+
+		fprintf(file, "{\"name\":\"%s (%s)\",\"cat\":\"asset\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":0,\"tid\":%u,\"args\":{\"type\":\"%s\"}}",
+			event.name, type, ts, dur, threadId, type);
+	}
+	else
+	{
+		fprintf(file, "{\"name\":\"%s\",\"cat\":\"rsx\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":0,\"tid\":%u}",
+			event.name, ts, dur, threadId);
+	}
+}
+
+bool CProfiler::Dump()
+{
+	if (!IsEnabled())
+		return false;
+
+	FILE* file = nullptr;
+	if (fopen_s(&file, m_tracePath.string().c_str(), "wb") != 0 || !file)
+	{
+		printf("TRACE: failed to open trace file \"%s\"\n", m_tracePath.string().c_str());
+		return false;
+	}
+
+	size_t numEvents = 0ull;
+	bool first = true;
+
+	fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+
+	std::lock_guard<std::mutex> lock(m_bufferMutex);
+
+	for (const std::unique_ptr<CTraceThreadBuffer>& buffer : m_buffers)
+	{
+		fprintf(file, first ? "\n" : ",\n");
+		first = false;
+
+		fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%u,\"args\":{\"name\":\"thread %u\"}}", buffer->threadId, buffer->threadId);
+
+		std::lock_guard<std::mutex> chunkLock(buffer->chunkMutex);
+
+		for (size_t i = 0; i < buffer->chunks.size(); ++i)
+		{
+			const bool lastChunk = i == buffer->chunks.size() - 1;
+			const uint32_t count = lastChunk ? buffer->numEventsInChunk.load(std::memory_order_acquire) : traceEventChunkSize;
+
+			for (uint32_t e = 0; e < count; ++e)
+				WriteTraceEvent(file, buffer->chunks[i][e], buffer->threadId, first);
+
+			numEvents += count;
+		}
+	}
+
+	fprintf(file, "\n]}\n");
+	fclose(file);
+
+	printf("TRACE: wrote %llu events from %llu threads to \"%s\"\n", numEvents, m_buffers.size(), m_tracePath.string().c_str());
+
+	return true;
+}
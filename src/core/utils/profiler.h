@@ -0,0 +1,107 @@
+#pragma once
+
+// scoped trace zones, dumped as chrome trace json (chrome://tracing or ui.perfetto.dev)
+// each thread records completed zones into its own buffer so recording never takes a lock after the first zone on a thread,
+// while tracing is disabled a zone costs a single relaxed load.
+//
+// zone names must be string literals (or otherwise outlive the trace), only the pointer is stored.
+
+struct TraceEvent_t
+{
+	const char* name;
+	uint32_t assetType; // fourcc, appended to the name when dumped so each type gets its own row in the trace. 0 if none
+	int64_t start; // ns since tracing was enabled
+	int64_t duration; // ns
+};
+
+static constexpr uint32_t traceEventChunkSize = 4096; // events per chunk
+
+class CTraceThreadBuffer
+{
+public:
+	CTraceThreadBuffer(const uint32_t id) : threadId(id), numEventsInChunk(0u) {};
+
+	inline void AddEvent(const TraceEvent_t& event)
+	{
+		const uint32_t idx = numEventsInChunk.load(std::memory_order_relaxed);
+		if (chunks.empty() || idx == traceEventChunkSize)
+		{
+			NewChunk();
+			AddEvent(event);
+			return;
+		}
+
+		chunks.back()[idx] = event;
+		numEventsInChunk.store(idx + 1, std::memory_order_release);
+	}
+
+	const uint32_t threadId;
+
+	std::vector<std::unique_ptr<TraceEvent_t[]>> chunks; // every chunk but the last is full
+	std::atomic<uint32_t> numEventsInChunk; // number of events written to the last chunk
+	std::mutex chunkMutex; // guards chunks, only taken when a chunk is allocated and while dumping
+
+private:
+	void NewChunk();
+};
+
+class CProfiler
+{
+public:
+	CProfiler() : m_enabled(false), m_startTime() {};
+
+	// starts recording zones, events are written to tracePath on Dump
+	void Enable(const std::filesystem::path& tracePath);
+	inline const bool IsEnabled() const { return m_enabled.load(std::memory_order_relaxed); }
+
+	// writes every recorded event to the trace file, threads should be done recording by now
+	bool Dump();
+
+	inline const int64_t GetTime() const
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_startTime).count();
+	}
+
+	CTraceThreadBuffer* const GetThreadBuffer();
+
+private:
+	std::vector<std::unique_ptr<CTraceThreadBuffer>> m_buffers;
+	std::mutex m_bufferMutex; // guards m_buffers
+
+	std::filesystem::path m_tracePath;
+
+	std::atomic<bool> m_enabled;
+	std::chrono::steady_clock::time_point m_startTime;
+};
+
+extern CProfiler g_Profiler;
+
+class CTraceZone
+{
+public:
+	CTraceZone(const char* const name, const uint32_t assetType = 0u) : m_name(name), m_assetType(assetType), m_start(g_Profiler.IsEnabled() ? g_Profiler.GetTime() : -1ll) {};
+	~CTraceZone()
+	{
+		if (m_start < 0ll)
+			return;
+
+		const int64_t end = g_Profiler.GetTime();
+		g_Profiler.GetThreadBuffer()->AddEvent({ m_name, m_assetType, m_start, end - m_start });
+	}
+
+	CTraceZone(const CTraceZone&) = delete;
+	CTraceZone& operator=(const CTraceZone&) = delete;
+
+private:
+	const char* const m_name;
+	const uint32_t m_assetType;
+	const int64_t m_start;
+};
+
+#define TRACE_ZONE_CONCAT_(a, b) a##b
+#define TRACE_ZONE_CONCAT(a, b) TRACE_ZONE_CONCAT_(a, b)
+
+// records the time from here to the end of the enclosing scope
+#define TRACE_ZONE(name) const CTraceZone TRACE_ZONE_CONCAT(traceZone_, __LINE__)(name)
+// same as TRACE_ZONE, but split per asset type in the trace
+#define TRACE_ZONE_TYPE(name, type) const CTraceZone TRACE_ZONE_CONCAT(traceZone_, __LINE__)(name, static_cast<uint32_t>(type))
@@ -29,6 +29,7 @@ const size_t CRamen::addIdx(const size_t index, char* const buf, const size_t bu
 		noodles[index] = new CNoodle(buf, 0ull, bufSize, false);
 
 		noodleSize++;
+		track(bufSize);
 
 		return index;
 	}
@@ -41,6 +42,7 @@ const size_t CRamen::addIdx(const size_t index, char* const buf, const size_t bu
 	noodles[index] = new CNoodle(compBufShrink, compSize, bufSize, true);
 
 	noodleSize++;
+	track(compSize);
 
 	return index;
 }
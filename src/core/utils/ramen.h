@@ -19,14 +19,21 @@ public:
 			}
 		}
 
+		inline const size_t memorySize() const { return isCompressed ? compressedSize : decompressedSize; }
+
 		char* data;
 		size_t compressedSize;
 		size_t decompressedSize;
 		bool isCompressed;
 	};
 
-	inline CRamen() : noodles(nullptr), capacity(0ull), noodleSize(0ull) {};
-	inline CRamen(const size_t size) : noodles(nullptr), capacity(0ull), noodleSize(0ull)
+	inline CRamen() : noodles(nullptr), capacity(0ull), noodleSize(0ull), memCategory(eMemoryCategory::MEM_RAMEN), memAssetType(0u), memSize(0ull) {};
+	inline CRamen(const eMemoryCategory category) : noodles(nullptr), capacity(0ull), noodleSize(0ull), memCategory(category), memAssetType(0u), memSize(0ull) {};
+	inline CRamen(const size_t size) : noodles(nullptr), capacity(0ull), noodleSize(0ull), memCategory(eMemoryCategory::MEM_RAMEN), memAssetType(0u), memSize(0ull)
+	{
+		resize(size);
+	}
+	inline CRamen(const size_t size, const eMemoryCategory category) : noodles(nullptr), capacity(0ull), noodleSize(0ull), memCategory(category), memAssetType(0u), memSize(0ull)
 	{
 		resize(size);
 	}
@@ -48,10 +55,14 @@ public:
 			this->noodles = dataChunks.noodles;
 			this->capacity = dataChunks.capacity;
 			this->noodleSize = dataChunks.noodleSize;
+			this->memCategory = dataChunks.memCategory;
+			this->memAssetType = dataChunks.memAssetType;
+			this->memSize = dataChunks.memSize;
 
 			dataChunks.noodles = nullptr;
 			dataChunks.capacity = 0ull;
 			dataChunks.noodleSize = 0ull;
+			dataChunks.memSize = 0ull;
 		}
 
 		return *this;
@@ -67,10 +78,14 @@ public:
 			this->noodles = raman.noodles;
 			this->capacity = raman.capacity;
 			this->noodleSize = raman.noodleSize;
+			this->memCategory = raman.memCategory;
+			this->memAssetType = raman.memAssetType;
+			this->memSize = raman.memSize;
 
 			raman.noodles = nullptr;
 			raman.capacity = 0ull;
 			raman.noodleSize = 0ull;
+			raman.memSize = 0ull;
 		}
 	}
 
@@ -102,6 +117,7 @@ public:
 			}
 		}
 
+		untrack(memSize);
 		noodleSize = 0;
 	}
 
@@ -126,11 +142,16 @@ public:
 		}
 		else if (newSize < noodleSize) // shrink
 		{
+			size_t freedSize = 0ull;
 			for (size_t i = newSize; i < noodleSize; ++i)
 			{
+				freedSize += noodles[i]->memorySize();
 				delete noodles[i];
 			}
 
+			untrack(freedSize);
+			noodleSize = newSize;
+
 			if (newSize < (capacity / 2ull))
 			{
 				const size_t newCapacity = std::max(newSize, 1ull);
@@ -144,6 +165,12 @@ public:
 		return noodleSize;
 	}
 
+	// bytes held by the noodles
+	inline const size_t memorySize() const
+	{
+		return memSize;
+	}
+
 	inline void shrink()
 	{
 		resize(noodleSize);
@@ -183,7 +210,30 @@ private:
 		noodles = newChunks;
 		capacity = newCapacity;
 	}
+	inline void track(const size_t size)
+	{
+		// attribute everything in this ramen to the asset type it was first filled for
+		if (memSize == 0ull)
+			memAssetType = MemoryTracker::GetThreadAssetType();
+
+		memSize += size;
+		g_MemoryTracker.Alloc(memCategory, memAssetType, size);
+	}
+
+	inline void untrack(const size_t size)
+	{
+		if (size == 0ull)
+			return;
+
+		memSize -= size;
+		g_MemoryTracker.Free(memCategory, memAssetType, size);
+	}
+
 	CNoodle** noodles;
 	size_t capacity;
 	size_t noodleSize;
+
+	eMemoryCategory memCategory;
+	uint32_t memAssetType;
+	size_t memSize;
 };
\ No newline at end of file
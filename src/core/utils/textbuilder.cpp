@@ -0,0 +1,202 @@
+#include <pch.h>
+#include <core/utils/textbuilder.h>
+
+#include <charconv>
+#include <bit>
+#include <emmintrin.h>
+
+void CTextBuilder::Clear(const size_t maxRetained)
+{
+	m_length = 0ull;
+
+	if (m_capacity > maxRetained + 1ull)
+	{
+		m_buffer.reset();
+		m_capacity = 0ull;
+
+		Reserve(std::min(maxRetained, static_cast<size_t>(0x10000)));
+	}
+}
+
+void CTextBuilder::Reserve(const size_t capacity)
+{
+	if (capacity < m_capacity)
+		return;
+
+	std::unique_ptr<char[]> buffer = std::make_unique<char[]>(capacity + 1ull);
+
+	if (m_length)
+		memcpy(buffer.get(), m_buffer.get(), m_length);
+
+	m_buffer = std::move(buffer);
+	m_capacity = capacity + 1ull;
+}
+
+void CTextBuilder::Grow(const size_t required)
+{
+	Reserve(std::max(m_capacity * 2, m_length + required));
+}
+
+void CTextBuilder::AppendInt(const int64_t value)
+{
+	char buf[24];
+	const std::to_chars_result result = std::to_chars(buf, buf + sizeof(buf), value);
+
+	Append(buf, result.ptr - buf);
+}
+
+void CTextBuilder::AppendUInt(const uint64_t value)
+{
+	char buf[24];
+	const std::to_chars_result result = std::to_chars(buf, buf + sizeof(buf), value);
+
+	Append(buf, result.ptr - buf);
+}
+
+void CTextBuilder::AppendHex(const uint64_t value)
+{
+	char buf[24];
+	const std::to_chars_result result = std::to_chars(buf, buf + sizeof(buf), value, 16);
+
+	Append(buf, result.ptr - buf);
+}
+
+void CTextBuilder::AppendFloatFixed(const double value, const int precision)
+{
+	// doubles in fixed notation can be a little over 300 digits before the decimal point
+	char buf[384];
+	const std::to_chars_result result = std::to_chars(buf, buf + sizeof(buf), value, std::chars_format::fixed, precision);
+
+	assertm(result.ec == std::errc(), "float didn't fit in the buffer");
+	Append(buf, result.ptr - buf);
+}
+
+void CTextBuilder::AppendFloatGeneral(const double value, const int precision)
+{
+	char buf[64];
+	const std::to_chars_result result = std::to_chars(buf, buf + sizeof(buf), value, std::chars_format::general, precision);
+
+	assertm(result.ec == std::errc(), "float didn't fit in the buffer");
+	Append(buf, result.ptr - buf);
+}
+
+void CTextBuilder::AppendEscapedKV(const std::string_view str)
+{
+	const char* cur = str.data();
+	const char* const end = str.data() + str.length();
+
+	while (cur < end)
+	{
+		// copy everything up to the next byte that needs escaping in one go
+		const size_t plain = TextEscape_FindKV(cur, end - cur);
+
+		Append(cur, plain);
+		cur += plain;
+
+		if (cur == end)
+			break;
+
+		const char c = *cur++;
+
+		switch (c)
+		{
+		case '\0':
+			break;
+		case '\t':
+			Append("\\t", 2ull);
+			break;
+		case '\n':
+			Append("\\n", 2ull);
+			break;
+		case '\r':
+			Append("\\r", 2ull);
+			break;
+		case '\"':
+			Append("\\\"", 2ull);
+			break;
+		default:
+		{
+			Append("\\x", 2ull);
+			AppendHex(static_cast<uint8_t>(c));
+
+			break;
+		}
+		}
+	}
+}
+
+void CTextBuilder::AppendEscapedJSON(const std::string_view str)
+{
+	static const char* const s_hexDigits = "0123456789abcdef";
+
+	for (const char c : str)
+	{
+		switch (c)
+		{
+		case '\"':
+			Append("\\\"", 2ull);
+			break;
+		case '\\':
+			Append("\\\\", 2ull);
+			break;
+		case '\t':
+			Append("\\t", 2ull);
+			break;
+		case '\n':
+			Append("\\n", 2ull);
+			break;
+		case '\r':
+			Append("\\r", 2ull);
+			break;
+		default:
+		{
+			if (static_cast<uint8_t>(c) < 0x20)
+			{
+				const char escaped[6] = { '\\', 'u', '0', '0', s_hexDigits[static_cast<uint8_t>(c) >> 4], s_hexDigits[c & 0xf] };
+				Append(escaped, sizeof(escaped));
+			}
+			else
+			{
+				Append(c);
+			}
+
+			break;
+		}
+		}
+	}
+}
+
+static inline bool TextEscape_IsKVSpecial(const uint8_t c)
+{
+	return c < 0x20 || c == 0x7f || c == '\"';
+}
+
+size_t TextEscape_FindKV(const char* const str, const size_t length)
+{
+	// sixteen bytes at a time, bytes below 0x20 are found with an unsigned min since sse2 only has signed compares
+	const __m128i quote = _mm_set1_epi8('\"');
+	const __m128i del = _mm_set1_epi8(0x7f);
+	const __m128i control = _mm_set1_epi8(0x1f);
+
+	size_t i = 0ull;
+	for (; i + 16ull <= length; i += 16ull)
+	{
+		const __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(str + i));
+
+		const __m128i isControl = _mm_cmpeq_epi8(_mm_min_epu8(chars, control), chars);
+		const __m128i isSpecial = _mm_or_si128(isControl, _mm_or_si128(_mm_cmpeq_epi8(chars, quote), _mm_cmpeq_epi8(chars, del)));
+
+		const uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(isSpecial));
+
+		if (mask)
+			return i + std::countr_zero(mask);
+	}
+
+	for (; i < length; i++)
+	{
+		if (TextEscape_IsKVSpecial(static_cast<uint8_t>(str[i])))
+			return i;
+	}
+
+	return length;
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+// growable text builder for exporters that assemble a whole file before writing it.
+// clearing keeps the memory block, so a thread_local builder acts as a per thread arena that every asset it writes reuses
+// instead of going back to the allocator for each small append.
+class CTextBuilder
+{
+public:
+	CTextBuilder(const size_t initialCapacity = 0x10000ull) : m_buffer(nullptr), m_length(0ull), m_capacity(0ull)
+	{
+		Reserve(initialCapacity);
+	}
+
+	CTextBuilder(const CTextBuilder&) = delete;
+	CTextBuilder& operator=(const CTextBuilder&) = delete;
+
+	// drop the text but keep the memory, blocks over maxRetained are freed so one huge asset doesn't pin memory forever
+	void Clear(const size_t maxRetained = 0x4000000ull);
+	void Reserve(const size_t capacity);
+
+	inline void Append(const char* const str, const size_t length)
+	{
+		if (m_length + length >= m_capacity)
+			Grow(length);
+
+		memcpy(m_buffer.get() + m_length, str, length);
+		m_length += length;
+	}
+
+	inline void Append(const std::string_view str) { Append(str.data(), str.length()); }
+
+	inline void Append(const char character)
+	{
+		if (m_length + 1ull >= m_capacity)
+			Grow(1ull);
+
+		m_buffer[m_length++] = character;
+	}
+
+	inline void AppendIndentation(const size_t level)
+	{
+		if (m_length + level >= m_capacity)
+			Grow(level);
+
+		memset(m_buffer.get() + m_length, '\t', level);
+		m_length += level;
+	}
+
+	void AppendInt(const int64_t value);
+	void AppendUInt(const uint64_t value);
+	void AppendHex(const uint64_t value); // lowercase, no prefix or padding
+
+	// same output as printf's "%.*f" and "%.*g"
+	void AppendFloatFixed(const double value, const int precision = 6);
+	void AppendFloatGeneral(const double value, const int precision = 6);
+
+	// appends the contents of a quoted keyvalues string. tab, newline, carriage return and quotes get their escapes,
+	// other control characters are written as \x followed by their hex value and nulls are dropped. utf8 passes through.
+	void AppendEscapedKV(const std::string_view str);
+
+	// appends the contents of a quoted json string. quotes and backslashes get escaped, control characters use their short
+	// escapes or \u followed by their hex value. utf8 passes through.
+	void AppendEscapedJSON(const std::string_view str);
+
+	inline char* const Data() { return m_buffer.get(); }
+	inline const char* const Data() const { return m_buffer.get(); }
+	inline const size_t Length() const { return m_length; }
+	inline const std::string_view View() const { return std::string_view(m_buffer.get(), m_length); }
+
+	// null terminated, the terminator isn't part of the length
+	inline const char* const CStr()
+	{
+		m_buffer[m_length] = '\0';
+		return m_buffer.get();
+	}
+
+private:
+	void Grow(const size_t required);
+
+	std::unique_ptr<char[]> m_buffer;
+	size_t m_length;
+	size_t m_capacity; // always leaves room for a null terminator
+};
+
+// offset of the first byte in str that AppendEscapedKV would have to escape (control characters, 0x7f, or a quote), or length if there are none
+size_t TextEscape_FindKV(const char* const str, const size_t length);
@@ -0,0 +1,7 @@
+#include <pch.h>
+#include <thirdparty/imgui/misc/imgui_utility.h>
+
+const uint32_t CThread::GetNestedExportThreadBudget(const uint32_t maxUseful)
+{
+    return std::clamp(GetConCurrentThreads() / std::max(UtilsConfig->exportThreadCount, 1u), 1u, std::max(maxUseful, 1u));
+}
@@ -63,6 +63,10 @@ public:
         return threadCount != 0 ? threadCount : 1; // Even if we have no count, at least 1 thread should exist else this pc wouldn't be running..
     }
 
+    // threads for work inside a single asset export. exports already run one asset per export thread,
+    // so only the cores those threads leave idle are used, capped at maxUseful (e.g. the number of work items)
+    static const uint32_t GetNestedExportThreadBudget(const uint32_t maxUseful);
+
 private:
     std::thread workerThread;
     std::atomic<bool> isDetached;
@@ -145,4 +149,148 @@ private:
             task();
         }
     }
-};
\ No newline at end of file
+};
+
+// calls func(i) for every i in [0, count), spread over up to numThreads threads.
+// items are handed out one at a time from a shared counter so uneven items still balance out, runs inline if there's only one thread to use
+template <typename Function>
+void ParallelFor(const size_t count, const uint32_t numThreads, Function&& func)
+{
+    const uint32_t numTasks = static_cast<uint32_t>(std::min(static_cast<size_t>(numThreads), count));
+
+    if (numTasks <= 1u)
+    {
+        for (size_t i = 0; i < count; ++i)
+            func(i);
+
+        return;
+    }
+
+    std::atomic<size_t> itemIdx = 0ull;
+
+    auto runItems = [&]()
+        {
+            for (size_t i = itemIdx++; i < count; i = itemIdx++)
+                func(i);
+        };
+
+    CParallelTask task(numTasks);
+    task.addTask(runItems, numTasks);
+    task.execute();
+    task.wait();
+}
+
+// worker threads that stay alive between ParallelFor calls, for work that comes in many small batches (e.g. blocks of a stream being encoded)
+// where spawning and joining threads for every batch would cost more than the batch itself. the calling thread works on every batch too
+class CWorkerPool
+{
+public:
+    CWorkerPool(const uint32_t numThreads) : batchFunc(nullptr), batchCount(0ull), batchIdx(0u), numBusy(0u), stopping(false), nextItem(0ull)
+    {
+        for (uint32_t i = 1; i < numThreads; ++i)
+        {
+            threads.emplace_back([this]() { this->workerThread(); });
+        }
+    }
+
+    ~CWorkerPool()
+    {
+        {
+            std::unique_lock<std::mutex> lock(batchMutex);
+            stopping = true;
+        }
+
+        batchStarted.notify_all();
+
+        // joined by CThread
+        threads.clear();
+    }
+
+    CWorkerPool(const CWorkerPool&) = delete;
+    CWorkerPool& operator=(const CWorkerPool&) = delete;
+
+    inline const uint32_t getNumThreads() const { return static_cast<uint32_t>(threads.size()) + 1u; }
+
+    // same as the free ParallelFor, but on this pool's threads
+    template <typename Function>
+    void ParallelFor(const size_t count, Function&& func)
+    {
+        if (threads.empty() || count <= 1ull)
+        {
+            for (size_t i = 0; i < count; ++i)
+                func(i);
+
+            return;
+        }
+
+        const std::function<void(const size_t)> itemFunc = std::ref(func);
+
+        {
+            std::unique_lock<std::mutex> lock(batchMutex);
+
+            batchFunc = &itemFunc;
+            batchCount = count;
+            nextItem = 0ull;
+            numBusy = static_cast<uint32_t>(threads.size());
+            batchIdx++;
+        }
+
+        batchStarted.notify_all();
+
+        runItems(itemFunc, count);
+
+        std::unique_lock<std::mutex> lock(batchMutex);
+        batchFinished.wait(lock, [this]() { return numBusy == 0u; });
+
+        batchFunc = nullptr;
+    }
+
+private:
+    std::vector<CThread> threads;
+
+    std::mutex batchMutex;
+    std::condition_variable batchStarted;
+    std::condition_variable batchFinished;
+
+    const std::function<void(const size_t)>* batchFunc;
+    size_t batchCount;
+    uint32_t batchIdx; // bumped for every batch, so workers can tell a new batch from the one they just finished
+    uint32_t numBusy;
+    bool stopping;
+
+    std::atomic<size_t> nextItem;
+
+    void runItems(const std::function<void(const size_t)>& func, const size_t count)
+    {
+        for (size_t i = nextItem++; i < count; i = nextItem++)
+            func(i);
+    }
+
+    void workerThread()
+    {
+        uint32_t lastBatchIdx = 0u;
+
+        while (true)
+        {
+            const std::function<void(const size_t)>* func = nullptr;
+            size_t count = 0ull;
+            {
+                std::unique_lock<std::mutex> lock(batchMutex);
+                batchStarted.wait(lock, [this, lastBatchIdx]() { return stopping || batchIdx != lastBatchIdx; });
+
+                if (stopping)
+                    break;
+
+                lastBatchIdx = batchIdx;
+                func = batchFunc;
+                count = batchCount;
+            }
+
+            runItems(*func, count);
+
+            std::unique_lock<std::mutex> lock(batchMutex);
+            if (--numBusy == 0u)
+                batchFinished.notify_one();
+        }
+    }
+};
@@ -1,10 +1,106 @@
 #include <pch.h>
 #include <core/utils/utils_general.h>
 
+#include <emmintrin.h>
+
 void WaitForDebugger()
 {
     while (!IsDebuggerPresent())
     {
         Sleep(1000);
     }
-}
\ No newline at end of file
+}
+
+void ByteSwap32Array(void* const data, const size_t count)
+{
+    uint32_t* const values = reinterpret_cast<uint32_t*>(data);
+
+    size_t i = 0ull;
+    for (; i + 4ull <= count; i += 4ull)
+    {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i));
+
+        // swap the bytes in each 16 bit half, then swap the halves (sse2 has no byte shuffle)
+        block = _mm_or_si128(_mm_slli_epi16(block, 8), _mm_srli_epi16(block, 8));
+        block = _mm_shufflehi_epi16(_mm_shufflelo_epi16(block, _MM_SHUFFLE(2, 3, 0, 1)), _MM_SHUFFLE(2, 3, 0, 1));
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(values + i), block);
+    }
+
+    for (; i < count; i++)
+        ISWAP32(values[i]);
+}
+
+void RadixSortByKey64(std::vector<uint64_t>& keys, std::vector<uint32_t>& values)
+{
+    assert(keys.size() == values.size());
+
+    const size_t count = keys.size();
+
+    if (count < 2ull)
+        return;
+
+    constexpr uint32_t digitBits = 11u;
+    constexpr uint64_t digitMask = (1ull << digitBits) - 1ull;
+
+    // not worth clearing the count table for every pass
+    if (count < 64ull)
+    {
+        for (size_t i = 1ull; i < count; i++)
+        {
+            const uint64_t key = keys[i];
+            const uint32_t value = values[i];
+
+            size_t j = i;
+            for (; j > 0ull && keys[j - 1ull] > key; j--)
+            {
+                keys[j] = keys[j - 1ull];
+                values[j] = values[j - 1ull];
+            }
+
+            keys[j] = key;
+            values[j] = value;
+        }
+
+        return;
+    }
+
+    // bits that differ between any two keys, passes over digits without any of them would leave the order as is
+    uint64_t varyingBits = 0ull;
+    for (size_t i = 1ull; i < count; i++)
+        varyingBits |= keys[i] ^ keys[0];
+
+    std::vector<uint64_t> tempKeys(count);
+    std::vector<uint32_t> tempValues(count);
+    std::vector<size_t> offsets(1ull << digitBits);
+
+    for (uint32_t shift = 0u; shift < 64u; shift += digitBits)
+    {
+        if (((varyingBits >> shift) & digitMask) == 0ull)
+            continue;
+
+        std::fill(offsets.begin(), offsets.end(), 0ull);
+
+        for (size_t i = 0ull; i < count; i++)
+            offsets[(keys[i] >> shift) & digitMask]++;
+
+        size_t total = 0ull;
+        for (size_t& offset : offsets)
+        {
+            const size_t digitCount = offset;
+            offset = total;
+            total += digitCount;
+        }
+
+        for (size_t i = 0ull; i < count; i++)
+        {
+            const size_t dst = offsets[(keys[i] >> shift) & digitMask]++;
+
+            tempKeys[dst] = keys[i];
+            tempValues[dst] = values[i];
+        }
+
+        keys.swap(tempKeys);
+        values.swap(tempValues);
+    }
+}
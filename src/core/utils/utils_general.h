@@ -21,6 +21,13 @@
 #define SWAP32(n) (((uint32_t)n & 0xff) << 24 | ((uint32_t)n & 0xff00) << 8 | ((uint32_t)n & 0xff0000) >> 8 | ((uint32_t)n >> 24))
 #define ISWAP32(n) n = SWAP32(n)
 
+// swaps the byte order of count 32 bit values in place, four at a time
+void ByteSwap32Array(void* const data, const size_t count);
+
+// stable sort of values by their 64 bit keys, both vectors are reordered. lsd radix sort with 11 bit digits (the count table
+// stays in l1), digits that are the same in every key are skipped so keys that only use a few bits only take a few passes
+void RadixSortByKey64(std::vector<uint64_t>& keys, std::vector<uint32_t>& values);
+
 inline const char* keepAfterLastSlashOrBackslash(const char* src)
 {
 	const char* lastSlash = strrchr(src, '/');
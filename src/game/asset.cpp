@@ -25,6 +25,8 @@ static std::vector<uint32_t> postLoadOrder =
 
 void CGlobalAssetData::ProcessAssetsPostLoad()
 {
+    TRACE_ZONE("CGlobalAssetData::ProcessAssetsPostLoad");
+
     this->m_donePostLoad = false;
 
     struct TypeRange_t
@@ -88,6 +90,9 @@ void CGlobalAssetData::ProcessAssetsPostLoad()
                             continue;
 
                         AssetLookup_t* const pAssetLookup = &this->v_assets[assetToProcess];
+                        TRACE_ZONE_TYPE("PostLoad", range.type);
+                        MEMORY_TYPE_SCOPE(range.type);
+
                         // temp
                         it->second.postLoadFunc(pAssetLookup->m_asset->GetContainerFile<CAssetContainer>(), pAssetLookup->m_asset);
                         pAssetLookup->m_asset->SetPostLoadStatus(true);
@@ -121,6 +126,9 @@ void CGlobalAssetData::ProcessAssetsPostLoad()
                     AssetLookup_t* const pAssetLookup = &this->v_assets[assetToProcess];
                     if (auto it = m_assetTypeBindings.find(pAssetLookup->m_asset->GetAssetType()); it != m_assetTypeBindings.end() && it->second.postLoadFunc)
                     {
+                        TRACE_ZONE_TYPE("PostLoad", it->first);
+                        MEMORY_TYPE_SCOPE(it->first);
+
                         //it->second.postLoadFunc(pAssetLookup->m_asset->pak(), pAssetLookup->m_asset);
                         // temp
                         it->second.postLoadFunc(pAssetLookup->m_asset->GetContainerFile<CAssetContainer>(), pAssetLookup->m_asset);
@@ -136,6 +144,8 @@ void CGlobalAssetData::ProcessAssetsPostLoad()
 
         this->m_donePostLoad = true; // Record that we've finished post-load so that ODL paks can handle their own post-loading later on
     }
+
+    g_MemoryTracker.EnforceBudget();
 }
 
 CGlobalAssetData g_assetData;
\ No newline at end of file
@@ -7,6 +7,7 @@
 #include <filesystem>
 #include <iomanip>
 #include <time.h>
+#include <core/logging/logbuffer.h>
 
 extern ExportSettings_t g_ExportSettings;
 
@@ -244,43 +245,6 @@ struct AssetVersion_t
 	}
 };
 
-static const char* s_LogLevelNames[] = {
-	"INFO",
-	"WARNING",
-	"ERROR",
-};
-
-static uint32_t s_LogLevelColours[] = {
-	0xFFFFFFFF,
-	0xFFFF00FF,
-	0xFF0000FF,
-};
-
-struct ContainerMessage_t
-{
-	enum class MessageType_e : int8_t
-	{
-		MSG_INVALID = -1,
-		MSG_INFO = 0,
-		MSG_WARNING,
-		MSG_ERROR,
-	};
-
-	ContainerMessage_t(MessageType_e _type, const char* _sourceName, const char* _message) : type(_type), sourceName(_sourceName), message(_message) {};
-
-	~ContainerMessage_t()
-	{
-		free((void*)timestampStr);
-		free((void*)sourceName);
-		free((void*)message);
-	}
-
-	const char* timestampStr;
-	const char* sourceName;
-	const char* message;
-	MessageType_e type;
-};
-
 class CAssetContainer;
 
 class CAsset
@@ -409,6 +373,7 @@ public:
 	void SetFilePath(const std::filesystem::path& filePath)
 	{
 		m_filePath = filePath;
+		m_fileName = filePath.filename().string();
 	}
 
 	const std::filesystem::path& GetFilePath() const
@@ -416,8 +381,15 @@ public:
 		return m_filePath;
 	}
 
+	// cached so logging doesn't have to build a new string every time
+	const std::string& GetFileName() const
+	{
+		return m_fileName;
+	}
+
 private:
 	std::filesystem::path m_filePath;
+	std::string m_fileName;
 
 };
 
@@ -475,9 +447,6 @@ public:
 
 	CAssetContainer* m_pakPatchMaster;
 
-	ContainerMessage_t* m_logMessages;
-	uint32_t m_numLogMessages;
-
 	bool m_donePostLoad;
 
 	void AddAssetPostLoadCallback(uint64_t guid, AssetLoadCallback_t callback)
@@ -536,116 +505,43 @@ public:
 
 
 
-#define GET_LOG_MSG_VARIADIC(args, returnVar, fmt) std::vector<char> buf(1+std::vsnprintf(NULL, 0, fmt, args)); \
-											   va_list args2; \
-                                               va_copy(args2, args); \
-											   va_end(args); \
-											   std::vsnprintf(buf.data(), buf.size(), fmt, args2); \
-											   va_end(args2); \
-											   returnVar = std::string(buf.begin(), buf.end())
 	// Logging functions
 	void Log_Info(const CAssetContainer* const container, const char* fmt, ...)
 	{
 		va_list args;
 		va_start(args, fmt);
-
-		std::string msg;
-		GET_LOG_MSG_VARIADIC(args, msg, fmt);
-
-		const std::string sourceName = container ? container->GetFilePath().filename().string() : "N/A";
-
-		Log("[%s] %s\n", sourceName.c_str(), msg.c_str());
-		LogMessages_Append(ContainerMessage_t::MessageType_e::MSG_INFO, sourceName, msg);
+		Log_Write(eLogSeverity::LOG_SEV_INFO, container, 0ull, 0u, fmt, args);
+		va_end(args);
 	}
 
 	void Log_Warning(const CAssetContainer* const container, const char* fmt, ...)
 	{
 		va_list args;
-
 		va_start(args, fmt);
-		
-		std::string msg;
-		GET_LOG_MSG_VARIADIC(args, msg, fmt);
-
-		const std::string sourceName = container ? container->GetFilePath().filename().string() : "N/A";
-
-		Log("WARNING [%s]: %s\n", sourceName.c_str(), msg.c_str());
-
-		LogMessages_Append(ContainerMessage_t::MessageType_e::MSG_WARNING, sourceName, msg);
+		Log_Write(eLogSeverity::LOG_SEV_WARNING, container, 0ull, 0u, fmt, args);
+		va_end(args);
 	}
 
 	void Log_Error(const CAssetContainer* const container, const char* fmt, ...)
 	{
 		va_list args;
 		va_start(args, fmt);
-
-		std::string msg;
-		GET_LOG_MSG_VARIADIC(args, msg, fmt);
-
-		const std::string sourceName = container ? container->GetFilePath().filename().string() : "N/A";
-
-		Log("ERROR [%s]: %s\n", sourceName.c_str(), msg.c_str());
-
-		LogMessages_Append(ContainerMessage_t::MessageType_e::MSG_ERROR, sourceName, msg);
-	}
-
-	const ContainerMessage_t* GetLogMessages() const
-	{
-		return m_logMessages;
+		Log_Write(eLogSeverity::LOG_SEV_ERROR, container, 0ull, 0u, fmt, args);
+		va_end(args);
 	}
 
-	const uint32_t GetNumLogMessages() const
+	// for messages about a specific asset, code is message specific (e.g. the unsupported asset version)
+	void Log_Asset(const eLogSeverity severity, const CAssetContainer* const container, const uint64_t assetGuid, const uint32_t code, const char* fmt, ...)
 	{
-		return m_numLogMessages;
-	}
-
-	void LogMessages_Append(ContainerMessage_t::MessageType_e type, const std::string& sourceName, const std::string& msg)
-	{
-		// If there's no log messages ptr, try and allocate a placeholder so we can write something into the array
-		if (!m_logMessages)
-			m_logMessages = reinterpret_cast<ContainerMessage_t*>(calloc(0, sizeof(ContainerMessage_t)));
-
-		// If there's still no log messages ptr just return since logs are not critical
-		if (!m_logMessages)
-			return;
-
-		m_logMessages = reinterpret_cast<ContainerMessage_t*>(realloc(m_logMessages, sizeof(ContainerMessage_t) * (m_numLogMessages + 1)));
-
-		const time_t t = std::time(nullptr);
-		tm tm;
-		if (localtime_s(&tm, &t))
-		{
-			assertm(0, "failed to get time");
-			return;
-		}
-
-		std::ostringstream oss;
-		oss << std::put_time(&tm, "%H:%M:%S");
-
-		ContainerMessage_t* m = &m_logMessages[m_numLogMessages];
-		m->type = type;
-		m->timestampStr = _strdup(oss.str().c_str());
-		m->message = _strdup(msg.c_str());
-		m->sourceName = _strdup(sourceName.c_str());
-
-		m_numLogMessages++;
+		va_list args;
+		va_start(args, fmt);
+		Log_Write(severity, container, assetGuid, code, fmt, args);
+		va_end(args);
 	}
 
-	void FreeLogMessages()
+	void Log_Write(const eLogSeverity severity, const CAssetContainer* const container, const uint64_t assetGuid, const uint32_t code, const char* fmt, va_list args)
 	{
-		if (m_logMessages && m_numLogMessages > 0)
-		{
-			for (uint32_t i = 0; i < m_numLogMessages; ++i)
-			{
-				free((void*)m_logMessages->message);
-				free((void*)m_logMessages->message);
-			}
-
-			free(m_logMessages);
-
-			m_numLogMessages = 0;
-			m_logMessages = nullptr;
-		}
+		g_Logger.Write(severity, container ? container->GetFileName().c_str() : "N/A", assetGuid, code, fmt, args);
 	}
 };
 
@@ -0,0 +1,1301 @@
+#include <pch.h>
+#include <game/audio/flacfile.h>
+
+struct FlacCompressionLevel_t
+{
+	uint8_t maxLpcOrder; // 0 to only use fixed predictors
+	uint8_t qlpPrecision;
+	uint8_t maxPartitionOrder;
+	bool stereoDecorrelation; // try left/side, right/side and mid/side
+	bool exhaustiveLpcOrder; // try every lpc order instead of picking one from the prediction error
+};
+
+static const FlacCompressionLevel_t s_FlacCompressionLevels[flacMaxCompressionLevel + 1] =
+{
+	{ 0,  0,  3, false, false },
+	{ 0,  0,  3, true,  false },
+	{ 0,  0,  4, true,  false },
+	{ 6,  12, 4, false, false },
+	{ 8,  12, 4, true,  false },
+	{ 8,  12, 5, true,  false },
+	{ 8,  13, 6, true,  false },
+	{ 12, 14, 6, true,  false },
+	{ 12, 15, 8, true,  true  },
+};
+
+//
+// BIT WRITING
+//
+class CFlacBitWriter
+{
+public:
+	CFlacBitWriter(std::vector<uint8_t>* const out) : m_out(out), m_accum(0ull), m_numBits(0u) {};
+
+	// bits must be 32 or less
+	inline void Write(const uint32_t value, const uint32_t bits)
+	{
+		if (bits == 0u)
+			return;
+
+		const uint64_t mask = (1ull << bits) - 1ull;
+
+		m_accum = (m_accum << bits) | (value & mask);
+		m_numBits += bits;
+
+		while (m_numBits >= 8u)
+		{
+			m_numBits -= 8u;
+			m_out->push_back(static_cast<uint8_t>(m_accum >> m_numBits));
+		}
+	}
+
+	inline void WriteSigned(const int32_t value, const uint32_t bits)
+	{
+		Write(static_cast<uint32_t>(value), bits);
+	}
+
+	inline void WriteRice(const uint32_t value, const uint32_t param)
+	{
+		uint32_t quotient = value >> param;
+
+		// unary coded quotient, zeros terminated by a one
+		while (quotient >= 32u)
+		{
+			Write(0u, 32u);
+			quotient -= 32u;
+		}
+
+		Write(1u, quotient + 1u);
+		Write(value, param);
+	}
+
+	// frame numbers are coded like utf-8 characters
+	inline void WriteUTF8(const uint64_t value)
+	{
+		if (value < 0x80ull)
+		{
+			Write(static_cast<uint32_t>(value), 8u);
+			return;
+		}
+
+		uint32_t numBytes = 2u;
+		while (numBytes < 7u && value >= (1ull << (5u * numBytes + 1u)))
+			numBytes++;
+
+		const uint32_t leadBits = 7u - numBytes;
+		const uint32_t leadMask = (0xFFu << (8u - numBytes)) & 0xFFu;
+
+		Write(leadMask | static_cast<uint32_t>(value >> (6u * (numBytes - 1u))) & ((1u << leadBits) - 1u), 8u);
+
+		for (uint32_t i = numBytes - 1u; i > 0u; --i)
+			Write(0x80u | static_cast<uint32_t>((value >> (6u * (i - 1u))) & 0x3Fu), 8u);
+	}
+
+	inline void AlignToByte()
+	{
+		if (m_numBits)
+			Write(0u, 8u - m_numBits);
+	}
+
+private:
+	std::vector<uint8_t>* const m_out;
+
+	uint64_t m_accum;
+	uint32_t m_numBits;
+};
+
+//
+// CRC
+//
+struct FlacCRCTables_t
+{
+	FlacCRCTables_t()
+	{
+		for (uint32_t i = 0; i < 256u; ++i)
+		{
+			uint8_t crc8 = static_cast<uint8_t>(i);
+			for (int bit = 0; bit < 8; ++bit)
+				crc8 = (crc8 & 0x80u) ? static_cast<uint8_t>((crc8 << 1) ^ 0x07u) : static_cast<uint8_t>(crc8 << 1);
+
+			uint16_t crc16 = static_cast<uint16_t>(i << 8);
+			for (int bit = 0; bit < 8; ++bit)
+				crc16 = (crc16 & 0x8000u) ? static_cast<uint16_t>((crc16 << 1) ^ 0x8005u) : static_cast<uint16_t>(crc16 << 1);
+
+			table8[i] = crc8;
+			table16[i] = crc16;
+		}
+	}
+
+	uint8_t table8[256];
+	uint16_t table16[256];
+};
+
+static const FlacCRCTables_t s_FlacCRCTables;
+
+static uint8_t FlacCRC8(const uint8_t* const data, const size_t size)
+{
+	uint8_t crc = 0u;
+	for (size_t i = 0; i < size; ++i)
+		crc = s_FlacCRCTables.table8[crc ^ data[i]];
+
+	return crc;
+}
+
+static uint16_t FlacCRC16(const uint8_t* const data, const size_t size)
+{
+	uint16_t crc = 0u;
+	for (size_t i = 0; i < size; ++i)
+		crc = static_cast<uint16_t>((crc << 8) ^ s_FlacCRCTables.table16[(crc >> 8) ^ data[i]]);
+
+	return crc;
+}
+
+//
+// RESIDUAL CODING
+//
+static inline uint32_t FlacZigZag(const int32_t value)
+{
+	return (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31);
+}
+
+// picks the partition order and rice parameters with the smallest estimated size, returns the size in bits
+static uint64_t FlacChooseRiceParams(FlacSubframe_t& subframe, const uint32_t blockSize, const uint32_t maxPartitionOrder)
+{
+	const uint32_t predOrder = subframe.order;
+	const int32_t* const residual = subframe.residual.data();
+
+	// finest partition order that works for this block, every partition has to hold at least one residual
+	uint32_t maxOrder = 0u;
+	while (maxOrder < maxPartitionOrder && (blockSize % (1u << (maxOrder + 1u))) == 0u && (blockSize >> (maxOrder + 1u)) > predOrder)
+		maxOrder++;
+
+	// sums of the zigzagged residuals for each partition at the finest order, coarser orders are merged from these
+	uint64_t sums[1u << flacMaxPartitionOrder] = {};
+	{
+		const uint32_t numPartitions = 1u << maxOrder;
+		const uint32_t partitionSize = blockSize >> maxOrder;
+
+		uint32_t sample = predOrder;
+		for (uint32_t partition = 0; partition < numPartitions; ++partition)
+		{
+			const uint32_t end = (partition + 1u) * partitionSize;
+
+			uint64_t sum = 0ull;
+			for (; sample < end; ++sample)
+				sum += FlacZigZag(residual[sample - predOrder]);
+
+			sums[partition] = sum;
+		}
+	}
+
+	uint64_t bestBits = UINT64_MAX;
+
+	for (int order = static_cast<int>(maxOrder); order >= 0; --order)
+	{
+		const uint32_t numPartitions = 1u << order;
+		const uint32_t partitionSize = blockSize >> order;
+
+		uint8_t params[1u << flacMaxPartitionOrder];
+		uint64_t bits = 0ull;
+		bool needsRice2 = false;
+
+		for (uint32_t partition = 0; partition < numPartitions; ++partition)
+		{
+			const uint64_t sum = sums[partition];
+			const uint64_t count = partition == 0u ? partitionSize - predOrder : partitionSize;
+
+			// best parameter is around log2 of the mean, try either side of it
+			uint32_t param = 0u;
+			if (count && sum > count)
+			{
+				const uint64_t mean = sum / count;
+				param = static_cast<uint32_t>(std::bit_width(mean)) - 1u;
+			}
+
+			uint64_t bestPartitionBits = UINT64_MAX;
+			uint32_t bestParam = 0u;
+			for (uint32_t candidate = param > 0u ? param - 1u : 0u; candidate <= std::min(param + 1u, 30u); ++candidate)
+			{
+				const uint64_t partitionBits = (count * (candidate + 1ull)) + (sum >> candidate);
+				if (partitionBits < bestPartitionBits)
+				{
+					bestPartitionBits = partitionBits;
+					bestParam = candidate;
+				}
+			}
+
+			params[partition] = static_cast<uint8_t>(bestParam);
+			bits += bestPartitionBits;
+
+			if (bestParam > 14u)
+				needsRice2 = true;
+		}
+
+		bits += 6ull + (numPartitions * (needsRice2 ? 5ull : 4ull));
+
+		if (bits < bestBits)
+		{
+			bestBits = bits;
+			subframe.partitionOrder = static_cast<uint8_t>(order);
+			memcpy(subframe.riceParams, params, numPartitions);
+		}
+
+		// merge pairs of partitions for the next order
+		if (order > 0)
+		{
+			for (uint32_t partition = 0; partition < (numPartitions >> 1u); ++partition)
+				sums[partition] = sums[partition * 2u] + sums[(partition * 2u) + 1u];
+		}
+	}
+
+	return bestBits;
+}
+
+static void FlacWriteResidual(CFlacBitWriter& writer, const FlacSubframe_t& subframe, const uint32_t blockSize)
+{
+	const uint32_t numPartitions = 1u << subframe.partitionOrder;
+	const uint32_t partitionSize = blockSize >> subframe.partitionOrder;
+
+	bool isRice2 = false;
+	for (uint32_t partition = 0; partition < numPartitions; ++partition)
+		isRice2 |= subframe.riceParams[partition] > 14u;
+
+	writer.Write(isRice2 ? 1u : 0u, 2u);
+	writer.Write(subframe.partitionOrder, 4u);
+
+	const int32_t* residual = subframe.residual.data();
+
+	for (uint32_t partition = 0; partition < numPartitions; ++partition)
+	{
+		const uint32_t param = subframe.riceParams[partition];
+		const uint32_t count = partition == 0u ? partitionSize - subframe.order : partitionSize;
+
+		writer.Write(param, isRice2 ? 5u : 4u);
+
+		for (uint32_t i = 0; i < count; ++i)
+			writer.WriteRice(FlacZigZag(residual[i]), param);
+
+		residual += count;
+	}
+}
+
+//
+// PREDICTION
+//
+static void FlacFixedResidual(const int32_t* const samples, const uint32_t blockSize, const uint32_t order, int32_t* const residual)
+{
+	for (uint32_t i = order; i < blockSize; ++i)
+	{
+		const int64_t x0 = samples[i];
+
+		int64_t r = x0;
+		switch (order)
+		{
+		case 1:
+			r = x0 - samples[i - 1];
+			break;
+		case 2:
+			r = x0 - (2ll * samples[i - 1]) + samples[i - 2];
+			break;
+		case 3:
+			r = x0 - (3ll * samples[i - 1]) + (3ll * samples[i - 2]) - samples[i - 3];
+			break;
+		case 4:
+			r = x0 - (4ll * samples[i - 1]) + (6ll * samples[i - 2]) - (4ll * samples[i - 3]) + samples[i - 4];
+			break;
+		}
+
+		residual[i - order] = static_cast<int32_t>(r);
+	}
+}
+
+// returns false if the residual doesn't fit in 32 bits
+static bool FlacLpcResidual(const int32_t* const samples, const uint32_t blockSize, const FlacSubframe_t& subframe, int32_t* const residual)
+{
+	const uint32_t order = subframe.order;
+
+	for (uint32_t i = order; i < blockSize; ++i)
+	{
+		int64_t prediction = 0ll;
+		for (uint32_t j = 0; j < order; ++j)
+			prediction += static_cast<int64_t>(subframe.qlpCoeffs[j]) * samples[i - j - 1];
+
+		const int64_t r = static_cast<int64_t>(samples[i]) - (prediction >> subframe.qlpShift);
+		if (r > INT32_MAX || r < INT32_MIN)
+			return false;
+
+		residual[i - order] = static_cast<int32_t>(r);
+	}
+
+	return true;
+}
+
+// quantises lpc coefficients to the given precision, returns false if they can't be represented
+static bool FlacQuantiseLpc(const double* const lpc, const uint32_t order, const uint32_t precision, FlacSubframe_t& subframe)
+{
+	double cmax = 0.0;
+	for (uint32_t i = 0; i < order; ++i)
+		cmax = std::max(cmax, std::abs(lpc[i]));
+
+	if (cmax <= 0.0)
+		return false;
+
+	const int32_t qmax = (1 << (precision - 1u)) - 1;
+	const int32_t qmin = -(1 << (precision - 1u));
+
+	int log2cmax = 0;
+	std::frexp(cmax, &log2cmax);
+	log2cmax--;
+
+	int shift = static_cast<int>(precision) - log2cmax - 2;
+	if (shift > 15)
+		shift = 15;
+	else if (shift < 0)
+		return false; // negative shifts are not allowed
+
+	// carry the rounding error over to the next coefficient
+	double error = 0.0;
+	for (uint32_t i = 0; i < order; ++i)
+	{
+		error += lpc[i] * static_cast<double>(1 << shift);
+
+		const int32_t q = std::clamp(static_cast<int32_t>(std::lround(error)), qmin, qmax);
+		error -= q;
+
+		subframe.qlpCoeffs[i] = q;
+	}
+
+	subframe.qlpPrecision = static_cast<uint8_t>(precision);
+	subframe.qlpShift = static_cast<int8_t>(shift);
+
+	return true;
+}
+
+// scratch for one encoding thread
+struct FlacEncodeScratch_t
+{
+	FlacSubframe_t candidates[4]; // one per possible channel (left/right/mid/side)
+	FlacSubframe_t trial;
+
+	std::vector<int32_t> mid;
+	std::vector<int32_t> side;
+
+	std::vector<double> windowed;
+};
+
+// picks the cheapest way to code a channel, the result is left in subframe
+static void FlacAnalyseSubframe(const int32_t* const samples, const uint32_t blockSize, const uint32_t bitsPerSample, const FlacCompressionLevel_t& level, FlacSubframe_t& subframe, FlacSubframe_t& trial, std::vector<double>& windowed)
+{
+	subframe.residual.resize(blockSize);
+	trial.residual.resize(blockSize);
+
+	// constant
+	bool isConstant = true;
+	for (uint32_t i = 1; i < blockSize; ++i)
+	{
+		if (samples[i] != samples[0])
+		{
+			isConstant = false;
+			break;
+		}
+	}
+
+	if (isConstant)
+	{
+		subframe.type = FlacSubframe_t::CONSTANT;
+		subframe.order = 0u;
+		subframe.bits = bitsPerSample;
+		return;
+	}
+
+	// verbatim is the worst case
+	subframe.type = FlacSubframe_t::VERBATIM;
+	subframe.order = 0u;
+	subframe.bits = static_cast<uint64_t>(blockSize) * bitsPerSample;
+
+	// fixed predictors
+	const uint32_t maxFixedOrder = std::min(4u, blockSize - 1u);
+	for (uint32_t order = 0; order <= maxFixedOrder; ++order)
+	{
+		trial.type = FlacSubframe_t::FIXED;
+		trial.order = static_cast<uint8_t>(order);
+
+		FlacFixedResidual(samples, blockSize, order, trial.residual.data());
+		trial.bits = (static_cast<uint64_t>(order) * bitsPerSample) + FlacChooseRiceParams(trial, blockSize, level.maxPartitionOrder);
+
+		if (trial.bits < subframe.bits)
+			std::swap(subframe, trial);
+	}
+
+	// linear prediction
+	const uint32_t maxLpcOrder = std::min(static_cast<uint32_t>(level.maxLpcOrder), blockSize - 1u);
+	if (maxLpcOrder == 0u)
+		return;
+
+	// tukey(0.5) window
+	windowed.resize(blockSize);
+	{
+		const uint32_t taper = blockSize / 4u;
+		for (uint32_t i = 0; i < blockSize; ++i)
+		{
+			double w = 1.0;
+			if (taper > 0u && i < taper)
+				w = 0.5 - (0.5 * std::cos(M_PI * static_cast<double>(i) / static_cast<double>(taper)));
+			else if (taper > 0u && i >= blockSize - taper)
+				w = 0.5 - (0.5 * std::cos(M_PI * static_cast<double>(blockSize - 1u - i) / static_cast<double>(taper)));
+
+			windowed[i] = static_cast<double>(samples[i]) * w;
+		}
+	}
+
+	double autoc[flacMaxLpcOrder + 1] = {};
+	for (uint32_t lag = 0; lag <= maxLpcOrder; ++lag)
+	{
+		double sum = 0.0;
+		for (uint32_t i = lag; i < blockSize; ++i)
+			sum += windowed[i] * windowed[i - lag];
+
+		autoc[lag] = sum;
+	}
+
+	if (autoc[0] <= 0.0)
+		return;
+
+	// levinson-durbin, coefficients for every order up to the max
+	double lpc[flacMaxLpcOrder][flacMaxLpcOrder] = {};
+	double error[flacMaxLpcOrder] = {};
+	{
+		double current[flacMaxLpcOrder] = {};
+		double err = autoc[0];
+
+		for (uint32_t i = 0; i < maxLpcOrder; ++i)
+		{
+			double r = -autoc[i + 1];
+			for (uint32_t j = 0; j < i; ++j)
+				r -= current[j] * autoc[i - j];
+
+			r /= err;
+
+			current[i] = r;
+			for (uint32_t j = 0; j < (i >> 1); ++j)
+			{
+				const double tmp = current[j];
+				current[j] += r * current[i - 1 - j];
+				current[i - 1 - j] += r * tmp;
+			}
+
+			if (i & 1)
+				current[i >> 1] += current[i >> 1] * r;
+
+			err *= (1.0 - (r * r));
+
+			// predictor coefficients are the negated reflection form
+			for (uint32_t j = 0; j <= i; ++j)
+				lpc[i][j] = -current[j];
+
+			error[i] = err;
+		}
+	}
+
+	uint32_t firstOrder = 1u;
+	uint32_t lastOrder = maxLpcOrder;
+
+	if (!level.exhaustiveLpcOrder)
+	{
+		// estimate the size of each order from its prediction error and only try the best one
+		const double errorScale = 0.5 / static_cast<double>(blockSize);
+
+		double bestBits = std::numeric_limits<double>::max();
+		uint32_t bestOrder = 1u;
+		for (uint32_t order = 1; order <= maxLpcOrder; ++order)
+		{
+			const double scaledError = error[order - 1] * errorScale;
+			const double bitsPerResidual = scaledError > 0.0 ? std::max(0.0, 0.5 * std::log2(scaledError)) : 0.0;
+			const double bits = (bitsPerResidual * static_cast<double>(blockSize - order)) + (static_cast<double>(order) * (level.qlpPrecision + bitsPerSample));
+
+			if (bits < bestBits)
+			{
+				bestBits = bits;
+				bestOrder = order;
+			}
+		}
+
+		firstOrder = bestOrder;
+		lastOrder = bestOrder;
+	}
+
+	for (uint32_t order = firstOrder; order <= lastOrder; ++order)
+	{
+		trial.type = FlacSubframe_t::LPC;
+		trial.order = static_cast<uint8_t>(order);
+
+		if (!FlacQuantiseLpc(lpc[order - 1], order, level.qlpPrecision, trial))
+			continue;
+
+		if (!FlacLpcResidual(samples, blockSize, trial, trial.residual.data()))
+			continue;
+
+		trial.bits = (static_cast<uint64_t>(order) * (bitsPerSample + level.qlpPrecision)) + 9ull + FlacChooseRiceParams(trial, blockSize, level.maxPartitionOrder);
+
+		if (trial.bits < subframe.bits)
+			std::swap(subframe, trial);
+	}
+}
+
+static void FlacWriteSubframe(CFlacBitWriter& writer, const int32_t* const samples, const uint32_t blockSize, const uint32_t bitsPerSample, const FlacSubframe_t& subframe)
+{
+	// zero pad bit, type, no wasted bits
+	switch (subframe.type)
+	{
+	case FlacSubframe_t::CONSTANT:
+	{
+		writer.Write(0x00u, 8u);
+		writer.WriteSigned(samples[0], bitsPerSample);
+
+		break;
+	}
+	case FlacSubframe_t::VERBATIM:
+	{
+		writer.Write(0x02u, 8u);
+
+		for (uint32_t i = 0; i < blockSize; ++i)
+			writer.WriteSigned(samples[i], bitsPerSample);
+
+		break;
+	}
+	case FlacSubframe_t::FIXED:
+	{
+		writer.Write((0x08u | subframe.order) << 1u, 8u);
+
+		for (uint32_t i = 0; i < subframe.order; ++i)
+			writer.WriteSigned(samples[i], bitsPerSample);
+
+		FlacWriteResidual(writer, subframe, blockSize);
+
+		break;
+	}
+	case FlacSubframe_t::LPC:
+	{
+		writer.Write((0x20u | (subframe.order - 1u)) << 1u, 8u);
+
+		for (uint32_t i = 0; i < subframe.order; ++i)
+			writer.WriteSigned(samples[i], bitsPerSample);
+
+		writer.Write(subframe.qlpPrecision - 1u, 4u);
+		writer.WriteSigned(subframe.qlpShift, 5u);
+
+		for (uint32_t i = 0; i < subframe.order; ++i)
+			writer.WriteSigned(subframe.qlpCoeffs[i], subframe.qlpPrecision);
+
+		FlacWriteResidual(writer, subframe, blockSize);
+
+		break;
+	}
+	}
+}
+
+enum eFlacChannelAssignment : uint32_t
+{
+	FLAC_CHANNELS_INDEPENDENT = 0, // + number of channels - 1
+	FLAC_CHANNELS_LEFT_SIDE = 8,
+	FLAC_CHANNELS_RIGHT_SIDE = 9,
+	FLAC_CHANNELS_MID_SIDE = 10,
+};
+
+// encodes one block into a complete frame
+static void FlacEncodeFrame(std::vector<uint8_t>& out, const int32_t* const* const channelSamples, const uint32_t numChannels, const uint32_t blockSize, const uint64_t frameNumber, const uint32_t bitsPerSample, const FlacCompressionLevel_t& level)
+{
+	thread_local FlacEncodeScratch_t scratch;
+
+	out.clear();
+
+	CFlacBitWriter writer(&out);
+
+	uint32_t channelAssignment = FLAC_CHANNELS_INDEPENDENT + (numChannels - 1u);
+
+	// per channel subframe, samples and bit depth that end up in the frame
+	const FlacSubframe_t* subframes[8] = {};
+	const int32_t* subframeSamples[8] = {};
+	uint32_t subframeBits[8] = {};
+
+	if (numChannels == 2u && level.stereoDecorrelation)
+	{
+		scratch.mid.resize(blockSize);
+		scratch.side.resize(blockSize);
+
+		const int32_t* const left = channelSamples[0];
+		const int32_t* const right = channelSamples[1];
+
+		for (uint32_t i = 0; i < blockSize; ++i)
+		{
+			scratch.mid[i] = (left[i] + right[i]) >> 1;
+			scratch.side[i] = left[i] - right[i];
+		}
+
+		// side channel needs an extra bit
+		FlacAnalyseSubframe(left, blockSize, bitsPerSample, level, scratch.candidates[0], scratch.trial, scratch.windowed);
+		FlacAnalyseSubframe(right, blockSize, bitsPerSample, level, scratch.candidates[1], scratch.trial, scratch.windowed);
+		FlacAnalyseSubframe(scratch.mid.data(), blockSize, bitsPerSample, level, scratch.candidates[2], scratch.trial, scratch.windowed);
+		FlacAnalyseSubframe(scratch.side.data(), blockSize, bitsPerSample + 1u, level, scratch.candidates[3], scratch.trial, scratch.windowed);
+
+		const uint64_t leftBits = scratch.candidates[0].bits;
+		const uint64_t rightBits = scratch.candidates[1].bits;
+		const uint64_t midBits = scratch.candidates[2].bits;
+		const uint64_t sideBits = scratch.candidates[3].bits;
+
+		const uint64_t independentSize = leftBits + rightBits;
+		const uint64_t leftSideSize = leftBits + sideBits;
+		const uint64_t rightSideSize = rightBits + sideBits;
+		const uint64_t midSideSize = midBits + sideBits;
+
+		const uint64_t bestSize = std::min({ independentSize, leftSideSize, rightSideSize, midSideSize });
+
+		if (bestSize == independentSize)
+		{
+			channelAssignment = FLAC_CHANNELS_INDEPENDENT + 1u;
+			subframes[0] = &scratch.candidates[0]; subframeSamples[0] = left; subframeBits[0] = bitsPerSample;
+			subframes[1] = &scratch.candidates[1]; subframeSamples[1] = right; subframeBits[1] = bitsPerSample;
+		}
+		else if (bestSize == leftSideSize)
+		{
+			channelAssignment = FLAC_CHANNELS_LEFT_SIDE;
+			subframes[0] = &scratch.candidates[0]; subframeSamples[0] = left; subframeBits[0] = bitsPerSample;
+			subframes[1] = &scratch.candidates[3]; subframeSamples[1] = scratch.side.data(); subframeBits[1] = bitsPerSample + 1u;
+		}
+		else if (bestSize == rightSideSize)
+		{
+			channelAssignment = FLAC_CHANNELS_RIGHT_SIDE;
+			subframes[0] = &scratch.candidates[3]; subframeSamples[0] = scratch.side.data(); subframeBits[0] = bitsPerSample + 1u;
+			subframes[1] = &scratch.candidates[1]; subframeSamples[1] = right; subframeBits[1] = bitsPerSample;
+		}
+		else
+		{
+			channelAssignment = FLAC_CHANNELS_MID_SIDE;
+			subframes[0] = &scratch.candidates[2]; subframeSamples[0] = scratch.mid.data(); subframeBits[0] = bitsPerSample;
+			subframes[1] = &scratch.candidates[3]; subframeSamples[1] = scratch.side.data(); subframeBits[1] = bitsPerSample + 1u;
+		}
+	}
+
+	// header
+	const uint32_t blockSizeCode = blockSize == flacBlockSize ? 12u : 7u; // 4096, or 16-bit size stored at the end of the header
+	const uint32_t sampleSizeCode = bitsPerSample == 24u ? 6u : 4u;
+
+	writer.Write(0xFFF8u, 16u); // sync code, fixed block size
+	writer.Write(blockSizeCode, 4u);
+	writer.Write(0u, 4u); // sample rate from streaminfo
+	writer.Write(channelAssignment, 4u);
+	writer.Write(sampleSizeCode, 3u);
+	writer.Write(0u, 1u);
+	writer.WriteUTF8(frameNumber);
+
+	if (blockSizeCode == 7u)
+		writer.Write(blockSize - 1u, 16u);
+
+	writer.Write(FlacCRC8(out.data(), out.size()), 8u);
+
+	// subframes
+	if (subframes[0])
+	{
+		for (uint32_t i = 0; i < numChannels; ++i)
+			FlacWriteSubframe(writer, subframeSamples[i], blockSize, subframeBits[i], *subframes[i]);
+	}
+	else
+	{
+		for (uint32_t i = 0; i < numChannels; ++i)
+		{
+			FlacAnalyseSubframe(channelSamples[i], blockSize, bitsPerSample, level, scratch.candidates[0], scratch.trial, scratch.windowed);
+			FlacWriteSubframe(writer, channelSamples[i], blockSize, bitsPerSample, scratch.candidates[0]);
+		}
+	}
+
+	// footer
+	writer.AlignToByte();
+	writer.Write(FlacCRC16(out.data(), out.size()), 16u);
+}
+
+//
+// FILE WRITER
+//
+bool CFlacFileWriter::Open(const std::filesystem::path& path, const uint16_t channels, const uint32_t sampleRate, const uint8_t bitsPerSample, const uint32_t compressionLevel, const char* const title)
+{
+	Close();
+
+	if (channels == 0u || channels > 8u || (bitsPerSample != 16u && bitsPerSample != 24u) || sampleRate == 0u || sampleRate >= (1u << 20u))
+		return false;
+
+	if (!m_file.open(path.string(), eStreamIOMode::Write))
+		return false;
+
+	m_numBufferedFrames = 0u;
+	m_numFramesWritten = 0u;
+	m_numSamplesWritten = 0ull;
+	m_minFrameSize = UINT32_MAX;
+	m_maxFrameSize = 0u;
+
+	m_channels = channels;
+	m_sampleRate = sampleRate;
+	m_bitsPerSample = bitsPerSample;
+	m_compressionLevel = std::min(compressionLevel, flacMaxCompressionLevel);
+	m_open = true;
+
+	for (uint32_t i = 0; i < m_channels; ++i)
+		m_samples[i].resize(static_cast<size_t>(flacBlockSize) * flacBlocksPerBatch);
+
+	m_encodeWorkers = std::make_unique<CWorkerPool>(CThread::GetNestedExportThreadBudget(flacBlocksPerBatch));
+
+	m_file.write("fLaC", 4);
+
+	// frame sizes and the sample count get filled in on close
+	WriteStreamInfo();
+	WriteVorbisComment(title);
+
+	return true;
+}
+
+void CFlacFileWriter::WriteSamples(const float* const samples, const uint32_t frameCount)
+{
+	if (!m_open)
+		return;
+
+	const uint32_t batchSize = flacBlockSize * flacBlocksPerBatch;
+
+	for (uint32_t frame = 0; frame < frameCount; ++frame)
+	{
+		const float* const frameSamples = samples + (static_cast<size_t>(frame) * m_channels);
+
+		for (uint32_t channel = 0; channel < m_channels; ++channel)
+			m_samples[channel][m_numBufferedFrames] = FlacQuantiseSample(frameSamples[channel], m_bitsPerSample, m_dither);
+
+		if (++m_numBufferedFrames == batchSize)
+			EncodeBatch();
+	}
+}
+
+void CFlacFileWriter::EncodeBatch()
+{
+	if (m_numBufferedFrames == 0u)
+		return;
+
+	const FlacCompressionLevel_t& level = s_FlacCompressionLevels[m_compressionLevel];
+
+	const uint32_t numBlocks = (m_numBufferedFrames + flacBlockSize - 1u) / flacBlockSize;
+
+	auto encodeBlock = [this, &level](const uint32_t block)
+		{
+			const uint32_t firstFrame = block * flacBlockSize;
+			const uint32_t blockSize = std::min(flacBlockSize, m_numBufferedFrames - firstFrame);
+
+			const int32_t* channelSamples[8] = {};
+			for (uint32_t channel = 0; channel < m_channels; ++channel)
+				channelSamples[channel] = m_samples[channel].data() + firstFrame;
+
+			FlacEncodeFrame(m_encodedFrames[block], channelSamples, m_channels, blockSize, m_numFramesWritten + block, m_bitsPerSample, level);
+		};
+
+	m_encodeWorkers->ParallelFor(numBlocks, [&encodeBlock](const size_t block) { encodeBlock(static_cast<uint32_t>(block)); });
+
+	for (uint32_t block = 0; block < numBlocks; ++block)
+	{
+		const std::vector<uint8_t>& frame = m_encodedFrames[block];
+		m_file.write(reinterpret_cast<const char*>(frame.data()), frame.size());
+
+		m_minFrameSize = std::min(m_minFrameSize, static_cast<uint32_t>(frame.size()));
+		m_maxFrameSize = std::max(m_maxFrameSize, static_cast<uint32_t>(frame.size()));
+	}
+
+	m_numFramesWritten += numBlocks;
+	m_numSamplesWritten += m_numBufferedFrames;
+	m_numBufferedFrames = 0u;
+}
+
+void CFlacFileWriter::Close()
+{
+	if (!m_open)
+		return;
+
+	EncodeBatch();
+
+	// streaminfo directly follows the stream marker
+	m_file.seek(4);
+	WriteStreamInfo();
+	m_file.close();
+
+	for (uint32_t i = 0; i < m_channels; ++i)
+		m_samples[i] = {};
+
+	m_encodeWorkers.reset();
+
+	m_open = false;
+}
+
+void CFlacFileWriter::WriteStreamInfo()
+{
+	std::vector<uint8_t> block;
+	block.reserve(38);
+
+	CFlacBitWriter writer(&block);
+
+	// block header
+	writer.Write(0u, 1u); // not the last block, there is always a vorbis comment after it
+	writer.Write(0u, 7u); // STREAMINFO
+	writer.Write(34u, 24u);
+
+	const uint32_t minFrameSize = m_maxFrameSize ? m_minFrameSize : 0u; // 0 means unknown
+
+	writer.Write(flacBlockSize, 16u); // min block size
+	writer.Write(flacBlockSize, 16u); // max block size
+	writer.Write(minFrameSize, 24u);
+	writer.Write(m_maxFrameSize, 24u);
+	writer.Write(m_sampleRate, 20u);
+	writer.Write(m_channels - 1u, 3u);
+	writer.Write(m_bitsPerSample - 1u, 5u);
+	writer.Write(static_cast<uint32_t>(m_numSamplesWritten >> 32u), 4u);
+	writer.Write(static_cast<uint32_t>(m_numSamplesWritten), 32u);
+
+	// md5 of the unencoded audio is left unset, decoders treat this as unknown
+	for (uint32_t i = 0; i < 4u; ++i)
+		writer.Write(0u, 32u);
+
+	m_file.write(reinterpret_cast<const char*>(block.data()), block.size());
+}
+
+void CFlacFileWriter::WriteVorbisComment(const char* const title)
+{
+	static constexpr char vendor[] = "rsx";
+
+	std::string comment = "TITLE=";
+	comment += title ? title : "";
+
+	std::vector<uint8_t> block;
+
+	auto writeLE32 = [&block](const uint32_t value)
+		{
+			for (uint32_t i = 0; i < 4u; ++i)
+				block.push_back(static_cast<uint8_t>(value >> (i * 8u)));
+		};
+
+	// lengths in vorbis comments are little endian, unlike everything else in flac
+	writeLE32(static_cast<uint32_t>(sizeof(vendor) - 1));
+	block.insert(block.end(), vendor, vendor + sizeof(vendor) - 1);
+
+	writeLE32(1u);
+	writeLE32(static_cast<uint32_t>(comment.size()));
+	block.insert(block.end(), comment.begin(), comment.end());
+
+	const uint32_t blockSize = static_cast<uint32_t>(block.size());
+
+	// block header, this is the last metadata block
+	const uint8_t header[4] = { 0x80u | 4u, static_cast<uint8_t>(blockSize >> 16u), static_cast<uint8_t>(blockSize >> 8u), static_cast<uint8_t>(blockSize) };
+
+	m_file.write(reinterpret_cast<const char*>(header), sizeof(header));
+	m_file.write(reinterpret_cast<const char*>(block.data()), block.size());
+}
+
+//
+// FILE READER
+//
+class CFlacBitReader
+{
+public:
+	CFlacBitReader(const uint8_t* const data, const size_t size) : m_data(data), m_size(size), m_pos(0ull) {};
+
+	// bits must be 32 or less, reads past the end return zeros and set the overrun flag
+	inline uint32_t Read(const uint32_t bits)
+	{
+		uint32_t value = 0u;
+		for (uint32_t i = 0; i < bits; ++i)
+			value = (value << 1u) | ReadBit();
+
+		return value;
+	}
+
+	inline int32_t ReadSigned(const uint32_t bits)
+	{
+		if (bits == 0u)
+			return 0;
+
+		const uint32_t value = Read(bits);
+		const uint32_t signBit = 1u << (bits - 1u);
+
+		return static_cast<int32_t>((value ^ signBit) - signBit);
+	}
+
+	inline int32_t ReadRice(const uint32_t param)
+	{
+		uint32_t quotient = 0u;
+		while (!ReadBit() && !Overrun())
+			quotient++;
+
+		const uint32_t value = (quotient << param) | Read(param);
+
+		// undo the zigzag
+		return static_cast<int32_t>(value >> 1u) ^ -static_cast<int32_t>(value & 1u);
+	}
+
+	inline uint64_t ReadUTF8()
+	{
+		const uint32_t lead = Read(8u);
+		if ((lead & 0x80u) == 0u)
+			return lead;
+
+		uint32_t numBytes = 0u;
+		while (numBytes < 7u && (lead & (0x80u >> numBytes)))
+			numBytes++;
+
+		uint64_t value = lead & ((1u << (7u - numBytes)) - 1u);
+		for (uint32_t i = 1; i < numBytes; ++i)
+			value = (value << 6u) | (Read(8u) & 0x3Fu);
+
+		return value;
+	}
+
+	inline void AlignToByte()
+	{
+		m_pos = (m_pos + 7ull) & ~7ull;
+	}
+
+	inline void Seek(const size_t bytePos) { m_pos = static_cast<uint64_t>(bytePos) * 8ull; }
+
+	inline const size_t BytePos() const { return static_cast<size_t>(m_pos >> 3ull); }
+	inline const bool AtEnd() const { return BytePos() >= m_size; }
+	inline const bool Overrun() const { return m_pos > static_cast<uint64_t>(m_size) * 8ull; }
+
+private:
+	inline uint32_t ReadBit()
+	{
+		const uint64_t pos = m_pos++;
+		if ((pos >> 3ull) >= m_size)
+			return 0u;
+
+		return (m_data[pos >> 3ull] >> (7u - static_cast<uint32_t>(pos & 7ull))) & 1u;
+	}
+
+	const uint8_t* const m_data;
+	const size_t m_size;
+
+	uint64_t m_pos; // in bits
+};
+
+static bool FlacReadResidual(CFlacBitReader& reader, const uint32_t blockSize, const uint32_t predOrder, int32_t* residual)
+{
+	const uint32_t method = reader.Read(2u);
+	if (method > 1u)
+		return false;
+
+	const uint32_t paramBits = method == 1u ? 5u : 4u;
+	const uint32_t escapeParam = (1u << paramBits) - 1u;
+
+	const uint32_t partitionOrder = reader.Read(4u);
+	const uint32_t numPartitions = 1u << partitionOrder;
+	const uint32_t partitionSize = blockSize >> partitionOrder;
+
+	if ((blockSize % numPartitions) != 0u || partitionSize < predOrder)
+		return false;
+
+	for (uint32_t partition = 0; partition < numPartitions; ++partition)
+	{
+		const uint32_t count = partition == 0u ? partitionSize - predOrder : partitionSize;
+		const uint32_t param = reader.Read(paramBits);
+
+		if (param == escapeParam)
+		{
+			const uint32_t rawBits = reader.Read(5u);
+			for (uint32_t i = 0; i < count; ++i)
+				residual[i] = reader.ReadSigned(rawBits);
+		}
+		else
+		{
+			for (uint32_t i = 0; i < count; ++i)
+				residual[i] = reader.ReadRice(param);
+		}
+
+		residual += count;
+	}
+
+	return !reader.Overrun();
+}
+
+static bool FlacReadSubframe(CFlacBitReader& reader, const uint32_t blockSize, const uint32_t bitsPerSample, int32_t* const samples, std::vector<int32_t>& residual)
+{
+	const uint32_t header = reader.Read(8u);
+	if (header & 0x81u) // zero pad bit, wasted bits
+		return false;
+
+	const uint32_t type = header >> 1u;
+
+	if (type == 0x00u)
+	{
+		const int32_t value = reader.ReadSigned(bitsPerSample);
+		std::fill(samples, samples + blockSize, value);
+
+		return !reader.Overrun();
+	}
+
+	if (type == 0x01u)
+	{
+		for (uint32_t i = 0; i < blockSize; ++i)
+			samples[i] = reader.ReadSigned(bitsPerSample);
+
+		return !reader.Overrun();
+	}
+
+	const bool isLpc = (type & 0x20u) != 0u;
+	if (!isLpc && (type < 0x08u || type > 0x0Cu))
+		return false;
+
+	const uint32_t order = isLpc ? (type & 0x1Fu) + 1u : type & 0x07u;
+	if (order > blockSize)
+		return false;
+
+	for (uint32_t i = 0; i < order; ++i)
+		samples[i] = reader.ReadSigned(bitsPerSample);
+
+	int32_t qlpCoeffs[32] = {};
+	int32_t qlpShift = 0;
+
+	if (isLpc)
+	{
+		const uint32_t precision = reader.Read(4u) + 1u;
+		if (precision == 16u)
+			return false;
+
+		qlpShift = reader.ReadSigned(5u);
+		if (qlpShift < 0)
+			return false;
+
+		for (uint32_t i = 0; i < order; ++i)
+			qlpCoeffs[i] = reader.ReadSigned(precision);
+	}
+
+	residual.resize(blockSize);
+	if (!FlacReadResidual(reader, blockSize, order, residual.data()))
+		return false;
+
+	for (uint32_t i = order; i < blockSize; ++i)
+	{
+		int64_t prediction = 0ll;
+
+		if (isLpc)
+		{
+			for (uint32_t j = 0; j < order; ++j)
+				prediction += static_cast<int64_t>(qlpCoeffs[j]) * samples[i - j - 1];
+
+			prediction >>= qlpShift;
+		}
+		else
+		{
+			switch (order)
+			{
+			case 1:
+				prediction = samples[i - 1];
+				break;
+			case 2:
+				prediction = (2ll * samples[i - 1]) - samples[i - 2];
+				break;
+			case 3:
+				prediction = (3ll * samples[i - 1]) - (3ll * samples[i - 2]) + samples[i - 3];
+				break;
+			case 4:
+				prediction = (4ll * samples[i - 1]) - (6ll * samples[i - 2]) + (4ll * samples[i - 3]) - samples[i - 4];
+				break;
+			}
+		}
+
+		samples[i] = static_cast<int32_t>(prediction + residual[i - order]);
+	}
+
+	return true;
+}
+
+bool FlacDecodeFile(const std::filesystem::path& path, FlacDecodedStream_t& out, std::string& error)
+{
+	out = {};
+
+	CMappedFile file;
+	if (!file.open(path))
+	{
+		error = "failed to open file";
+		return false;
+	}
+
+	const uint8_t* const data = reinterpret_cast<const uint8_t*>(file.get());
+	const size_t size = file.size();
+
+	if (size < 4ull || memcmp(data, "fLaC", 4) != 0)
+	{
+		error = "missing stream marker";
+		return false;
+	}
+
+	CFlacBitReader reader(data, size);
+	reader.Seek(4ull);
+
+	// metadata
+	bool foundStreamInfo = false;
+	uint32_t maxBlockSize = 0u;
+
+	for (bool lastBlock = false; !lastBlock;)
+	{
+		lastBlock = reader.Read(1u) != 0u;
+
+		const uint32_t blockType = reader.Read(7u);
+		const uint32_t blockLength = reader.Read(24u);
+		const size_t blockEnd = reader.BytePos() + blockLength;
+
+		if (blockEnd > size)
+		{
+			error = "metadata block runs past the end of the file";
+			return false;
+		}
+
+		if (blockType == 0u)
+		{
+			reader.Read(16u); // min block size
+			maxBlockSize = reader.Read(16u);
+			reader.Read(24u); // min frame size
+			reader.Read(24u); // max frame size
+
+			out.sampleRate = reader.Read(20u);
+			out.channels = static_cast<uint16_t>(reader.Read(3u) + 1u);
+			out.bitsPerSample = static_cast<uint8_t>(reader.Read(5u) + 1u);
+			out.frameCount = (static_cast<uint64_t>(reader.Read(4u)) << 32ull) | reader.Read(32u);
+
+			foundStreamInfo = true;
+		}
+
+		reader.Seek(blockEnd);
+	}
+
+	if (!foundStreamInfo || (out.bitsPerSample != 16u && out.bitsPerSample != 24u) || maxBlockSize == 0u)
+	{
+		error = "missing or unsupported streaminfo";
+		return false;
+	}
+
+	out.samples.reserve(static_cast<size_t>(out.frameCount) * out.channels);
+
+	std::vector<int32_t> channelSamples[8];
+	for (uint32_t i = 0; i < out.channels; ++i)
+		channelSamples[i].resize(maxBlockSize);
+
+	std::vector<int32_t> residual;
+
+	uint64_t frameNumber = 0ull;
+	uint64_t numFramesDecoded = 0ull;
+
+	while (!reader.AtEnd())
+	{
+		const size_t frameStart = reader.BytePos();
+
+		// header
+		if (reader.Read(16u) != 0xFFF8u)
+		{
+			error = std::format("bad sync code in frame {}", frameNumber);
+			return false;
+		}
+
+		const uint32_t blockSizeCode = reader.Read(4u);
+		const uint32_t sampleRateCode = reader.Read(4u);
+		const uint32_t channelAssignment = reader.Read(4u);
+		const uint32_t sampleSizeCode = reader.Read(3u);
+		reader.Read(1u);
+
+		const uint64_t codedFrameNumber = reader.ReadUTF8();
+
+		uint32_t blockSize = 0u;
+		if (blockSizeCode == 12u)
+			blockSize = flacBlockSize;
+		else if (blockSizeCode == 7u)
+			blockSize = reader.Read(16u) + 1u;
+
+		const size_t headerEnd = reader.BytePos();
+		const uint32_t headerCRC = reader.Read(8u);
+
+		if (reader.Overrun() || headerCRC != FlacCRC8(data + frameStart, headerEnd - frameStart))
+		{
+			error = std::format("header crc mismatch in frame {}", frameNumber);
+			return false;
+		}
+
+		const uint32_t numChannels = channelAssignment < FLAC_CHANNELS_LEFT_SIDE ? channelAssignment + 1u : 2u;
+		const uint32_t bitsPerSample = sampleSizeCode == 6u ? 24u : (sampleSizeCode == 4u ? 16u : 0u);
+
+		if (codedFrameNumber != frameNumber || blockSize == 0u || blockSize > maxBlockSize || sampleRateCode != 0u || channelAssignment > FLAC_CHANNELS_MID_SIDE
+			|| numChannels != out.channels || bitsPerSample != out.bitsPerSample)
+		{
+			error = std::format("unexpected header in frame {}", frameNumber);
+			return false;
+		}
+
+		// subframes, the side channel has an extra bit
+		for (uint32_t i = 0; i < numChannels; ++i)
+		{
+			const bool isSide = (i == 1u && (channelAssignment == FLAC_CHANNELS_LEFT_SIDE || channelAssignment == FLAC_CHANNELS_MID_SIDE))
+				|| (i == 0u && channelAssignment == FLAC_CHANNELS_RIGHT_SIDE);
+
+			if (!FlacReadSubframe(reader, blockSize, bitsPerSample + (isSide ? 1u : 0u), channelSamples[i].data(), residual))
+			{
+				error = std::format("bad subframe {} in frame {}", i, frameNumber);
+				return false;
+			}
+		}
+
+		// footer
+		reader.AlignToByte();
+
+		const size_t frameEnd = reader.BytePos();
+		const uint32_t frameCRC = reader.Read(16u);
+
+		if (reader.Overrun() || frameCRC != FlacCRC16(data + frameStart, frameEnd - frameStart))
+		{
+			error = std::format("frame crc mismatch in frame {}", frameNumber);
+			return false;
+		}
+
+		// undo the stereo decorrelation
+		if (channelAssignment >= FLAC_CHANNELS_LEFT_SIDE)
+		{
+			int32_t* const a = channelSamples[0].data();
+			int32_t* const b = channelSamples[1].data();
+
+			for (uint32_t i = 0; i < blockSize; ++i)
+			{
+				switch (channelAssignment)
+				{
+				case FLAC_CHANNELS_LEFT_SIDE:
+					b[i] = a[i] - b[i];
+					break;
+				case FLAC_CHANNELS_RIGHT_SIDE:
+					a[i] = a[i] + b[i];
+					break;
+				case FLAC_CHANNELS_MID_SIDE:
+				{
+					const int32_t mid = static_cast<int32_t>((static_cast<uint32_t>(a[i]) << 1u) | (b[i] & 1));
+					const int32_t side = b[i];
+
+					a[i] = (mid + side) >> 1;
+					b[i] = (mid - side) >> 1;
+					break;
+				}
+				}
+			}
+		}
+
+		for (uint32_t i = 0; i < blockSize; ++i)
+		{
+			for (uint32_t channel = 0; channel < numChannels; ++channel)
+				out.samples.push_back(channelSamples[channel][i]);
+		}
+
+		numFramesDecoded += blockSize;
+		frameNumber++;
+	}
+
+	if (numFramesDecoded != out.frameCount)
+	{
+		error = std::format("decoded {} samples per channel, streaminfo says {}", numFramesDecoded, out.frameCount);
+		return false;
+	}
+
+	return true;
+}
@@ -0,0 +1,125 @@
+#pragma once
+#include <game/audio/wavefile.h>
+
+// native flac encoder
+// samples are buffered into fixed size blocks, a batch of blocks is encoded into frames in parallel (on worker threads kept for the whole file) and then written out in order.
+// only the current batch is ever held in memory, so memory use doesn't depend on the length of the source.
+
+static constexpr uint32_t flacBlockSize = 4096; // samples per channel in every frame but the last
+static constexpr uint32_t flacBlocksPerBatch = 32;
+static constexpr uint32_t flacMaxLpcOrder = 12;
+static constexpr uint32_t flacMaxPartitionOrder = 8;
+static constexpr uint32_t flacMaxCompressionLevel = 8;
+
+// residual of a subframe and how it should be coded
+struct FlacSubframe_t
+{
+	enum eType : uint8_t
+	{
+		CONSTANT,
+		VERBATIM,
+		FIXED,
+		LPC,
+	};
+
+	eType type;
+	uint8_t order;
+
+	// lpc only
+	uint8_t qlpPrecision;
+	int8_t qlpShift;
+	int32_t qlpCoeffs[flacMaxLpcOrder];
+
+	// rice coded residual
+	uint8_t partitionOrder;
+	uint8_t riceParams[1 << flacMaxPartitionOrder];
+
+	std::vector<int32_t> residual;
+
+	uint64_t bits; // size of the encoded subframe, not including the header
+};
+
+// converts a decoded sample to the integer that gets stored, only 16-bit is dithered.
+// dither has to be fed samples in the same order the writer sees them for the result to match
+inline const int32_t FlacQuantiseSample(const float sample, const uint8_t bitsPerSample, CAudioDither& dither)
+{
+	// doubles so 24-bit samples don't lose precision while being scaled
+	const double scale = static_cast<double>((1 << (bitsPerSample - 1u)) - 1);
+	const int32_t maxValue = (1 << (bitsPerSample - 1u)) - 1;
+	const int32_t minValue = -(1 << (bitsPerSample - 1u));
+
+	// 24-bit is already finer than anything the decoders give us
+	const double scaled = (sample * scale) + (bitsPerSample == 16u ? dither.Next() : 0.0);
+
+	return std::clamp(static_cast<int32_t>(std::lround(scaled)), minValue, maxValue);
+}
+
+class CFlacFileWriter
+{
+public:
+	CFlacFileWriter() : m_numBufferedFrames(0u), m_numFramesWritten(0u), m_numSamplesWritten(0ull), m_minFrameSize(0u), m_maxFrameSize(0u),
+		m_channels(0u), m_sampleRate(0u), m_bitsPerSample(0u), m_compressionLevel(0u), m_open(false) {};
+	~CFlacFileWriter()
+	{
+		Close();
+	}
+
+	CFlacFileWriter(const CFlacFileWriter&) = delete;
+	CFlacFileWriter& operator=(const CFlacFileWriter&) = delete;
+
+	// bitsPerSample must be 16 or 24, compressionLevel is 0-8 (fastest to smallest). title gets stored in a vorbis comment
+	bool Open(const std::filesystem::path& path, const uint16_t channels, const uint32_t sampleRate, const uint8_t bitsPerSample, const uint32_t compressionLevel, const char* const title);
+
+	// samples are interleaved, frameCount is the number of samples per channel
+	void WriteSamples(const float* const samples, const uint32_t frameCount);
+
+	void Close();
+
+	inline const bool IsOpen() const { return m_open; }
+
+private:
+	void WriteStreamInfo();
+	void WriteVorbisComment(const char* const title);
+
+	// encodes and writes out everything that has been buffered
+	void EncodeBatch();
+
+	StreamIO m_file;
+
+	// planar samples for the current batch
+	std::vector<int32_t> m_samples[8];
+	uint32_t m_numBufferedFrames;
+
+	// encoded frames for the current batch, kept around so they only get reallocated when they need to grow
+	std::vector<uint8_t> m_encodedFrames[flacBlocksPerBatch];
+
+	// batches are encoded on the same threads for the whole file, created on open
+	std::unique_ptr<CWorkerPool> m_encodeWorkers;
+
+	uint32_t m_numFramesWritten;
+	uint64_t m_numSamplesWritten;
+	uint32_t m_minFrameSize;
+	uint32_t m_maxFrameSize;
+
+	uint16_t m_channels;
+	uint32_t m_sampleRate;
+	uint8_t m_bitsPerSample;
+	uint32_t m_compressionLevel;
+
+	CAudioDither m_dither;
+	bool m_open;
+};
+
+// integer samples read back out of a flac file
+struct FlacDecodedStream_t
+{
+	std::vector<int32_t> samples; // interleaved
+	uint64_t frameCount; // samples per channel
+	uint32_t sampleRate;
+	uint16_t channels;
+	uint8_t bitsPerSample;
+};
+
+// decodes a file written by CFlacFileWriter, only what the writer emits is supported (streaminfo sample rate and depth, no wasted bits).
+// every frame is crc checked, error gets the reason if the stream can't be decoded
+bool FlacDecodeFile(const std::filesystem::path& path, FlacDecodedStream_t& out, std::string& error);
@@ -2,8 +2,11 @@
 #include "miles.h"
 
 #include <game/audio/wavefile.h>
+#include <game/audio/flacfile.h>
 #include <game/rtech/utils/utils.h>
 
+#include <chrono>
+
 std::string CMilesAudioBank::GetStreamingFileNameForSource(const MilesSource_t* source) const
 {
 	std::string sourceStreamFileName = GetBankStem();
@@ -56,10 +59,12 @@ void CMilesAudioBank::DiscoverStreamingFiles()
 			if (it.path().extension() == ".mstr")
 			{
 				//Log("MSTR: Checking %s\n", it.path().string().c_str());
-				StreamIO stream(it.path(), eStreamIOMode::Read);
+				std::unique_ptr<CMappedFile> stream = std::make_unique<CMappedFile>();
+
+				if (!stream->open(it.path()) || stream->size() < sizeof(MilesStreamHeader_t))
+					continue;
 
-				MilesStreamHeader_t header = stream.read<MilesStreamHeader_t>();
-				stream.close();
+				const MilesStreamHeader_t header = *reinterpret_cast<const MilesStreamHeader_t*>(stream->get());
 
 				// Require 'CSTR' magic and "version" 2
 				// It's not clear if the 2 is actually a version, but it lines up
@@ -90,6 +95,9 @@ void CMilesAudioBank::DiscoverStreamingFiles()
 					else
 						this->m_localisedStreamStates[header.languageIdx] |= 1 << header.patchIdx;
 				}
+
+				// keep the stream mapped so sources don't have to open it again every time they are exported
+				this->m_streamFiles[it.path().filename().string()] = std::move(stream);
 			}
 		}
 	}
@@ -273,77 +281,73 @@ extern ExportSettings_t g_ExportSettings;
 
 constexpr const char* PATH_PREFIX_ASRC = "audio";
 
+// the stream file is mapped, so reads past its end come back short. whatever couldn't be read is zero filled
+// so the decoder never sees uninitialised memory, and the rest of the stream is treated as empty
 uint32_t ReadAudioStream(char* buffer, size_t length, MilesASIUserData_t* userData)
 {
 	size_t totalRead = 0;
+	bool truncated = false;
 
 	if (userData->dataRead < userData->headerSize)
 	{
 		auto Diff = userData->headerSize - userData->dataRead;
 		auto MinDiff = std::min(length, Diff);
-		userData->streamReader->read(buffer, MinDiff);
-		userData->dataRead += MinDiff;
-		totalRead += MinDiff;
+		const size_t headerRead = userData->streamFile->read(buffer, userData->readOffset, MinDiff);
+		userData->readOffset += headerRead;
+		userData->dataRead += headerRead;
+		totalRead += headerRead;
+
+		truncated = headerRead < MinDiff;
 
 		if (userData->dataRead >= userData->headerSize)
-			userData->streamReader->seek(userData->audioStreamOffset);
+			userData->readOffset = userData->audioStreamOffset;
 	}
 
-	uint64_t LengthToRead = length - totalRead;
-	LengthToRead = std::min(userData->audioStreamSize, LengthToRead);
-
-	userData->streamReader->read(buffer + totalRead, LengthToRead);
-	totalRead += LengthToRead;
-	userData->audioStreamSize -= LengthToRead;
-
-	return (uint32_t)totalRead;
-}
-
-bool ExportAudioSourceAsset(CAsset* const asset, const int setting)
-{
-	UNUSED(setting);
-
-	CMilesAudioAsset* audioAsset = static_cast<CMilesAudioAsset*>(asset);
-	CMilesAudioBank* audioBank = asset->GetContainerFile<CMilesAudioBank>();
+	if (!truncated)
+	{
+		uint64_t LengthToRead = length - totalRead;
+		LengthToRead = std::min(userData->audioStreamSize, LengthToRead);
 
-	// Create exported path + asset path.
-	std::filesystem::path exportPath = g_ExportSettings.GetExportDirectory();// std::filesystem::current_path().append(EXPORT_DIRECTORY_NAME);
-	const std::filesystem::path asrcPath(audioAsset->GetAssetName());
+		const size_t streamRead = userData->streamFile->read(buffer + totalRead, userData->readOffset, LengthToRead);
+		userData->readOffset += streamRead;
+		totalRead += streamRead;
+		userData->audioStreamSize -= streamRead;
 
-	// truncate paths?
-	if (g_ExportSettings.exportPathsFull)
-		exportPath.append(asrcPath.parent_path().string());
-	else
-		exportPath.append(PATH_PREFIX_ASRC);
+		truncated = streamRead < LengthToRead;
+	}
 
-	if (!CreateDirectories(exportPath))
+	if (truncated)
 	{
-		assertm(false, "Failed to create asset type directory.");
-		return false;
+		Log("MILES: Stream file is truncated at offset %llu, remaining audio data will be silent.\n", userData->readOffset);
+		userData->dataRead = userData->headerSize;
+		userData->audioStreamSize = 0;
 	}
 
-	exportPath.append(asrcPath.filename().string());
-	exportPath.replace_extension("wav");
+	if (totalRead < length)
+		memset(buffer + totalRead, 0, length - totalRead);
 
-	MilesSource_t* source = reinterpret_cast<MilesSource_t*>(audioAsset->GetAssetData());
+	return (uint32_t)totalRead;
+}
 
-	// get the bank's path and replace the filename
-	// with the stream file name that we've just put together
-	std::filesystem::path streamPath(audioBank->GetFilePath());
-	streamPath.replace_filename(audioAsset->GetContainerFileName());
+// finds the decoder for a source and opens its stream, fills in the format info in ctx
+static bool OpenAudioSource(CMilesAudioAsset* const audioAsset, MilesDecodeContext_t& ctx)
+{
+	const CMilesAudioBank* const audioBank = audioAsset->GetContainerFile<CMilesAudioBank>();
+	const MilesSource_t* const source = reinterpret_cast<MilesSource_t*>(audioAsset->GetAssetData());
 
 	// Data Reading
-	StreamIO streamFile(streamPath, eStreamIOMode::Read);
-
-	MilesStreamHeader_t streamFileHeader = streamFile.read<MilesStreamHeader_t>();
-
-	streamFile.seek(source->streamHeaderOffset);
+	const CMappedFile* const streamFile = audioBank->GetStreamFile(audioAsset->GetContainerFileName());
 
-	char* sourceStreamHeaderData = new char[source->streamHeaderSize];
+	if (!streamFile || source->streamHeaderOffset + source->streamHeaderSize > streamFile->size())
+	{
+		Log("MILES: Stream file \"%s\" is missing or too small for source '%s'.\n", audioAsset->GetContainerFileName().c_str(), audioAsset->GetAssetName().c_str());
+		return false;
+	}
 
-	streamFile.read(sourceStreamHeaderData, source->streamHeaderSize);
+	const MilesStreamHeader_t* const streamFileHeader = reinterpret_cast<const MilesStreamHeader_t*>(streamFile->get());
 
-	std::vector<char> decodedAudioData;
+	// the header is read straight out of the mapped stream file
+	const char* const sourceStreamHeaderData = streamFile->get() + source->streamHeaderOffset;
 
 	MilesASIDecoder_t* decoder = nullptr;
 
@@ -378,41 +382,56 @@ bool ExportAudioSourceAsset(CAsset* const asset, const int setting)
 	const auto ASI_stream_parse_metadata = static_cast<ASI_parse_metadata_f>(decoder->ASI_stream_parse_metadata);
 	const auto ASI_open_stream = static_cast<ASI_open_stream_f>(decoder->ASI_open_stream);
 	const auto ASI_notify_seek = static_cast<ASI_notify_seek_f>(decoder->ASI_notify_seek);
-	const auto ASI_decode_block = static_cast<ASI_decode_block_f>(decoder->ASI_decode_block);
-	const auto ASI_get_block_size = static_cast<ASI_get_block_size_f>(decoder->ASI_get_block_size);
 
-	uint16_t channels;
-	uint32_t sampleRate;
-	uint32_t samplesCount;
-	ASI_stream_parse_metadata(sourceStreamHeaderData, source->streamHeaderSize, &channels, &sampleRate, &samplesCount, (int*)&parsedMetadata, nullptr);
+	ASI_stream_parse_metadata(const_cast<char*>(sourceStreamHeaderData), source->streamHeaderSize, &ctx.channels, &ctx.sampleRate, &ctx.sampleCount, (int*)&parsedMetadata, nullptr);
 
-	streamFile.seek(source->streamHeaderOffset);
+	ctx.decoder = decoder;
+	ctx.maxSamplesPerDecode = parsedMetadata.maxSamplesPerDecode;
 
-	std::vector<char> container(parsedMetadata.minSizeToOpenStream, 0);
+	// reused between sources, the decoder expects its state to start out zeroed
+	ctx.container.assign(parsedMetadata.minSizeToOpenStream, 0);
 
-	MilesASIUserData_t userData = {
-		&streamFile,
+	ctx.userData = {
+		streamFile,
+		source->streamHeaderOffset,
 		0,
 		source->streamHeaderSize,
-		streamFileHeader.streamDataOffset + source->streamDataOffset
+		streamFileHeader->streamDataOffset + source->streamDataOffset,
+		0
 	};
 
-	size_t containerSize = container.size();
-	ASI_open_stream(container.data(), &containerSize, ReadAudioStream, &userData);
+	size_t containerSize = ctx.container.size();
+	ASI_open_stream(ctx.container.data(), &containerSize, ReadAudioStream, &ctx.userData);
+
+	ASI_notify_seek(ctx.container.data());
 
-	ASI_notify_seek(container.data());
+	ctx.userData.audioStreamSize = *(uint64_t*)(ctx.container.data() + 0x18) - source->streamHeaderSize;
 
-	userData.audioStreamSize = *(uint64_t*)(container.data() + 0x18) - source->streamHeaderSize;
+	return true;
+}
 
+// decodes a source opened with OpenAudioSource, blockFunc gets called with the interleaved output of every decode call.
+// blockFunc always receives sampleCount frames in total, anything the decoder didn't produce is silence
+template<typename BlockFunc_t>
+static void DecodeAudioSource(MilesDecodeContext_t& ctx, const BlockFunc_t& blockFunc)
+{
+	const auto ASI_decode_block = static_cast<ASI_decode_block_f>(ctx.decoder->ASI_decode_block);
+	const auto ASI_get_block_size = static_cast<ASI_get_block_size_f>(ctx.decoder->ASI_get_block_size);
 
-	std::vector<float> interleavedBuffer = std::vector<float>(channels * samplesCount);
-	float* outputBuffer = interleavedBuffer.data();
+	const uint16_t channels = ctx.channels;
+	const uint32_t samplesCount = ctx.sampleCount;
 
-	std::vector<char> stream_data;
+	std::vector<char>& stream_data = ctx.inputData;
+	stream_data.clear();
 
 	// Buffer for holding the decoded data for each decode_block call.
 	// parsedSizeInfo[2] is the max number of samples per decode
-	std::vector<float> radDecodedData(channels* parsedMetadata.maxSamplesPerDecode);
+	std::vector<float>& radDecodedData = ctx.blockData;
+	radDecodedData.resize(static_cast<size_t>(channels) * ctx.maxSamplesPerDecode);
+
+	// only ever holds one block, so memory use doesn't depend on the length of the source
+	ctx.interleavedData.resize(static_cast<size_t>(channels) * ctx.maxSamplesPerDecode);
+	float* const outputBuffer = ctx.interleavedData.data();
 
 	size_t totalFramesDecoded = 0;
 	uint32_t minInputBufferSize = 0; // start off with 0 bytes for input buffer so we can ask the decoder what it wants
@@ -422,33 +441,31 @@ bool ExportAudioSourceAsset(CAsset* const asset, const int setting)
 		// Clear the decode buffer just in case something goes wrong
 		memset(radDecodedData.data(), 0, radDecodedData.size() * 4);
 
-		//const auto decode_block = static_cast<decoder_new_f_t>(decoder->ASI_decode_block);
-
 		uint32_t bytesConsumed = 0;
 		uint32_t blockSize = 0;
 
 		// If we have not yet established the smallest that our input buffer can be, call getblocksize once to find out
 		if (minInputBufferSize == 0)
 		{
-			ASI_get_block_size(container.data(), stream_data.data(), 0, &bytesConsumed, &blockSize, &minInputBufferSize);
+			ASI_get_block_size(ctx.container.data(), stream_data.data(), 0, &bytesConsumed, &blockSize, &minInputBufferSize);
 
 			// Fetch the smallest possible amount of data to populate the input buffer.
 			// Future decode iterations will include this minimum buffer size in their read operation
 			stream_data.resize(minInputBufferSize);
-			ReadAudioStream(stream_data.data(), stream_data.size(), &userData);
+			ReadAudioStream(stream_data.data(), stream_data.size(), &ctx.userData);
 		}
 
 		// Make a call to the decoder to find out how much data it wants for the next decode
-		ASI_get_block_size(container.data(), stream_data.data(), stream_data.size(), &bytesConsumed, &blockSize, &minInputBufferSize);
+		ASI_get_block_size(ctx.container.data(), stream_data.data(), stream_data.size(), &bytesConsumed, &blockSize, &minInputBufferSize);
 
 		if (blockSize == 0xFFFF)
 			break;
 
 		const size_t oldSize = stream_data.size();
 		stream_data.resize(blockSize + minInputBufferSize);
-		ReadAudioStream(stream_data.data() + oldSize, stream_data.size() - oldSize, &userData);
+		ReadAudioStream(stream_data.data() + oldSize, stream_data.size() - oldSize, &ctx.userData);
 
-		ASI_get_block_size(container.data(), stream_data.data(), stream_data.size(), &bytesConsumed, &blockSize, &minInputBufferSize);
+		ASI_get_block_size(ctx.container.data(), stream_data.data(), stream_data.size(), &bytesConsumed, &blockSize, &minInputBufferSize);
 
 		// if we have now got a valid decode input buffer
 		if (blockSize != 0xFFFF)
@@ -456,13 +473,10 @@ bool ExportAudioSourceAsset(CAsset* const asset, const int setting)
 			uint32_t decodeBytesConsumed = 0;
 			uint32_t samplesDecoded = 0;
 
-			ASI_decode_block(container.data(), stream_data.data(), stream_data.size(), radDecodedData.data(), radDecodedData.size() * sizeof(float), &decodeBytesConsumed, &samplesDecoded);
+			ASI_decode_block(ctx.container.data(), stream_data.data(), stream_data.size(), radDecodedData.data(), radDecodedData.size() * sizeof(float), &decodeBytesConsumed, &samplesDecoded);
 
-			if (decodeBytesConsumed == 0)
-			{
-				printf("Finished decoding.\n");
-				//break;
-			}
+			// don't run past the end of the source if the decoder gives us more than the header said there would be
+			samplesDecoded = static_cast<uint32_t>(std::min(static_cast<size_t>(samplesDecoded), std::min(samplesCount - totalFramesDecoded, static_cast<size_t>(ctx.maxSamplesPerDecode))));
 
 			// The decoder provides us with a non-interleaved buffer which means that
 			// each channel's data is separate out into separate locations within the decode buffer
@@ -476,37 +490,24 @@ bool ExportAudioSourceAsset(CAsset* const asset, const int setting)
 			// and decide how to process the audio immediately after decoding
 			for (int channelIdx = 0; channelIdx < channels; ++channelIdx)
 			{
-				const float* const channelSampleBuffer = radDecodedData.data() + (parsedMetadata.maxSamplesPerDecode * channelIdx);
+				const float* const channelSampleBuffer = radDecodedData.data() + (ctx.maxSamplesPerDecode * channelIdx);
 
 				for (uint32_t sampleIdx = 0; sampleIdx < samplesDecoded; ++sampleIdx)
 				{
 					// Index in the output buffer from which the channels of this sample begin
-					const size_t outputIdx = static_cast<size_t>(channels) * (sampleIdx + totalFramesDecoded);
+					const size_t outputIdx = static_cast<size_t>(channels) * sampleIdx;
 
 					outputBuffer[outputIdx + channelIdx] = channelSampleBuffer[sampleIdx];
 				}
 			}
 
+			blockFunc(outputBuffer, samplesDecoded);
+
 			// Add number of samples decoded to the total to keep track of when we are done decoding the whole thing
 			totalFramesDecoded += samplesDecoded;
 
-			const size_t unconsumedInputBytes = stream_data.size() - decodeBytesConsumed;
-
-			// Allocate temporary buffer to store the unconsumed input bytes until the main input buffer can be resized
-			char* tempBuffer = new char[unconsumedInputBytes];
-
-			// Copy unconsumed bytes to the temporary buffer
-			memcpy(tempBuffer, stream_data.data() + decodeBytesConsumed, unconsumedInputBytes);
-
-			// Resize the input buffer to the size of the temporary buffer
-			stream_data.resize(unconsumedInputBytes);
-
-			// Copy the bytes from the temporary buffer to the actual input buffer
-			memcpy(stream_data.data(), tempBuffer, stream_data.size());
-
-			// Release the temporary buffer
-			delete[] tempBuffer;
-			tempBuffer = nullptr;
+			// Move the unconsumed input bytes to the front of the input buffer
+			stream_data.erase(stream_data.begin(), stream_data.begin() + std::min(static_cast<size_t>(decodeBytesConsumed), stream_data.size()));
 		}
 		else
 		{
@@ -516,208 +517,235 @@ bool ExportAudioSourceAsset(CAsset* const asset, const int setting)
 
 	}
 
-	StreamIO outFile(exportPath, eStreamIOMode::Write);
+	// pad with silence if the decoder stopped early, the output is always as long as the source header says
+	if (totalFramesDecoded < samplesCount && ctx.maxSamplesPerDecode > 0u)
+	{
+		memset(outputBuffer, 0, ctx.interleavedData.size() * sizeof(float));
 
-	WAVEHEADER hdr;
+		while (totalFramesDecoded < samplesCount)
+		{
+			const uint32_t silentFrames = static_cast<uint32_t>(std::min(samplesCount - totalFramesDecoded, static_cast<size_t>(ctx.maxSamplesPerDecode)));
 
+			blockFunc(outputBuffer, silentFrames);
+			totalFramesDecoded += silentFrames;
+		}
+	}
+}
 
-	outFile.write(hdr);
-	outFile.write(reinterpret_cast<char*>(interleavedBuffer.data()), interleavedBuffer.size() * sizeof(float));
+bool ExportAudioSourceAsset(CAsset* const asset, const int setting)
+{
+	CMilesAudioAsset* audioAsset = static_cast<CMilesAudioAsset*>(asset);
+	CMilesAudioBank* audioBank = asset->GetContainerFile<CMilesAudioBank>();
 
-	const uint64_t DataSize = interleavedBuffer.size() * sizeof(float);
-	hdr.size = static_cast<long>(DataSize + 36);
+	// Create exported path + asset path.
+	std::filesystem::path exportPath = g_ExportSettings.GetExportDirectory();// std::filesystem::current_path().append(EXPORT_DIRECTORY_NAME);
+	const std::filesystem::path asrcPath(audioAsset->GetAssetName());
 
-	hdr.fmt.channels = channels;
-	hdr.fmt.sampleRate = sampleRate;
-	hdr.fmt.blockAlign = static_cast<uint16_t>(DataSize / samplesCount);
-	hdr.fmt.bitsPerSample = static_cast<uint16_t>(((DataSize * 8) / samplesCount) / channels);
+	// truncate paths?
+	if (g_ExportSettings.exportPathsFull)
+		exportPath.append(asrcPath.parent_path().string());
+	else
+		exportPath.append(PATH_PREFIX_ASRC);
 
-	hdr.data.chunkSize = static_cast<long>(DataSize);
+	if (!CreateDirectories(exportPath))
+	{
+		assertm(false, "Failed to create asset type directory.");
+		return false;
+	}
 
-	hdr.fmt.avgBytesPerSecond = hdr.fmt.blockAlign * sampleRate;
+	exportPath.append(asrcPath.filename().string());
 
-	outFile.seek(0);
-	outFile.write(hdr);
-	outFile.close();
+	const bool exportFlac = setting == eAudioExportSetting::AUDIO_FLAC_16 || setting == eAudioExportSetting::AUDIO_FLAC_24;
+	exportPath.replace_extension(exportFlac ? "flac" : "wav");
 
-	return true;
-}
+	// one per export thread, so the decoder buffers get reused between sources
+	thread_local MilesDecodeContext_t decodeContext;
 
-// Audio preview system
-#include <core/render/preview/audio_preview.h>
+	if (!OpenAudioSource(audioAsset, decodeContext))
+		return false;
 
-struct DecodedAudioData_t
-{
-	std::vector<float> samples;
-	uint32_t sampleRate;
-	uint16_t channels;
-	bool valid;
-};
+	// blocks are written out as they are decoded
+	if (exportFlac)
+	{
+		const uint8_t bitsPerSample = setting == eAudioExportSetting::AUDIO_FLAC_24 ? 24u : 16u;
 
-static DecodedAudioData_t* g_pCurrentPreviewData = nullptr;
+		CFlacFileWriter flacWriter;
+		if (!flacWriter.Open(exportPath, decodeContext.channels, decodeContext.sampleRate, bitsPerSample, g_ExportSettings.exportFlacCompressionLevel, audioAsset->GetAssetName().c_str()))
+		{
+			Log("MILES: Failed to open \"%s\" for writing.\n", exportPath.string().c_str());
+			return false;
+		}
 
-bool DecodeAudioForPreview(CAsset* const asset, DecodedAudioData_t& outData)
-{
-	outData.valid = false;
+		DecodeAudioSource(decodeContext, [&flacWriter](const float* const samples, const uint32_t frameCount)
+			{
+				flacWriter.WriteSamples(samples, frameCount);
+			});
 
-	CMilesAudioAsset* audioAsset = static_cast<CMilesAudioAsset*>(asset);
-	CMilesAudioBank* audioBank = asset->GetContainerFile<CMilesAudioBank>();
+		flacWriter.Close();
+	}
+	else
+	{
+		const eWaveSampleFormat sampleFormat = setting == eAudioExportSetting::AUDIO_WAV_PCM16 ? eWaveSampleFormat::WAV_PCM16 : eWaveSampleFormat::WAV_FLOAT32;
+
+		CWaveFileWriter waveWriter;
+		if (!waveWriter.Open(exportPath, decodeContext.channels, decodeContext.sampleRate, sampleFormat))
+		{
+			Log("MILES: Failed to open \"%s\" for writing.\n", exportPath.string().c_str());
+			return false;
+		}
 
-	MilesSource_t* source = reinterpret_cast<MilesSource_t*>(audioAsset->GetAssetData());
+		DecodeAudioSource(decodeContext, [&waveWriter](const float* const samples, const uint32_t frameCount)
+			{
+				waveWriter.WriteSamples(samples, frameCount);
+			});
 
-	// get the bank's path and replace the filename
-	// with the stream file name that we've just put together
-	std::filesystem::path streamPath(audioBank->GetFilePath());
-	streamPath.replace_filename(audioAsset->GetContainerFileName());
+		waveWriter.Close();
+	}
 
-	// Data Reading
-	StreamIO streamFile(streamPath, eStreamIOMode::Read);
+	audioBank->AddDecodedAudio(decodeContext.sampleCount, decodeContext.sampleRate);
 
-	MilesStreamHeader_t streamFileHeader = streamFile.read<MilesStreamHeader_t>();
+	return true;
+}
 
-	streamFile.seek(source->streamHeaderOffset);
+void RunFlacExportVerify()
+{
+	const std::filesystem::path tempPath = std::filesystem::temp_directory_path() / "rsx_flacverify.flac";
 
-	char* sourceStreamHeaderData = new char[source->streamHeaderSize];
+	static constexpr uint8_t s_bitDepths[] = { 16u, 24u };
 
-	streamFile.read(sourceStreamHeaderData, source->streamHeaderSize);
+	MilesDecodeContext_t decodeContext;
+	std::vector<float> decodedSamples;
+	std::vector<int32_t> expectedSamples;
+	FlacDecodedStream_t stream;
 
-	MilesASIDecoder_t* decoder = nullptr;
+	size_t numSources = 0ull;
+	size_t numChecked = 0ull;
+	size_t numFailed = 0ull;
+	uint64_t totalSamples = 0ull;
 
-	switch (*(uint32_t*)sourceStreamHeaderData)
-	{
-	case 'RADA': // Rad Audio
-		decoder = GetRadAudioDecoder();
-		break;
-	case 'BCF1': // Bink Audio
-		decoder = nullptr;
-		break;
-	default:
-	{
-		decoder = nullptr;
-		break;
-	}
-	}
+	const auto startTime = std::chrono::high_resolution_clock::now();
 
-	if (!decoder)
+	for (const CGlobalAssetData::AssetLookup_t& it : g_assetData.v_assets)
 	{
-		delete[] sourceStreamHeaderData;
-		return false;
-	}
+		if (it.m_asset->GetAssetContainerType() != CAsset::ContainerType::AUDIO)
+			continue;
 
-	struct {
-		uint32_t minSizeToOpenStream;
-		uint32_t maxBlockSize;
-		uint32_t maxSamplesPerDecode;
-		uint32_t decodeFormat;
-	} parsedMetadata;
+		CMilesAudioAsset* const audioAsset = static_cast<CMilesAudioAsset*>(it.m_asset);
 
-	const auto ASI_stream_parse_metadata = static_cast<ASI_parse_metadata_f>(decoder->ASI_stream_parse_metadata);
-	const auto ASI_open_stream = static_cast<ASI_open_stream_f>(decoder->ASI_open_stream);
-	const auto ASI_notify_seek = static_cast<ASI_notify_seek_f>(decoder->ASI_notify_seek);
-	const auto ASI_decode_block = static_cast<ASI_decode_block_f>(decoder->ASI_decode_block);
-	const auto ASI_get_block_size = static_cast<ASI_get_block_size_f>(decoder->ASI_get_block_size);
+		if (!OpenAudioSource(audioAsset, decodeContext))
+			continue;
 
-	uint16_t channels;
-	uint32_t sampleRate;
-	uint32_t samplesCount;
-	ASI_stream_parse_metadata(sourceStreamHeaderData, source->streamHeaderSize, &channels, &sampleRate, &samplesCount, (int*)&parsedMetadata, nullptr);
+		decodedSamples.clear();
+		DecodeAudioSource(decodeContext, [&decodedSamples, &decodeContext](const float* const samples, const uint32_t frameCount)
+			{
+				decodedSamples.insert(decodedSamples.end(), samples, samples + (static_cast<size_t>(frameCount) * decodeContext.channels));
+			});
 
-	streamFile.seek(source->streamHeaderOffset);
+		numSources++;
 
-	std::vector<char> container(parsedMetadata.minSizeToOpenStream, 0);
+		const uint32_t frameCount = static_cast<uint32_t>(decodedSamples.size() / std::max(decodeContext.channels, static_cast<uint16_t>(1u)));
 
-	MilesASIUserData_t userData = {
-		&streamFile,
-		0,
-		source->streamHeaderSize,
-		streamFileHeader.streamDataOffset + source->streamDataOffset
-	};
+		for (const uint8_t bitsPerSample : s_bitDepths)
+		{
+			numChecked++;
 
-	size_t containerSize = container.size();
-	ASI_open_stream(container.data(), &containerSize, ReadAudioStream, &userData);
+			// the writer is fed in the same block sizes as an export, a fresh dither gives the same integers it stored
+			{
+				CFlacFileWriter flacWriter;
+				if (!flacWriter.Open(tempPath, decodeContext.channels, decodeContext.sampleRate, bitsPerSample, g_ExportSettings.exportFlacCompressionLevel, audioAsset->GetAssetName().c_str()))
+				{
+					printf("FLAC VERIFY: %s (%u-bit): failed to open \"%s\" for writing\n", audioAsset->GetAssetName().c_str(), bitsPerSample, tempPath.string().c_str());
+					numFailed++;
+					continue;
+				}
 
-	ASI_notify_seek(container.data());
+				const size_t blockSize = static_cast<size_t>(std::max(decodeContext.maxSamplesPerDecode, 1u));
+				for (size_t frame = 0; frame < frameCount; frame += blockSize)
+					flacWriter.WriteSamples(decodedSamples.data() + (frame * decodeContext.channels), static_cast<uint32_t>(std::min(blockSize, frameCount - frame)));
 
-	userData.audioStreamSize = *(uint64_t*)(container.data() + 0x18) - source->streamHeaderSize;
+				flacWriter.Close();
+			}
 
-	// Allocate output buffer
-	outData.samples = std::vector<float>(channels * samplesCount);
-	float* outputBuffer = outData.samples.data();
+			CAudioDither dither;
+			expectedSamples.resize(decodedSamples.size());
+			for (size_t i = 0; i < decodedSamples.size(); ++i)
+				expectedSamples[i] = FlacQuantiseSample(decodedSamples[i], bitsPerSample, dither);
 
-	std::vector<char> stream_data;
-	std::vector<float> radDecodedData(channels * parsedMetadata.maxSamplesPerDecode);
+			std::string error;
+			if (!FlacDecodeFile(tempPath, stream, error))
+			{
+				printf("FLAC VERIFY: %s (%u-bit): %s\n", audioAsset->GetAssetName().c_str(), bitsPerSample, error.c_str());
+				numFailed++;
+				continue;
+			}
 
-	size_t totalFramesDecoded = 0;
-	uint32_t minInputBufferSize = 0;
+			if (stream.channels != decodeContext.channels || stream.sampleRate != decodeContext.sampleRate || stream.bitsPerSample != bitsPerSample || stream.frameCount != frameCount)
+			{
+				printf("FLAC VERIFY: %s (%u-bit): format mismatch, %u ch %u Hz %u-bit %llu samples, expected %u ch %u Hz %u-bit %u samples\n", audioAsset->GetAssetName().c_str(), bitsPerSample,
+					stream.channels, stream.sampleRate, stream.bitsPerSample, stream.frameCount, decodeContext.channels, decodeContext.sampleRate, bitsPerSample, frameCount);
+				numFailed++;
+				continue;
+			}
 
-	while (totalFramesDecoded < samplesCount)
-	{
-		memset(radDecodedData.data(), 0, radDecodedData.size() * 4);
+			const auto mismatch = std::mismatch(expectedSamples.begin(), expectedSamples.end(), stream.samples.begin());
+			if (mismatch.first != expectedSamples.end())
+			{
+				const size_t idx = static_cast<size_t>(mismatch.first - expectedSamples.begin());
 
-		uint32_t bytesConsumed = 0;
-		uint32_t blockSize = 0;
+				printf("FLAC VERIFY: %s (%u-bit): sample %llu channel %llu decoded as %d, expected %d\n", audioAsset->GetAssetName().c_str(), bitsPerSample,
+					idx / decodeContext.channels, idx % decodeContext.channels, *mismatch.second, *mismatch.first);
+				numFailed++;
+				continue;
+			}
 
-		if (minInputBufferSize == 0)
-		{
-			ASI_get_block_size(container.data(), stream_data.data(), 0, &bytesConsumed, &blockSize, &minInputBufferSize);
-			stream_data.resize(minInputBufferSize);
-			ReadAudioStream(stream_data.data(), stream_data.size(), &userData);
+			totalSamples += frameCount;
 		}
+	}
 
-		ASI_get_block_size(container.data(), stream_data.data(), stream_data.size(), &bytesConsumed, &blockSize, &minInputBufferSize);
+	std::error_code ec;
+	std::filesystem::remove(tempPath, ec);
 
-		if (blockSize == 0xFFFF)
-			break;
+	if (numSources == 0ull)
+		return;
 
-		const size_t oldSize = stream_data.size();
-		stream_data.resize(blockSize + minInputBufferSize);
-		ReadAudioStream(stream_data.data() + oldSize, stream_data.size() - oldSize, &userData);
+	const double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - startTime).count();
 
-		ASI_get_block_size(container.data(), stream_data.data(), stream_data.size(), &bytesConsumed, &blockSize, &minInputBufferSize);
+	printf("FLAC VERIFY: %llu of %llu round trips matched (%llu sources at 16 and 24-bit, level %u), %llu samples per channel in %.1f ms\n",
+		numChecked - numFailed, numChecked, numSources, g_ExportSettings.exportFlacCompressionLevel, totalSamples, seconds * 1000.0);
+}
 
-		if (blockSize != 0xFFFF)
-		{
-			uint32_t decodeBytesConsumed = 0;
-			uint32_t samplesDecoded = 0;
+// Audio preview system
+#include <core/render/preview/audio_preview.h>
+
+struct DecodedAudioData_t
+{
+	std::vector<float> samples;
+	uint32_t sampleRate;
+	uint16_t channels;
+	bool valid;
+};
 
-			ASI_decode_block(container.data(), stream_data.data(), stream_data.size(), radDecodedData.data(), radDecodedData.size() * sizeof(float), &decodeBytesConsumed, &samplesDecoded);
+static DecodedAudioData_t* g_pCurrentPreviewData = nullptr;
 
-			if (decodeBytesConsumed == 0)
-			{
-				// Finished decoding
-			}
+bool DecodeAudioForPreview(CAsset* const asset, DecodedAudioData_t& outData)
+{
+	outData.valid = false;
 
-			// Interleave channels
-			for (int channelIdx = 0; channelIdx < channels; ++channelIdx)
-			{
-				const float* const channelSampleBuffer = radDecodedData.data() + (parsedMetadata.maxSamplesPerDecode * channelIdx);
+	MilesDecodeContext_t decodeContext;
 
-				for (uint32_t sampleIdx = 0; sampleIdx < samplesDecoded; ++sampleIdx)
-				{
-					const size_t outputIdx = static_cast<size_t>(channels) * (sampleIdx + totalFramesDecoded);
-					outputBuffer[outputIdx + channelIdx] = channelSampleBuffer[sampleIdx];
-				}
-			}
+	if (!OpenAudioSource(static_cast<CMilesAudioAsset*>(asset), decodeContext))
+		return false;
 
-			totalFramesDecoded += samplesDecoded;
+	outData.samples.clear();
+	outData.samples.reserve(static_cast<size_t>(decodeContext.channels) * decodeContext.sampleCount);
 
-			const size_t unconsumedInputBytes = stream_data.size() - decodeBytesConsumed;
-			char* tempBuffer = new char[unconsumedInputBytes];
-			memcpy(tempBuffer, stream_data.data() + decodeBytesConsumed, unconsumedInputBytes);
-			stream_data.resize(unconsumedInputBytes);
-			memcpy(stream_data.data(), tempBuffer, stream_data.size());
-			delete[] tempBuffer;
-		}
-		else
+	DecodeAudioSource(decodeContext, [&outData, &decodeContext](const float* const samples, const uint32_t frameCount)
 		{
-			break;
-		}
-	}
-
-	delete[] sourceStreamHeaderData;
+			outData.samples.insert(outData.samples.end(), samples, samples + (static_cast<size_t>(frameCount) * decodeContext.channels));
+		});
 
-	outData.sampleRate = sampleRate;
-	outData.channels = channels;
+	outData.sampleRate = decodeContext.sampleRate;
+	outData.channels = decodeContext.channels;
 	outData.valid = true;
 
 	return true;
@@ -842,7 +870,7 @@ void InitAudioSourceAssetType()
 		.loadFunc = nullptr,
 		.postLoadFunc = nullptr,
 		.previewFunc = nullptr,
-		.e = { ExportAudioSourceAsset, 0, nullptr, 0ull },
+		.e = { ExportAudioSourceAsset, 0, s_AudioExportSettingNames, ARRSIZE(s_AudioExportSettingNames) },
 	};
 
 	REGISTER_TYPE(type);
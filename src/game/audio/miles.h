@@ -13,7 +13,8 @@ union OffsetPtr_t
 
 struct MilesASIUserData_t
 {
-	StreamIO* streamReader;
+	const CMappedFile* streamFile;
+	uint64_t readOffset; // current position in the stream file
 	uint64_t dataRead;
 	uint64_t headerSize;
 	uint64_t audioStreamOffset;
@@ -44,6 +45,42 @@ typedef size_t(*ASI_stream_seek_direct_f)(const char*, size_t, size_t, size_t*,
 typedef size_t(*ASI_decode_block_f)(void*, const char*, size_t, void*, size_t, uint32_t*, uint32_t*);
 typedef void(*ASI_get_block_size_f)(void*, const char*, size_t, uint32_t*, uint32_t*, uint32_t*);
 
+// state for decoding a source, along with scratch buffers
+// each export thread keeps one around so buffers only get reallocated when a source needs more than the previous ones did
+struct MilesDecodeContext_t
+{
+	MilesASIDecoder_t* decoder;
+	MilesASIUserData_t userData;
+
+	std::vector<char> container; // decoder state
+	std::vector<char> inputData; // encoded data waiting to be decoded
+	std::vector<float> blockData; // non-interleaved output of one decode call
+	std::vector<float> interleavedData; // output of one decode call, interleaved
+
+	uint32_t maxSamplesPerDecode;
+
+	uint16_t channels;
+	uint32_t sampleRate;
+	uint32_t sampleCount;
+};
+
+enum eAudioExportSetting : int
+{
+	AUDIO_WAV_FLOAT,
+	AUDIO_WAV_PCM16,
+	AUDIO_FLAC_16,
+	AUDIO_FLAC_24,
+
+	AUDIO_COUNT,
+};
+
+static const char* s_AudioExportSettingNames[] =
+{
+	"WAV (32-bit Float)",
+	"WAV (16-bit PCM)",
+	"FLAC (16-bit)",
+	"FLAC (24-bit)",
+};
 
 // it seems that this struct has never changed.... yet...
 struct MilesStreamHeader_t
@@ -304,7 +341,7 @@ static_assert(offsetof(MilesBankHeader_v45_t, unk_offset_38) == 0x38);
 class CMilesAudioBank : public CAssetContainer
 {
 public:
-	CMilesAudioBank() {};
+	CMilesAudioBank() : m_decodedAudioTime(0ull) {};
 	~CMilesAudioBank() = default;
 
 	const CAsset::ContainerType GetContainerType() const
@@ -327,6 +364,23 @@ public:
 	}
 
 	bool IsValidSource(const MilesSource_t* source) const;
+
+	// stream files are mapped for as long as the bank is loaded, returns nullptr if the file wasn't found when the bank was parsed
+	const CMappedFile* GetStreamFile(const std::string& streamFileName) const
+	{
+		const auto it = m_streamFiles.find(streamFileName);
+		return it != m_streamFiles.end() ? it->second.get() : nullptr;
+	}
+
+	// length of the audio that has been decoded from this bank
+	void AddDecodedAudio(const uint32_t sampleCount, const uint32_t sampleRate)
+	{
+		if (sampleRate)
+			m_decodedAudioTime.fetch_add((static_cast<uint64_t>(sampleCount) * 1000000ull) / sampleRate, std::memory_order_relaxed);
+	}
+
+	const double GetDecodedAudioSeconds() const { return static_cast<double>(m_decodedAudioTime.load(std::memory_order_relaxed)) / 1000000.0; }
+
 private:
 
 	void DiscoverStreamingFiles();
@@ -338,6 +392,11 @@ private:
 	std::map<uint16_t, uint32_t> m_localisedStreamStates;
 	uint32_t m_streamStates;
 
+	// valid stream files for this bank, by file name
+	std::unordered_map<std::string, std::unique_ptr<CMappedFile>> m_streamFiles;
+
+	std::atomic<uint64_t> m_decodedAudioTime; // microseconds
+
 	std::shared_ptr<char[]> m_fileBuf;
 
 	std::vector<const char*> m_languageNames;
@@ -460,6 +519,9 @@ private:
 // Decoders
 MilesASIDecoder_t* GetRadAudioDecoder();
 
+// encodes every loaded audio source to flac at 16 and 24-bit, decodes the files again and checks the samples match what the encoder was given
+void RunFlacExportVerify();
+
 // Audio Preview
 bool PlayAudioPreview(CAsset* const asset);
 void StopAudioPreview();
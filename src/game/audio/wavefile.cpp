@@ -0,0 +1,90 @@
+#include <pch.h>
+#include <game/audio/wavefile.h>
+
+bool CWaveFileWriter::Open(const std::filesystem::path& path, const uint16_t channels, const uint32_t sampleRate, const eWaveSampleFormat format)
+{
+	Close();
+
+	if (!m_file.open(path.string(), eStreamIOMode::Write))
+		return false;
+
+	m_dataSize = 0ull;
+	m_channels = channels;
+	m_sampleRate = sampleRate;
+	m_format = format;
+	m_open = true;
+
+	// sizes get filled in on close
+	WriteHeader();
+
+	return true;
+}
+
+void CWaveFileWriter::WriteSamples(const float* const samples, const uint32_t frameCount)
+{
+	if (!m_open || frameCount == 0u)
+		return;
+
+	const size_t sampleCount = static_cast<size_t>(frameCount) * m_channels;
+
+	switch (m_format)
+	{
+	case eWaveSampleFormat::WAV_FLOAT32:
+	{
+		m_file.write(reinterpret_cast<const char*>(samples), sampleCount * sizeof(float));
+		m_dataSize += sampleCount * sizeof(float);
+
+		break;
+	}
+	case eWaveSampleFormat::WAV_PCM16:
+	{
+		m_convertBuffer.resize(sampleCount);
+
+		for (size_t i = 0; i < sampleCount; ++i)
+		{
+			const float scaled = (samples[i] * 32767.0f) + m_dither.Next();
+
+			m_convertBuffer[i] = static_cast<int16_t>(std::clamp(std::lround(scaled), -32768l, 32767l));
+		}
+
+		m_file.write(reinterpret_cast<const char*>(m_convertBuffer.data()), sampleCount * sizeof(int16_t));
+		m_dataSize += sampleCount * sizeof(int16_t);
+
+		break;
+	}
+	}
+}
+
+void CWaveFileWriter::Close()
+{
+	if (!m_open)
+		return;
+
+	m_file.seek(0);
+	WriteHeader();
+	m_file.close();
+
+	m_open = false;
+}
+
+void CWaveFileWriter::WriteHeader()
+{
+	const uint16_t bytesPerSample = m_format == eWaveSampleFormat::WAV_PCM16 ? sizeof(int16_t) : sizeof(float);
+
+	// riff sizes are 32-bit, anything bigger than this won't play anywhere anyway
+	const uint32_t dataSize = static_cast<uint32_t>(std::min(m_dataSize, static_cast<uint64_t>(UINT32_MAX - 36u)));
+
+	WAVEHEADER hdr;
+	hdr.size = static_cast<long>(dataSize + 36u);
+
+	hdr.fmt.formatTag = m_format == eWaveSampleFormat::WAV_PCM16 ? 1 : 3; // WAVE_FORMAT_PCM : WAVE_FORMAT_IEEE_FLOAT
+	hdr.fmt.channels = m_channels;
+	hdr.fmt.sampleRate = m_sampleRate;
+	hdr.fmt.blockAlign = static_cast<uint16_t>(bytesPerSample * m_channels);
+	hdr.fmt.bitsPerSample = static_cast<uint16_t>(bytesPerSample * 8u);
+	hdr.fmt.avgBytesPerSecond = hdr.fmt.blockAlign * m_sampleRate;
+
+	hdr.data.chunkSize = static_cast<long>(dataSize);
+
+	m_file.write(hdr);
+}
@@ -26,4 +26,75 @@ struct WAVEHEADER
 
 	FORMATCHUNK fmt;
 	DATACHUNK data;
-};
\ No newline at end of file
+};
+
+// triangular (tpdf) dither noise of +-1 lsb, used when quantising float samples to integers.
+// hides the quantisation error in noise instead of leaving it correlated with the signal
+class CAudioDither
+{
+public:
+	CAudioDither() : m_state(0x9E3779B9u) {};
+
+	inline const float Next()
+	{
+		return NextUniform() - NextUniform();
+	}
+
+private:
+	// uniform random value in [0, 1)
+	inline const float NextUniform()
+	{
+		// xorshift32
+		m_state ^= m_state << 13;
+		m_state ^= m_state >> 17;
+		m_state ^= m_state << 5;
+
+		return static_cast<float>(m_state >> 8) * (1.0f / 16777216.0f);
+	}
+
+	uint32_t m_state;
+};
+
+enum class eWaveSampleFormat : uint8_t
+{
+	WAV_FLOAT32, // 32-bit ieee float, exactly what the decoders output
+	WAV_PCM16, // 16-bit integer pcm, dithered
+};
+
+// writes a wave file as decoded samples come in so the whole clip never has to be held in memory.
+// the header is written up front and its sizes are patched in once the file is closed
+class CWaveFileWriter
+{
+public:
+	CWaveFileWriter() : m_dataSize(0ull), m_channels(0u), m_sampleRate(0u), m_format(eWaveSampleFormat::WAV_FLOAT32), m_open(false) {};
+	~CWaveFileWriter()
+	{
+		Close();
+	}
+
+	CWaveFileWriter(const CWaveFileWriter&) = delete;
+	CWaveFileWriter& operator=(const CWaveFileWriter&) = delete;
+
+	bool Open(const std::filesystem::path& path, const uint16_t channels, const uint32_t sampleRate, const eWaveSampleFormat format);
+
+	// samples are interleaved, frameCount is the number of samples per channel
+	void WriteSamples(const float* const samples, const uint32_t frameCount);
+
+	void Close();
+
+	inline const bool IsOpen() const { return m_open; }
+
+private:
+	void WriteHeader();
+
+	StreamIO m_file;
+	std::vector<int16_t> m_convertBuffer; // reused for every block when converting to pcm
+
+	uint64_t m_dataSize;
+	uint16_t m_channels;
+	uint32_t m_sampleRate;
+	eWaveSampleFormat m_format;
+
+	CAudioDither m_dither;
+	bool m_open;
+};
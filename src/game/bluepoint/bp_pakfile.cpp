@@ -1,6 +1,9 @@
 #include <pch.h>
 #include <core/utils/utils_general.h>
 #include <game/bluepoint/bp_pakfile.h>
+#include <thirdparty/imgui/misc/imgui_utility.h>
+
+#include <chrono>
 
 #if defined(XB_XCOMPRESS)
 #include <thirdparty/xcompress/xcompress.h>
@@ -10,6 +13,47 @@
 
 extern ExportSettings_t g_ExportSettings;
 
+#if defined(XB_XCOMPRESS)
+// chunks are compressed independently, so each thread keeps a context around and resets it between chunks
+struct BluepointDecompressionContext_t
+{
+	XMEMDECOMPRESSION_CONTEXT ctx = nullptr;
+	int windowSize = 0;
+
+	~BluepointDecompressionContext_t()
+	{
+		if (ctx)
+			XMemDestroyDecompressionContext(ctx);
+	}
+
+	XMEMDECOMPRESSION_CONTEXT Get(const int maxChunkSize)
+	{
+		if (ctx && windowSize == maxChunkSize)
+		{
+			XMemResetDecompressionContext(ctx);
+			return ctx;
+		}
+
+		if (ctx)
+			XMemDestroyDecompressionContext(ctx);
+
+		XMEMCODEC_PARAMETERS_LZX params;
+		params.Flags = 0;
+		params.WindowSize = maxChunkSize;
+		params.CompressionPartitionSize = 524288;
+
+		if (FAILED(XMemCreateDecompressionContext(XMEMCODEC_LZX, &params, 0, &ctx)))
+			ctx = nullptr;
+
+		windowSize = maxChunkSize;
+
+		return ctx;
+	}
+};
+
+static thread_local BluepointDecompressionContext_t s_decompressionContext;
+#endif
+
 bool CBluepointPakfile::ParseFromFile()
 {
 	const std::filesystem::path& filePath = GetFilePath();
@@ -50,11 +94,23 @@ bool CBluepointPakfile::ParseFromFile()
 		m_chunkSize = hdr->chunkSize;
 		m_chunks.reserve(hdr->chunkCount);
 
+		if (m_chunkSize <= 0)
+			return false;
+
 		char* ptrToCurChunk = hdr->pChunkData();
+		const char* const bufEnd = m_Buf.get() + fileSize;
 
 		for (int i = 0; i < hdr->chunkCount; i++)
 		{
 			const int chunkSize = *hdr->pChunkSize(i);
+
+			// chunks get decoded on other threads, make sure none of them read past the end of the file
+			if (chunkSize < 0 || chunkSize > bufEnd - ptrToCurChunk)
+			{
+				assertm(false, "chunk data out of bounds");
+				return false;
+			}
+
 			const Chunk_t chunk{ .data = ptrToCurChunk, .dataSize = chunkSize, .pad = 0 };
 
 			m_chunks.emplace_back(chunk);
@@ -62,6 +118,22 @@ bool CBluepointPakfile::ParseFromFile()
 			ptrToCurChunk += chunkSize;
 		}
 
+		// count the files that read each compressed chunk, so the cache knows when a decoded chunk is no longer needed
+		m_chunkCache.resize(m_chunks.size());
+
+		for (int i = 0; i < m_fileCount; i++)
+		{
+			const bpkfile_v6_t* const file = hdr->pFile(i);
+
+			if (!file->IsCompressed() || file->chunkStart < 0)
+				continue;
+
+			const int lastChunk = std::min(file->chunkStart + ChunkCountForSize(file->decompressedSize, m_chunkSize), hdr->chunkCount);
+
+			for (int chunk = file->chunkStart; chunk < lastChunk; chunk++)
+				m_chunkCache[chunk].numPendingUsers++;
+		}
+
 		return true;
 	}
 	default:
@@ -72,6 +144,202 @@ bool CBluepointPakfile::ParseFromFile()
 	}
 }
 
+bool CBluepointPakfile::DecodeChunk(const int idx, const int decodedSize, DecodedChunk_t& out) const
+{
+#if defined(XB_XCOMPRESS)
+	const Chunk_t& chunk = m_chunks.at(idx);
+
+	const XMEMDECOMPRESSION_CONTEXT ctx = s_decompressionContext.Get(m_chunkSize);
+	if (!ctx)
+		return false;
+
+	std::shared_ptr<char[]> data = MemoryTracker::AllocSharedBuffer(eMemoryCategory::MEM_BP_CHUNKS, m_chunkSize);
+
+	SIZE_T dataSize = static_cast<SIZE_T>(m_chunkSize);
+	if (FAILED(XMemDecompress(ctx, data.get(), &dataSize, chunk.data, chunk.dataSize)))
+		return false;
+
+	assertm(static_cast<int>(dataSize) >= decodedSize, "chunk decompressed to less data than expected");
+
+	out.data = std::move(data);
+	out.dataSize = static_cast<int>(dataSize);
+
+	return true;
+#else
+	UNUSED(idx);
+	UNUSED(decodedSize);
+	UNUSED(out);
+
+	return false;
+#endif
+}
+
+bool CBluepointPakfile::AcquireChunks(const int firstChunk, const int numChunks, const int decompressedSize, const bool compressed, std::vector<DecodedChunk_t>& out)
+{
+	out.clear();
+
+	if (firstChunk < 0 || numChunks < 0 || static_cast<size_t>(firstChunk) + numChunks > m_chunks.size())
+		return false;
+
+	out.resize(numChunks);
+
+#if defined(XB_XCOMPRESS)
+	if (!compressed)
+#else
+	UNUSED(compressed); // without xcompress, compressed chunks are passed through as stored
+	UNUSED(decompressedSize);
+#endif
+	{
+		// raw chunks are used in place, the aliased pointers keep the file buffer alive
+		for (int i = 0; i < numChunks; i++)
+		{
+			const Chunk_t& chunk = m_chunks[firstChunk + i];
+			out[i] = { std::shared_ptr<char[]>(m_Buf, chunk.data), chunk.dataSize };
+		}
+
+		return true;
+	}
+
+#if defined(XB_XCOMPRESS)
+	// take what's cached and claim the chunks nobody is decoding yet
+	std::vector<int> claimed;
+	{
+		std::lock_guard<std::mutex> lock(m_chunkCacheMutex);
+
+		for (int i = 0; i < numChunks; i++)
+		{
+			ChunkCacheEntry_t& entry = m_chunkCache[firstChunk + i];
+
+			if (entry.data)
+			{
+				out[i] = { entry.data, entry.dataSize };
+			}
+			else if (!entry.decoding)
+			{
+				entry.decoding = true;
+				claimed.push_back(i);
+			}
+		}
+	}
+
+	auto decodeChunk = [&](const int i) -> bool
+		{
+			const int decodedSize = std::min(m_chunkSize, decompressedSize - (i * m_chunkSize));
+
+			if (DecodeChunk(firstChunk + i, decodedSize, out[i]))
+				return true;
+
+			out[i] = {};
+			return false;
+		};
+
+	const uint32_t numThreads = CThread::GetNestedExportThreadBudget(static_cast<uint32_t>(claimed.size()));
+
+	ParallelFor(claimed.size(), numThreads, [&](const size_t i) { decodeChunk(claimed[i]); });
+
+	bool success = true;
+
+	std::unique_lock<std::mutex> lock(m_chunkCacheMutex);
+
+	for (const int i : claimed)
+	{
+		ChunkCacheEntry_t& entry = m_chunkCache[firstChunk + i];
+
+		entry.data = out[i].data;
+		entry.dataSize = out[i].dataSize;
+		entry.decoding = false;
+	}
+
+	if (!claimed.empty())
+		m_chunkDecoded.notify_all();
+
+	// the rest were being decoded for another file
+	for (int i = 0; i < numChunks; i++)
+	{
+		if (out[i].data)
+			continue;
+
+		ChunkCacheEntry_t& entry = m_chunkCache[firstChunk + i];
+
+		m_chunkDecoded.wait(lock, [&entry] { return !entry.decoding; });
+
+		if (entry.data)
+		{
+			out[i] = { entry.data, entry.dataSize };
+			continue;
+		}
+
+		// it failed to decode, or got evicted before we got to it
+		lock.unlock();
+		const bool decoded = decodeChunk(i);
+		lock.lock();
+
+		if (!decoded)
+			success = false;
+	}
+
+	return success;
+#endif
+}
+
+void CBluepointPakfile::ReleaseChunks(const int firstChunk, const int numChunks)
+{
+	std::lock_guard<std::mutex> lock(m_chunkCacheMutex);
+
+	const int lastChunk = std::min(firstChunk + numChunks, static_cast<int>(m_chunkCache.size()));
+
+	for (int i = std::max(firstChunk, 0); i < lastChunk; i++)
+	{
+		ChunkCacheEntry_t& entry = m_chunkCache[i];
+
+		// files exported more than once keep decoding the chunk again after the count runs out
+		entry.numPendingUsers = std::max(entry.numPendingUsers - 1, 0);
+
+		if (entry.numPendingUsers == 0)
+			entry.data.reset();
+	}
+}
+
+size_t CBluepointPakfile::EvictChunks(const size_t bytesToFree)
+{
+	std::lock_guard<std::mutex> lock(m_chunkCacheMutex);
+
+	size_t freedSize = 0ull;
+
+	for (ChunkCacheEntry_t& entry : m_chunkCache)
+	{
+		if (freedSize >= bytesToFree)
+			break;
+
+		// still being read by an export
+		if (!entry.data || entry.data.use_count() > 1)
+			continue;
+
+		entry.data.reset();
+		freedSize += static_cast<size_t>(m_chunkSize);
+	}
+
+	return freedSize;
+}
+
+static size_t EvictBluepointChunks(const size_t bytesToFree)
+{
+	size_t freedSize = 0ull;
+
+	for (CAssetContainer* const container : g_assetData.v_assetContainers)
+	{
+		if (freedSize >= bytesToFree)
+			break;
+
+		if (container->GetContainerType() != CAsset::ContainerType::BP_PAK)
+			continue;
+
+		freedSize += static_cast<CBluepointPakfile*>(container)->EvictChunks(bytesToFree - freedSize);
+	}
+
+	return freedSize;
+}
+
 void LoadBluepointWrappedFileAsset(CAssetContainer* container, CAsset* asset)
 {
 	UNUSED(container);
@@ -108,7 +376,7 @@ bool ExportBluepointWrappedFileAsset(CAsset* const asset, const int setting)
 	UNUSED(setting);
 
 	const CBluepointWrappedFile* const file = static_cast<const CBluepointWrappedFile* const>(asset);
-	const CBluepointPakfile* const pakfile = file->GetContainerFile<CBluepointPakfile>();
+	CBluepointPakfile* const pakfile = file->GetContainerFile<CBluepointPakfile>();
 
 	std::filesystem::path exportPath = g_ExportSettings.GetExportDirectory();
 	const std::filesystem::path filePath(file->GetAssetName());
@@ -134,50 +402,98 @@ bool ExportBluepointWrappedFileAsset(CAsset* const asset, const int setting)
 	if (!filePath.has_extension())
 		exportPath.replace_extension(".bin");
 
-	std::unique_ptr<char[]> fileBuf = std::make_unique<char[]>(file->GetDecompSize());
-	char* curpos = fileBuf.get();
+	std::vector<CBluepointPakfile::DecodedChunk_t> chunks;
+	if (!pakfile->AcquireChunks(file->GetFirstChunkIndex(), file->GetChunkCount(), file->GetDecompSize(), file->IsCompressed(), chunks))
+	{
+		assertm(false, "Failed to decode file chunks.");
+		pakfile->ReleaseChunks(file->GetFirstChunkIndex(), file->GetChunkCount());
+
+		return false;
+	}
+
+	StreamIO out;
+	if (!out.open(exportPath.string(), eStreamIOMode::Write))
+	{
+		assertm(false, "Failed to open file for write.");
+		pakfile->ReleaseChunks(file->GetFirstChunkIndex(), file->GetChunkCount());
 
-	const CBluepointPakfile::Chunk_t* const firstChunk = pakfile->GetChunk(file->GetFirstChunkIndex());
+		return false;
+	}
 
-#ifdef XB_XCOMPRESS
-	XMEMCOMPRESSION_CONTEXT ctx = nullptr;
+	// the file is written straight out of the decoded chunks
+	size_t remainingSize = static_cast<size_t>(file->GetDecompSize());
 
-	// [rika]: only create context if we need it
-	if (file->IsCompressed())
+	for (const CBluepointPakfile::DecodedChunk_t& chunk : chunks)
 	{
-		XMEMCODEC_PARAMETERS_LZX params;
-		params.Flags = 0;
-		params.WindowSize = pakfile->GetMaxChunkSize();
-		params.CompressionPartitionSize = 524288;
+		const size_t chunkSize = std::min(remainingSize, static_cast<size_t>(chunk.dataSize));
 
-		XMemCreateDecompressionContext(XMEMCODEC_LZX, &params, 0, &ctx);
+		out.write(chunk.data.get(), chunkSize);
+		remainingSize -= chunkSize;
 	}
-#endif
 
-	for (int i = 0; i < file->GetChunkCount(); i++)
+	// chunks passed through still compressed can come up short, the rest of the file is zeroes
+	if (remainingSize)
 	{
-		const CBluepointPakfile::Chunk_t* const chunk = firstChunk + i;
+		const std::unique_ptr<char[]> padding = std::make_unique<char[]>(remainingSize);
+		out.write(padding.get(), remainingSize);
+	}
 
-#ifdef XB_XCOMPRESS
-		if (file->IsCompressed() && ctx != nullptr)
-		{
-			SIZE_T decompSize = 0;
-			XMemDecompress(ctx, curpos, &decompSize, chunk->data, chunk->dataSize);
+	out.close();
 
-			curpos += decompSize;
+	pakfile->ReleaseChunks(file->GetFirstChunkIndex(), file->GetChunkCount());
 
-			continue;
-		}
-#endif
-		
-		memcpy_s(curpos, chunk->dataSize, chunk->data, chunk->dataSize);
-		curpos += firstChunk[i].dataSize;
+	return true;
+}
+
+void RunBluepointDecodeBenchmark()
+{
+	std::vector<CBluepointWrappedFile*> files;
+
+	for (const CGlobalAssetData::AssetLookup_t& it : g_assetData.v_assets)
+	{
+		if (it.m_asset->GetAssetContainerType() == CAsset::ContainerType::BP_PAK)
+			files.push_back(static_cast<CBluepointWrappedFile*>(it.m_asset));
 	}
 
-	StreamIO out(exportPath, eStreamIOMode::Write);
-	out.write(fileBuf.get(), file->GetDecompSize());
+	if (files.empty())
+		return;
 
-	return true;
+	// same split as a bulk export, files spread over the export threads with their chunks decoded on the rest
+	const uint32_t numThreads = static_cast<uint32_t>(std::min(static_cast<size_t>(std::max(UtilsConfig->exportThreadCount, 1u)), files.size()));
+
+	std::atomic<size_t> fileIdx = 0ull;
+	std::atomic<size_t> decodedSize = 0ull;
+	std::atomic<uint32_t> numFailed = 0u;
+
+	auto decodeFiles = [&]()
+		{
+			std::vector<CBluepointPakfile::DecodedChunk_t> chunks;
+
+			for (size_t i = fileIdx++; i < files.size(); i = fileIdx++)
+			{
+				CBluepointWrappedFile* const file = files[i];
+				CBluepointPakfile* const pakfile = file->GetContainerFile<CBluepointPakfile>();
+
+				if (pakfile->AcquireChunks(file->GetFirstChunkIndex(), file->GetChunkCount(), file->GetDecompSize(), file->IsCompressed(), chunks))
+					decodedSize += static_cast<size_t>(file->GetDecompSize());
+				else
+					++numFailed;
+
+				pakfile->ReleaseChunks(file->GetFirstChunkIndex(), file->GetChunkCount());
+			}
+		};
+
+	const auto startTime = std::chrono::high_resolution_clock::now();
+
+	CParallelTask task(numThreads);
+	task.addTask(decodeFiles, numThreads);
+	task.execute();
+	task.wait();
+
+	const double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - startTime).count();
+	const double totalMiB = static_cast<double>(decodedSize.load()) / (1024.0 * 1024.0);
+
+	printf("BPK BENCHMARK: decoded %llu files (%.1f MiB) on %u export threads in %.1f ms, %.1f MiB/s, %u failed\n", files.size(), totalMiB, numThreads, seconds * 1000.0, totalMiB / seconds, numFailed.load());
 }
 
 void InitBluepointWrappedFileAssetType()
@@ -194,4 +510,6 @@ void InitBluepointWrappedFileAssetType()
 	};
 
 	REGISTER_TYPE(type);
+
+	g_MemoryTracker.RegisterEvictor(eMemoryCategory::MEM_BP_CHUNKS, EvictBluepointChunks);
 }
\ No newline at end of file
@@ -1,6 +1,8 @@
 #pragma once
 #include <game/asset.h>
 
+#include <condition_variable>
+
 #define BP_PAK_ID       MAKEFOURCC('X', 'B', 'A', 'R')
 #define BP_PAK_VER_R1   6
 
@@ -17,16 +19,6 @@ struct bpkfile_v6_t
     int dataStartOffset;
     int dataEndOffset;
 
-    void swap()
-    {
-        ISWAP32(this->unk_8);
-
-        ISWAP32(this->chunkStart);
-        ISWAP32(this->decompressedSize);
-        ISWAP32(this->dataStartOffset);
-        ISWAP32(this->dataEndOffset);
-    }
-
     inline const bool IsCompressed() const { return decompressedSize != dataEndOffset - dataStartOffset; }
     inline const int DataSize() const { return IsCompressed() ? (dataEndOffset - dataStartOffset) : decompressedSize; }
 };
@@ -92,14 +84,17 @@ struct bpkhdr_v6_t
         ISWAP32(this->dataSize);
         ISWAP32(this->patchCount);
 
+        // the tables are swapped as whole blocks, the filename hashes are used as stored so they get swapped back
+        ByteSwap32Array(pFile(0), static_cast<size_t>(fileCount) * (sizeof(bpkfile_v6_t) / sizeof(int)));
+
         for (int i = 0; i < fileCount; i++)
         {
-            pFile(i)->swap();
-            ISWAP32(*pUnk(i));
+            ISWAP32(pFile(i)->hash[0]);
+            ISWAP32(pFile(i)->hash[1]);
         }
 
-        for (int i = 0; i < chunkCount; i++)
-            ISWAP32(*pChunkSize(i));
+        // unk values and chunk sizes are back to back
+        ByteSwap32Array(pUnk(0), static_cast<size_t>(fileCount) + chunkCount);
 
         for (int i = 0; i < patchCount; i++)
             pPatch(i)->swap();
@@ -143,6 +138,25 @@ public:
 
     inline const Chunk_t* const GetChunk(const int idx) const { return &m_chunks.at(idx); }
 
+    // number of chunks a file's data is split over
+    static inline const int ChunkCountForSize(const int decompressedSize, const int maxChunkSize) { return std::max((decompressedSize + maxChunkSize - 1) / maxChunkSize, 1); }
+
+    struct DecodedChunk_t
+    {
+        std::shared_ptr<char[]> data;
+        int dataSize;
+    };
+
+    // gets the decoded data for a file's chunks. compressed chunks come from the chunk cache, any that aren't in it yet are decoded in parallel,
+    // uncompressed chunks point straight into the file buffer. call ReleaseChunks once the data has been used.
+    bool AcquireChunks(const int firstChunk, const int numChunks, const int decompressedSize, const bool compressed, std::vector<DecodedChunk_t>& out);
+
+    // a chunk is dropped from the cache once every file that reads it has released it
+    void ReleaseChunks(const int firstChunk, const int numChunks);
+
+    // drops cached chunks that aren't being read, returns the number of bytes freed
+    size_t EvictChunks(const size_t bytesToFree);
+
 private:
     char m_fileName[BP_PAK_FILENAME_SIZE];
 
@@ -157,6 +171,21 @@ private:
     int m_chunkSize;
     std::vector<Chunk_t> m_chunks;
 
+    struct ChunkCacheEntry_t
+    {
+        std::shared_ptr<char[]> data; // decoded chunk, empty while it isn't cached
+        int dataSize;
+
+        int numPendingUsers; // files that haven't read this chunk yet
+        bool decoding;
+    };
+
+    bool DecodeChunk(const int idx, const int decodedSize, DecodedChunk_t& out) const;
+
+    std::vector<ChunkCacheEntry_t> m_chunkCache;
+    std::mutex m_chunkCacheMutex;
+    std::condition_variable m_chunkDecoded;
+
     std::shared_ptr<char[]> m_Buf;
 };
 
@@ -203,7 +232,7 @@ public:
         m_dataSizeCompressed = file->DataSize();
         m_dataIsCompressed = file->IsCompressed();
 
-        m_chunkCount = m_dataSizeDecompressed > pakfile->GetMaxChunkSize() ? (m_dataSizeDecompressed / pakfile->GetMaxChunkSize()) + 1 : 1;
+        m_chunkCount = CBluepointPakfile::ChunkCountForSize(m_dataSizeDecompressed, pakfile->GetMaxChunkSize());
         m_chunkIndex = file->chunkStart;
 
         m_unk_8 = file->unk_8;
@@ -232,4 +261,7 @@ private:
     bool m_dataIsCompressed;
 
     int m_unk_8; // weird guy
-};
\ No newline at end of file
+};
+
+// decodes every file in the loaded bluepoint paks without writing anything and prints the throughput
+void RunBluepointDecodeBenchmark();
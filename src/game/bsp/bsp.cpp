@@ -5,6 +5,10 @@
 #include <core/render/dx.h>
 #include <game/rtech/assets/material.h>
 #include <game/rtech/assets/texture.h>
+#include <thirdparty/imgui/misc/imgui_utility.h>
+
+#include <charconv>
+#include <chrono>
 
 extern CDXParentHandler* g_dxHandler;
 extern std::unique_ptr<char[]> GetWrapAssetData(CAsset* const asset, uint64_t* outSize);
@@ -316,6 +320,36 @@ void CBSPData::PopulateFromPakAsset(CPakAsset* pakAsset, void* bspData)
 
 	l.numVertPositions = header->lumps[LUMP_VERTEXES].filelen / sizeof(Vector);
 	l.numVertNormals = header->lumps[LUMP_VERTNORMALS].filelen / sizeof(Vector);
+
+	ResolveLumpViews();
+}
+
+template <typename T>
+static std::span<const T> GetLumpSpan(const std::unordered_map<uint8_t, std::shared_ptr<char[]>>& lumpData, const std::unordered_map<uint8_t, uint32_t>& lumpSizes, const uint8_t lumpId)
+{
+	const auto dataIt = lumpData.find(lumpId);
+	const auto sizeIt = lumpSizes.find(lumpId);
+
+	if (dataIt == lumpData.end() || sizeIt == lumpSizes.end() || !dataIt->second)
+		return {};
+
+	return { reinterpret_cast<const T*>(dataIt->second.get()), sizeIt->second / sizeof(T) };
+}
+
+void CBSPData::ResolveLumpViews()
+{
+	m_lumpViews.models = GetLumpSpan<dmodel_t>(m_lumpData, m_lumpSizes, LUMP_MODELS);
+	m_lumpViews.meshes = GetLumpSpan<dmesh_t>(m_lumpData, m_lumpSizes, LUMP_MESHES);
+	m_lumpViews.materialSorts = GetLumpSpan<dmaterialsort_t>(m_lumpData, m_lumpSizes, LUMP_MATERIAL_SORT);
+	m_lumpViews.texData = GetLumpSpan<dtexdata_t>(m_lumpData, m_lumpSizes, LUMP_TEXDATA);
+	m_lumpViews.texDataStrings = GetLumpSpan<char>(m_lumpData, m_lumpSizes, LUMP_TEXDATA_STRING_DATA);
+
+	m_lumpViews.meshIndices = GetLumpSpan<uint16_t>(m_lumpData, m_lumpSizes, LUMP_MESH_INDICES);
+	m_lumpViews.vertPositions = GetLumpSpan<Vector>(m_lumpData, m_lumpSizes, LUMP_VERTEXES);
+	m_lumpViews.vertNormals = GetLumpSpan<Vector>(m_lumpData, m_lumpSizes, LUMP_VERTNORMALS);
+
+	for (uint8_t i = LUMP_VERTS_UNLIT; i <= LUMP_VERTS_UNLIT_TS; ++i)
+		m_lumpViews.vertLumps[i - LUMP_VERTS_UNLIT] = GetLumpSpan<char>(m_lumpData, m_lumpSizes, i);
 }
 
 void CreateDXDrawDataTransformsBuffer(CDXDrawData* drawData)
@@ -535,75 +569,517 @@ CDXDrawData* CBSPData::ConstructPreviewData()
 	return m_drawData;
 }
 
-// very temp
-void CBSPData::Export(std::ofstream* out)
+const char* const CBSPData::GetTexDataName(const int texData) const
+{
+	const BSPLumpViews_t& lumps = m_lumpViews;
+
+	if (texData < 0 || static_cast<size_t>(texData) >= lumps.texData.size())
+		return nullptr;
+
+	const int nameOffset = lumps.texData[texData].nameStringTableID;
+
+	if (nameOffset < 0 || static_cast<size_t>(nameOffset) >= lumps.texDataStrings.size())
+		return nullptr;
+
+	// the name has to end inside the lump
+	const char* const name = &lumps.texDataStrings[nameOffset];
+	if (!memchr(name, '\0', lumps.texDataStrings.size() - nameOffset))
+		return nullptr;
+
+	return name;
+}
+
+// converts a range of meshes to indexed buffers, one per texdata in the order they're first used
+// vertices are shared within a material when they're the same vertex in the same vertex lump
+static void BSP_BuildMeshRange(const BSPLumpViews_t& lumps, const int* const meshIds, const size_t numMeshIds, std::vector<BSPMaterialMesh_t>& outMeshes)
 {
-	UNUSED(out);
-	const float3* positionsLump = reinterpret_cast<float3*>(GetLumpData(LUMP_VERTEXES).get());
-	const float3* normalsLump = reinterpret_cast<float3*>(GetLumpData(LUMP_VERTNORMALS).get());
-	const uint16_t* indicesLump = reinterpret_cast<uint16_t*>(GetLumpData(LUMP_MESH_INDICES).get());
+	std::unordered_map<int, size_t> materialIndices;
+	std::vector<std::unordered_map<uint64_t, uint32_t>> vertexMaps;
 
-	for (int i = 0; i < l.numVertPositions; ++i)
+	for (size_t i = 0; i < numMeshIds; ++i)
 	{
-		*out << (std::format("v {} {} {}\n", positionsLump[i].x, positionsLump[i].y, positionsLump[i].z));
+		const dmesh_t& mesh = lumps.meshes[meshIds[i]];
+
+		if (mesh.triCount <= 0 || mesh.firstIdx < 0 || mesh.mtlSortIdx < 0 || static_cast<size_t>(mesh.mtlSortIdx) >= lumps.materialSorts.size())
+			continue;
+
+		const size_t firstIdx = static_cast<size_t>(mesh.firstIdx);
+		const size_t numIndices = static_cast<size_t>(mesh.triCount) * 3;
+
+		if (firstIdx + numIndices > lumps.meshIndices.size())
+			continue;
+
+		const dmaterialsort_t& mtlSort = lumps.materialSorts[mesh.mtlSortIdx];
+
+		const uint8_t vertLumpId = GetVertexLumpIdByMeshFlag(mesh.flags & 0x600);
+		const size_t vertexStride = GetVertexStrideByLumpId(vertLumpId);
+		const std::span<const char>& vertLump = lumps.vertLumps[vertLumpId - LUMP_VERTS_UNLIT];
+		const int64_t numVertices = static_cast<int64_t>(vertLump.size() / vertexStride);
+
+		const auto materialIt = materialIndices.try_emplace(mtlSort.texdata, outMeshes.size());
+		if (materialIt.second)
+		{
+			outMeshes.emplace_back().texData = mtlSort.texdata;
+			vertexMaps.emplace_back();
+		}
+
+		BSPMaterialMesh_t& outMesh = outMeshes[materialIt.first->second];
+		std::unordered_map<uint64_t, uint32_t>& vertexMap = vertexMaps[materialIt.first->second];
+
+		for (size_t k = firstIdx; k < firstIdx + numIndices; k += 3)
+		{
+			// every corner is checked before anything is added, triangles pointing outside the lumps are dropped
+			int64_t vertIndices[3];
+			const char* verts[3];
+			bool valid = true;
+
+			for (int v = 0; v < 3 && valid; ++v)
+			{
+				vertIndices[v] = static_cast<int64_t>(lumps.meshIndices[k + v]) + mtlSort.firstVertex;
+
+				if (vertIndices[v] < 0 || vertIndices[v] >= numVertices)
+				{
+					valid = false;
+					break;
+				}
+
+				verts[v] = vertLump.data() + (vertexStride * vertIndices[v]);
+
+				uint32_t posIdx, nmlIdx;
+				memcpy(&posIdx, verts[v], sizeof(uint32_t));
+				memcpy(&nmlIdx, verts[v] + sizeof(uint32_t), sizeof(uint32_t));
+
+				valid = posIdx < lumps.vertPositions.size() && nmlIdx < lumps.vertNormals.size();
+			}
+
+			if (!valid)
+				continue;
+
+			for (int v = 0; v < 3; ++v)
+			{
+				const uint64_t vertKey = (static_cast<uint64_t>(vertLumpId) << 32) | static_cast<uint64_t>(vertIndices[v]);
+				const auto vertIt = vertexMap.try_emplace(vertKey, static_cast<uint32_t>(outMesh.positions.size()));
+
+				if (vertIt.second)
+				{
+					uint32_t posIdx, nmlIdx;
+					memcpy(&posIdx, verts[v], sizeof(uint32_t));
+					memcpy(&nmlIdx, verts[v] + sizeof(uint32_t), sizeof(uint32_t));
+
+					// every vertex type has its uv straight after the position and normal indices
+					float uv[2];
+					memcpy(uv, verts[v] + (2 * sizeof(uint32_t)), sizeof(uv));
+
+					outMesh.positions.push_back(lumps.vertPositions[posIdx]);
+					outMesh.normals.push_back(lumps.vertNormals[nmlIdx]);
+					outMesh.uvs.emplace_back(uv[0], uv[1]);
+				}
+
+				outMesh.indices.push_back(vertIt.first->second);
+			}
+		}
 	}
+}
+
+void CBSPData::BuildWorldMeshes(std::vector<BSPMaterialMesh_t>& outMeshes) const
+{
+	const BSPLumpViews_t& lumps = m_lumpViews;
 
-	for (int i = 0; i < l.numVertNormals; ++i)
+	outMeshes.clear();
+
+	// meshes of every model in model order. the world model has most of the map's meshes,
+	// so work is split into ranges of meshes rather than by model
+	std::vector<int> meshIds;
+	meshIds.reserve(lumps.meshes.size());
+
+	for (const dmodel_t& model : lumps.models)
 	{
-		*out << (std::format("vn {} {} {}\n", normalsLump[i].x, normalsLump[i].y, normalsLump[i].z));
+		if (model.firstMesh < 0 || model.meshCount <= 0 || static_cast<size_t>(model.firstMesh) + model.meshCount > lumps.meshes.size())
+			continue;
+
+		for (int i = model.firstMesh; i < model.firstMesh + model.meshCount; ++i)
+			meshIds.push_back(i);
 	}
 
-	//for (int i = LUMP_VERTS_UNLIT; i <= LUMP_VERTS_UNLIT_TS; ++i)
-	//{
-	//	if (GetLumpSize(i) <= 0)
-	//		continue;
+	if (meshIds.empty())
+		return;
 
-	//	const UINT originalStride = GetVertexStrideByLumpId(i);
-	//	const UINT newStride = CONVERT_VERT_STRIDE(originalStride);
-	//	const size_t numVertices = GetLumpSize(i) / GetVertexStrideByLumpId(i);
+	const uint32_t numThreads = CThread::GetNestedExportThreadBudget(UINT32_MAX);
 
-	//}
+	// fixed size ranges so the output is the same however many threads there are
+	constexpr size_t meshesPerRange = 256ull;
+	const size_t numRanges = (meshIds.size() + meshesPerRange - 1) / meshesPerRange;
+
+	std::vector<std::vector<BSPMaterialMesh_t>> rangeMeshes(numRanges);
+
+	ParallelFor(numRanges, numThreads, [&](const size_t range)
+		{
+			const size_t first = range * meshesPerRange;
+			BSP_BuildMeshRange(lumps, &meshIds[first], std::min(meshesPerRange, meshIds.size() - first), rangeMeshes[range]);
+		});
 
-	for (int i = 0; i < l.numModels; ++i)
+	// every range's buffers for a material are appended in range order
+	std::map<int, std::vector<const BSPMaterialMesh_t*>> materialParts;
+
+	for (const std::vector<BSPMaterialMesh_t>& meshes : rangeMeshes)
 	{
-		dmodel_t* model = &reinterpret_cast<dmodel_t*>(GetLumpData(LUMP_MODELS).get())[i];
+		for (const BSPMaterialMesh_t& mesh : meshes)
+		{
+			if (!mesh.indices.empty())
+				materialParts[mesh.texData].push_back(&mesh);
+		}
+	}
+
+	std::vector<std::pair<int, const std::vector<const BSPMaterialMesh_t*>*>> materials;
+	materials.reserve(materialParts.size());
+
+	for (const auto& [texData, parts] : materialParts)
+		materials.emplace_back(texData, &parts);
 
-		for (int j = model->firstMesh; j < (model->firstMesh + model->meshCount); ++j)
+	outMeshes.resize(materials.size());
+
+	ParallelFor(materials.size(), numThreads, [&](const size_t i)
 		{
-			dmesh_t* mesh = &reinterpret_cast<dmesh_t*>(GetLumpData(LUMP_MESHES).get())[j];
+			BSPMaterialMesh_t& outMesh = outMeshes[i];
+			outMesh.texData = materials[i].first;
 
-			if (mesh->triCount <= 0)
-				continue;
+			size_t numVertices = 0ull;
+			size_t numIndices = 0ull;
+
+			for (const BSPMaterialMesh_t* const part : *materials[i].second)
+			{
+				numVertices += part->positions.size();
+				numIndices += part->indices.size();
+			}
+
+			outMesh.positions.reserve(numVertices);
+			outMesh.normals.reserve(numVertices);
+			outMesh.uvs.reserve(numVertices);
+			outMesh.indices.reserve(numIndices);
+
+			for (const BSPMaterialMesh_t* const part : *materials[i].second)
+			{
+				const uint32_t baseVertex = static_cast<uint32_t>(outMesh.positions.size());
+
+				outMesh.positions.insert(outMesh.positions.end(), part->positions.begin(), part->positions.end());
+				outMesh.normals.insert(outMesh.normals.end(), part->normals.begin(), part->normals.end());
+				outMesh.uvs.insert(outMesh.uvs.end(), part->uvs.begin(), part->uvs.end());
+
+				for (const uint32_t index : part->indices)
+					outMesh.indices.push_back(index + baseVertex);
+			}
+		});
+}
+
+//
+// WORLD EXPORT
+//
+
+static inline void BSP_AppendFloat(std::string& out, const float value)
+{
+	char buf[32];
+	const std::to_chars_result result = std::to_chars(buf, buf + sizeof(buf), value);
+
+	out.append(buf, result.ptr);
+}
+
+static inline void BSP_AppendUInt(std::string& out, const uint64_t value)
+{
+	char buf[24];
+	const std::to_chars_result result = std::to_chars(buf, buf + sizeof(buf), value);
+
+	out.append(buf, result.ptr);
+}
+
+// every material is formatted on its own thread, then written in order
+static bool BSP_WriteWorldOBJ(const std::filesystem::path& exportPath, const std::string& mapName, const std::vector<BSPMaterialMesh_t>& meshes, const std::vector<std::string>& materialNames, const uint32_t numThreads)
+{
+	// obj indices are global and start at 1
+	std::vector<uint64_t> baseVertices(meshes.size());
+
+	uint64_t numVertices = 1ull;
+	for (size_t i = 0; i < meshes.size(); ++i)
+	{
+		baseVertices[i] = numVertices;
+		numVertices += meshes[i].positions.size();
+	}
+
+	std::vector<std::string> materialText(meshes.size());
+
+	ParallelFor(meshes.size(), numThreads, [&](const size_t i)
+		{
+			const BSPMaterialMesh_t& mesh = meshes[i];
+			std::string& out = materialText[i];
+
+			out.reserve((mesh.positions.size() * 96ull) + (mesh.indices.size() * 24ull) + 256ull);
 
-			const dmaterialsort_t* mtlSort = &reinterpret_cast<dmaterialsort_t*>(GetLumpData(LUMP_MATERIAL_SORT).get())[mesh->mtlSortIdx];
-			
-			const int meshVertType = mesh->flags & 0x600;
-			const int meshVertLumpId = GetVertexLumpIdByMeshFlag(meshVertType);
+			out.append("g ").append(materialNames[i]).append("\n");
+			out.append("usemtl ").append(materialNames[i]).append("\n");
 
-			const UINT vertexStride = GetVertexStrideByLumpId(meshVertLumpId);
+			for (const Vector& position : mesh.positions)
+			{
+				out.append("v ");
+				BSP_AppendFloat(out, position.x);
+				out.push_back(' ');
+				BSP_AppendFloat(out, position.y);
+				out.push_back(' ');
+				BSP_AppendFloat(out, position.z);
+				out.push_back('\n');
+			}
 
-			std::string faceString = "";
-			int vertWriteIndex = 0;
-			for (int k = mesh->firstIdx; k < mesh->firstIdx + (mesh->triCount * 3); ++k)
+			// obj has v going up
+			for (const Vector2D& uv : mesh.uvs)
 			{
-				const int index = indicesLump[k] + mtlSort->firstVertex;
+				out.append("vt ");
+				BSP_AppendFloat(out, uv.x);
+				out.push_back(' ');
+				BSP_AppendFloat(out, 1.0f - uv.y);
+				out.push_back('\n');
+			}
 
-				const uint32_t* vertPointer = reinterpret_cast<uint32_t*>(GetLumpData(meshVertLumpId).get() + (vertexStride * index));
+			for (const Vector& normal : mesh.normals)
+			{
+				out.append("vn ");
+				BSP_AppendFloat(out, normal.x);
+				out.push_back(' ');
+				BSP_AppendFloat(out, normal.y);
+				out.push_back(' ');
+				BSP_AppendFloat(out, normal.z);
+				out.push_back('\n');
+			}
 
-				const uint32_t posIdx = vertPointer[0];
-				const uint32_t nmlIdx = vertPointer[1];
+			for (size_t k = 0; k < mesh.indices.size(); k += 3)
+			{
+				out.push_back('f');
 
-				if ((vertWriteIndex % 3) == 0)
+				for (size_t v = 0; v < 3; ++v)
 				{
-					*out << (faceString) << "\n";
-					faceString = "f";
+					const uint64_t index = mesh.indices[k + v] + baseVertices[i];
+
+					out.push_back(' ');
+					BSP_AppendUInt(out, index);
+					out.push_back('/');
+					BSP_AppendUInt(out, index);
+					out.push_back('/');
+					BSP_AppendUInt(out, index);
 				}
 
-				faceString += std::format(" {}//{}", posIdx + 1, nmlIdx + 1);
-
-				vertWriteIndex++;
+				out.push_back('\n');
 			}
-			*out << (faceString);
+		});
+
+	StreamIO out;
+	if (!out.open(exportPath.string(), eStreamIOMode::Write))
+	{
+		assertm(false, "Failed to open file for write.");
+		return false;
+	}
+
+	const std::string header = std::format("# world geometry for {}\no {}\n", mapName, mapName);
+	out.write(header.c_str(), header.length());
+
+	for (const std::string& text : materialText)
+		out.write(text.c_str(), text.length());
+
+	out.close();
+
+	return true;
+}
+
+static void BSP_AppendJSONString(std::string& out, const std::string& str)
+{
+	out.push_back('"');
+
+	for (const char c : str)
+	{
+		if (c == '"' || c == '\\')
+		{
+			out.push_back('\\');
+			out.push_back(c);
 		}
+		else if (static_cast<unsigned char>(c) < 0x20)
+			out.append(std::format("\\u{:04x}", static_cast<int>(c)));
+		else
+			out.push_back(c);
+	}
+
+	out.push_back('"');
+}
+
+// binary gltf, one primitive per material. the data is kept z up and the node rotates it to gltf's y up
+static bool BSP_WriteWorldGLB(const std::filesystem::path& exportPath, const std::string& mapName, const std::vector<BSPMaterialMesh_t>& meshes, const std::vector<std::string>& materialNames)
+{
+	constexpr uint32_t GLB_MAGIC = 0x46546C67; // glTF
+	constexpr uint32_t GLB_CHUNK_JSON = 0x4E4F534A;
+	constexpr uint32_t GLB_CHUNK_BIN = 0x004E4942;
+
+	constexpr int GLTF_FLOAT = 5126;
+	constexpr int GLTF_UNSIGNED_INT = 5125;
+	constexpr int GLTF_ARRAY_BUFFER = 34962;
+	constexpr int GLTF_ELEMENT_ARRAY_BUFFER = 34963;
+
+	// positions, normals, uvs, then indices for every material. all of them are four byte aligned
+	size_t binSize = 0ull;
+	for (const BSPMaterialMesh_t& mesh : meshes)
+		binSize += (mesh.positions.size() * sizeof(Vector) * 2) + (mesh.uvs.size() * sizeof(Vector2D)) + (mesh.indices.size() * sizeof(uint32_t));
+
+	std::vector<char> bin(binSize);
+
+	std::string primitives;
+	std::string materials;
+	std::string bufferViews;
+	std::string accessors;
+
+	size_t binOffset = 0ull;
+	for (size_t i = 0; i < meshes.size(); ++i)
+	{
+		const BSPMaterialMesh_t& mesh = meshes[i];
+		const size_t firstAccessor = i * 4;
+
+		const std::pair<const void*, size_t> views[4] =
+		{
+			{ mesh.positions.data(), mesh.positions.size() * sizeof(Vector) },
+			{ mesh.normals.data(), mesh.normals.size() * sizeof(Vector) },
+			{ mesh.uvs.data(), mesh.uvs.size() * sizeof(Vector2D) },
+			{ mesh.indices.data(), mesh.indices.size() * sizeof(uint32_t) },
+		};
+
+		for (int view = 0; view < 4; ++view)
+		{
+			memcpy(bin.data() + binOffset, views[view].first, views[view].second);
+
+			bufferViews.append(bufferViews.empty() ? "" : ",");
+			bufferViews.append(std::format("{{\"buffer\":0,\"byteOffset\":{},\"byteLength\":{},\"target\":{}}}", binOffset, views[view].second, view == 3 ? GLTF_ELEMENT_ARRAY_BUFFER : GLTF_ARRAY_BUFFER));
+
+			binOffset += views[view].second;
+		}
+
+		// positions need their bounds
+		Vector mins(FLT_MAX, FLT_MAX, FLT_MAX);
+		Vector maxs(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+
+		for (const Vector& position : mesh.positions)
+		{
+			mins = Vector(std::min(mins.x, position.x), std::min(mins.y, position.y), std::min(mins.z, position.z));
+			maxs = Vector(std::max(maxs.x, position.x), std::max(maxs.y, position.y), std::max(maxs.z, position.z));
+		}
+
+		accessors.append(accessors.empty() ? "" : ",");
+		accessors.append(std::format("{{\"bufferView\":{},\"componentType\":{},\"count\":{},\"type\":\"VEC3\",\"min\":[{},{},{}],\"max\":[{},{},{}]}}",
+			firstAccessor, GLTF_FLOAT, mesh.positions.size(), mins.x, mins.y, mins.z, maxs.x, maxs.y, maxs.z));
+		accessors.append(std::format(",{{\"bufferView\":{},\"componentType\":{},\"count\":{},\"type\":\"VEC3\"}}", firstAccessor + 1, GLTF_FLOAT, mesh.normals.size()));
+		accessors.append(std::format(",{{\"bufferView\":{},\"componentType\":{},\"count\":{},\"type\":\"VEC2\"}}", firstAccessor + 2, GLTF_FLOAT, mesh.uvs.size()));
+		accessors.append(std::format(",{{\"bufferView\":{},\"componentType\":{},\"count\":{},\"type\":\"SCALAR\"}}", firstAccessor + 3, GLTF_UNSIGNED_INT, mesh.indices.size()));
+
+		primitives.append(primitives.empty() ? "" : ",");
+		primitives.append(std::format("{{\"attributes\":{{\"POSITION\":{},\"NORMAL\":{},\"TEXCOORD_0\":{}}},\"indices\":{},\"material\":{}}}", firstAccessor, firstAccessor + 1, firstAccessor + 2, firstAccessor + 3, i));
+
+		materials.append(materials.empty() ? "{\"name\":" : ",{\"name\":");
+		BSP_AppendJSONString(materials, materialNames[i]);
+		materials.append("}");
 	}
-}
\ No newline at end of file
+
+	std::string escapedMapName;
+	BSP_AppendJSONString(escapedMapName, mapName);
+
+	std::string json;
+	json.reserve(primitives.length() + materials.length() + bufferViews.length() + accessors.length() + 512ull);
+
+	json.append("{\"asset\":{\"version\":\"2.0\",\"generator\":\"RSX\"},\"scene\":0,\"scenes\":[{\"nodes\":[0]}],");
+	json.append(std::format("\"nodes\":[{{\"name\":{},\"mesh\":0,\"rotation\":[-0.70710677,0,0,0.70710677]}}],", escapedMapName));
+	json.append(std::format("\"meshes\":[{{\"name\":{},\"primitives\":[{}]}}],", escapedMapName, primitives));
+	json.append(std::format("\"materials\":[{}],", materials));
+	json.append(std::format("\"buffers\":[{{\"byteLength\":{}}}],", bin.size()));
+	json.append(std::format("\"bufferViews\":[{}],", bufferViews));
+	json.append(std::format("\"accessors\":[{}]}}", accessors));
+
+	// chunks have to be four byte aligned, json is padded with spaces
+	while (json.length() % 4)
+		json.push_back(' ');
+
+	const uint32_t jsonChunkSize = static_cast<uint32_t>(json.length());
+	const uint32_t binChunkSize = static_cast<uint32_t>(bin.size());
+	const uint32_t fileSize = static_cast<uint32_t>(12 + 8 + jsonChunkSize + 8 + binChunkSize);
+
+	StreamIO out;
+	if (!out.open(exportPath.string(), eStreamIOMode::Write))
+	{
+		assertm(false, "Failed to open file for write.");
+		return false;
+	}
+
+	const uint32_t header[3] = { GLB_MAGIC, 2u, fileSize };
+	out.write(reinterpret_cast<const char*>(header), sizeof(header));
+
+	const uint32_t jsonChunk[2] = { jsonChunkSize, GLB_CHUNK_JSON };
+	out.write(reinterpret_cast<const char*>(jsonChunk), sizeof(jsonChunk));
+	out.write(json.c_str(), json.length());
+
+	const uint32_t binChunk[2] = { binChunkSize, GLB_CHUNK_BIN };
+	out.write(reinterpret_cast<const char*>(binChunk), sizeof(binChunk));
+	out.write(bin.data(), bin.size());
+
+	out.close();
+
+	return true;
+}
+
+bool CBSPData::Export(const std::filesystem::path& exportPath, const eBSPExportSetting setting) const
+{
+	const auto startTime = std::chrono::high_resolution_clock::now();
+
+	std::vector<BSPMaterialMesh_t> meshes;
+	BuildWorldMeshes(meshes);
+
+	if (meshes.empty())
+	{
+		Log("WARNING: BSP for map \"%s\" has no world meshes to export.\n", m_mapName.c_str());
+		return false;
+	}
+
+	std::vector<std::string> materialNames(meshes.size());
+	size_t numTriangles = 0ull;
+
+	for (size_t i = 0; i < meshes.size(); ++i)
+	{
+		const char* const name = GetTexDataName(meshes[i].texData);
+		materialNames[i] = name ? name : std::format("texdata_{}", meshes[i].texData);
+
+		numTriangles += meshes[i].indices.size() / 3;
+	}
+
+	std::filesystem::path outPath = exportPath;
+	bool success = false;
+
+	switch (setting)
+	{
+	case eBSPExportSetting::BSP_EXPORT_OBJ:
+	{
+		outPath.replace_extension(".obj");
+
+		success = BSP_WriteWorldOBJ(outPath, m_mapName, meshes, materialNames, CThread::GetNestedExportThreadBudget(static_cast<uint32_t>(meshes.size())));
+
+		break;
+	}
+	case eBSPExportSetting::BSP_EXPORT_GLB:
+	{
+		outPath.replace_extension(".glb");
+		success = BSP_WriteWorldGLB(outPath, m_mapName, meshes, materialNames);
+
+		break;
+	}
+	default:
+	{
+		assertm(false, "Export setting is not handled.");
+		return false;
+	}
+	}
+
+	if (success)
+	{
+		Log("BSP: exported %llu triangles in %llu materials for map \"%s\" in %.2fs\n", numTriangles, meshes.size(), m_mapName.c_str(),
+			std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - startTime).count());
+	}
+
+	return success;
+}
@@ -1,6 +1,8 @@
 #pragma once
 #include <game/asset.h>
 
+#include <span>
+
 // todo
 //class CBSPFile : public CAssetContainer
 //{
@@ -77,6 +79,42 @@ struct dmesh_t
 	int flags;
 };
 
+// typed views of the lumps used to build world meshes, resolved once when the lumps are loaded
+// lumps that don't exist (or are too small for a single element) are empty spans
+struct BSPLumpViews_t
+{
+	std::span<const dmodel_t> models;
+	std::span<const dmesh_t> meshes;
+	std::span<const dmaterialsort_t> materialSorts;
+	std::span<const dtexdata_t> texData;
+	std::span<const char> texDataStrings;
+
+	std::span<const uint16_t> meshIndices;
+	std::span<const Vector> vertPositions;
+	std::span<const Vector> vertNormals;
+
+	// LUMP_VERTS_UNLIT to LUMP_VERTS_UNLIT_TS, kept as bytes since every vertex type has its own stride
+	std::span<const char> vertLumps[4];
+};
+
+// indexed world geometry for a single texdata (material)
+struct BSPMaterialMesh_t
+{
+	int texData;
+
+	std::vector<Vector> positions;
+	std::vector<Vector> normals;
+	std::vector<Vector2D> uvs;
+
+	std::vector<uint32_t> indices;
+};
+
+enum eBSPExportSetting
+{
+	BSP_EXPORT_OBJ,
+	BSP_EXPORT_GLB,
+};
+
 class CPakAsset;
 class CDXDrawData;
 struct ID3D11ShaderResourceView;
@@ -96,7 +134,16 @@ public:
 
 	CDXDrawData* ConstructPreviewData();
 
-	void Export(std::ofstream* out);
+	// converts every model's meshes to indexed per material buffers and writes them as one file, see eBSPExportSetting
+	bool Export(const std::filesystem::path& exportPath, const eBSPExportSetting setting) const;
+
+	inline const BSPLumpViews_t& GetLumpViews() const { return m_lumpViews; }
+
+	// sorted by texdata, materials with no triangles are left out
+	void BuildWorldMeshes(std::vector<BSPMaterialMesh_t>& outMeshes) const;
+
+	// name of a texdata's material from the string table, nullptr if out of range
+	const char* const GetTexDataName(const int texData) const;
 
 	const std::shared_ptr<char[]> GetLumpData(int lumpId) const
 	{
@@ -138,11 +185,15 @@ private:
 
 	void CreateOrUpdatePreviewStructuredBuffers();
 
+	void ResolveLumpViews();
+
 private:
 	std::string m_mapName;
 	std::unordered_map<uint8_t, std::shared_ptr<char[]>> m_lumpData;
 	std::unordered_map<uint8_t, uint32_t> m_lumpSizes;
 
+	BSPLumpViews_t m_lumpViews;
+
 	CDXDrawData* m_drawData;
 
 	int m_version;
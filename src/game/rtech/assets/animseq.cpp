@@ -67,22 +67,9 @@ void LoadAnimSeqAsset(CAssetContainer* const container, CAsset* const asset)
 	pakAsset->setExtraData(seqAsset);
 }
 
-void PostLoadAnimSeqAsset(CAssetContainer* const container, CAsset* const asset)
+// parses the animation data for this sequence using the skeleton of its parent model or rig
+static void ParseAnimSeqAnimations(AnimSeqAsset* const seqAsset)
 {
-	UNUSED(container);
-
-	CPakAsset* pakAsset = static_cast<CPakAsset*>(asset);
-
-	if (!pakAsset->hasExtraData())
-		return;
-
-#ifndef DEBUG_NO_ASEQ_POSTLOAD
-	AnimSeqAsset* const seqAsset = pakAsset->extraData<AnimSeqAsset*>();
-	// do not parse this animation if there is no skeleton, if we go to export a sequence from a model/rig that has not been parsed, we will have to parse on export.
-	// this also means this sequence will not export data when exported standalone
-	if (nullptr == seqAsset->parentRig && nullptr == seqAsset->parentModel)
-		return;
-
 	const std::vector<ModelBone_t>* bones = nullptr;
 
 	if (seqAsset->parentModel)
@@ -136,6 +123,58 @@ void PostLoadAnimSeqAsset(CAssetContainer* const container, CAsset* const asset)
 	default:
 		break;
 	}
+}
+
+void AcquireAnimSeqAnimations(AnimSeqAsset* const seqAsset)
+{
+	seqAsset->animData.Acquire([seqAsset] { ParseAnimSeqAnimations(seqAsset); });
+}
+
+// drops parsed animation data until we are under the memory budget, it gets parsed again when the sequence is next exported
+static size_t EvictAnimSeqAnimations(const size_t bytesToFree)
+{
+	size_t freedSize = 0ull;
+
+	for (const CGlobalAssetData::AssetLookup_t& lookup : g_assetData.v_assets)
+	{
+		if (freedSize >= bytesToFree)
+			break;
+
+		if (lookup.m_asset->GetAssetType() != 'qesa' || lookup.m_asset->GetAssetContainerType() != CAsset::ContainerType::PAK)
+			continue;
+
+		AnimSeqAsset* const seqAsset = static_cast<CPakAsset*>(lookup.m_asset)->extraData<AnimSeqAsset*>();
+		if (!seqAsset || !seqAsset->animationParsed)
+			continue;
+
+		const size_t size = seqAsset->seqdesc.parsedData.memorySize();
+		if (size == 0ull)
+			continue;
+
+		if (seqAsset->animData.TryEvict([seqAsset] { seqAsset->seqdesc.parsedData.nuke(); }))
+			freedSize += size;
+	}
+
+	return freedSize;
+}
+
+void PostLoadAnimSeqAsset(CAssetContainer* const container, CAsset* const asset)
+{
+	UNUSED(container);
+
+	CPakAsset* pakAsset = static_cast<CPakAsset*>(asset);
+
+	if (!pakAsset->hasExtraData())
+		return;
+
+#ifndef DEBUG_NO_ASEQ_POSTLOAD
+	AnimSeqAsset* const seqAsset = pakAsset->extraData<AnimSeqAsset*>();
+	// do not parse this animation if there is no skeleton, if we go to export a sequence from a model/rig that has not been parsed, we will have to parse on export.
+	// this also means this sequence will not export data when exported standalone
+	if (nullptr == seqAsset->parentRig && nullptr == seqAsset->parentModel)
+		return;
+
+	ParseAnimSeqAnimations(seqAsset);
 
 	// the sequence has been parsed for exporting
 	seqAsset->animationParsed = true;
@@ -234,6 +273,11 @@ bool ExportAnimSeqAsset(CPakAsset* const asset, const int setting, const AnimSeq
 	case eAnimSeqExportSetting::ANIMSEQ_RMAX:
 	case eAnimSeqExportSetting::ANIMSEQ_SMD:
 	{
+		// animation data may have been evicted to stay under the memory budget
+		AnimSeqAsset* const seqAsset = const_cast<AnimSeqAsset*>(animSeqAsset);
+		AcquireAnimSeqAnimations(seqAsset);
+		const CEvictableDataRef animDataRef(&seqAsset->animData);
+
 		return ExportSeqDesc(setting, &animSeqAsset->seqdesc, exportPathCop, skelName, bones, asset->guid());
 	}
 	//	exporting asset
@@ -383,4 +427,6 @@ void InitAnimSeqAssetType()
 	};
 
 	REGISTER_TYPE(type);
+
+	g_MemoryTracker.RegisterEvictor(eMemoryCategory::MEM_ANIM_DATA, EvictAnimSeqAnimations);
 }
\ No newline at end of file
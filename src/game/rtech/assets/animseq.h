@@ -210,6 +210,7 @@ public:
 	eSeqVersion version;
 
 	ModelSeq_t seqdesc;
+	CEvictableData animData; // parsed animation data in seqdesc, can be evicted when over the memory budget
 
 	inline const bool UseStall() const { return version == eSeqVersion::VERSION_7 ? false : true; };
 	inline void UpdateDataSize_V12(const int boneCount) { RawSizeV11(boneCount); }
@@ -646,4 +647,7 @@ private:
 };
 
 bool ExportAnimSeqAsset(CPakAsset* const asset, const int setting, const AnimSeqAsset* const animSeqAsset, const std::filesystem::path& exportPath, const char* const skelName, const std::vector<ModelBone_t>* bones);
+
+// makes sure the parsed animation data is resident, must be paired with animData.Release()
+void AcquireAnimSeqAnimations(AnimSeqAsset* const seqAsset);
 bool ExportAnimSeqFromAsset(const std::filesystem::path& exportPath, const std::string& stem, const char* const name, const int numAnimSeqs, const AssetGuid_t* const animSeqs, const std::vector<ModelBone_t>* const bones, const int forceExportSetting = -1);
\ No newline at end of file
@@ -1,6 +1,10 @@
 #include <pch.h>
 #include <game/rtech/assets/datatable.h>
 #include <thirdparty/imgui/imgui.h>
+#include <thirdparty/imgui/misc/imgui_utility.h>
+#include <core/utils/arrowipc.h>
+
+#include <charconv>
 
 void LoadDatatableAsset(CAssetContainer* const pak, CAsset* const asset)
 {
@@ -148,109 +152,388 @@ void* PreviewDatatableAsset(CAsset* const asset, const bool firstFrameForAsset)
 enum eDatatableExportSetting
 {
     CSV,
+    TSV,
+    ARROW,
 };
 
-#define HANDLE_LAST_COLUMN(idx, num) (idx == (num - 1) ? "\n" : ",")
-bool ExportCSVDatatableAsset(CPakAsset* const asset, const DatatableAsset* const dtblAsset, std::filesystem::path& exportPath)
+// values of one column pulled out of the row data, so every export format can work down a column at a time
+struct DatatableColumnValues_t
 {
-    UNUSED(asset);
+    const DatatableAssetColumn* column;
 
-    exportPath.replace_extension(".csv");
+    std::vector<uint8_t> bools;
+    std::vector<int32_t> ints;
+    std::vector<float> floats; // three per row for vectors
+    std::vector<std::string_view> strings;
+    std::vector<uint8_t> valid; // string types only, zero where the value was stripped by DFS
 
-    StreamIO outFile(exportPath.string(), eStreamIOMode::Write);
-    std::ofstream& out = *outFile.W();
+    bool hasStripped;
+};
 
-    // set up the header row
-    for (int i = 0; i < dtblAsset->numColumns; i++)
+static constexpr int s_DatatableTextChunkRows = 4096;
+static constexpr std::string_view s_DatatableStrippedValue = "!!DATA EXCLUDED!!";
+
+// walks the rows once per column and copies the values out into typed arrays
+static void Datatable_TransposeColumn(const DatatableAsset* const dtblAsset, const int colIdx, DatatableColumnValues_t& values)
+{
+    const DatatableAssetColumn* const column = dtblAsset->GetColumn(colIdx);
+    const size_t numRows = static_cast<size_t>(dtblAsset->numRows);
+
+    values.column = column;
+    values.hasStripped = false;
+
+    switch (column->type)
+    {
+    case DatatableColumType_t::Bool:
+    {
+        values.bools.resize(numRows);
+
+        for (int i = 0; i < dtblAsset->numRows; i++)
+            values.bools[i] = *reinterpret_cast<const bool* const>(dtblAsset->GetRowPtr(i) + column->rowOffset) ? 1u : 0u;
+
+        break;
+    }
+    case DatatableColumType_t::Int:
     {
-        out << "\"" << dtblAsset->GetColumn(i)->name << "\"";
-        out << HANDLE_LAST_COLUMN(i, dtblAsset->numColumns);
+        values.ints.resize(numRows);
+
+        for (int i = 0; i < dtblAsset->numRows; i++)
+            values.ints[i] = *reinterpret_cast<const int* const>(dtblAsset->GetRowPtr(i) + column->rowOffset);
+
+        break;
     }
-    
-    // write rows
-    for (int i = 0; i < dtblAsset->numRows; i++)
+    case DatatableColumType_t::Float:
     {
-        const char* const row = dtblAsset->GetRowPtr(i);
+        values.floats.resize(numRows);
+
+        for (int i = 0; i < dtblAsset->numRows; i++)
+            values.floats[i] = *reinterpret_cast<const float* const>(dtblAsset->GetRowPtr(i) + column->rowOffset);
 
-        for (int j = 0; j < dtblAsset->numColumns; j++)
+        break;
+    }
+    case DatatableColumType_t::Vector:
+    {
+        values.floats.resize(numRows * 3);
+
+        for (int i = 0; i < dtblAsset->numRows; i++)
+            memcpy(&values.floats[i * 3ull], dtblAsset->GetRowPtr(i) + column->rowOffset, sizeof(float) * 3);
+
+        break;
+    }
+    case DatatableColumType_t::String:
+    case DatatableColumType_t::Asset:
+    case DatatableColumType_t::AssetNoPrecache:
+    {
+        values.strings.resize(numRows);
+        values.valid.resize(numRows);
+
+        for (int i = 0; i < dtblAsset->numRows; i++)
         {
-            const DatatableAssetColumn* const column = dtblAsset->GetColumn(j);
+            const char* const data = *reinterpret_cast<const char* const* const>(dtblAsset->GetRowPtr(i) + column->rowOffset);
 
-            switch (column->type)
+            // Detect data stripped by DFS
+            if (data[0] == 0xf)
             {
-            case DatatableColumType_t::Bool:
-            {
-                const bool& data = *reinterpret_cast<const bool* const>(row + column->rowOffset);
-                out << (data ? "true" : "false");
-
-                break;
+                values.hasStripped = true;
+                continue;
             }
-            case DatatableColumType_t::Int:
-            {
-                const int& data = *reinterpret_cast<const int* const>(row + column->rowOffset);
-                out << data;
 
-                break;
-            }
-            case DatatableColumType_t::Float:
-            {
-                const float& data = *reinterpret_cast<const float* const>(row + column->rowOffset);
-                out << data;
+            values.strings[i] = data;
+            values.valid[i] = 1u;
+        }
 
-                break;
-            }
-            case DatatableColumType_t::Vector:
-            {
-                const Vector* const data = reinterpret_cast<const Vector* const>(row + column->rowOffset);
-                out << "\"<" << data->x << "," << data->y << "," << data->z << ">\"";
+        break;
+    }
+    default:
+    {
+        assertm(false, "Unknown or invalid DataTable column type");
+        break;
+    }
+    }
+}
 
-                break;
-            }
-            case DatatableColumType_t::String:
-            case DatatableColumType_t::Asset:
-            case DatatableColumType_t::AssetNoPrecache:
-            {
-                const char* const data = *reinterpret_cast<const char* const* const>(row + column->rowOffset);
+// same as the default stream formatting the csv export has always used (%g, 6 significant digits), so existing diffs and importers keep working.
+// the arrow output stores the floats as is
+static inline void Datatable_AppendFloat(std::string& out, const float value)
+{
+    char buf[32];
+    const std::to_chars_result result = std::to_chars(buf, buf + sizeof(buf), value, std::chars_format::general, 6);
 
-                // Detect data stripped by DFS
-                if (data[0] == 0xf)
-                {
-                    out << "\"" << "!!DATA EXCLUDED!!" << "\"";
-                    break;
-                }
+    out.append(buf, result.ptr);
+}
+
+static inline void Datatable_AppendInt(std::string& out, const int32_t value)
+{
+    char buf[16];
+    const std::to_chars_result result = std::to_chars(buf, buf + sizeof(buf), value);
 
-                out << "\"" << data << "\"";
+    out.append(buf, result.ptr);
+}
 
-                break;
-            }
-            default:
+// tsv has no quoting, so separators and line breaks inside a value are escaped instead of breaking the row/column layout
+static void Datatable_AppendTSVEscaped(std::string& out, const std::string_view str)
+{
+    size_t runStart = 0ull;
+
+    for (size_t i = 0; i < str.size(); i++)
+    {
+        const char* escaped = nullptr;
+
+        switch (str[i])
+        {
+        case '\\': escaped = "\\\\"; break;
+        case '\t': escaped = "\\t"; break;
+        case '\n': escaped = "\\n"; break;
+        case '\r': escaped = "\\r"; break;
+        default: continue;
+        }
+
+        out.append(str.data() + runStart, i - runStart);
+        out.append(escaped);
+
+        runStart = i + 1;
+    }
+
+    out.append(str.data() + runStart, str.size() - runStart);
+}
+
+// formats a run of rows from one column into a shared buffer, cellEnds gets the end offset of each cell
+static void Datatable_FormatColumnCells(const DatatableColumnValues_t& values, const int firstRow, const int numRows, const bool quoted, std::string& cells, std::vector<uint32_t>& cellEnds)
+{
+    cells.clear();
+    cellEnds.resize(numRows);
+
+    switch (values.column->type)
+    {
+    case DatatableColumType_t::Bool:
+    {
+        for (int i = 0; i < numRows; i++)
+        {
+            cells.append(values.bools[firstRow + i] ? "true" : "false");
+            cellEnds[i] = static_cast<uint32_t>(cells.size());
+        }
+
+        break;
+    }
+    case DatatableColumType_t::Int:
+    {
+        for (int i = 0; i < numRows; i++)
+        {
+            Datatable_AppendInt(cells, values.ints[firstRow + i]);
+            cellEnds[i] = static_cast<uint32_t>(cells.size());
+        }
+
+        break;
+    }
+    case DatatableColumType_t::Float:
+    {
+        for (int i = 0; i < numRows; i++)
+        {
+            Datatable_AppendFloat(cells, values.floats[firstRow + i]);
+            cellEnds[i] = static_cast<uint32_t>(cells.size());
+        }
+
+        break;
+    }
+    case DatatableColumType_t::Vector:
+    {
+        for (int i = 0; i < numRows; i++)
+        {
+            const float* const data = &values.floats[(firstRow + i) * 3ull];
+
+            cells.append(quoted ? "\"<" : "<");
+            Datatable_AppendFloat(cells, data[0]);
+            cells.push_back(',');
+            Datatable_AppendFloat(cells, data[1]);
+            cells.push_back(',');
+            Datatable_AppendFloat(cells, data[2]);
+            cells.append(quoted ? ">\"" : ">");
+
+            cellEnds[i] = static_cast<uint32_t>(cells.size());
+        }
+
+        break;
+    }
+    case DatatableColumType_t::String:
+    case DatatableColumType_t::Asset:
+    case DatatableColumType_t::AssetNoPrecache:
+    {
+        for (int i = 0; i < numRows; i++)
+        {
+            const std::string_view value = values.valid[firstRow + i] ? std::string_view(values.strings[firstRow + i]) : s_DatatableStrippedValue;
+
+            if (quoted)
             {
-                assertm(false, "Unknown or invalid DataTable column type");
-                break;
+                cells.push_back('"');
+                cells.append(value);
+                cells.push_back('"');
             }
+            else
+            {
+                Datatable_AppendTSVEscaped(cells, value);
             }
 
-            out << HANDLE_LAST_COLUMN(j, dtblAsset->numColumns);
+            cellEnds[i] = static_cast<uint32_t>(cells.size());
         }
+
+        break;
+    }
+    default:
+    {
+        // transposing already complained about this column, keep the row shape intact
+        std::fill(cellEnds.begin(), cellEnds.end(), static_cast<uint32_t>(cells.size()));
+        break;
     }
+    }
+}
+
+// CSV and TSV share everything but the separator and quoting, rapidcsv (and so repak) reads the quoted CSV
+static bool ExportTextDatatableAsset(const std::vector<DatatableColumnValues_t>& columns, const int numRows, std::filesystem::path& exportPath, const eDatatableExportSetting setting, const uint32_t numThreads)
+{
+    const bool quoted = setting == eDatatableExportSetting::CSV;
+    const char separator = quoted ? ',' : '\t';
+
+    exportPath.replace_extension(quoted ? ".csv" : ".tsv");
+
+    StreamIO out;
+    if (!out.open(exportPath.string(), eStreamIOMode::Write))
+    {
+        assertm(false, "Failed to open file for write.");
+        return false;
+    }
+
+    const size_t numColumns = columns.size();
+
+    // set up the header row
+    std::string header;
+    for (size_t i = 0; i < numColumns; i++)
+    {
+        if (quoted)
+        {
+            header.push_back('"');
+            header.append(columns[i].column->name);
+            header.push_back('"');
+        }
+        else
+        {
+            Datatable_AppendTSVEscaped(header, columns[i].column->name);
+        }
+
+        header.push_back(i == (numColumns - 1) ? '\n' : separator);
+    }
+
+    out.write(header.data(), header.size());
+
+    // rows are formatted in fixed size chunks, each column of a chunk in one pass, then stitched together into lines
+    const size_t numChunks = (static_cast<size_t>(numRows) + s_DatatableTextChunkRows - 1) / s_DatatableTextChunkRows;
+    std::vector<std::string> chunkText(numChunks);
 
-    // Write a final row to the CSV file as a "type row"
+    ParallelFor(numChunks, numThreads, [&](const size_t chunkIdx)
+        {
+            const int firstRow = static_cast<int>(chunkIdx) * s_DatatableTextChunkRows;
+            const int chunkRows = std::min(s_DatatableTextChunkRows, numRows - firstRow);
+
+            std::vector<std::string> cells(numColumns);
+            std::vector<std::vector<uint32_t>> cellEnds(numColumns);
+
+            size_t textSize = 0ull;
+            for (size_t i = 0; i < numColumns; i++)
+            {
+                Datatable_FormatColumnCells(columns[i], firstRow, chunkRows, quoted, cells[i], cellEnds[i]);
+                textSize += cells[i].size() + chunkRows;
+            }
+
+            std::string& text = chunkText[chunkIdx];
+            text.reserve(textSize);
+
+            for (int row = 0; row < chunkRows; row++)
+            {
+                for (size_t i = 0; i < numColumns; i++)
+                {
+                    const uint32_t cellStart = row > 0 ? cellEnds[i][row - 1] : 0u;
+
+                    text.append(cells[i], cellStart, cellEnds[i][row] - cellStart);
+                    text.push_back(i == (numColumns - 1) ? '\n' : separator);
+                }
+            }
+        });
+
+    for (const std::string& text : chunkText)
+        out.write(text.data(), text.size());
+
+    // Write a final row to the file as a "type row"
     // This row simply contains the names of each column's data type
-    for (int i = 0; i < dtblAsset->numColumns; i++)
+    std::string typeRow;
+    for (size_t i = 0; i < numColumns; i++)
     {
-        out << s_DatatableColumnTypeName[static_cast<int>(dtblAsset->GetColumn(i)->type)];
+        const std::string_view typeName = s_DatatableColumnTypeName[static_cast<int>(columns[i].column->type)];
+
+        // the type names are stored quoted for the CSV
+        typeRow.append(quoted ? typeName : typeName.substr(1, typeName.length() - 2));
 
         // rapidcsv handles an empty line as a new entry, so unlike other columns,
         // we shouldn't newline here when we reached the last column as otherwise
         // we will treat the empty line as the asset type row in repak.
-        out << (i == (dtblAsset->numColumns - 1) ? "" : ",");
+        if (i != (numColumns - 1))
+            typeRow.push_back(separator);
     }
 
-    outFile.close();
+    out.write(typeRow.data(), typeRow.size());
+    out.close();
 
     return true;
 }
-#undef HANDLE_LAST_COLUMN
+
+// columnar binary export, strings stripped by DFS are written as nulls
+static bool ExportArrowDatatableAsset(const std::vector<DatatableColumnValues_t>& columns, const int numRows, std::filesystem::path& exportPath)
+{
+    exportPath.replace_extension(".arrow");
+
+    CArrowFileWriter writer(numRows);
+
+    for (const DatatableColumnValues_t& values : columns)
+    {
+        const std::string name = values.column->name;
+
+        switch (values.column->type)
+        {
+        case DatatableColumType_t::Bool:
+        {
+            writer.AddBoolColumn(name, values.bools.data());
+            break;
+        }
+        case DatatableColumType_t::Int:
+        {
+            writer.AddInt32Column(name, values.ints.data());
+            break;
+        }
+        case DatatableColumType_t::Float:
+        {
+            writer.AddFloatColumn(name, values.floats.data());
+            break;
+        }
+        case DatatableColumType_t::Vector:
+        {
+            writer.AddFloatListColumn(name, values.floats.data(), 3);
+            break;
+        }
+        case DatatableColumType_t::String:
+        case DatatableColumType_t::Asset:
+        case DatatableColumType_t::AssetNoPrecache:
+        {
+            writer.AddStringColumn(name, values.strings.data(), values.hasStripped ? values.valid.data() : nullptr);
+            break;
+        }
+        default:
+        {
+            assertm(false, "Unknown or invalid DataTable column type");
+            return false;
+        }
+        }
+    }
+
+    return writer.Write(exportPath);
+}
 
 bool ExportDatatableAsset(CAsset* const asset, const int setting)
 {
@@ -271,11 +554,22 @@ bool ExportDatatableAsset(CAsset* const asset, const int setting)
 
     exportPath.append(stgsPath.filename().string());
 
+    const uint32_t numThreads = CThread::GetNestedExportThreadBudget(UINT32_MAX);
+
+    // every format reads the table column by column, so pull the values out of the rows once up front
+    std::vector<DatatableColumnValues_t> columns(dtblAsset->numColumns);
+    ParallelFor(columns.size(), numThreads, [&](const size_t i) { Datatable_TransposeColumn(dtblAsset, static_cast<int>(i), columns[i]); });
+
     switch (setting)
     {
     case eDatatableExportSetting::CSV:
+    case eDatatableExportSetting::TSV:
     {
-        return ExportCSVDatatableAsset(pakAsset, dtblAsset, exportPath);
+        return ExportTextDatatableAsset(columns, dtblAsset->numRows, exportPath, static_cast<eDatatableExportSetting>(setting), numThreads);
+    }
+    case eDatatableExportSetting::ARROW:
+    {
+        return ExportArrowDatatableAsset(columns, dtblAsset->numRows, exportPath);
     }
     default:
     {
@@ -289,6 +583,7 @@ bool ExportDatatableAsset(CAsset* const asset, const int setting)
 
 void InitDatatableAssetType()
 {
+    static const char* settings[] = { "CSV", "TSV", "Arrow (Columnar)" };
     AssetTypeBinding_t type =
     {
         .name = "DataTable",
@@ -297,8 +592,8 @@ void InitDatatableAssetType()
         .loadFunc = LoadDatatableAsset,
         .postLoadFunc = nullptr,
         .previewFunc = PreviewDatatableAsset,
-        .e = { ExportDatatableAsset, 0, nullptr, 0ull },
+        .e = { ExportDatatableAsset, 0, settings, ARRSIZE(settings) },
     };
 
     REGISTER_TYPE(type);
-}
\ No newline at end of file
+}
@@ -114,7 +114,11 @@ bool ExportLocalisationAsset(CAsset* const asset, const int setting)
     exportPath.append(loclAsset->fileName); // likely quicker than "exportPath.append(localizationPath.stem().string());"
     exportPath.replace_extension(".locl");
 
-    std::ofstream ofs(exportPath, std::ios::out | std::ios::binary);
+    StreamIO out(exportPath, eStreamIOMode::Write);
+    if (!out.W())
+        return false;
+
+    std::ofstream& ofs = *out.W();
 
     ofs << "\"" << loclAsset->fileName << "\"\n{\n";
 
@@ -140,7 +144,7 @@ bool ExportLocalisationAsset(CAsset* const asset, const int setting)
 
     ofs << "}";
 
-    ofs.close();
+    out.close();
 
     return true;
 }
@@ -45,71 +45,24 @@ void PostLoadLocalizationAsset(CAssetContainer* pak, CAsset* asset)
     }
 }
 
-std::string EscapeLocalizationString(const std::string& str)
+void WriteLocalizationAssetText(const LocalizationAsset* const loclAsset, CTextBuilder& out)
 {
-    std::stringstream outStream;
+    out.Clear();
 
-    for (int i = 0; i < str.length(); ++i)
+    out.Append('\"');
+    out.Append(loclAsset->fileName);
+    out.Append("\"\n{\n");
+
+    for (const auto& it : loclAsset->entryMap)
     {
-        unsigned char c = str.at(i);
-
-        // if this char is over ascii then it's a multibyte sequence
-        if (c > 0x7F)
-        {
-            // find the number of bytes to add to the stringstream
-            int numBytes = 0;
-
-            if (c <= 0xBF)
-                numBytes = 1;
-            else if (c >= 0xc2 && c <= 0xdf) // 0xC2 -> 0xDF - 2 byte sequence
-                numBytes = 2;
-            else if (c >= 0xe0 && c <= 0xef) // 0xE0 -> 0xEF - 3 byte sequence
-                numBytes = 3;
-            else if (c >= 0xf0 && c <= 0xf4) // 0xF0 -> 0xF4 - 4 byte sequence
-                numBytes = 4;
-
-            assert(numBytes != 0);
-
-            for (int j = 0; j < numBytes; ++j)
-            {
-                outStream << str.at(i + j);
-            }
-
-            // add numBytes-1 to the char index
-            // since one increment will already be handled by the for loop
-            i += numBytes-1;
-            continue;
-        }
-
-        switch (c)
-        {
-        case '\0':
-            break;
-        case '\t':
-            outStream << "\\t";
-            break;
-        case '\n':
-            outStream << "\\n";
-            break;
-        case '\r':
-            outStream << "\\r";
-            break;
-        case '\"':
-            outStream << "\\\"";
-            break;
-        default:
-        {
-            if (!std::isprint(c))
-                outStream << std::hex << std::setfill('0') << std::setw(2) << "\\x" << (int)c;
-            else
-                outStream << c;
-
-            break;
-        }
-        }
+        out.Append("\t\"");
+        out.AppendHex(it.first);
+        out.Append("\" \"");
+        out.AppendEscapedKV(it.second);
+        out.Append("\"\n");
     }
 
-    return outStream.str();
+    out.Append('}');
 }
 
 static const char* const s_PathPrefixLOCL = s_AssetTypePaths.find(AssetType_t::LOCL)->second;
@@ -139,19 +92,20 @@ bool ExportLocalizationAsset(CAsset* const asset, const int setting)
     exportPath.append(loclAsset->fileName);
     exportPath.replace_extension(".locl");
 
-    std::ofstream ofs(exportPath, std::ios::out | std::ios::binary);
-
-    ofs << "\"" << loclAsset->fileName << "\"\n{\n";
+    static thread_local CTextBuilder text;
+    WriteLocalizationAssetText(loclAsset, text);
 
-
-    for (auto& it : loclAsset->entryMap)
+    StreamIO out;
+    if (!out.open(exportPath.string(), eStreamIOMode::Write))
     {
-        ofs << "\t\"" << std::hex << it.first << "\" \"" << EscapeLocalizationString(it.second).c_str() << "\"\n"; // use the .c_str() function here now so it gets null terminated properly (if there's extra data or it's cut off, there will no longer be a [NUL] character in the file.
+        assertm(false, "Failed to open file for write.");
+        return false;
     }
 
-    ofs << "}";
+    out.write(text.Data(), text.Length());
+    out.close();
 
-    ofs.close();
+    text.Clear();
 
     return true;
 }
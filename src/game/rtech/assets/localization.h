@@ -1,4 +1,5 @@
 #pragma once
+#include <core/utils/textbuilder.h>
 
 #pragma pack(push, 1)
 struct LocalizationEntry_t
@@ -36,4 +37,7 @@ struct LocalizationAsset
     std::unordered_map<uint64_t, std::string> entryMap;
 
     std::string getName() { return fileName; };
-};
\ No newline at end of file
+};
+
+// writes the exported .locl text, entries are keyed by their hash in hex
+void WriteLocalizationAssetText(const LocalizationAsset* const loclAsset, CTextBuilder& out);
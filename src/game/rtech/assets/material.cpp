@@ -271,6 +271,9 @@ void PostLoadMaterialAsset(CAssetContainer* const container, CAsset* const asset
         materialAsset->txtrAssets.push_back(TextureAssetEntry_t(textureAsset, static_cast<uint32_t>(i)));
     }
 
+    // textures or bindings may have changed if this isn't the first time we've been post loaded
+    g_MaterialExportCache.Invalidate(materialAsset);
+
     if (materialAsset->cpuData)
     {
         CreateD3DBuffer(g_dxHandler->GetDevice(),
@@ -838,7 +841,7 @@ static inline void TextureNameReal(MaterialTextureExportInfo_s& info, const std:
         info.exportPath = tmp.parent_path();
 }
 
-void ParseMaterialTextureExportInfo(std::unordered_map<uint32_t, MaterialTextureExportInfo_s>& textures, const MaterialAsset* materialAsset, const std::filesystem::path& exportPath, const eTextureExportName nameSetting, const bool useFullPaths)
+void ParseMaterialTextureExportInfo(MaterialTextureExportMap_t& textures, const MaterialAsset* materialAsset, const std::filesystem::path& exportPath, const eTextureExportName nameSetting, const bool useFullPaths)
 {
     textures.clear();
 
@@ -930,7 +933,104 @@ void ParseMaterialTextureExportInfo(std::unordered_map<uint32_t, MaterialTexture
     }
 }
 
-void ExportMaterialTextures(const int setting, const MaterialAsset* materialAsset, const std::unordered_map<uint32_t, MaterialTextureExportInfo_s>& textureInfo)
+CMaterialExportCache g_MaterialExportCache;
+
+std::shared_ptr<const MaterialTextureExportMap_t> CMaterialExportCache::GetTextureExportInfo(const MaterialAsset* const materialAsset, const std::filesystem::path& exportPath, const eTextureExportName nameSetting, const bool useFullPaths)
+{
+    auto findResolved = [&](const std::vector<ResolvedMaterial_t>& resolved) -> std::shared_ptr<const MaterialTextureExportMap_t>
+        {
+            for (const ResolvedMaterial_t& entry : resolved)
+            {
+                if (entry.asset == materialAsset && entry.nameSetting == nameSetting && entry.useFullPaths == useFullPaths && entry.exportPath == exportPath)
+                    return entry.textures;
+            }
+
+            return nullptr;
+        };
+
+    {
+        std::lock_guard<std::mutex> lock(m_resolvedMutex);
+
+        if (const auto it = m_resolvedMaterials.find(materialAsset->guid); it != m_resolvedMaterials.end())
+        {
+            if (std::shared_ptr<const MaterialTextureExportMap_t> textures = findResolved(it->second))
+            {
+                m_numResolveHits++;
+                return textures;
+            }
+        }
+    }
+
+    // parse outside of the lock, this is the slow part
+    std::shared_ptr<MaterialTextureExportMap_t> textures = std::make_shared<MaterialTextureExportMap_t>();
+    ParseMaterialTextureExportInfo(*textures, materialAsset, exportPath, nameSetting, useFullPaths);
+
+    std::lock_guard<std::mutex> lock(m_resolvedMutex);
+
+    std::vector<ResolvedMaterial_t>& resolved = m_resolvedMaterials[materialAsset->guid];
+
+    // another thread resolved the same material while we were parsing, use theirs so everyone shares the same data
+    if (std::shared_ptr<const MaterialTextureExportMap_t> existing = findResolved(resolved))
+    {
+        m_numResolveHits++;
+        return existing;
+    }
+
+    // entries for a different asset with this guid are from paks that have been unloaded (or another pak with the same material), replace them
+    std::erase_if(resolved, [materialAsset](const ResolvedMaterial_t& entry) { return entry.asset != materialAsset; });
+    resolved.push_back({ materialAsset, exportPath, nameSetting, useFullPaths, textures });
+
+    m_numResolveMisses++;
+    return textures;
+}
+
+void CMaterialExportCache::Invalidate(const MaterialAsset* const materialAsset)
+{
+    std::lock_guard<std::mutex> lock(m_resolvedMutex);
+
+    m_resolvedMaterials.erase(materialAsset->guid);
+}
+
+bool CMaterialExportCache::ClaimTextureExport(const std::filesystem::path& exportPath, const int setting)
+{
+    // the same file with a different setting (e.g. png and dds, or mip counts) is a different export
+    std::string key = exportPath.string();
+    key.append(std::format("|{}", setting));
+
+    std::lock_guard<std::mutex> lock(m_exportedMutex);
+
+    if (m_exportedTextures.insert(std::move(key)).second)
+        return true;
+
+    m_numExportsSkipped++;
+    return false;
+}
+
+void CMaterialExportCache::ResetExportedTextures()
+{
+    uint64_t numResolveHits = 0ull;
+    uint64_t numResolveMisses = 0ull;
+
+    {
+        std::lock_guard<std::mutex> lock(m_resolvedMutex);
+
+        numResolveHits = m_numResolveHits;
+        numResolveMisses = m_numResolveMisses;
+
+        m_numResolveHits = 0ull;
+        m_numResolveMisses = 0ull;
+    }
+
+    std::lock_guard<std::mutex> lock(m_exportedMutex);
+
+    if (numResolveHits || m_numExportsSkipped)
+        Log("MATL: resolved textures for %llu materials (%llu cache hits), %llu textures exported, %llu repeated texture exports skipped\n", numResolveMisses, numResolveHits, m_exportedTextures.size(), m_numExportsSkipped);
+
+    m_exportedTextures.clear();
+    m_numExportsSkipped = 0ull;
+}
+
+void ExportMaterialTextures(const int setting, const MaterialAsset* materialAsset, const MaterialTextureExportMap_t& textureInfo)
 {
     for (auto& entry : materialAsset->txtrAssets)
     {
@@ -951,6 +1051,10 @@ void ExportMaterialTextures(const int setting, const MaterialAsset* materialAsse
 
         exportPath.append(info->exportName);
 
+        // textures are shared between materials, and materials between models. only write each one once.
+        if (!g_MaterialExportCache.ClaimTextureExport(exportPath, setting))
+            continue;
+
         TextureAsset* const textureAsset = asset->extraData<TextureAsset* const>();
 
         switch (setting)
@@ -985,13 +1089,18 @@ FORCEINLINE void ExportMaterialStructWriteGUID(const TextureAssetEntry_t& tex, s
 
 // [amos]: when the rson parser is finished, we should make both rsx and repak use rson.
 bool ExportMaterialStruct(const MaterialAsset* const materialAsset, 
-    std::filesystem::path& exportPath, const std::unordered_map<uint32_t, MaterialTextureExportInfo_s>& textureInfo)
+    std::filesystem::path& exportPath, const MaterialTextureExportMap_t& textureInfo)
 {
     if (materialAsset->materialType == _TYPE_LEGACY)
         return false;
 
     exportPath.replace_extension(".json");
-    std::ofstream ofs(exportPath, std::ios::out);
+
+    StreamIO out(exportPath, eStreamIOMode::Write, true);
+    if (!out.W())
+        return false;
+
+    std::ofstream& ofs = *out.W();
 
     // [rika]: some material names (notably r2 materials) use '\\' instead of '/'
     std::string materialName(materialAsset->name);
@@ -1171,7 +1280,7 @@ bool ExportMaterialAsset(CAsset* const asset, const int setting)
     auto txtrAssetBinding = g_assetData.m_assetTypeBindings.find('rtxt');
 
     // [rika]: grab our paths and names for textures
-    std::unordered_map<uint32_t, MaterialTextureExportInfo_s> textureNames;
+    std::shared_ptr<const MaterialTextureExportMap_t> textureNames;
     {
         std::filesystem::path texturePath;
         // textures should be exported to 'texture/' instead
@@ -1190,12 +1299,12 @@ bool ExportMaterialAsset(CAsset* const asset, const int setting)
             texturePath = exportPath.string().c_str() + truncate;
         }
 
-        ParseMaterialTextureExportInfo(textureNames, materialAsset, texturePath, static_cast<eTextureExportName>(g_ExportSettings.exportTextureNameSetting), g_ExportSettings.exportPathsFull);
+        textureNames = g_MaterialExportCache.GetTextureExportInfo(materialAsset, texturePath, static_cast<eTextureExportName>(g_ExportSettings.exportTextureNameSetting), g_ExportSettings.exportPathsFull);
     }
 
     // [rika]: export the material's textures if we're doing that
     if (g_ExportSettings.exportMaterialTextures && txtrAssetBinding != g_assetData.m_assetTypeBindings.end() && materialAsset->txtrAssets.size())
-        ExportMaterialTextures(txtrAssetBinding->second.e.exportSetting, materialAsset, textureNames);
+        ExportMaterialTextures(txtrAssetBinding->second.e.exportSetting, materialAsset, *textureNames);
 
     std::filesystem::path materialExportPath = exportPath;
     materialExportPath /= materialPath.stem();
@@ -1210,11 +1319,11 @@ bool ExportMaterialAsset(CAsset* const asset, const int setting)
     {
         // [amos]: when exporting cpu we typically also want the material itself so
         // it can be used directly in repak
-        return ExportRawMaterialAsset(materialAsset, materialExportPath) && ExportMaterialStruct(materialAsset, materialExportPath, textureNames);
+        return ExportRawMaterialAsset(materialAsset, materialExportPath) && ExportMaterialStruct(materialAsset, materialExportPath, *textureNames);
     }
     case eMaterialExportSetting::MATL_UBER_S:
     {
-        return ExportStructMaterialAsset(materialAsset, materialExportPath) && ExportMaterialStruct(materialAsset, materialExportPath, textureNames);
+        return ExportStructMaterialAsset(materialAsset, materialExportPath) && ExportMaterialStruct(materialAsset, materialExportPath, *textureNames);
     }
     default:
     {
@@ -831,5 +831,49 @@ struct MaterialTextureExportInfo_s
 	bool isNormal;
 };
 
-void ParseMaterialTextureExportInfo(std::unordered_map<uint32_t, MaterialTextureExportInfo_s>& textures, const MaterialAsset* materialAsset, const std::filesystem::path& exportPath, const eTextureExportName nameSetting, const bool useFullPaths);
-void ExportMaterialTextures(const int setting, const MaterialAsset* materialAsset, const std::unordered_map<uint32_t, MaterialTextureExportInfo_s>& textureInfo);
\ No newline at end of file
+typedef std::unordered_map<uint32_t, MaterialTextureExportInfo_s> MaterialTextureExportMap_t;
+
+void ParseMaterialTextureExportInfo(MaterialTextureExportMap_t& textures, const MaterialAsset* materialAsset, const std::filesystem::path& exportPath, const eTextureExportName nameSetting, const bool useFullPaths);
+void ExportMaterialTextures(const int setting, const MaterialAsset* materialAsset, const MaterialTextureExportMap_t& textureInfo);
+
+// Process wide cache of resolved material textures
+// Materials get exported many times over (once per model that uses them, on top of their own export), and their textures are shared
+// between materials, so texture names/paths are resolved once per material and each texture file is only written once per export run.
+class CMaterialExportCache
+{
+public:
+	// resolved textures for this material, parsed on first use and shared by every later export with the same path and name settings
+	std::shared_ptr<const MaterialTextureExportMap_t> GetTextureExportInfo(const MaterialAsset* const materialAsset, const std::filesystem::path& exportPath, const eTextureExportName nameSetting, const bool useFullPaths);
+
+	// drops everything resolved for this material, its textures can change when more paks are loaded
+	void Invalidate(const MaterialAsset* const materialAsset);
+
+	// returns true if the caller is the first to export this texture file this run, and should export it
+	bool ClaimTextureExport(const std::filesystem::path& exportPath, const int setting);
+
+	// called when an export run is finished, so textures get written again on the next one (they may have been removed since)
+	void ResetExportedTextures();
+
+private:
+	struct ResolvedMaterial_t
+	{
+		const MaterialAsset* asset; // validates the entry, guids can be shared between loaded paks
+		std::filesystem::path exportPath;
+		eTextureExportName nameSetting;
+		bool useFullPaths;
+
+		std::shared_ptr<const MaterialTextureExportMap_t> textures;
+	};
+
+	std::mutex m_resolvedMutex;
+	std::unordered_map<uint64_t, std::vector<ResolvedMaterial_t>> m_resolvedMaterials; // keyed by material guid
+
+	std::mutex m_exportedMutex;
+	std::unordered_set<std::string> m_exportedTextures;
+
+	uint64_t m_numResolveHits = 0ull;
+	uint64_t m_numResolveMisses = 0ull;
+	uint64_t m_numExportsSkipped = 0ull;
+};
+
+extern CMaterialExportCache g_MaterialExportCache;
\ No newline at end of file
@@ -5,7 +5,7 @@
 #include <game/rtech/assets/texture.h>
 #include <game/rtech/assets/material.h>
 #include <game/rtech/assets/rson.h>
-#include <game/rtech/utils/bvh/bvh.h>
+#include <game/rtech/utils/bvh/bvhquery.h>
 #include <game/rtech/utils/bsp/bspflags.h>
 
 #include <core/render/dx.h>
@@ -944,6 +944,85 @@ static void ParseModelTextureData_v16(ModelParsedData_t* const parsedData)
         parsedData->skins.emplace_back(pStudioHdr->pSkinName(i), pStudioHdr->pSkinFamily(i));
 }
 
+// parses vertex data again after it has been evicted
+static void ReparseModelVertexData(CPakAsset* const pakAsset, ModelAsset* const modelAsset)
+{
+    switch (modelAsset->version)
+    {
+    case eMDLVersion::VERSION_8:
+        ParseModelVertexData_v8(pakAsset, modelAsset);
+        break;
+    case eMDLVersion::VERSION_9:
+    case eMDLVersion::VERSION_10:
+    case eMDLVersion::VERSION_11:
+    case eMDLVersion::VERSION_12:
+        ParseModelVertexData_v9(pakAsset, modelAsset);
+        break;
+    case eMDLVersion::VERSION_12_1:
+    case eMDLVersion::VERSION_12_2:
+    case eMDLVersion::VERSION_12_3:
+    case eMDLVersion::VERSION_12_4:
+    case eMDLVersion::VERSION_12_5:
+    case eMDLVersion::VERSION_13:
+    case eMDLVersion::VERSION_13_1:
+        ParseModelVertexData_v12_1(pakAsset, modelAsset);
+        break;
+    case eMDLVersion::VERSION_14:
+    case eMDLVersion::VERSION_14_1:
+    case eMDLVersion::VERSION_15:
+        ParseModelVertexData_v14(pakAsset, modelAsset);
+        break;
+    case eMDLVersion::VERSION_16:
+    case eMDLVersion::VERSION_17:
+    case eMDLVersion::VERSION_18:
+    case eMDLVersion::VERSION_19:
+    case eMDLVersion::VERSION_19_1:
+        ParseModelVertexData_v16(pakAsset, modelAsset);
+        break;
+    default:
+        assertm(false, "unaccounted asset version, will cause major issues!");
+        break;
+    }
+}
+
+// drops parsed vertex data until we are under the memory budget, it gets parsed again when the model is next used
+static size_t EvictModelVertexData(const size_t bytesToFree)
+{
+    size_t freedSize = 0ull;
+
+    for (const CGlobalAssetData::AssetLookup_t& lookup : g_assetData.v_assets)
+    {
+        if (freedSize >= bytesToFree)
+            break;
+
+        if (lookup.m_asset->GetAssetType() != '_ldm' || lookup.m_asset->GetAssetContainerType() != CAsset::ContainerType::PAK)
+            continue;
+
+        ModelAsset* const modelAsset = static_cast<CPakAsset*>(lookup.m_asset)->extraData<ModelAsset*>();
+        if (!modelAsset)
+            continue;
+
+        ModelParsedData_t* const parsedData = modelAsset->GetParsedData();
+
+        const size_t size = parsedData->meshVertexData.memorySize();
+        if (size == 0ull)
+            continue;
+
+        const bool evicted = modelAsset->vertexData.TryEvict([parsedData]
+            {
+                parsedData->meshVertexData.nuke();
+                parsedData->lods.clear();
+                parsedData->lods.shrink_to_fit();
+                parsedData->bodyParts.clear();
+            });
+
+        if (evicted)
+            freedSize += size;
+    }
+
+    return freedSize;
+}
+
 void LoadModelAsset(CAssetContainer* const pak, CAsset* const asset)
 {
     UNUSED(pak);
@@ -1248,6 +1327,10 @@ void* PreviewModelAsset(CAsset* const asset, const bool firstFrameForAsset)
 
     ModelAsset* const modelAsset = reinterpret_cast<ModelAsset*>(pakAsset->extraData());
 
+    // vertex data may have been evicted to stay under the memory budget
+    modelAsset->vertexData.Acquire([pakAsset, modelAsset] { ReparseModelVertexData(pakAsset, modelAsset); });
+    const CEvictableDataRef vertexDataRef(&modelAsset->vertexData);
+
     ModelParsedData_t* const parsedData = modelAsset->GetParsedData();
 
     static ModelPreviewInfo_t previewInfo;
@@ -1489,12 +1572,7 @@ static bool ExportPhysicsModelPhy(const ModelAsset* const modelAsset, std::files
                     if (idx1 == -1 || idx2 == -1)
                         break;
 
-                    Triangle& tri = colModel.tris.emplace_back();
-
-                    tri.a = base;
-                    tri.b = verts[idx1];
-                    tri.c = verts[idx2];
-                    tri.flags = 0;
+                    colModel.AddTri(base, verts[idx1], verts[idx2], 0u);
                 }
             }
         }
@@ -1506,15 +1584,28 @@ static bool ExportPhysicsModelPhy(const ModelAsset* const modelAsset, std::files
     return colModel.exportSTL(exportPath.replace_extension(".stl"));
 }
 
+static bool ExportCollisionModel(CollisionModel_t& colModel, std::filesystem::path& exportPath, const int setting)
+{
+    switch (setting)
+    {
+    case eModelExportSetting::MODEL_PLY_RESPAWN_PHYSICS:
+        return colModel.exportPLY(exportPath.replace_extension(".ply"));
+    case eModelExportSetting::MODEL_OBJ_RESPAWN_PHYSICS:
+        return colModel.exportOBJ(exportPath.replace_extension(".obj"));
+    default:
+        return colModel.exportSTL(exportPath.replace_extension(".stl"));
+    }
+}
+
+// fills out a BVHModel_t for every collision header in the model, contents filters are left to the caller
 template <typename mstudiocollmodel_t, typename mstudiocollheader_t>
-static bool ExportPhysicsModelBVH(const ModelAsset* const modelAsset, std::filesystem::path& exportPath)
+static bool GetPhysicsModelBVHs(const ModelAsset* const modelAsset, std::vector<BVHModel_t>& bvhModels)
 {
     const studiohdr_generic_t& hdr = modelAsset->StudioHdr();
 
     if (!hdr.bvhOffset)
         return false;
 
-    CollisionModel_t outModel;
     const void* bvhData = (const char*)modelAsset->data + hdr.bvhOffset;
 
     const mstudiocollmodel_t* collModel = reinterpret_cast<const mstudiocollmodel_t*>(bvhData);
@@ -1529,6 +1620,8 @@ static bool ExportPhysicsModelBVH(const ModelAsset* const modelAsset, std::files
 
     const uint32_t* maskData = reinterpret_cast<const uint32_t*>((reinterpret_cast<const char*>(collModel) + collModel->contentMasksIndex));
 
+    bvhModels.reserve(headerCount);
+
     for (int i = 0; i < headerCount; i++)
     {
         const mstudiocollheader_t& collHeader = collHeaders[i];
@@ -1537,7 +1630,7 @@ static bool ExportPhysicsModelBVH(const ModelAsset* const modelAsset, std::files
         const void* vertData = reinterpret_cast<const char*>(collModel) + collHeader.vertIndex;
         const void* leafData = reinterpret_cast<const char*>(collModel) + collHeader.bvhLeafIndex;
 
-        BVHModel_t data;
+        BVHModel_t& data = bvhModels.emplace_back();
 
         data.nodes = reinterpret_cast<const dbvhnode_t*>(bvhNodes);
         data.verts = reinterpret_cast<const Vector*>(vertData);
@@ -1546,23 +1639,65 @@ static bool ExportPhysicsModelBVH(const ModelAsset* const modelAsset, std::files
         data.masks = reinterpret_cast<const uint32_t*>(maskData);
         data.origin = reinterpret_cast<const Vector*>(&collHeader.origin);
         data.scale = collHeader.scale;
+        data.maskFilter = 0u;
+        data.filterExclusive = true; // nothing filtered
+        data.filterAND = false;
+    }
+
+    return true;
+}
+
+static bool GetPhysicsModelBVHs(const ModelAsset* const modelAsset, std::vector<BVHModel_t>& bvhModels)
+{
+    if (modelAsset->version >= eMDLVersion::VERSION_12_1)
+        return GetPhysicsModelBVHs<r5::mstudiocollmodel_v8_t, r5::mstudiocollheader_v12_t>(modelAsset, bvhModels);
+    else
+        return GetPhysicsModelBVHs<r5::mstudiocollmodel_v8_t, r5::mstudiocollheader_v8_t>(modelAsset, bvhModels);
+}
+
+static bool ExportPhysicsModelBVH(const ModelAsset* const modelAsset, std::filesystem::path& exportPath, const int setting)
+{
+    std::vector<BVHModel_t> bvhModels;
+
+    if (!GetPhysicsModelBVHs(modelAsset, bvhModels))
+        return false;
+
+    CollisionModel_t outModel;
+
+    for (BVHModel_t& data : bvhModels)
+    {
         data.maskFilter = g_ExportSettings.exportPhysicsContentsFilter;
         data.filterExclusive = g_ExportSettings.exportPhysicsFilterExclusive;
         data.filterAND = g_ExportSettings.exportPhysicsFilterAND;
 
-        const dbvhnode_t* startNode = reinterpret_cast<const dbvhnode_t*>(bvhNodes);
-        const uint32_t contents = maskData[startNode->cmIndex];
-
-        Coll_HandleNodeChildType(outModel, contents, 0, startNode->child0Type, startNode->index0, &data);
-        Coll_HandleNodeChildType(outModel, contents, 0, startNode->child1Type, startNode->index1, &data);
-        Coll_HandleNodeChildType(outModel, contents, 0, startNode->child2Type, startNode->index2, &data);
-        Coll_HandleNodeChildType(outModel, contents, 0, startNode->child3Type, startNode->index3, &data);
+        Coll_ParseBVH(outModel, &data);
     }
 
     if (!outModel.tris.size() && !outModel.quads.size())
         return false;
 
-    outModel.exportSTL(exportPath.replace_extension(".stl"));
+    ExportCollisionModel(outModel, exportPath, setting);
+    return true;
+}
+
+bool GetModelCollisionQuery(CAsset* const asset, CCollisionQuery& query)
+{
+    if (asset->GetAssetContainerType() != CAsset::ContainerType::PAK || asset->GetAssetType() != '_ldm')
+        return false;
+
+    const ModelAsset* const modelAsset = reinterpret_cast<ModelAsset*>(static_cast<CPakAsset*>(asset)->extraData());
+
+    if (!modelAsset)
+        return false;
+
+    std::vector<BVHModel_t> bvhModels;
+
+    if (!GetPhysicsModelBVHs(modelAsset, bvhModels))
+        return false;
+
+    for (const BVHModel_t& data : bvhModels)
+        query.AddBVH(&data);
+
     return true;
 }
 
@@ -1572,11 +1707,15 @@ bool ExportModelAsset(CAsset* const asset, const int setting)
     CPakAsset* const pakAsset = static_cast<CPakAsset*>(asset);
     assertm(pakAsset, "Asset should be valid.");
 
-    const ModelAsset* const modelAsset = reinterpret_cast<ModelAsset*>(pakAsset->extraData());
+    ModelAsset* const modelAsset = reinterpret_cast<ModelAsset*>(pakAsset->extraData());
 
     if (!modelAsset)
         return false;
 
+    // vertex data may have been evicted to stay under the memory budget
+    modelAsset->vertexData.Acquire([pakAsset, modelAsset] { ReparseModelVertexData(pakAsset, modelAsset); });
+    const CEvictableDataRef vertexDataRef(&modelAsset->vertexData);
+
     std::unique_ptr<char[]> streamedData = pakAsset->getStarPakData(modelAsset->vertexStreamingData.offset, modelAsset->vertexStreamingData.size, false);
 
     assertm(modelAsset->name, "No name for model.");
@@ -1658,14 +1797,13 @@ bool ExportModelAsset(CAsset* const asset, const int setting)
                 return ExportPhysicsModelPhy<irps::phyheader_t>(modelAsset, exportPath);
         }
         case eModelExportSetting::MODEL_STL_RESPAWN_PHYSICS:
+        case eModelExportSetting::MODEL_PLY_RESPAWN_PHYSICS:
+        case eModelExportSetting::MODEL_OBJ_RESPAWN_PHYSICS:
         {
             // [amos]: the high detail bvh4 mesh seems encased in a mesh that is
             // more or less identical to the vphysics one. The polygon winding
             // order of the vphysics replica is however always inverted.
-            if (modelAsset->version >= eMDLVersion::VERSION_12_1)
-                return ExportPhysicsModelBVH<r5::mstudiocollmodel_v8_t, r5::mstudiocollheader_v12_t>(modelAsset, exportPath);
-            else
-                return ExportPhysicsModelBVH<r5::mstudiocollmodel_v8_t, r5::mstudiocollheader_v8_t>(modelAsset, exportPath);
+            return ExportPhysicsModelBVH(modelAsset, exportPath, setting);
         }
         default:
         {
@@ -1691,4 +1829,6 @@ void InitModelAssetType()
     };
 
     REGISTER_TYPE(type);
+
+    g_MemoryTracker.RegisterEvictor(eMemoryCategory::MEM_VERTEX_DATA, EvictModelVertexData);
 }
\ No newline at end of file
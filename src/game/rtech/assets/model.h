@@ -427,6 +427,7 @@ public:
 	uint32_t numAnimSeqs;
 
 	ModelParsedData_t parsedData;
+	CEvictableData vertexData; // lods, body parts and mesh vertex data in parsedData, can be evicted when over the memory budget
 
 	eMDLVersion version; // like asset version, but takes between version revisions into consideration
 
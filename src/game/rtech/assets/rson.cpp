@@ -25,15 +25,24 @@ void LoadRSONAsset(CAssetContainer* const container, CAsset* const asset)
         return;
     }
 
-    std::stringstream out;
-    RSONAssetNode_t rootNode(rsonAsset);
-    rootNode.R_ParseNodeValues(out, 0); // store raw text so we can preview or export it
-    rsonAsset->rawText = out.str();
+    // load threads each keep one builder around, only the finished text gets its own allocation
+    static thread_local CTextBuilder out;
+
+    WriteRSONAssetText(rsonAsset, out); // store raw text so we can preview or export it
+    rsonAsset->rawText = out.View();
 
 	pakAsset->SetAssetNameFromCache();
 	pakAsset->setExtraData(rsonAsset);
 }
 
+void WriteRSONAssetText(const RSONAsset* const rsonAsset, CTextBuilder& out)
+{
+    out.Clear();
+
+    RSONAssetNode_t rootNode(rsonAsset);
+    rootNode.R_ParseNodeValues(out, 0);
+}
+
 void* PreviewRSONAsset(CAsset* const asset, const bool firstFrameForAsset)
 {
     UNUSED(firstFrameForAsset);
@@ -93,13 +102,15 @@ bool ExportRSONAsset(CAsset* const asset, const int setting)
     return true;
 }
 
-// recursively parses all node values out of the rson node tree into our stringstream
-void RSONAssetNode_t::R_ParseNodeValues(std::stringstream& out, const size_t indentIdx) const
+// recursively parses all node values out of the rson node tree into our text builder
+void RSONAssetNode_t::R_ParseNodeValues(CTextBuilder& out, const size_t indentIdx) const
 {
-	const std::string indentation = GetIndentation(indentIdx);
-
 	if (this->name)
-		out << indentation << this->name << ":";
+	{
+		out.AppendIndentation(indentIdx);
+		out.Append(this->name);
+		out.Append(':');
+	}
 
 	if (this->IsArray())
 	{
@@ -108,13 +119,16 @@ void RSONAssetNode_t::R_ParseNodeValues(std::stringstream& out, const size_t ind
 
 		// no random line for root
 		if (!IsRoot())
-			out << "\n";
+			out.Append('\n');
 
 		// Non-root arrays always have square brackets.
 		// Root arrays of objects do not typically have square brackets
 		const bool isSquareBracketedArray = !IsRoot() || !IsArrayOfObjects();
 		if(isSquareBracketedArray)
-			out << indentation << "[\n";
+		{
+			out.AppendIndentation(indentIdx);
+			out.Append("[\n");
+		}
 
 		for (int i = 0; i < this->valueCount; i++)
 		{
@@ -123,17 +137,19 @@ void RSONAssetNode_t::R_ParseNodeValues(std::stringstream& out, const size_t ind
 			// special case for arrays of objects since running it through WriteNodeValue will not give a desired output
 			if (!IsArrayOfObjects())
 			{
-				out << indentation << "\t"; // [rika]: set our indentation for array values, do after we've checked if it's nodes, as we increase the indentation there already.
+				out.AppendIndentation(indentIdx + 1); // [rika]: set our indentation for array values, do after we've checked if it's nodes, as we increase the indentation there already.
 
-				R_WriteNodeValue(out, val, indentation, indentIdx + 1);
+				R_WriteNodeValue(out, val, indentIdx, indentIdx + 1);
 			}
 			else
 			{
-				out << indentation << "{\n";
+				out.AppendIndentation(indentIdx);
+				out.Append("{\n");
 				// [rika]: skipping nullptrs for objects only, don't want to run ParseNodeValues on a null pointer
 				if (val.valPtr == nullptr)
 				{
-					out << indentation << "}\n";
+					out.AppendIndentation(indentIdx);
+					out.Append("}\n");
 					continue;
 				}
 
@@ -149,36 +165,43 @@ void RSONAssetNode_t::R_ParseNodeValues(std::stringstream& out, const size_t ind
 					curNode = curNode->nextPeer;
 				}
 
-				out << indentation << "}\n";
+				out.AppendIndentation(indentIdx);
+				out.Append("}\n");
 			}
 		}
 
 		if(isSquareBracketedArray)
-			out << indentation << "]\n";
+		{
+			out.AppendIndentation(indentIdx);
+			out.Append("]\n");
+		}
 
 		return;
 	}
 
 	// no random space for root
 	if (this->name)
-		out << " ";
+		out.Append(' ');
 
-	R_WriteNodeValue(out, values, indentation, indentIdx);
+	R_WriteNodeValue(out, values, indentIdx, indentIdx);
 }
 
-void RSONAssetNode_t::R_WriteNodeValue(std::stringstream& out, RSONNodeValue_t val, const std::string& indentation, const size_t indentIdx) const
+void RSONAssetNode_t::R_WriteNodeValue(CTextBuilder& out, RSONNodeValue_t val, const size_t indentLevel, const size_t indentIdx) const
 {
 	switch (this->type & 0x1ff)
 	{
 	case eRSONFieldType::RSON_NULL:
 	{
-		out << "null\n";
+		out.Append("null\n");
 
 		return; // only needs to be parsed on export
 	}
 	case eRSONFieldType::RSON_STRING:
 	{
-		out << val.string << "\n";
+		if (val.string)
+			out.Append(val.string);
+
+		out.Append('\n');
 
 		return;
 	}
@@ -186,7 +209,7 @@ void RSONAssetNode_t::R_WriteNodeValue(std::stringstream& out, RSONNodeValue_t v
 	{
 		assertm(false, "rson type RSON_VALUE used\n");
 
-		out << "\n";
+		out.Append('\n');
 
 		return;
 	}
@@ -196,9 +219,10 @@ void RSONAssetNode_t::R_WriteNodeValue(std::stringstream& out, RSONNodeValue_t v
 
 		// no random line if root
 		if (this->name)
-			out << "\n";
+			out.Append('\n');
 
-		out << indentation << "{\n";
+		out.AppendIndentation(indentLevel);
+		out.Append("{\n");
 
 		for (int i = 0; i < this->valueCount; i++)
 		{
@@ -218,29 +242,33 @@ void RSONAssetNode_t::R_WriteNodeValue(std::stringstream& out, RSONNodeValue_t v
 			}
 		}
 
-		out << indentation << "}\n";
+		out.AppendIndentation(indentLevel);
+		out.Append("}\n");
 
 		return;
 	}
 	case eRSONFieldType::RSON_BOOLEAN:
 	{
-		out << std::boolalpha << val.valueBool << "\n";
+		out.Append(val.valueBool ? "true\n" : "false\n");
 		return;
 	}
 	case eRSONFieldType::RSON_INTEGER:
 	case eRSONFieldType::RSON_SIGNED_INTEGER:
 	{
-		out << static_cast<int64_t>(val.value) << "\n";
+		out.AppendInt(static_cast<int64_t>(val.value));
+		out.Append('\n');
 		return;
 	}
 	case eRSONFieldType::RSON_UNSIGNED_INTEGER:
 	{
-		out << val.value << "\n";
+		out.AppendUInt(val.value);
+		out.Append('\n');
 		return;
 	}
 	case eRSONFieldType::RSON_DOUBLE:
 	{
-		out << val.valueFP << "\n";
+		out.AppendFloatGeneral(val.valueFP); // matches ostream's default formatting
+		out.Append('\n');
 		return;
 	}
 	default:
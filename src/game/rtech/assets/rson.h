@@ -1,6 +1,7 @@
 #pragma once
 
 #include <game/rtech/utils/utils.h>
+#include <core/utils/textbuilder.h>
 
 enum eRSONFieldType : int
 {
@@ -68,8 +69,8 @@ public:
 	RSONAssetNode_t* nextPeer;
 	RSONAssetNode_t* prevPeer; // unsure if ever written to disk
 
-	void R_ParseNodeValues(std::stringstream& out, const size_t indentIdx) const;
-	void R_WriteNodeValue(std::stringstream& out, RSONNodeValue_t val, const std::string& indentation, const size_t indentIdx) const;
+	void R_ParseNodeValues(CTextBuilder& out, const size_t indentIdx) const;
+	void R_WriteNodeValue(CTextBuilder& out, RSONNodeValue_t val, const size_t indentLevel, const size_t indentIdx) const;
 
 	FORCEINLINE const bool IsArray() const
 	{
@@ -94,4 +95,7 @@ public:
 };
 
 union AssetGuid_t;
-void WriteRSONDependencyArray(std::ofstream& out, const char* const name, const AssetGuid_t* const dependencies, const int count);
\ No newline at end of file
+void WriteRSONDependencyArray(std::ofstream& out, const char* const name, const AssetGuid_t* const dependencies, const int count);
+
+// writes the text form of the whole node tree, what gets previewed and exported
+void WriteRSONAssetText(const RSONAsset* const rsonAsset, CTextBuilder& out);
@@ -223,75 +223,87 @@ void SettingsAsset::R_ParseSettingsArray(SettingsKVField_t* field, const char* v
 	}
 }
 
-void SettingsAsset::R_WriteSetFileArray(std::string& out, const size_t indentLevel, const char* valuePtr,
+void SettingsAsset::R_WriteSetFileArray(CTextBuilder& out, const size_t indentLevel, const char* valuePtr,
 	const size_t arrayElemCount, const SettingsLayoutAsset& subLayout)
 {
-	out += "[\n";
+	out.Append("[\n");
 
 	const size_t layoutSize = subLayout.totalLayoutSize;
 	const size_t fieldCount = subLayout.layoutFields.size();
 
-	const std::string indentation = GetIndentation(indentLevel);
-
 	for (size_t i = 0; i < arrayElemCount; ++i)
 	{
 		const char* const elemValues = reinterpret_cast<const char*>(valuePtr) + (i * layoutSize);
-		out += indentation + "\t{\n";
+		out.AppendIndentation(indentLevel + 1);
+		out.Append("{\n");
 
 		for (size_t j = 0; j < fieldCount; ++j)
 		{
 			const SettingsField& subField = subLayout.layoutFields[j];
-			out += indentation + "\t\t" + "\"" + subField.fieldName + "\": ";
+			out.AppendIndentation(indentLevel + 2);
+			out.Append('\"');
+			out.Append(subField.fieldName);
+			out.Append("\": ");
 
 			R_WriteSetFile(out, indentLevel+2, elemValues, &subLayout , &subField);
 
-			const char* const commaChar = j != (fieldCount - 1) ? ",\n" : "\n";
-			out += commaChar;
+			out.Append(j != (fieldCount - 1) ? ",\n" : "\n");
 		}
 
-		out += indentation + "\t}";
+		out.AppendIndentation(indentLevel + 1);
+		out.Append('}');
 
 		if (fieldCount)
-		{
-			const char* const commaChar = i != (arrayElemCount - 1) ? ",\n" : "\n";
-			out += commaChar;
-		}
+			out.Append(i != (arrayElemCount - 1) ? ",\n" : "\n");
 	}
 
-	out += indentation + "]";
+	out.AppendIndentation(indentLevel);
+	out.Append(']');
 }
 
-void SettingsAsset::R_WriteSetFile(std::string& out, const size_t indentLevel, const char* valData,
+void SettingsAsset::R_WriteSetFile(CTextBuilder& out, const size_t indentLevel, const char* valData,
 	const SettingsLayoutAsset* layout, const SettingsField* const field)
 {
 	switch (field->dataType)
 	{
 	case eSettingsFieldType::ST_BOOL:
 	{
-		out.append((valData[field->valueOffset]) ? "true" : "false");
+		out.Append((valData[field->valueOffset]) ? "true" : "false");
 		break;
 	}
 	case eSettingsFieldType::ST_INTEGER:
 	{
-		out.append(std::format("{:d}", *reinterpret_cast<const int*>(&valData[field->valueOffset])));
+		out.AppendInt(*reinterpret_cast<const int*>(&valData[field->valueOffset]));
 		break;
 	}
 	case eSettingsFieldType::ST_FLOAT:
 	{
-		out.append(std::format("{:f}", *reinterpret_cast<const float*>(&valData[field->valueOffset])));
+		out.AppendFloatFixed(*reinterpret_cast<const float*>(&valData[field->valueOffset]));
 		break;
 	}
 	case eSettingsFieldType::ST_FLOAT2:
 	{
 		const float* floatValues = reinterpret_cast<const float*>(&valData[field->valueOffset]);
-		out.append(std::format("\"<{:f},{:f}>\"", floatValues[0], floatValues[1]));
+
+		out.Append("\"<");
+		out.AppendFloatFixed(floatValues[0]);
+		out.Append(',');
+		out.AppendFloatFixed(floatValues[1]);
+		out.Append(">\"");
 
 		break;
 	}
 	case eSettingsFieldType::ST_FLOAT3:
 	{
 		const float* floatValues = reinterpret_cast<const float*>(&valData[field->valueOffset]);
-		out.append(std::format("\"<{:f},{:f},{:f}>\"", floatValues[0], floatValues[1], floatValues[2]));
+
+		out.Append("\"<");
+		out.AppendFloatFixed(floatValues[0]);
+		out.Append(',');
+		out.AppendFloatFixed(floatValues[1]);
+		out.Append(',');
+		out.AppendFloatFixed(floatValues[2]);
+		out.Append(">\"");
 
 		break;
 	}
@@ -300,7 +312,10 @@ void SettingsAsset::R_WriteSetFile(std::string& out, const size_t indentLevel, c
 	case eSettingsFieldType::ST_ASSET_NOPRECACHE:
 	{
 		const char* const charBuf = *(const char**)&valData[field->valueOffset];
-		out.append(std::format("\"{:s}\"", charBuf));
+
+		out.Append('\"');
+		out.Append(charBuf);
+		out.Append('\"');
 		break;
 	}
 	case eSettingsFieldType::ST_ARRAY:
@@ -324,47 +339,49 @@ void SettingsAsset::R_WriteSetFile(std::string& out, const size_t indentLevel, c
 	}
 }
 
-void SettingsAsset::R_WriteSetFile(std::string& out, const size_t indentLevel, const char* valData, const SettingsLayoutAsset* layout)
+void SettingsAsset::R_WriteSetFile(CTextBuilder& out, const size_t indentLevel, const char* valData, const SettingsLayoutAsset* layout)
 {
-	const std::string indentation = GetIndentation(indentLevel);
 	const size_t numLayoutFields = layout->layoutFields.size();
 
 	for (size_t i = 0; i < numLayoutFields; ++i)
 	{
 		const SettingsField* const field = &layout->layoutFields.at(i);
-		out += indentation + "\"" + field->fieldName + "\": ";
+		out.AppendIndentation(indentLevel);
+		out.Append('\"');
+		out.Append(field->fieldName);
+		out.Append("\": ");
 
 		R_WriteSetFile(out, indentLevel, valData, layout, field);
 
-		const char* const commaChar = i != (numLayoutFields-1) ? ",\n" : "\n";
-		out += commaChar;
+		out.Append(i != (numLayoutFields-1) ? ",\n" : "\n");
 	}
 }
 
-void SettingsAsset::R_WriteModNames(std::string& out) const
+void SettingsAsset::R_WriteModNames(CTextBuilder& out) const
 {
-	out += "\t\"$modNames\": [\n";
+	out.Append("\t\"$modNames\": [\n");
 
 	for (uint32_t i = 0; i < modNameCount; i++)
 	{
-		const char* const commaChar = i != (modNameCount - 1) ? "," : "";
-		out += std::string("\t\t\"") + modNames[i] + "\"" + commaChar + "\n";
+		out.Append("\t\t\"");
+		out.Append(modNames[i]);
+		out.Append(i != (modNameCount - 1) ? "\",\n" : "\"\n");
 	}
 
-	out += "\t]";
+	out.Append("\t]");
 }
 
-void SettingsAsset::R_WriteModValues(std::string& out, const SettingsLayoutAsset* const layout) const
+void SettingsAsset::R_WriteModValues(CTextBuilder& out, const SettingsLayoutAsset* const layout) const
 {
-	out += "\t\"$modValues\": [\n";
+	out.Append("\t\"$modValues\": [\n");
 
 	for (uint32_t i = 0; i < modValuesCount; i++)
 	{
 		const SettingsMod_s* const modValue = &modValues[i];
-		out += std::format("\t\t{{ // originally mapped to offset {:d}\n", modValue->valueOffset);
+		out.Append(std::format("\t\t{{ // originally mapped to offset {:d}\n", modValue->valueOffset));
 
-		out += std::format("\t\t\t\"index\": {:d},\n\t\t\t\"type\": \"{:s}\",\n\t\t\t",
-			modValue->nameIndex, g_settingsModType[modValue->type]);
+		out.Append(std::format("\t\t\t\"index\": {:d},\n\t\t\t\"type\": \"{:s}\",\n\t\t\t",
+			modValue->nameIndex, g_settingsModType[modValue->type]));
 
 		SettingsLayoutFindByOffsetResult_s searchResult;
 		const bool foundField = SettingsFieldFinder_FindFieldByAbsoluteOffset(layout, modValue->valueOffset, searchResult);
@@ -375,78 +392,90 @@ void SettingsAsset::R_WriteModValues(std::string& out, const SettingsLayoutAsset
 			{
 			case SettingsModType_e::kIntAdd:
 			case SettingsModType_e::kIntMultiply:
-				out += std::format("\"value\": {:d},\n", modValue->value.intValue);
+				out.Append(std::format("\"value\": {:d},\n", modValue->value.intValue));
 				break;
 			case SettingsModType_e::kFloatAdd:
 			case SettingsModType_e::kFloatMultiply:
-				out += std::format("\"value\": {:f},\n", modValue->value.floatValue);
+				out.Append(std::format("\"value\": {:f},\n", modValue->value.floatValue));
 				break;
 			case SettingsModType_e::kBool:
-				out += std::format("\"value\": {:s},\n", modValue->value.boolValue ? "true" : "false");
+				out.Append(std::format("\"value\": {:s},\n", modValue->value.boolValue ? "true" : "false"));
 				break;
 			case SettingsModType_e::kNumber:
 				if (searchResult.field->dataType == eSettingsFieldType::ST_INTEGER)
-					out += std::format("\"value\": {:d},\n", modValue->value.intValue);
+					out.Append(std::format("\"value\": {:d},\n", modValue->value.intValue));
 				else
-					out += std::format("\"value\": {:f},\n", modValue->value.floatValue);
+					out.Append(std::format("\"value\": {:f},\n", modValue->value.floatValue));
 				break;
 			case SettingsModType_e::kString:
-				out += std::format("\"value\": \"{:s}\",\n", &stringData[modValue->value.stringOffset]);
+				out.Append(std::format("\"value\": \"{:s}\",\n", &stringData[modValue->value.stringOffset]));
 				break;
 			}
 
-			out += std::format("\t\t\t\"field\": \"{:s}\"\n", searchResult.fieldAccessPath);
+			out.Append(std::format("\t\t\t\"field\": \"{:s}\"\n", searchResult.fieldAccessPath));
 		}
 		else
 		{
 			assert(0);
-			out += "// FAILURE( !!! SETTINGS FIELD NOT FOUND !!! )\n";
+			out.Append("// FAILURE( !!! SETTINGS FIELD NOT FOUND !!! )\n");
 		}
 
-		const char* const commaChar = i != (modValuesCount - 1) ? "," : "";
-		out += std::string("\t\t}") + commaChar + "\n";
+		out.Append(i != (modValuesCount - 1) ? "\t\t},\n" : "\t\t}\n");
 	}
 
-	out += "\t]";
+	out.Append("\t]");
 }
 
-static bool RenderSettingsAsset(CPakAsset* const asset, std::string& stringStream)
+// writes the whole .json into the builder, cleared first
+bool WriteSettingsAssetText(CPakAsset* const asset, CTextBuilder& out)
 {
+	out.Clear();
+
 	SettingsAsset* settingsAsset = asset->extraData<SettingsAsset*>();
 	if (!settingsAsset->layoutAsset)
 		return false;
 
 	const SettingsLayoutAsset* const layout = settingsAsset->layoutAsset->extraData<SettingsLayoutAsset*>();
 
-	stringStream += std::string("{\n") + "\t\"layoutAsset\": \"" + layout->name + "\",\n";
+	out.Append("{\n\t\"layoutAsset\": \"");
+	out.Append(layout->name);
+	out.Append("\",\n");
 
 	if (settingsAsset->uniqueId)
-		stringStream += std::format("\t\"uniqueId\": {:d},\n", settingsAsset->uniqueId);
+	{
+		out.Append("\t\"uniqueId\": ");
+		out.AppendInt(settingsAsset->uniqueId);
+		out.Append(",\n");
+	}
 
-	stringStream += "\t\"settings\": {\n";
+	out.Append("\t\"settings\": {\n");
 
-	// Recursively write the .set file contents into the string stream
-	settingsAsset->R_WriteSetFile(stringStream, 2, (const char*)settingsAsset->valueData, layout);
+	// Recursively write the .set file contents into the builder
+	settingsAsset->R_WriteSetFile(out, 2, (const char*)settingsAsset->valueData, layout);
 
-	stringStream += "\t}";
+	out.Append("\t}");
 
 	if (settingsAsset->modNameCount)
 	{
-		stringStream += ",\n";
-		settingsAsset->R_WriteModNames(stringStream);
+		out.Append(",\n");
+		settingsAsset->R_WriteModNames(out);
 	}
 
 	if (settingsAsset->modValuesCount)
 	{
-		stringStream += ",\n";
-		settingsAsset->R_WriteModValues(stringStream, layout);
+		out.Append(",\n");
+		settingsAsset->R_WriteModValues(out, layout);
 	}
 
 	if (settingsAsset->modFlags)
-		stringStream += std::format(",\n\t\"$modFlags\": {:d}\n", settingsAsset->modFlags);
+	{
+		out.Append(",\n\t\"$modFlags\": ");
+		out.AppendInt(settingsAsset->modFlags);
+		out.Append('\n');
+	}
 
-	stringStream += "\n}";
-	FixSlashes(stringStream);
+	out.Append("\n}");
+	std::replace(out.Data(), out.Data() + out.Length(), '\\', '/'); // same as FixSlashes
 
 	return true;
 }
@@ -457,9 +486,9 @@ bool ExportSettingsAsset(CAsset* const asset, const int setting)
 
 	CPakAsset* pakAsset = static_cast<CPakAsset*>(asset);
 
-	std::string stringStream;
+	static thread_local CTextBuilder text;
 
-	if (!RenderSettingsAsset(pakAsset, stringStream))
+	if (!WriteSettingsAssetText(pakAsset, text))
 		return false;
 
 	std::filesystem::path exportPath = g_ExportSettings.GetExportDirectory();
@@ -483,7 +512,9 @@ bool ExportSettingsAsset(CAsset* const asset, const int setting)
 		return false;
 	}
 
-	out.write(stringStream.c_str(), stringStream.length());
+	out.write(text.Data(), text.Length());
+	text.Clear();
+
 	return true;
 }
 
@@ -491,16 +522,17 @@ static void* PreviewSettingsAsset(CAsset* const asset, const bool firstFrameForA
 {
 	CPakAsset* pakAsset = static_cast<CPakAsset*>(asset);
 
-	std::string stringStream;
+	// rebuilt every frame, so keep the memory around between them
+	static CTextBuilder text;
 
-	if (!RenderSettingsAsset(pakAsset, stringStream))
+	if (!WriteSettingsAssetText(pakAsset, text))
 	{
 		ImGui::Text("Settings asset unavailable");
 		return nullptr;
 	}
 
 	UNUSED(firstFrameForAsset);
-	ImGui::InputTextMultiline("##settings_preview", const_cast<char*>(stringStream.c_str()), stringStream.length()+1, ImVec2(-1, -1), ImGuiInputTextFlags_ReadOnly);
+	ImGui::InputTextMultiline("##settings_preview", const_cast<char*>(text.CStr()), text.Length()+1, ImVec2(-1, -1), ImGuiInputTextFlags_ReadOnly);
 
 	return nullptr;
 }
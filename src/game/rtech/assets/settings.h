@@ -1,5 +1,6 @@
 #pragma once
 #include <game/rtech/assets/settings_layout.h>
+#include <core/utils/textbuilder.h>
 
 enum SettingsModType_e : unsigned short
 {
@@ -206,11 +207,14 @@ public:
 	void R_ParseSettingsField(SettingsKVField_t* field, const char* valueData, const SettingsLayoutAsset* layout, const SettingsField* const layoutField);
 	void R_ParseSettingsArray(SettingsKVField_t* field, const char* valueData, const size_t arrayElemCount, const SettingsLayoutAsset& layout);
 
-	void R_WriteSetFile(std::string& out, const size_t indentLevel, const char* valueData, const SettingsLayoutAsset* layout);
-	void R_WriteSetFile(std::string& out, const size_t indentLevel, const char* valueData, const SettingsLayoutAsset* layout, const SettingsField* const field);
+	void R_WriteSetFile(CTextBuilder& out, const size_t indentLevel, const char* valueData, const SettingsLayoutAsset* layout);
+	void R_WriteSetFile(CTextBuilder& out, const size_t indentLevel, const char* valueData, const SettingsLayoutAsset* layout, const SettingsField* const field);
 
-	void R_WriteSetFileArray(std::string& out, const size_t indentLevel, const char* valData, const size_t arrayElemCount, const SettingsLayoutAsset& subLayout);
+	void R_WriteSetFileArray(CTextBuilder& out, const size_t indentLevel, const char* valData, const size_t arrayElemCount, const SettingsLayoutAsset& subLayout);
 
-	void R_WriteModNames(std::string& out) const;
-	void R_WriteModValues(std::string& out, const SettingsLayoutAsset* const layout) const;
-};
\ No newline at end of file
+	void R_WriteModNames(CTextBuilder& out) const;
+	void R_WriteModValues(CTextBuilder& out, const SettingsLayoutAsset* const layout) const;
+};
+
+// writes the exported .json text for a settings asset, false if its layout isn't loaded
+bool WriteSettingsAssetText(CPakAsset* const asset, CTextBuilder& out);
\ No newline at end of file
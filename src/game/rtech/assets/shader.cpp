@@ -2,6 +2,7 @@
 #include <game/rtech/assets/shader.h>
 #include <game/rtech/cpakfile.h>
 #include <game/rtech/utils/utils.h>
+#include <core/shaderexp/shaderstore.h>
 
 #include <imgui.h>
 
@@ -393,31 +394,12 @@ void PostLoadShaderAsset(CAssetContainer* const pak, CAsset* const asset)
 
 		for (auto& it : shaderAsset->shaderBuffers)
 		{
-			const char* buf = it.buffer;
-
-			if (buf)
-			{
-				const DXBCHeader* const hdr = reinterpret_cast<const DXBCHeader*>(buf);
-
-				if (!hdr->isValid())
-					return;
-
-				for (uint32_t blobIdx = 0; blobIdx < hdr->BlobCount; blobIdx++)
-				{
-					const DXBCBlobHeader* const blob = hdr->pBlob(blobIdx);
-
-					if (!blob->isRDEF())
-						continue;
-
-					RDEFBlobHeader* rdefBlob = blob->pRDEFBlob();
-
-					shaderAsset->compilerStrings.emplace_back(rdefBlob->CompilerSignature());
-
-					break;
-				}
-
-			}
+			if (!it.buffer || it.bufferSize <= 0)
+				continue;
 
+			const std::string_view compilerString = GetDXBCCreator(it.buffer, static_cast<size_t>(it.bufferSize));
+			if (!compilerString.empty())
+				shaderAsset->compilerStrings.emplace_back(compilerString);
 		}
 
 	}
@@ -518,12 +500,18 @@ enum eShaderAssetExportSetting
 {
 	Raw,
 	MSW, // MultiShaderWrapper
+	RawDeduplicated, // bytecode goes into the shader blob store
 };
 
-static void ExportShaderMetaData(const ShaderAsset* const shaderAsset, std::filesystem::path& exportPath)
+static void ExportShaderMetaData(const ShaderAsset* const shaderAsset, std::filesystem::path& exportPath, const std::vector<ShaderBlobRef_t>* const blobRefs = nullptr)
 {
 	exportPath.replace_extension(".json");
-	std::ofstream ofs(exportPath, std::ios::out);
+
+	StreamIO out(exportPath, eStreamIOMode::Write, true);
+	if (!out.W())
+		return;
+
+	std::ofstream& ofs = *out.W();
 
 	ofs << "{\n";
 
@@ -574,6 +562,29 @@ static void ExportShaderMetaData(const ShaderAsset* const shaderAsset, std::file
 		i++;
 	}
 
+	if (!blobRefs)
+	{
+		ofs << "\t]\n";
+		ofs << "}\n";
+
+		return;
+	}
+
+	// hashes of the blobs in the shader blob store, null for buffers that are refs or have no data
+	ofs << "\t],\n";
+	ofs << "\t\"blobs\": [\n";
+
+	for (size_t blobIdx = 0; blobIdx < blobRefs->size(); blobIdx++)
+	{
+		const ShaderBlobRef_t& blobRef = blobRefs->at(blobIdx);
+		const char* const commaChar = blobIdx != (blobRefs->size() - 1) ? "," : "";
+
+		if (blobRef.valid)
+			ofs << "\t\t\"" << blobRef.hash.ToString() << "\"" << commaChar << "\n";
+		else
+			ofs << "\t\tnull" << commaChar << "\n";
+	}
+
 	ofs << "\t]\n";
 	ofs << "}\n";
 }
@@ -599,6 +610,30 @@ bool ExportRawShaderAsset(const ShaderAsset* const shaderAsset, std::filesystem:
 	return true;
 }
 
+// writes every unique bytecode blob once, the shader's metadata references them by hash
+bool ExportDeduplicatedShaderAsset(const CAsset* const asset, const ShaderAsset* const shaderAsset, std::filesystem::path& exportPath)
+{
+	std::vector<ShaderBlobRef_t> blobRefs;
+	blobRefs.reserve(shaderAsset->shaderBuffers.size());
+
+	for (auto& buf : shaderAsset->shaderBuffers)
+	{
+		if (buf.isRef || !buf.buffer || buf.bufferSize <= 0)
+		{
+			blobRefs.push_back({});
+			continue;
+		}
+
+		blobRefs.push_back(g_ShaderBlobStore.StoreBlob(buf.buffer, static_cast<size_t>(buf.bufferSize)));
+	}
+
+	ExportShaderMetaData(shaderAsset, exportPath, &blobRefs);
+
+	g_ShaderBlobStore.AddShader(asset->GetAssetGUID(), asset->GetAssetName(), s_dxShaderTypeNames[static_cast<int>(shaderAsset->type)], std::move(blobRefs));
+
+	return true;
+}
+
 #include <core/shaderexp/multishader.h>
 
 void ConstructMSWShader(CMultiShaderWrapperIO::Shader_t& shader, const ShaderAsset* const shaderAsset)
@@ -645,6 +680,31 @@ void ConstructMSWShader(CMultiShaderWrapperIO::Shader_t& shader, const ShaderAss
 	memcpy_s(shader.features, sizeof(shader.features), shaderAsset->shaderFeatures, sizeof(shader.features));
 }
 
+bool WriteMSWFile(CMultiShaderWrapperIO& writer, const std::filesystem::path& exportPath)
+{
+	if (!FileSystem::IsArchivedPath(exportPath))
+		return writer.WriteFile(exportPath.string().c_str());
+
+	// the msw writer seeks around while writing, so stage it in a temp file before storing it in the export archive
+	FILE* f = nullptr;
+	if (tmpfile_s(&f) != 0 || !f)
+		return false;
+
+	bool written = writer.WriteFile(f);
+	if (written)
+	{
+		fseek(f, 0, SEEK_END);
+		const size_t fileSize = static_cast<size_t>(ftell(f));
+		fseek(f, 0, SEEK_SET);
+
+		std::unique_ptr<char[]> fileBuf = std::make_unique<char[]>(fileSize);
+		written = fread(fileBuf.get(), sizeof(char), fileSize, f) == fileSize && g_ExportArchive.AddFile(exportPath, fileBuf.get(), fileSize);
+	}
+
+	fclose(f);
+	return written;
+}
+
 bool ExportMSWShaderAsset(const ShaderAsset* const shaderAsset, std::filesystem::path& exportPath)
 {
 	exportPath.replace_extension(".msw");
@@ -656,7 +716,7 @@ bool ExportMSWShaderAsset(const ShaderAsset* const shaderAsset, std::filesystem:
 	ConstructMSWShader(shader, shaderAsset);
 
 	writer.SetShader(&shader);
-	return writer.WriteFile(exportPath.string().c_str());
+	return WriteMSWFile(writer, exportPath);
 }
 
 static const char* const s_PathPrefixSHDR = s_AssetTypePaths.find(AssetType_t::SHDR)->second;
@@ -708,6 +768,11 @@ bool ExportShaderAsset(CAsset* const asset, const int setting)
 		// NOTE: this func changes the value of exportPath!!
 		return ExportMSWShaderAsset(shaderAsset, exportPath);
 	}
+	case eShaderAssetExportSetting::RawDeduplicated:
+	{
+		// NOTE: this func changes the value of exportPath!!
+		return ExportDeduplicatedShaderAsset(asset, shaderAsset, exportPath);
+	}
 	default:
 	{
 		assertm(false, "Export setting is not handled.");
@@ -725,33 +790,18 @@ std::map<uint32_t, ShaderResource> ResourceBindingFromDXBlob(CPakAsset* const as
 
 	std::map<uint32_t, ShaderResource> bindings;
 
-	if (!shaderAsset->data)
+	const DXBCReflection_t* const reflection = shaderAsset->GetReflection();
+	if (!reflection)
 		return bindings;
 
-	const DXBCHeader* const hdr = reinterpret_cast<DXBCHeader*>(shaderAsset->data);
-
-	if (!hdr->isValid())
-		return bindings;
-
-	for (uint32_t blobIdx = 0; blobIdx < hdr->BlobCount; blobIdx++)
+	for (const DXBCResourceBinding_t& resource : reflection->resourceBindings)
 	{
-		const DXBCBlobHeader* const blob = hdr->pBlob(blobIdx);
-
-		if (!blob->isRDEF())
+		if (resource.type != static_cast<uint32_t>(inputType))
 			continue;
 
-		RDEFBlobHeader* rdefBlob = blob->pRDEFBlob();
-		for (uint32_t resIdx = 0; resIdx < rdefBlob->BoundResourceCount; resIdx++)
-		{
-			RDEFResourceBinding* resource = rdefBlob->pBoundResource(resIdx);
-			if (resource->Type != inputType)
-				continue;
-
-			const ShaderResource tmp(resource->Name(rdefBlob), *resource);
-			bindings.emplace(resource->BindPoint, tmp);
-		}
-
-		break;
+		// names are null terminated views into the shader's bytecode
+		const ShaderResource tmp(resource.name.data(), resource);
+		bindings.emplace(resource.bindPoint, tmp);
 	}
 
 	return bindings;
@@ -764,41 +814,22 @@ std::vector<TmpConstBufVar> ConstBufVarFromDXBlob(CPakAsset* const asset, const
 
 	std::vector<TmpConstBufVar> vars;
 
-	if (!shaderAsset->data)
+	const DXBCReflection_t* const reflection = shaderAsset->GetReflection();
+	if (!reflection)
 		return vars;
 
-	const DXBCHeader* const hdr = reinterpret_cast<DXBCHeader*>(shaderAsset->data);
-
-	if (!hdr->isValid())
+	const DXBCConstantBuffer_t* const constBuf = reflection->FindConstantBuffer(constBufName);
+	if (!constBuf)
 		return vars;
 
-	for (uint32_t blobIdx = 0; blobIdx < hdr->BlobCount; blobIdx++)
-	{
-		const DXBCBlobHeader* const blob = hdr->pBlob(blobIdx);
-
-		if (!blob->isRDEF())
-			continue;
-
-		RDEFBlobHeader* rdefBlob = blob->pRDEFBlob();
-		for (uint32_t constBufIdx = 0; constBufIdx < rdefBlob->ConstBufferCount; constBufIdx++)
-		{
-			const RDefConstBuffer* const constBuf = rdefBlob->pConstBuffer(constBufIdx);
-			if (strncmp(constBufName, constBuf->Name(rdefBlob), 64))
-				continue;
-
-			for (uint32_t constIdx = 0; constIdx < constBuf->ConstCount; constIdx++)
-			{
-				const RDEFConst* const constVar = constBuf->pConst(rdefBlob, constIdx);
-				const RDEFType* const constType = constVar->pType(rdefBlob);
-
-				const TmpConstBufVar tmp(constVar->Name(rdefBlob), static_cast<D3D_SHADER_VARIABLE_TYPE>(constType->Type), constVar->Size);
-				vars.push_back(tmp);
-			}
+	vars.reserve(constBuf->numVariables);
 
-			break;
-		}
+	for (uint32_t constIdx = 0; constIdx < constBuf->numVariables; constIdx++)
+	{
+		const DXBCVariable_t& constVar = reflection->variables[constBuf->firstVariable + constIdx];
 
-		break;
+		const TmpConstBufVar tmp(constVar.name.data(), static_cast<D3D_SHADER_VARIABLE_TYPE>(constVar.type), constVar.size);
+		vars.push_back(tmp);
 	}
 
 	return vars;
@@ -806,7 +837,7 @@ std::vector<TmpConstBufVar> ConstBufVarFromDXBlob(CPakAsset* const asset, const
 
 void InitShaderAssetType()
 {
-	static const char* settings[] = { "Raw", "MSW" };
+	static const char* settings[] = { "Raw", "MSW", "Raw (Deduplicated)" };
 	AssetTypeBinding_t type =
 	{
 		.name = "Shader",
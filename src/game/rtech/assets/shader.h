@@ -1,6 +1,7 @@
 #pragma once
 #include <d3d11.h>
 #include "core/render/dx.h"
+#include <core/shaderexp/dxbc.h>
 
 struct ShaderAssetHeader_v8_t
 {
@@ -275,147 +276,33 @@ public:
 
     std::vector<ShaderBufEntry_t> shaderBuffers;
     std::vector<std::string> compilerStrings;
-};
-
-// dxbc
-//https://github.com/microsoft/D3D12TranslationLayer/blob/master/DxbcParser/include/BlobContainer.h
-
-#define DXBC_FOURCC_NAME    (('C'<<24)+('B'<<16)+('X'<<8)+'D')
-#define DXBC_FOURCC_RDEF    (('F'<<24)+('E'<<16)+('D'<<8)+'R')
-
-
-// D3D10_Type
-struct RDEFType
-{
-    uint16_t Class; // D3D10_SHADER_VARIABLE_CLASS
-    uint16_t Type; // D3D10_SHADER_VARIABLE_TYPE
-    uint16_t Rows;
-    uint16_t Columns;
-    uint16_t Elements;
-    uint16_t Members;
-    uint16_t Offset;
-    uint16_t unk_D;
-    uint32_t Reserved[4];
-    uint32_t NameOffset;
-
-    inline const char* Name(void* rdefBlob) const { return reinterpret_cast<const char*>((char*)rdefBlob + NameOffset); }
-};
-
-//D3D11_Constant
-struct RDEFConst
-{
-    uint32_t NameOffset;
-    uint32_t StartOffset;
-    uint32_t Size;
-    D3D10_SHADER_VARIABLE_FLAGS Flags;
-    uint32_t TypeOffset;
-    uint32_t DefaultValue;
-    uint32_t Reserved[4];
-
-    inline const char* Name(void* rdefBlob) const { return reinterpret_cast<const char*>((char*)rdefBlob + NameOffset); }
-    RDEFType* pType(void* rdefBlob) const { return reinterpret_cast<RDEFType*>((char*)rdefBlob + TypeOffset); }
-};
-
-// D3D10_ConstantBuffer
-struct RDefConstBuffer
-{
-    uint32_t NameOffset;
-    uint32_t ConstCount;
-    uint32_t ConstOffset;
-    uint32_t ConstBufSize;
-    D3D10_CBUFFER_TYPE Type;
-    D3D10_SHADER_CBUFFER_FLAGS Flags;
-
-    inline const char* Name(void* rdefBlob) const { return reinterpret_cast<const char*>((char*)rdefBlob + NameOffset); }
-    inline RDEFConst* pConst(void* rdefBlob, uint32_t i) const { assertm(i < ConstCount, "index exceeded ConstCount"); return reinterpret_cast<RDEFConst*>((char*)rdefBlob + ConstOffset) + i; }
-
-};
-
-// D3D10_ResourceBinding
-struct RDEFResourceBinding
-{
-    uint32_t NameOffset; // from start of RDEFBlobHeader
-    D3D_SHADER_INPUT_TYPE Type;
-    D3D_RESOURCE_RETURN_TYPE ReturnType;
-    D3D10_SRV_DIMENSION Dimension;
-    uint32_t NumSamples;
-    uint32_t BindPoint;
-    uint32_t BindCount;
-    D3D_SHADER_INPUT_FLAGS Flags;
-
-    inline const char* Name(void* rdefBlob) const { return reinterpret_cast<const char*>((char*)rdefBlob + NameOffset); }
-};
-
-enum ShaderType : uint16_t
-{
-    ComputeShader = 0x4353,
-    DomainShader = 0x4453,
-    GeometryShader = 0x4753,
-    HullShader = 0x4853,
-    VertexShader = 0xFFFE,
-    PixelShader = 0xFFFF,
-};
-
-// D3D11_RDEF_Header
-struct RDEFBlobHeader
-{
-    uint32_t ConstBufferCount;
-    uint32_t ConstBufferOffset;
-    uint32_t BoundResourceCount;
-    uint32_t BoundResourceOffset;
-    uint8_t  VersionMinor;
-    uint8_t  VersionMajor;
-    ShaderType ShaderType;
-    uint32_t CompilerFlags;
-    uint32_t CreatorOffset; // name of compiler?
-    uint32_t ID; // 'RD11'
-    uint32_t unk_20[7];
-
-    const char* CompilerSignature() const { return reinterpret_cast<const char*>((char*)this + CreatorOffset); }
-    RDEFResourceBinding* pBoundResource(uint32_t i) const { assertm(i < BoundResourceCount, "index exceeded BoundResourceCount"); return reinterpret_cast<RDEFResourceBinding*>((char*)this + BoundResourceOffset) + i; }
-    RDefConstBuffer* pConstBuffer(uint32_t i) const { assertm(i < ConstBufferCount, "index exceeded ConstBufferCount"); return reinterpret_cast<RDefConstBuffer*>((char*)this + ConstBufferOffset) + i; }
-};
-
-struct DXBCBlobHeader
-{
-    uint32_t    BlobFourCC;
-    uint32_t    BlobSize;    // Byte count for BlobData
 
-    inline bool isRDEF() const { return BlobFourCC == DXBC_FOURCC_RDEF ? true : false; }
-    RDEFBlobHeader* const pRDEFBlob() const { return reinterpret_cast<RDEFBlobHeader*>((char*)this + sizeof(DXBCBlobHeader)); }
-};
+    // reflection for the shader's bytecode, parsed the first time it's needed. nullptr if there is no bytecode or it is malformed
+    const DXBCReflection_t* const GetReflection() const
+    {
+        std::call_once(reflectionParsed, [this]
+            {
+                if (!data || dataSize <= 0)
+                    return;
 
-#define DXBC_HASH_SIZE 16
-struct DXBCHash
-{
-    unsigned char Digest[DXBC_HASH_SIZE];
-};
+                std::unique_ptr<DXBCReflection_t> parsed = std::make_unique<DXBCReflection_t>();
+                if (ParseDXBCReflection(data, static_cast<size_t>(dataSize), *parsed))
+                    reflection = std::move(parsed);
+            });
 
-struct DXBCVersion
-{
-    uint16_t Major;
-    uint16_t Minor;
-};
+        return reflection.get();
+    }
 
-struct DXBCHeader
-{
-    uint32_t    DXBCHeaderFourCC;
-    DXBCHash    Hash;
-    DXBCVersion Version;
-    uint32_t    ContainerSizeInBytes; // Count from start of this header, including all blobs
-    uint32_t    BlobCount;
-   
-    inline bool isValid() const { return DXBCHeaderFourCC == DXBC_FOURCC_NAME ? true : false; }
-    uint32_t* const pBlobOffset(uint32_t i) const { assertm(i < BlobCount, "index exceeded BlobCount"); return reinterpret_cast<uint32_t*>((char*)this + sizeof(DXBCHeader)) + i; }
-    uint32_t BlobOffset(uint32_t i) const { return *pBlobOffset(i); }
-    DXBCBlobHeader* const pBlob(uint32_t i) const { return reinterpret_cast<DXBCBlobHeader*>((char*)this + BlobOffset(i)); }
+private:
+    mutable std::once_flag reflectionParsed;
+    mutable std::unique_ptr<DXBCReflection_t> reflection;
 };
 
 struct ShaderResource
 {
-    ShaderResource(const char* n, RDEFResourceBinding bind) : name(n), binding(bind) { };
+    ShaderResource(const char* n, const DXBCResourceBinding_t& bind) : name(n), binding(bind) { };
     const char* name;
-    RDEFResourceBinding binding;
+    DXBCResourceBinding_t binding;
 };
 
 struct TmpConstBufVar
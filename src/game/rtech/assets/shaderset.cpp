@@ -153,6 +153,7 @@ enum eShaderSetExportSetting
 
 #include <core/shaderexp/multishader.h>
 extern void ConstructMSWShader(CMultiShaderWrapperIO::Shader_t& shader, const ShaderAsset* const shaderAsset);
+extern bool WriteMSWFile(CMultiShaderWrapperIO& writer, const std::filesystem::path& exportPath);
 
 static bool ExportMSWShaderSetAsset(const ShaderSetAsset* const shaderSetAsset, std::filesystem::path& exportPath, const bool packShaders)
 {
@@ -185,7 +186,7 @@ static bool ExportMSWShaderSetAsset(const ShaderSetAsset* const shaderSetAsset,
 		shaderSetAsset->numPixelShaderTextures, shaderSetAsset->numVertexShaderTextures, shaderSetAsset->numSamplers,
 		static_cast<uint8_t>(shaderSetAsset->firstResourceBindPoint), static_cast<uint8_t>(shaderSetAsset->numResources));
 
-	return writer.WriteFile(exportPath.string().c_str());
+	return WriteMSWFile(writer, exportPath);
 }
 
 static const char* const s_PathPrefixSHDR = s_AssetTypePaths.find(AssetType_t::SHDS)->second;
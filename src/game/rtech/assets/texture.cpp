@@ -865,7 +865,12 @@ static const char* GetMipNameForType(const eTextureMipType type)
 static void ExportTextureMetaData(const TextureAsset* const txtrAsset, std::filesystem::path& exportPath)
 {
     exportPath.replace_extension(".json");
-    std::ofstream ofs(exportPath, std::ios::out);
+
+    StreamIO out(exportPath, eStreamIOMode::Write, true);
+    if (!out.W())
+        return;
+
+    std::ofstream& ofs = *out.W();
 
     ofs << "{\n";
 
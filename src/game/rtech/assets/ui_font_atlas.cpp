@@ -1,6 +1,7 @@
 #include <pch.h>
 #include <game/rtech/assets/ui_font_atlas.h>
 #include <game/rtech/assets/texture.h>
+#include <core/utils/textbuilder.h>
 
 #include <iomanip>
 #include <fstream>
@@ -217,6 +218,70 @@ void UIFontHeader::SetCharacterForImages(const UIFontAtlasAsset* const fontAsset
     //assertm(remainingTextures == 0, "not every image was assigned a unicode character.");
 }
 
+// same result as SetCharacterForImages with TextureFromUnicodeMap, but walks the maps once instead of searching them for every codepoint.
+// a codepoint belongs to the first map whose last codepoint is above it, so the current map only ever moves forward.
+void UIFontHeader::SetCharacterForImagesFromUnicodeMap(const UIFontAtlasAsset* const fontAsset) const
+{
+    assertm(numUnicodeMaps > 0 && unicodeMap, "font should have unicode maps if we're here");
+
+    // get the max number of unicodes in here!
+    const int fakeChunkCount = (unicodeMap[numUnicodeMaps - 1].unicodeLast >> 6); // fake it til we make it, get the last possible chunk if this wasn't a legacy map!
+    const int maxUnicode = (fakeChunkCount + 1) << 6;
+
+    // codepoints that aren't in any map get the question mark, so only the first of them can claim its image
+    const uint32_t fallbackTextureIndex = GetTextureIndexFromUnicodeMap(FONT_UTF16_QMARK);
+
+    if (fallbackTextureIndex == FONT_TEXTURE_IDX_INVALID)
+        Log("Font %s doesn't even have question mark \"?\"\n", name);
+
+    uint32_t remainingTextures = numUnicodeTextures;
+    const auto setCharacterForImage = [&](const uint32_t idx, const int unicode)
+        {
+            if (idx >= numUnicodeTextures)
+                return;
+
+            UIFontCharacter_t* const image = &fontAsset->images[textureIndex + idx];
+
+            if (image->utf16 != -1)
+                return;
+
+            image->utf16 = unicode;
+
+            remainingTextures--;
+        };
+
+    uint32_t mapIdx = 0;
+    int unicode = 0;
+
+    while (unicode < maxUnicode && remainingTextures > 0)
+    {
+        while (mapIdx < numUnicodeMaps && unicodeMap[mapIdx].unicodeLast <= unicode)
+            mapIdx++;
+
+        // past the last map, everything left falls back
+        if (mapIdx >= numUnicodeMaps)
+        {
+            setCharacterForImage(fallbackTextureIndex, unicode);
+            break;
+        }
+
+        const UIFontUnicodeMap_t* const map = &unicodeMap[mapIdx];
+
+        // gap before this map
+        if (map->unicodeFirst > unicode)
+        {
+            setCharacterForImage(fallbackTextureIndex, unicode);
+            unicode = std::min(map->unicodeFirst, maxUnicode);
+
+            continue;
+        }
+
+        const int mapEnd = std::min(map->unicodeLast, maxUnicode);
+        for (; unicode < mapEnd && remainingTextures > 0; unicode++)
+            setCharacterForImage(static_cast<uint32_t>(map->textureIndex + unicode - map->unicodeFirst), unicode);
+    }
+}
+
 void LoadUIFontAtlasAsset(CAssetContainer* const pak, CAsset* const asset)
 {
 	UNUSED(pak);
@@ -309,11 +374,7 @@ void LoadUIFontAtlasAsset(CAssetContainer* const pak, CAsset* const asset)
         // [rika]: r2tt handling
         if (font->numUnicodeMaps > 0) UNLIKELY
         {
-            // get the max number of unicodes in here!
-            const int fakeChunkCount = (font->unicodeMap[font->numUnicodeMaps - 1].unicodeLast >> 6); // fake it til we make it, get the last possible chunk if this wasn't a legacy map!
-            const int maxUnicode = (fakeChunkCount + 1) << 6;
-
-            font->SetCharacterForImages(fontAsset, maxUnicode, font->numUnicodeTextures, &UIFontHeader::TextureFromUnicodeMap);
+            font->SetCharacterForImagesFromUnicodeMap(fontAsset);
 
             continue;
         }
@@ -383,10 +444,26 @@ void PostLoadUIFontAtlasAsset(CAssetContainer* const pak, CAsset* const asset)
 	// Only raw needs SRV.
 	fontAsset->txtrRaw = std::make_shared<CTexture>(txtrData.get(), highestMip->slicePitch, highestMip->width, highestMip->height, fontAsset->txtrFormat, 1u, 1u);
 	fontAsset->txtrRaw->CreateShaderResourceView(g_dxHandler->GetDevice());
+}
 
-	// Convert to respective srgb non srgb format for texture slicing later.
-	fontAsset->txtrConverted = std::make_shared<CTexture>(txtrData.get(), highestMip->slicePitch, highestMip->width, highestMip->height, fontAsset->txtrFormat, 1u, 1u);
-	fontAsset->txtrConverted->ConvertToFormat(IsSRGB(fontAsset->txtrFormat) ? DXGI_FORMAT_R8G8B8A8_UNORM_SRGB : DXGI_FORMAT_R8G8B8A8_UNORM); // Convert in advance to non compressed format for preview.
+std::shared_ptr<CTexture> UIFontAtlasAsset::GetConvertedTexture()
+{
+    std::lock_guard<std::mutex> lock(txtrConvertedMutex);
+
+    if (txtrConverted || !txtrRaw)
+        return txtrConverted;
+
+    // Convert to respective srgb non srgb format for texture slicing.
+    std::shared_ptr<CTexture> txtr = std::make_shared<CTexture>(reinterpret_cast<const char*>(txtrRaw->GetPixels()), txtrRaw->GetSlicePitch(), txtrRaw->GetWidth(), txtrRaw->GetHeight(), txtrFormat, 1u, 1u);
+    if (!txtr->ConvertToFormat(IsSRGB(txtrFormat) ? DXGI_FORMAT_R8G8B8A8_UNORM_SRGB : DXGI_FORMAT_R8G8B8A8_UNORM))
+    {
+        assertm(false, "Failed to decode atlas texture.");
+        return nullptr;
+    }
+
+    txtrConverted = std::move(txtr);
+
+    return txtrConverted;
 }
 
 struct UICharacterPreviewData_t
@@ -501,9 +578,8 @@ void* PreviewUIFontAtlasAsset(CAsset* const asset, const bool firstFrameForAsset
     auto CreateTextureForImage = [](UIFontAtlasAsset* const fontAsset, const UIFontCharacter_t* const fontCharacter) -> std::shared_ptr<CTexture>
     {
         assertm(fontAsset->txtrRaw, "Atlas texture wasn't created yet.");
-        assertm(fontAsset->txtrConverted, "Converted atlas texture wasn't created yet.");
 
-        if (!fontAsset->txtrRaw || !fontAsset->txtrConverted)
+        if (!fontAsset->txtrRaw)
             return nullptr;
 
         // This will be the main texture.
@@ -514,9 +590,13 @@ void* PreviewUIFontAtlasAsset(CAsset* const asset, const bool firstFrameForAsset
         if (fontCharacter->width * fontCharacter->height == 0)
             return nullptr;
 
+        const std::shared_ptr<CTexture> convertedTxtr = fontAsset->GetConvertedTexture();
+        if (!convertedTxtr)
+            return nullptr;
+
         // Create texture / shader and get slice for image.
         std::shared_ptr<CTexture> txtrData = std::make_shared<CTexture>(nullptr, 0u, fontCharacter->width, fontCharacter->height, (IsSRGB(fontAsset->txtrFormat) ? DXGI_FORMAT_R8G8B8A8_UNORM_SRGB : DXGI_FORMAT_R8G8B8A8_UNORM), 1u, 1u);
-        txtrData->CopySourceTextureSlice(fontAsset->txtrConverted.get(), static_cast<size_t>(fontCharacter->posX), static_cast<size_t>(fontCharacter->posY), fontCharacter->width, fontCharacter->height, 0u, 0u);
+        txtrData->CopySourceTextureSlice(convertedTxtr.get(), static_cast<size_t>(fontCharacter->posX), static_cast<size_t>(fontCharacter->posY), fontCharacter->width, fontCharacter->height, 0u, 0u);
         txtrData->CreateShaderResourceView(g_dxHandler->GetDevice());
 
         return txtrData;
@@ -764,9 +844,219 @@ enum eUIFontAtlasExportSetting
     PNG_T,  // PNG (Textures)
     DDS_AT, // DDS (Atlas)
     DDS_T,  // DDS (Textures)
+    BMF_AT, // BMFont (PNG atlas + .fnt per font)
 };
 
 static const char* const s_PathPrefixFONT = s_AssetTypePaths.find(AssetType_t::FONT)->second;
+
+// decodes the atlas once, then crops and writes out the glyphs of every font in parallel
+static bool ExportUIFontAtlasGlyphs(CAsset* const asset, UIFontAtlasAsset* const uiAsset, const std::filesystem::path& exportPath, const bool exportPng)
+{
+    const std::shared_ptr<CTexture> convertedTxtr = uiAsset->GetConvertedTexture();
+    assertm(convertedTxtr, "Converted atlas was not valid.");
+
+    if (!convertedTxtr)
+        return false;
+
+    struct FontGlyphExport_t
+    {
+        const UIFontCharacter_t* character;
+        std::filesystem::path path;
+    };
+
+    std::vector<FontGlyphExport_t> glyphExports;
+    glyphExports.reserve(static_cast<size_t>(uiAsset->imageCount));
+
+    // set up paths and directories up front. fonts can share a name and images can share a character,
+    // those paths are only written once so two threads never write the same file. the last image for a path wins,
+    // like it did when glyphs were written one after the other.
+    std::unordered_map<std::string, size_t> glyphPaths; // path to its index in glyphExports
+    for (uint16_t idx = 0; idx < uiAsset->fontCount; idx++)
+    {
+        const UIFontHeader* const font = &uiAsset->fontData.at(idx);
+        const std::string name = !font->name ? std::format("unnamed_{}", idx) : font->name;
+
+        std::filesystem::path fontPath = exportPath;
+        fontPath.append(name);
+
+        if (!CreateDirectories(fontPath))
+        {
+            assertm(false, "Failed to create export type directory");
+            return false;
+        }
+
+        for (uint32_t texIdx = 0; texIdx < font->numUnicodeTextures; texIdx++)
+        {
+            const UIFontCharacter_t* const character = &uiAsset->images[font->textureIndex + texIdx];
+
+            if (character->width * character->height == 0)
+                continue;
+
+            std::filesystem::path glyphPath = fontPath;
+            glyphPath.append(std::format("U+{:04x}.{}", character->utf16, exportPng ? "png" : "dds"));
+
+            const auto [it, inserted] = glyphPaths.try_emplace(glyphPath.string(), glyphExports.size());
+            if (!inserted)
+            {
+                glyphExports[it->second].character = character;
+                continue;
+            }
+
+            glyphExports.push_back({ character, std::move(glyphPath) });
+        }
+    }
+
+    if (glyphExports.empty())
+        return true;
+
+    const DXGI_FORMAT sliceFormat = IsSRGB(uiAsset->txtrFormat) ? DXGI_FORMAT_R8G8B8A8_UNORM_SRGB : DXGI_FORMAT_R8G8B8A8_UNORM;
+
+    std::atomic<uint32_t> numFailed = 0u;
+    std::atomic<uint32_t> numExported = 0u;
+
+    const ProgressBarEvent_t* const glyphExportProgress = g_pImGuiHandler->AddProgressBarEvent("Exporting Fonts..", static_cast<uint32_t>(glyphExports.size()), &numExported, true);
+
+    const uint32_t numThreads = CThread::GetNestedExportThreadBudget(static_cast<uint32_t>(glyphExports.size()));
+
+    ParallelFor(glyphExports.size(), numThreads, [&](const size_t i)
+        {
+            const FontGlyphExport_t& glyphExport = glyphExports[i];
+            const UIFontCharacter_t* const character = glyphExport.character;
+
+            // the decoded atlas is only read from here, so it's fine to crop from it on multiple threads
+            std::unique_ptr<CTexture> sliceData = std::make_unique<CTexture>(nullptr, 0u, character->width, character->height, sliceFormat, 1u, 1u);
+            sliceData->CopySourceTextureSlice(convertedTxtr.get(), static_cast<size_t>(character->posX), static_cast<size_t>(character->posY), character->width, character->height, 0u, 0u);
+
+            if (!(exportPng ? sliceData->ExportAsPng(glyphExport.path) : sliceData->ExportAsDds(glyphExport.path)))
+                numFailed++;
+
+            numExported++;
+        });
+
+    g_pImGuiHandler->FinishProgressBarEvent(glyphExportProgress);
+
+    if (numFailed > 0u)
+    {
+        Log("FONT: failed to export %u of %llu glyphs in font atlas %llx\n", numFailed.load(), glyphExports.size(), asset->GetAssetGUID());
+        return false;
+    }
+
+    return true;
+}
+
+// the atlas as a single png with a bmfont text description for each font, instead of a file per glyph
+static bool ExportUIFontAtlasBMFont(UIFontAtlasAsset* const uiAsset, const std::filesystem::path& exportPath)
+{
+    assertm(uiAsset->txtrRaw, "Atlas was not valid.");
+
+    if (!uiAsset->txtrRaw)
+        return false;
+
+    if (!CreateDirectories(exportPath))
+    {
+        assertm(false, "Failed to create export type directory");
+        return false;
+    }
+
+    const std::string atlasFileName = exportPath.filename().string() + ".png";
+
+    std::filesystem::path atlasPath = exportPath;
+    atlasPath.append(atlasFileName);
+
+    if (!uiAsset->txtrRaw->ExportAsPng(atlasPath))
+        return false;
+
+    static thread_local CTextBuilder text;
+
+    for (uint16_t idx = 0; idx < uiAsset->fontCount; idx++)
+    {
+        const UIFontHeader* const font = &uiAsset->fontData.at(idx);
+        const std::string name = !font->name ? std::format("unnamed_{}", idx) : font->name;
+
+        uint32_t numChars = 0u;
+        uint16_t lineHeight = 0u;
+
+        for (uint32_t texIdx = 0; texIdx < font->numUnicodeTextures; texIdx++)
+        {
+            const UIFontCharacter_t* const character = &uiAsset->images[font->textureIndex + texIdx];
+
+            if (character->utf16 == -1)
+                continue;
+
+            numChars++;
+            lineHeight = std::max(lineHeight, character->height);
+        }
+
+        text.Clear();
+
+        text.Append("info face=\"");
+        text.AppendEscapedKV(name);
+        text.Append("\" size=");
+        text.AppendUInt(lineHeight);
+        text.Append(" bold=0 italic=0 charset=\"\" unicode=1 stretchH=100 smooth=1 aa=1 padding=0,0,0,0 spacing=0,0\n");
+
+        text.Append("common lineHeight=");
+        text.AppendUInt(lineHeight);
+        text.Append(" base=");
+        text.AppendUInt(lineHeight);
+        text.Append(" scaleW=");
+        text.AppendUInt(uiAsset->width);
+        text.Append(" scaleH=");
+        text.AppendUInt(uiAsset->height);
+        text.Append(" pages=1 packed=0\n");
+
+        text.Append("page id=0 file=\"");
+        text.AppendEscapedKV(atlasFileName);
+        text.Append("\"\n");
+
+        text.Append("chars count=");
+        text.AppendUInt(numChars);
+        text.Append('\n');
+
+        // the asset doesn't store bearings or advances, so glyphs are placed as they sit in the atlas and advance by their width
+        for (uint32_t texIdx = 0; texIdx < font->numUnicodeTextures; texIdx++)
+        {
+            const UIFontCharacter_t* const character = &uiAsset->images[font->textureIndex + texIdx];
+
+            if (character->utf16 == -1)
+                continue;
+
+            // empty glyphs are parked outside of the atlas
+            const bool isEmpty = character->width * character->height == 0;
+
+            text.Append("char id=");
+            text.AppendUInt(static_cast<uint32_t>(character->utf16));
+            text.Append(" x=");
+            text.AppendUInt(isEmpty ? 0u : character->posX);
+            text.Append(" y=");
+            text.AppendUInt(isEmpty ? 0u : character->posY);
+            text.Append(" width=");
+            text.AppendUInt(character->width);
+            text.Append(" height=");
+            text.AppendUInt(character->height);
+            text.Append(" xoffset=0 yoffset=0 xadvance=");
+            text.AppendUInt(character->width);
+            text.Append(" page=0 chnl=15\n");
+        }
+
+        std::filesystem::path fontPath = exportPath;
+        fontPath.append(name + ".fnt");
+
+        StreamIO out;
+        if (!out.open(fontPath.string(), eStreamIOMode::Write))
+        {
+            assertm(false, "Failed to open file for write.");
+            return false;
+        }
+
+        out.write(text.Data(), text.Length());
+    }
+
+    text.Clear();
+
+    return true;
+}
+
 bool ExportUIFontAtlasAsset(CAsset* const asset, const int setting)
 {
     CPakAsset* pakAsset = static_cast<CPakAsset*>(asset);
@@ -827,89 +1117,10 @@ bool ExportUIFontAtlasAsset(CAsset* const asset, const int setting)
         return false;
     }
     case eUIFontAtlasExportSetting::DDS_T:
-    {
-        assertm(uiAsset->txtrConverted, "Converted atlas was not valid.");
-
-        std::atomic<uint32_t> remainingFonts = 0; // we don't actually need thread safe here
-        const ProgressBarEvent_t* const fontExportProgress = g_pImGuiHandler->AddProgressBarEvent("Exporting Fonts..", static_cast<uint32_t>(uiAsset->fontCount), &remainingFonts, true);
-        for (uint16_t idx = 0; idx < uiAsset->fontCount; idx++)
-        {
-            const UIFontHeader* const font = &uiAsset->fontData.at(idx);
-            const std::string name = !font->name ? std::format("unnamed_{}", idx) : font->name;
-
-            std::filesystem::path fontPath = exportPath;
-            fontPath.append(name);
-
-            if (!CreateDirectories(fontPath))
-            {
-                assertm(false, "Failed to create export type directory");
-                return false;
-            }
-
-            fontPath.append("generic");
-
-            for (uint32_t texIdx = 0; texIdx < font->numUnicodeTextures; texIdx++)
-            {
-                const UIFontCharacter_t* const character = &uiAsset->images[font->textureIndex + texIdx];
-
-                if (character->width * character->height == 0)
-                    continue;
-
-                fontPath.replace_filename(std::format("U+{:04x}.dds", character->utf16));
-
-                std::unique_ptr<CTexture> sliceData = std::make_unique<CTexture>(nullptr, 0u, character->width, character->height, (IsSRGB(uiAsset->txtrFormat) ? DXGI_FORMAT_R8G8B8A8_UNORM_SRGB : DXGI_FORMAT_R8G8B8A8_UNORM), 1u, 1u);
-                sliceData->CopySourceTextureSlice(uiAsset->txtrConverted.get(), static_cast<size_t>(character->posX), static_cast<size_t>(character->posY), character->width, character->height, 0u, 0u);
-                sliceData->ExportAsDds(fontPath);
-            }
-
-            remainingFonts++;
-        }
-        g_pImGuiHandler->FinishProgressBarEvent(fontExportProgress);
-
-        return true;
-    }
     case eUIFontAtlasExportSetting::PNG_T:
-    {
-        assertm(uiAsset->txtrConverted, "Converted atlas was not valid.");
-
-        std::atomic<uint32_t> remainingFonts = 0; // we don't actually need thread safe here
-        const ProgressBarEvent_t* const fontExportProgress = g_pImGuiHandler->AddProgressBarEvent("Exporting Fonts..", static_cast<uint32_t>(uiAsset->fontCount), &remainingFonts, true);
-        for (uint16_t idx = 0; idx < uiAsset->fontCount; idx++)
-        {
-            const UIFontHeader* const font = &uiAsset->fontData.at(idx);
-            const std::string name = !font->name ? std::format("unnamed_{}", idx) : font->name;
-
-            std::filesystem::path fontPath = exportPath;
-            fontPath.append(name);
-
-            if (!CreateDirectories(fontPath))
-            {
-                assertm(false, "Failed to create export type directory");
-                return false;
-            }
-
-            fontPath.append("generic");
-
-            for (uint32_t texIdx = 0; texIdx < font->numUnicodeTextures; texIdx++)
-            {
-                const UIFontCharacter_t* const character = &uiAsset->images[font->textureIndex + texIdx];
-
-                if (character->width * character->height == 0)
-                    continue;
-
-                fontPath.replace_filename(std::format("U+{:04x}.png", character->utf16));
-
-                std::unique_ptr<CTexture> sliceData = std::make_unique<CTexture>(nullptr, 0u, character->width, character->height, (IsSRGB(uiAsset->txtrFormat) ? DXGI_FORMAT_R8G8B8A8_UNORM_SRGB : DXGI_FORMAT_R8G8B8A8_UNORM), 1u, 1u);
-                sliceData->CopySourceTextureSlice(uiAsset->txtrConverted.get(), static_cast<size_t>(character->posX), static_cast<size_t>(character->posY), character->width, character->height, 0u, 0u);
-                sliceData->ExportAsPng(fontPath);
-            }
-
-            remainingFonts++;
-        }
-        g_pImGuiHandler->FinishProgressBarEvent(fontExportProgress);
-
-        return true;
-    }
+        return ExportUIFontAtlasGlyphs(asset, uiAsset, exportPath, setting == eUIFontAtlasExportSetting::PNG_T);
+    case eUIFontAtlasExportSetting::BMF_AT:
+        return ExportUIFontAtlasBMFont(uiAsset, exportPath);
     case eUIFontAtlasExportSetting::JSON_M:
     {
         const int version = pakAsset->version();
@@ -931,14 +1142,16 @@ bool ExportUIFontAtlasAsset(CAsset* const asset, const int setting)
         }
 
         exportPath.replace_extension(".json");
-        std::ofstream ofs(exportPath, std::ios::out);
+        StreamIO out(exportPath, eStreamIOMode::Write, true);
 
-        if (!ofs.is_open())
+        if (!out.W())
         {
             assertm(false, "Failed to open JSON file for writing");
             return false;
         }
 
+        std::ofstream& ofs = *out.W();
+
         CPakAsset* const textureAsset = g_assetData.FindAssetByGUID<CPakAsset>(uiAsset->atlasGUID);
         std::string atlasTexturePath = textureAsset ? textureAsset->GetAssetName() : std::format("0x{:016X}", uiAsset->atlasGUID);
         FixSlashes(atlasTexturePath);
@@ -1133,7 +1346,7 @@ bool ExportUIFontAtlasAsset(CAsset* const asset, const int setting)
         }
 
         ofs << "}\n";
-        ofs.close();
+        out.close();
         Log("Exported font atlas JSON: cpuData=%zu bytes, %u fonts\n", cpuDataSize, uiAsset->fontCount);
         return true;
     }
@@ -1149,7 +1362,7 @@ bool ExportUIFontAtlasAsset(CAsset* const asset, const int setting)
 
 void InitUIFontAtlasAssetType()
 {
-    static const char* settings[] = { "JSON", "PNG (Atlas)", "PNG (Textures)", "DDS (Atlas)", "DDS (Textures)" };
+    static const char* settings[] = { "JSON", "PNG (Atlas)", "PNG (Textures)", "DDS (Atlas)", "DDS (Textures)", "BMFont (Atlas)" };
     AssetTypeBinding_t type =
     {
         .name = "UI Font",
@@ -431,6 +431,7 @@ public:
     void ParseProportions(Vector2D* const imageBoundsScale, Vector2D* const imageSizeBase) const;
 
     void SetCharacterForImages(const UIFontAtlasAsset* const fontAsset, const int maxUnicode, const uint32_t numTextures, const uint32_t(UIFontHeader::*TextureFromCharacter)(int) const) const;
+    void SetCharacterForImagesFromUnicodeMap(const UIFontAtlasAsset* const fontAsset) const;
 
 private:
     inline const uint32_t GetTextureIndexFromUnicodeMap(int unicode) const;
@@ -517,7 +518,13 @@ public:
 
     std::vector<UIFontHeader> fontData;
 
+    // decoded to rgba the first time a preview or export needs to crop glyphs from it
+    std::shared_ptr<CTexture> GetConvertedTexture();
+
     std::shared_ptr<CTexture> txtrRaw;
-    std::shared_ptr<CTexture> txtrConverted;
+    std::shared_ptr<CTexture> txtrConverted; // don't use directly, see GetConvertedTexture
     DXGI_FORMAT txtrFormat;
+
+private:
+    std::mutex txtrConvertedMutex;
 };
@@ -227,55 +227,210 @@ void PostLoadUIImageAsset(CAssetContainer* container, CAsset* asset)
 }
 
 // Or swizzle work..
-std::unique_ptr<CTexture> DoTilingWork(std::unique_ptr<CTexture> texture, std::unique_ptr<char[]> const& buf, const size_t bufSize, const uint32_t widthBlocks, const uint32_t heightBlocks, const uint32_t bpp2x)
-{    
+// Destination block of the source block at (x, y). This doesn't depend on the data at all, so it only gets used to build remap tables.
+static const uint64_t GetTiledBlockDestination(const uint32_t x, const uint32_t y, const uint32_t widthBlocks)
+{
+    uint32_t mx = x;
+    uint32_t my = y;
+
+    // --- 2 ---
+    int power = 2;
+    int b_2 = (mx / 2 + my * (widthBlocks / power)) % (2 * (widthBlocks / power)) /
+        2 + (widthBlocks / power) * ((mx / 2 + my * (widthBlocks / power)) % (2 * (widthBlocks / power)) % 2) +
+        2 * (widthBlocks / power) * ((mx / 2 + my * (widthBlocks / power)) / (2 * (widthBlocks / power)));
+
+    int c_2 = mx % 2 + 2 * (b_2 % (widthBlocks / power));
+    mx = b_2 / (widthBlocks / power);
+    my = c_2 / 4;
+    c_2 %= 4;
+
+    // --- 4 ---
+    power = 4;
+    int b_4 = (my + mx / 2 * (widthBlocks / power)) % (2 * (widthBlocks / power)) /
+        2 + (widthBlocks / power) * ((my + mx / 2 * (widthBlocks / power)) % (2 * (widthBlocks / power)) % 2) +
+        2 * (widthBlocks / power) * ((my + mx / 2 * (widthBlocks / power)) / (2 * (widthBlocks / power)));
+
+    int c_4 = mx % 2 + 2 * (b_4 / (widthBlocks / power));
+    mx = b_4 / (widthBlocks / power);
+    my = c_4 / 4;
+    c_4 %= 4;
+
+    // --- 8 ---
+    power = 8;
+    int b_8 = ((c_2 + 4 * (b_4 % (widthBlocks / 4))) / 8 + my * (widthBlocks / power)) % (2 * (widthBlocks / power)) /
+        2 + (widthBlocks / power) * (((c_2 + 4 * (b_4 % (widthBlocks / 4))) / 8 + my * (widthBlocks / power)) % (2 * (widthBlocks / power)) % 2) +
+        2 * (widthBlocks / power) * (((c_2 + 4 * (b_4 % (widthBlocks / 4))) / 8 + my * (widthBlocks / power)) / (2 * (widthBlocks / power)));
+
+    my = (c_4 + 4 * ((int)b_8 / (widthBlocks / power)));
+    mx = (c_2 + 4 * (b_4 % (widthBlocks / 4))) % 8 + 8 * (uint32_t)(b_8 % (widthBlocks / power));
+
+    return static_cast<uint64_t>(my * widthBlocks + mx);
+}
+
+// Block permutation for an image size, indexed by source block. The permutation is the same for bc1 and bc7 since it's in blocks, not bytes.
+struct UIImageTileRemap_t
+{
+    static constexpr uint32_t invalidBlock = 0xFFFFFFFFu; // destination falls outside of the image or texture, these blocks get dropped
+
+    uint32_t widthBlocks;
+    uint32_t heightBlocks;
+    uint64_t maxDestBlocks; // number of whole blocks that fit in the destination texture
+    std::vector<uint32_t> destBlocks;
+};
+
+static std::mutex s_UIImageTileRemapMutex;
+static std::map<std::pair<uint64_t, uint64_t>, std::shared_ptr<const UIImageTileRemap_t>> s_UIImageTileRemaps;
+
+static std::shared_ptr<const UIImageTileRemap_t> GetUIImageTileRemap(const uint32_t widthBlocks, const uint32_t heightBlocks, const uint64_t maxDestBlocks)
+{
+    const std::pair<uint64_t, uint64_t> key((static_cast<uint64_t>(widthBlocks) << 32) | heightBlocks, maxDestBlocks);
+
+    {
+        std::lock_guard<std::mutex> lock(s_UIImageTileRemapMutex);
+
+        const auto it = s_UIImageTileRemaps.find(key);
+        if (it != s_UIImageTileRemaps.end())
+            return it->second;
+    }
+
+    // build outside of the lock, if two threads build the same remap at once the first one wins
+    std::shared_ptr<UIImageTileRemap_t> remap = std::make_shared<UIImageTileRemap_t>();
+    remap->widthBlocks = widthBlocks;
+    remap->heightBlocks = heightBlocks;
+    remap->maxDestBlocks = maxDestBlocks;
+    remap->destBlocks.resize(static_cast<size_t>(widthBlocks) * heightBlocks);
+
+    // blocks are copied without bounds checks, so anything that wouldn't fit in the texture is dropped here
+    const uint64_t numBlocks = std::min(static_cast<uint64_t>(remap->destBlocks.size()), maxDestBlocks);
+
+    uint32_t* destBlock = remap->destBlocks.data();
+    for (uint32_t y = 0u; y < heightBlocks; y++)
+    {
+        for (uint32_t x = 0u; x < widthBlocks; x++)
+        {
+            const uint64_t destination = GetTiledBlockDestination(x, y, widthBlocks);
+            assertm(destination < numBlocks, "destination greater than our texture size?");
+
+            *destBlock++ = destination < numBlocks ? static_cast<uint32_t>(destination) : UIImageTileRemap_t::invalidBlock;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(s_UIImageTileRemapMutex);
+    return s_UIImageTileRemaps.emplace(key, std::move(remap)).first->second;
+}
+
+// blockSize is a compile time constant so each copy is a single 8 or 16 byte move
+template<size_t blockSize>
+static void ApplyUIImageTileRemap(char* const dest, const char* const src, const uint32_t* const destBlocks, const size_t firstBlock, const size_t lastBlock)
+{
+    for (size_t i = firstBlock; i < lastBlock; i++)
+    {
+        const uint32_t destBlock = destBlocks[i];
+        if (destBlock == UIImageTileRemap_t::invalidBlock)
+            continue;
+
+        memcpy(dest + (static_cast<size_t>(destBlock) * blockSize), src + (i * blockSize), blockSize);
+    }
+}
+
+static void ApplyUIImageTileRemap(char* const dest, const char* const src, const uint32_t* const destBlocks, const size_t firstBlock, const size_t lastBlock, const uint32_t blockSize)
+{
+    switch (blockSize)
+    {
+    case 8u:
+        ApplyUIImageTileRemap<8u>(dest, src, destBlocks, firstBlock, lastBlock);
+        break;
+    case 16u:
+        ApplyUIImageTileRemap<16u>(dest, src, destBlocks, firstBlock, lastBlock);
+        break;
+    default:
+    {
+        for (size_t i = firstBlock; i < lastBlock; i++)
+        {
+            const uint32_t destBlock = destBlocks[i];
+            if (destBlock == UIImageTileRemap_t::invalidBlock)
+                continue;
+
+            memcpy(dest + (static_cast<size_t>(destBlock) * blockSize), src + (i * blockSize), blockSize);
+        }
+
+        break;
+    }
+    }
+}
+
+#ifdef _DEBUG
+// The old per block routine, remapped textures are checked against it in debug builds.
+static void DoTilingWorkReference(char* const dest, const size_t destSize, const char* const src, const size_t srcSize, const uint32_t widthBlocks, const uint32_t heightBlocks, const uint32_t bpp2x)
+{
     uint64_t tileOffset = 0ull;
     for (uint32_t y = 0u; y < heightBlocks; y++)
     {
         for (uint32_t x = 0u; x < widthBlocks; x++)
         {
-            uint32_t mx = x;
-            uint32_t my = y;
-
-            // --- 2 ---
-            int power = 2;
-            int b_2 = (mx / 2 + my * (widthBlocks / power)) % (2 * (widthBlocks / power)) /
-                2 + (widthBlocks / power) * ((mx / 2 + my * (widthBlocks / power)) % (2 * (widthBlocks / power)) % 2) +
-                2 * (widthBlocks / power) * ((mx / 2 + my * (widthBlocks / power)) / (2 * (widthBlocks / power)));
-
-            int c_2 = mx % 2 + 2 * (b_2 % (widthBlocks / power));
-            mx = b_2 / (widthBlocks / power);
-            my = c_2 / 4;
-            c_2 %= 4;
-
-            // --- 4 ---
-            power = 4;
-            int b_4 = (my + mx / 2 * (widthBlocks / power)) % (2 * (widthBlocks / power)) /
-                2 + (widthBlocks / power) * ((my + mx / 2 * (widthBlocks / power)) % (2 * (widthBlocks / power)) % 2) +
-                2 * (widthBlocks / power) * ((my + mx / 2 * (widthBlocks / power)) / (2 * (widthBlocks / power)));
-
-            int c_4 = mx % 2 + 2 * (b_4 / (widthBlocks / power));
-            mx = b_4 / (widthBlocks / power);
-            my = c_4 / 4;
-            c_4 %= 4;
-
-            // --- 8 ---
-            power = 8;
-            int b_8 = ((c_2 + 4 * (b_4 % (widthBlocks / 4))) / 8 + my * (widthBlocks / power)) % (2 * (widthBlocks / power)) /
-                2 + (widthBlocks / power) * (((c_2 + 4 * (b_4 % (widthBlocks / 4))) / 8 + my * (widthBlocks / power)) % (2 * (widthBlocks / power)) % 2) +
-                2 * (widthBlocks / power) * (((c_2 + 4 * (b_4 % (widthBlocks / 4))) / 8 + my * (widthBlocks / power)) / (2 * (widthBlocks / power)));
-
-            my = (c_4 + 4 * ((int)b_8 / (widthBlocks / power)));
-            mx = (c_2 + 4 * (b_4 % (widthBlocks / 4))) % 8 + 8 * (uint32_t)(b_8 % (widthBlocks / power));
-
-            const uint64_t destination = static_cast<uint64_t>(bpp2x * (my * widthBlocks + mx));
-            assertm(destination < texture->GetSlicePitch(), "destination greater than our texture size?");
-
-            assertm(tileOffset < bufSize, "offset greater than our buf?");
-            memcpy_s(texture->GetPixels() + destination, texture->GetSlicePitch() - destination, buf.get() + tileOffset, bpp2x); // Same as above, account for max size in dest buf based on copy location.
+            const uint64_t destination = bpp2x * GetTiledBlockDestination(x, y, widthBlocks);
+
+            if (destination < destSize && tileOffset < srcSize)
+                memcpy_s(dest + destination, destSize - destination, src + tileOffset, bpp2x);
+
             tileOffset += bpp2x;
         }
     }
+}
+#endif
+
+// images with fewer blocks than this are remapped on the calling thread, splitting them up costs more than it saves
+static constexpr size_t s_UIImageTileParallelMinBlocks = 64u * 1024u;
+static constexpr uint32_t s_UIImageTileMaxThreads = 8u;
+
+std::unique_ptr<CTexture> DoTilingWork(std::unique_ptr<CTexture> texture, std::unique_ptr<char[]> const& buf, const size_t bufSize, const uint32_t widthBlocks, const uint32_t heightBlocks, const uint32_t bpp2x)
+{
+    const std::shared_ptr<const UIImageTileRemap_t> remap = GetUIImageTileRemap(widthBlocks, heightBlocks, texture->GetSlicePitch() / bpp2x);
+
+    char* const dest = reinterpret_cast<char*>(texture->GetPixels());
+    const char* const src = buf.get();
+
+    assertm(remap->destBlocks.size() * bpp2x <= texture->GetSlicePitch(), "destination greater than our texture size?");
+    assertm(remap->destBlocks.size() * bpp2x <= bufSize, "offset greater than our buf?");
+
+    // only remap blocks we have source data for and that land inside the texture
+    const size_t numBlocks = std::min(remap->destBlocks.size(), std::min(bufSize, texture->GetSlicePitch()) / bpp2x);
+
+    const uint32_t numThreads = numBlocks >= s_UIImageTileParallelMinBlocks ? std::clamp(CThread::GetConCurrentThreads(), 1u, s_UIImageTileMaxThreads) : 1u;
+    if (numThreads > 1u)
+    {
+        // split on row boundaries, every row writes to its own set of blocks
+        const uint32_t rowsPerTask = (heightBlocks + numThreads - 1u) / numThreads;
+        const size_t blocksPerTask = static_cast<size_t>(rowsPerTask) * widthBlocks;
+
+        CParallelTask remapTask(numThreads);
+        for (size_t firstBlock = 0u; firstBlock < numBlocks; firstBlock += blocksPerTask)
+        {
+            const size_t lastBlock = std::min(firstBlock + blocksPerTask, numBlocks);
+
+            remapTask.addTask([dest, src, &remap, firstBlock, lastBlock, bpp2x]
+                {
+                    ApplyUIImageTileRemap(dest, src, remap->destBlocks.data(), firstBlock, lastBlock, bpp2x);
+                }, 1u);
+        }
+
+        remapTask.execute();
+        remapTask.wait();
+    }
+    else
+    {
+        ApplyUIImageTileRemap(dest, src, remap->destBlocks.data(), 0u, numBlocks, bpp2x);
+    }
+
+#ifdef _DEBUG
+    {
+        std::unique_ptr<char[]> reference = std::make_unique<char[]>(texture->GetSlicePitch());
+        memcpy(reference.get(), dest, texture->GetSlicePitch()); // blocks that never get written keep whatever the texture had
+
+        DoTilingWorkReference(reference.get(), texture->GetSlicePitch(), src, bufSize, widthBlocks, heightBlocks, bpp2x);
+        assertm(memcmp(reference.get(), dest, texture->GetSlicePitch()) == 0, "tile remap doesn't match the reference routine");
+    }
+#endif
 
     return std::move(texture);
 }
@@ -6,6 +6,7 @@
 #include <core/render/dx.h>
 #include <core/utils/fileio.h>
 #include <thirdparty/imgui/imgui.h>
+#include <thirdparty/imgui/misc/imgui_utility.h>
 
 extern CDXParentHandler* g_dxHandler;
 extern ExportSettings_t g_ExportSettings;
@@ -172,9 +173,27 @@ void PostLoadUIImageAtlasAsset(CAssetContainer* const pak, CAsset* const asset)
     uiAsset->rawTxtr = std::make_shared<CTexture>(txtrData.get(), highestMip->slicePitch, highestMip->width, highestMip->height, uiAsset->format, 1u, 1u);
     uiAsset->rawTxtr->CreateShaderResourceView(g_dxHandler->GetDevice());
 
-    // Convert to respective srgb non srgb format for texture slicing later.
-    uiAsset->convertedTxtr = std::make_shared<CTexture>(txtrData.get(), highestMip->slicePitch, highestMip->width, highestMip->height, uiAsset->format, 1u, 1u);
-    uiAsset->convertedTxtr->ConvertToFormat(IsSRGB(uiAsset->format) ? DXGI_FORMAT_R8G8B8A8_UNORM_SRGB : DXGI_FORMAT_R8G8B8A8_UNORM); // Convert in advance to non compressed format for preview.
+    // the converted texture used for slicing gets decoded when it's first needed, most atlases are never previewed or exported.
+}
+
+std::shared_ptr<CTexture> UIImageAtlasAsset::GetConvertedTexture()
+{
+    std::lock_guard<std::mutex> lock(convertedTxtrMutex);
+
+    if (convertedTxtr || !rawTxtr)
+        return convertedTxtr;
+
+    // Convert to respective srgb non srgb format for texture slicing.
+    std::shared_ptr<CTexture> txtr = std::make_shared<CTexture>(reinterpret_cast<const char*>(rawTxtr->GetPixels()), rawTxtr->GetSlicePitch(), rawTxtr->GetWidth(), rawTxtr->GetHeight(), format, 1u, 1u);
+    if (!txtr->ConvertToFormat(IsSRGB(format) ? DXGI_FORMAT_R8G8B8A8_UNORM_SRGB : DXGI_FORMAT_R8G8B8A8_UNORM))
+    {
+        assertm(false, "Failed to decode atlas texture.");
+        return nullptr;
+    }
+
+    convertedTxtr = std::move(txtr);
+
+    return convertedTxtr;
 }
 
 struct UITexturePreviewData_t
@@ -280,9 +299,8 @@ void* PreviewUIImageAtlasAsset(CAsset* const asset, const bool firstFrameForAsse
     auto CreateTextureForImage = [](UIImageAtlasAsset* const uiAsset, const UIAtlasImage* const uiImage) -> std::shared_ptr<CTexture>
     {
         assertm(uiAsset->rawTxtr, "Atlas texture wasn't created yet.");
-        assertm(uiAsset->convertedTxtr, "Converted atlas texture wasn't created yet.");
 
-        if (!uiAsset->rawTxtr || !uiAsset->convertedTxtr)
+        if (!uiAsset->rawTxtr)
             return nullptr;
 
         // This will be the main texture.
@@ -293,9 +311,13 @@ void* PreviewUIImageAtlasAsset(CAsset* const asset, const bool firstFrameForAsse
         if (!uiImage->width || !uiImage->height)
             return nullptr;
 
+        const std::shared_ptr<CTexture> convertedTxtr = uiAsset->GetConvertedTexture();
+        if (!convertedTxtr)
+            return nullptr;
+
         // Create texture / shader and get slice for image.
         std::shared_ptr<CTexture> txtrData = std::make_shared<CTexture>(nullptr, 0u, uiImage->width, uiImage->height, (IsSRGB(uiAsset->format) ? DXGI_FORMAT_R8G8B8A8_UNORM_SRGB : DXGI_FORMAT_R8G8B8A8_UNORM), 1u, 1u);
-        txtrData->CopySourceTextureSlice(uiAsset->convertedTxtr.get(), static_cast<size_t>(uiImage->posX), static_cast<size_t>(uiImage->posY), uiImage->width, uiImage->height, 0u, 0u);
+        txtrData->CopySourceTextureSlice(convertedTxtr.get(), static_cast<size_t>(uiImage->posX), static_cast<size_t>(uiImage->posY), uiImage->width, uiImage->height, 0u, 0u);
         txtrData->CreateShaderResourceView(g_dxHandler->GetDevice());
 
         return txtrData;
@@ -519,6 +541,96 @@ enum eUIImageAtlasExportSetting
 
 //static_assert(s_AssetTypePaths.count(PakAssetType_t::UIMG));
 static const char* const s_PathPrefixUIMG = s_AssetTypePaths.find(AssetType_t::UIMG)->second;
+
+// decodes the atlas once, then crops and writes out every image in it in parallel
+static bool ExportUIImageAtlasTextures(CAsset* const asset, UIImageAtlasAsset* const uiAsset, const std::filesystem::path& exportPath, const bool exportPng)
+{
+    const std::shared_ptr<CTexture> convertedTxtr = uiAsset->GetConvertedTexture();
+    assertm(convertedTxtr, "Converted atlas was not valid.");
+
+    if (!convertedTxtr)
+        return false;
+
+    struct AtlasImageExport_t
+    {
+        const UIAtlasImage* image;
+        std::filesystem::path path;
+    };
+
+    std::vector<AtlasImageExport_t> imageExports;
+    imageExports.reserve(uiAsset->imageArray.size());
+
+    // set up paths and directories up front, many images share the same directory
+    std::unordered_set<std::string> createdDirectories;
+    for (auto it = uiAsset->imageArray.rbegin() + 1; it != uiAsset->imageArray.rend(); ++it) // We skip the last element, this is the main atlas texture.
+    {
+        // [amos] if either of them are null, the DirectX::CopyRectangle call will crash.
+        // the preview function above logs it as N/A so I think we should just skip them.
+        if (!it->width || !it->height)
+        {
+            Log("UIMG: skipping image %x in atlas %llx (invalid texture)\n", it->pathHash, asset->GetAssetGUID());
+
+            continue;
+        }
+
+        std::filesystem::path currentPath = exportPath;
+        std::filesystem::path itemPath = it->path;
+
+        // Setup paths.
+        if (currentPath.has_parent_path())
+            currentPath.append(itemPath.parent_path().string());
+
+        // [amos] Need to remove trailing slash because otherwise std::filesystem::create_directories
+        // will fail with the error message "The operation completed successfully".
+        // See https://developercommunity.visualstudio.com/t/stdfilesystemcreate-directories-returns-false-if-p/278829
+        currentPath = currentPath.parent_path();
+
+        if (!createdDirectories.contains(currentPath.string()))
+        {
+            if (!CreateDirectories(currentPath))
+            {
+                assertm(false, "Failed to create export type directory");
+                return false;
+            }
+
+            createdDirectories.insert(currentPath.string());
+        }
+
+        currentPath.concat(std::format("\\{}.{}", itemPath.filename().string(), exportPng ? "png" : "dds"));
+
+        imageExports.push_back({ &(*it), std::move(currentPath) });
+    }
+
+    if (imageExports.empty())
+        return true;
+
+    const DXGI_FORMAT sliceFormat = IsSRGB(uiAsset->format) ? DXGI_FORMAT_R8G8B8A8_UNORM_SRGB : DXGI_FORMAT_R8G8B8A8_UNORM;
+
+    std::atomic<uint32_t> numFailed = 0u;
+
+    const uint32_t numThreads = CThread::GetNestedExportThreadBudget(static_cast<uint32_t>(imageExports.size()));
+
+    ParallelFor(imageExports.size(), numThreads, [&](const size_t i)
+        {
+            const AtlasImageExport_t& imageExport = imageExports[i];
+            const UIAtlasImage* const image = imageExport.image;
+
+            // the decoded atlas is only read from here, so it's fine to crop from it on multiple threads
+            std::unique_ptr<CTexture> sliceData = std::make_unique<CTexture>(nullptr, 0u, image->width, image->height, sliceFormat, 1u, 1u);
+            sliceData->CopySourceTextureSlice(convertedTxtr.get(), static_cast<size_t>(image->posX), static_cast<size_t>(image->posY), image->width, image->height, 0u, 0u);
+
+            if (!(exportPng ? sliceData->ExportAsPng(imageExport.path) : sliceData->ExportAsDds(imageExport.path)))
+                numFailed++;
+        });
+
+    if (numFailed > 0u)
+    {
+        Log("UIMG: failed to export %u of %llu images in ui image atlas %llx\n", numFailed.load(), imageExports.size(), asset->GetAssetGUID());
+        return false;
+    }
+
+    return true;
+}
 bool ExportUIImageAtlasAsset(CAsset* const asset, const int setting)
 {
     CPakAsset* pakAsset = static_cast<CPakAsset*>(asset);
@@ -576,83 +688,8 @@ bool ExportUIImageAtlasAsset(CAsset* const asset, const int setting)
         return false;
     }
     case eUIImageAtlasExportSetting::DDS_T:
-    {
-        assertm(uiAsset->convertedTxtr, "Converted atlas was not valid.");
-        for (auto it = uiAsset->imageArray.rbegin() + 1; it != uiAsset->imageArray.rend(); ++it) // We skip the last element, this is the main atlas texture.
-        {
-            // [amos] if either of them are null, the DirectX::CopyRectangle call will crash.
-            // the preview function above logs it as N/A so I think we should just skip them.
-            if (!it->width || !it->height)
-            {
-                printf("skipping image %x in altas %llx (invalid texture)...\n", it->pathHash, asset->GetAssetGUID());
-
-                continue;
-            }
-
-            std::filesystem::path currentPath = exportPath;
-            std::filesystem::path itemPath = it->path;
-
-            // Setup paths.
-            if (currentPath.has_parent_path())
-                currentPath.append(itemPath.parent_path().string());
-
-            // [amos] Need to remove trailing slash because otherwise std::filesystem::create_directories
-            // will fail with the error message "The operation completed successfully".
-            // See https://developercommunity.visualstudio.com/t/stdfilesystemcreate-directories-returns-false-if-p/278829
-            currentPath = currentPath.parent_path();
-
-            if (!CreateDirectories(currentPath))
-            {
-                assertm(false, "Failed to create export type directory");
-                return false;
-            }
-            currentPath.concat(std::format("\\{}.dds", itemPath.filename().string()));
-
-            printf("Format = %d\n", (int)uiAsset->format);
-
-            std::unique_ptr<CTexture> sliceData = std::make_unique<CTexture>(nullptr, 0u, it->width, it->height, (IsSRGB(uiAsset->format) ? DXGI_FORMAT_R8G8B8A8_UNORM_SRGB : DXGI_FORMAT_R8G8B8A8_UNORM), 1u, 1u);
-            sliceData->CopySourceTextureSlice(uiAsset->convertedTxtr.get(), static_cast<size_t>(it->posX), static_cast<size_t>(it->posY), it->width, it->height, 0u, 0u);
-            sliceData->ExportAsDds(currentPath);
-        }
-
-        return true;
-    }
     case eUIImageAtlasExportSetting::PNG_T:
-    {
-        assertm(uiAsset->convertedTxtr, "Converted atlas was not valid.");
-        for (auto it = uiAsset->imageArray.rbegin() + 1; it != uiAsset->imageArray.rend(); ++it) // We skip the last element, this is the main atlas texture.
-        {
-            // [amos] if either of them are null, the DirectX::CopyRectangle call will crash.
-            // the preview function above logs it as N/A so I think we should just skip them.
-            if (!it->width || !it->height)
-                continue;
-
-            std::filesystem::path currentPath = exportPath;
-            std::filesystem::path itemPath = it->path;
-
-            // Setup paths.
-            if (currentPath.has_parent_path())
-                currentPath.append(itemPath.parent_path().string());
-
-            // [amos] Need to remove trailing slash because otherwise std::filesystem::create_directories
-            // will fail with the error message "The operation completed successfully".
-            // See https://developercommunity.visualstudio.com/t/stdfilesystemcreate-directories-returns-false-if-p/278829
-            currentPath = currentPath.parent_path();
-
-            if (!CreateDirectories(currentPath))
-            {
-                assertm(false, "Failed to create export type directory");
-                return false;
-            }
-            currentPath.concat(std::format("\\{}.png", itemPath.filename().string()));
-
-            std::unique_ptr<CTexture> sliceData = std::make_unique<CTexture>(nullptr, 0u, it->width, it->height, (IsSRGB(uiAsset->format) ? DXGI_FORMAT_R8G8B8A8_UNORM_SRGB : DXGI_FORMAT_R8G8B8A8_UNORM), 1u, 1u);
-            sliceData->CopySourceTextureSlice(uiAsset->convertedTxtr.get(), static_cast<size_t>(it->posX), static_cast<size_t>(it->posY), it->width, it->height, 0u, 0u);
-            sliceData->ExportAsPng(currentPath);
-        }
-
-        return true;
-    }
+        return ExportUIImageAtlasTextures(asset, uiAsset, exportPath, setting == eUIImageAtlasExportSetting::PNG_T);
     case eUIImageAtlasExportSetting::JSON_AT:
     {
         // Helper to escape strings for JSON output
@@ -129,9 +129,15 @@ public:
 
 	uint64_t atlasGUID;
 
+	// decodes the atlas on first use, every image in the atlas is cropped from this one decoded texture
+	std::shared_ptr<CTexture> GetConvertedTexture();
+
 	//
 	std::shared_ptr<CTexture> rawTxtr;
-	std::shared_ptr<CTexture> convertedTxtr;
+	std::shared_ptr<CTexture> convertedTxtr; // don't use directly, see GetConvertedTexture
 	DXGI_FORMAT format;
 	std::vector<UIAtlasImage> imageArray;
+
+private:
+	std::mutex convertedTxtrMutex;
 };
\ No newline at end of file
@@ -108,6 +108,24 @@ std::unique_ptr<char[]> GetWrapAssetData(CAsset* const asset, uint64_t* outSize)
 }
 
 
+static const bool IsBSPWrapAsset(const CAsset* const asset)
+{
+    return std::filesystem::path(asset->GetAssetName()).extension() == ".bsp";
+}
+
+static CBSPData* const ParseWrapAssetBSP(CPakAsset* const pakAsset)
+{
+    std::unique_ptr<char[]> wrapData = GetWrapAssetData(pakAsset, nullptr);
+
+    if (!wrapData)
+        return nullptr;
+
+    CBSPData* const bspData = new CBSPData(std::filesystem::path(pakAsset->GetAssetName()).stem().string());
+    bspData->PopulateFromPakAsset(pakAsset, wrapData.get());
+
+    return bspData;
+}
+
 void PostLoadWrapAsset(CAssetContainer* const pak, CAsset* const asset)
 {
     UNUSED(pak);
@@ -117,27 +135,20 @@ void PostLoadWrapAsset(CAssetContainer* const pak, CAsset* const asset)
 
     wrapAsset->parsedDataType = eWrapAssetParsedDataType::NONE;
 
+    // only the preview needs the bsp parsed on load, exports parse it when they need it
 #if defined(HAS_BSP_SUPPORT)
-    std::filesystem::path assetPath = std::filesystem::path(asset->GetAssetName());
-    std::string extension = assetPath.extension().string();
-
-    if (extension == ".bsp")
+    if (IsBSPWrapAsset(asset))
     {
-        wrapAsset->parsedDataType = eWrapAssetParsedDataType::BSP;
-
-        std::unique_ptr<char[]> wrapData = GetWrapAssetData(asset, nullptr);
-
-        CBSPData* bspData = new CBSPData(assetPath.stem().string());
-        bspData->PopulateFromPakAsset(pakAsset, wrapData.get());
+        wrapAsset->parsedData = ParseWrapAssetBSP(pakAsset);
 
-        wrapAsset->parsedData = bspData;
+        if (wrapAsset->parsedData)
+            wrapAsset->parsedDataType = eWrapAssetParsedDataType::BSP;
     }
 #endif
 }
 
 bool ExportWrapAsset(CAsset* const asset, const int setting)
 {
-    UNUSED(setting);
     CPakAsset* pakAsset = static_cast<CPakAsset*>(asset);
 
     const WrapAsset* const wrapAsset = reinterpret_cast<WrapAsset*>(pakAsset->extraData());
@@ -157,50 +168,39 @@ bool ExportWrapAsset(CAsset* const asset, const int setting)
         return false;
     }
 
-    switch (wrapAsset->parsedDataType)
+    // world geometry of bsp wraps, anything else (and raw bsp exports) is written as is below
+    if (setting != eWrapExportSetting::WRAP_EXPORT_RAW && IsBSPWrapAsset(asset))
     {
-    case eWrapAssetParsedDataType::NONE:
-    default:
-    {
-        StreamIO wrapOut;
+        const eBSPExportSetting bspSetting = setting == eWrapExportSetting::WRAP_EXPORT_BSP_GLB ? eBSPExportSetting::BSP_EXPORT_GLB : eBSPExportSetting::BSP_EXPORT_OBJ;
 
-        if (!wrapOut.open(exportPath.string(), eStreamIOMode::Write))
-        {
-            assertm(false, "Failed to open file for write.");
-            return false;
-        }
+        if (wrapAsset->parsedDataType == eWrapAssetParsedDataType::BSP)
+            return reinterpret_cast<const CBSPData*>(wrapAsset->parsedData)->Export(exportPath, bspSetting);
 
-        uint64_t wrapOutSize = 0;
-        std::unique_ptr<char[]> wrapData = GetWrapAssetData(asset, &wrapOutSize);
+        // not parsed on load, parse it just for this export
+        const std::unique_ptr<CBSPData> bspData(ParseWrapAssetBSP(pakAsset));
 
-        if (!wrapData)
+        if (!bspData)
             return false;
 
-        wrapOut.write(wrapData.get(), wrapOutSize);
-        wrapOut.close();
-        break;
+        return bspData->Export(exportPath, bspSetting);
     }
-#if defined(HAS_BSP_SUPPORT)
-    case eWrapAssetParsedDataType::BSP:
-    {
-        StreamIO wrapOut;
 
-        if (!wrapOut.open(exportPath.string(), eStreamIOMode::Write))
-        {
-            assertm(false, "Failed to open file for write.");
-            return false;
-        }
+    StreamIO wrapOut;
 
-        CBSPData* bspData = reinterpret_cast<CBSPData*>(wrapAsset->parsedData);
+    if (!wrapOut.open(exportPath.string(), eStreamIOMode::Write))
+    {
+        assertm(false, "Failed to open file for write.");
+        return false;
+    }
 
-        bspData->Export(wrapOut.W());
+    uint64_t wrapOutSize = 0;
+    std::unique_ptr<char[]> wrapData = GetWrapAssetData(asset, &wrapOutSize);
 
-        wrapOut.close();
+    if (!wrapData)
+        return false;
 
-        break;
-    }
-#endif
-    }
+    wrapOut.write(wrapData.get(), wrapOutSize);
+    wrapOut.close();
 
     return true;
 }
@@ -232,6 +232,8 @@ void* PreviewWrapAsset(CAsset* const asset, const bool firstFrameForAsset)
 
 void InitWrapAssetType()
 {
+    static const char* settings[] = { "Raw", "OBJ (BSP World)", "GLB (BSP World)" };
+
     AssetTypeBinding_t type =
     {
         .name = "Wrapped File",
@@ -240,7 +242,7 @@ void InitWrapAssetType()
         .loadFunc = LoadWrapAsset,
         .postLoadFunc = PostLoadWrapAsset,
         .previewFunc = PreviewWrapAsset,
-        .e = { ExportWrapAsset, 0, nullptr, 0ull },
+        .e = { ExportWrapAsset, 0, settings, ARRSIZE(settings) },
     };
 
     REGISTER_TYPE(type);
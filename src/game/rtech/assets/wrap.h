@@ -10,6 +10,13 @@ enum class eWrapAssetParsedDataType
 	BSP,      // wrap asset is a base BSP file and contains a CBSPData pointer
 };
 
+enum eWrapExportSetting
+{
+	WRAP_EXPORT_RAW,
+	WRAP_EXPORT_BSP_OBJ, // world geometry of .bsp wraps, anything else is exported raw
+	WRAP_EXPORT_BSP_GLB,
+};
+
 struct WrapAssetHeader_v1_t
 {
 	uint32_t size;
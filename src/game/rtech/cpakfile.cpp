@@ -12,16 +12,20 @@
 #include <thirdparty/imgui/misc/imgui_utility.h>
 
 #define PARSE_THREAD_COUNT UtilsConfig->parseThreadCount
+#define PAK_LOAD_THREAD_COUNT UtilsConfig->pakLoadThreadCount
 #else
 #define PARSE_THREAD_COUNT 1
+#define PAK_LOAD_THREAD_COUNT 1
 #endif
 
+#include <chrono>
+
 //CGlobalPakData g_pakData;
 
 #if defined(PAKLOAD_PATCHING_ANY)
-CPakFile::CPakFile() : m_pPatchDataHeader(nullptr), m_pPatchFileHeaders(nullptr), patchDataBuffer(nullptr), patchStreamCursor(nullptr), m_pAssetsRaw(nullptr), m_pAssetsInternal(nullptr), m_pDependentAssets(nullptr),
+CPakFile::CPakFile() : m_pPatchDataHeader(nullptr), m_pPatchFileHeaders(nullptr), patchDataBuffer(nullptr), numAppliedPatchOps(0ull), usePatchInterpreter(false), patchVerify(false), patchStreamCursor(nullptr), m_pAssetsRaw(nullptr), m_pAssetsInternal(nullptr), m_pDependentAssets(nullptr),
 m_pGuidRefHeaders(nullptr), m_pHeader(nullptr), m_pPageHeaders(nullptr), m_pPointerHeaders(nullptr), m_pSegmentHeaders(nullptr), m_pExternalAssetRefOffsets(nullptr), m_pExternalAssetRefs(nullptr),
-p{}, segmentCollections{}, numAssetsWithProcessedPages(0), numProcessedAssets(0), numProcessedPages(0), numResolvedPointers(0)
+p{}, segmentCollections{}, numAssetsWithProcessedPages(0), numProcessedAssets(0), numProcessedPages(0), numPointersInProcessedPages(0)
 {
 }
 #else
@@ -41,6 +45,8 @@ CPakFile::~CPakFile()
         {
             _aligned_free(collection->buffer);
             collection->buffer = nullptr;
+
+            g_MemoryTracker.Free(eMemoryCategory::MEM_PAK_SEGMENTS, 0u, collection->dataSize);
         }
     }
 #endif // #if !defined(PAKLOAD_PATCHING_ANY)
@@ -60,24 +66,42 @@ struct PakFileLoadState_t
 
 const bool CPakFile::ParseFileBuffer(const std::string& path)
 {
+    TRACE_ZONE("CPakFile::ParseFileBuffer");
+
+    if (!LoadFileBuffer(path))
+        return false;
+
+    ProcessAssets();
+    return true;
+}
+
+const bool CPakFile::LoadFileBuffer(const std::string& path)
+{
+    TRACE_ZONE("CPakFile::LoadFileBuffer");
+
     // Make sure that the pak instance always holds an absolute file path
     if (!std::filesystem::path(path).is_absolute())
         SetFilePath(std::filesystem::absolute(path));
     else
         SetFilePath(path);
 
-    if (!ParseFromFile(GetFilePath().string(), this->m_Buf))
+    size_t bufSize = 0ull;
+    if (!ParseFromFile(GetFilePath().string(), this->m_Buf, bufSize))
         return false;
 
     // parse our initial header (subject to change)
     ParsePakFileHeader(m_Buf.get());
 
+    if (!ValidateHeaderData(bufSize))
+        return false;
+
     switch (header()->version)
     {
 #if defined(PAKLOAD_LOADING_V6)
     case 6:
     {
-        this->LoadNonPatched();
+        if (!this->LoadNonPatched(bufSize))
+            return false;
 
         break;
     }
@@ -87,7 +111,7 @@ const bool CPakFile::ParseFileBuffer(const std::string& path)
 #if defined(PAKLOAD_PATCHING_V7)
         return this->LoadAndPatchPakFileData<PakHdr_v7_t, PakAsset_v6_t>();
 #else
-        return this->LoadNonPatched();
+        return this->LoadNonPatched(bufSize);
 #endif // #if !defined(PAKLOAD_PATCHING_V7)
 
         break;
@@ -97,7 +121,7 @@ const bool CPakFile::ParseFileBuffer(const std::string& path)
 #if defined(PAKLOAD_PATCHING_V8)
         return this->LoadAndPatchPakFileData<PakHdr_v8_t, PakAsset_v8_t>();
 #else
-        return this->LoadNonPatched();
+        return this->LoadNonPatched(bufSize);
 #endif // #if !defined(PAKLOAD_PATCHING_V8)
 
         break;
@@ -142,8 +166,10 @@ const bool CPakFile::ParsePakFileHeader(const char* buf, const short version)
 }
 
 #if !defined(PAKLOAD_PATCHING_ANY) || defined(PAKLOAD_LOADING_V6)
-const bool CPakFile::LoadNonPatched()
+const bool CPakFile::LoadNonPatched(const size_t bufSize)
 {
+    TRACE_ZONE("CPakFile::LoadNonPatched");
+
     char* buf = m_Buf.get();
 
     size_t offset = header()->pakHdrSize;
@@ -249,60 +275,41 @@ const bool CPakFile::LoadNonPatched()
         offset += m_pPatchDataHeader->patchDataStreamSize;
     }
 
-    pageBuffers.resize(pageStart);
+    if (offset > bufSize || header()->GetContainedPageDataSize() > bufSize - offset)
+    {
+        g_assetData.Log_Error(this, "Pak is truncated, its pages end past the end of the file (%zu bytes)", bufSize);
+        return false;
+    }
 
+    pageBuffers.resize(pageStart);
+    pageSizes.resize(pageStart);
 
     // get a pointer for each page
     for (int i = pageStart; i < m_pHeader->numPages; ++i)
     {
         pageBuffers.emplace_back(buf + offset);
+        pageSizes.emplace_back(m_pPageHeaders[i].size);
         offset += m_pPageHeaders[i].size;
     }
 
     // resolve all pointers
-    for (int i = 0; i < m_pHeader->numPointers; ++i)
-    {
-        PakPointerHdr_t* pHdr = &m_pPointerHeaders[i];
-
-        char* page = pageBuffers[pHdr->index];
-        if (page)
-        {
-            PagePtr_t* pPtr = reinterpret_cast<PagePtr_t*>(page + pHdr->offset);
-
-            int pageIndex = pPtr->index - this->firstPageIdx;
-
-            if (pageIndex < 0)
-                pageIndex += m_pHeader->numPages;
-
-            pPtr->ptr = pageBuffers[pageIndex] + pPtr->offset;
-        }
-    }
+    ResolvePagePointers(m_pHeader->numPointers, true);
 
     m_pAssetsInternal = new PakAsset_t[m_pHeader->numAssets];
+    m_rejectedAssets.assign(m_pHeader->numAssets, false);
 
     for (int i = 0; i < m_pHeader->numAssets; ++i)
     {
         void* pAsset = reinterpret_cast<char*>(m_pAssetsRaw) + (header()->pakAssetSize * i);
 
-        // check if headPagePtr is potentially valid (this should always be true)
-        PagePtr_t* headPagePtr = PakAsset_t::HeadPage(pAsset, header()->version);
-        if (headPagePtr->index != UINT32_MAX && headPagePtr->offset != UINT32_MAX)
-            headPagePtr->ptr = pageBuffers[headPagePtr->index] + headPagePtr->offset;
-        else
-            headPagePtr->ptr = nullptr;
-
-        // check if dataPagePtr is potentially valid
-        PagePtr_t* dataPagePtr = PakAsset_t::DataPage(pAsset, header()->version);
-        if (dataPagePtr->index != UINT32_MAX && dataPagePtr->offset != UINT32_MAX)
-            dataPagePtr->ptr = pageBuffers[dataPagePtr->index] + dataPagePtr->offset;
-        else
-            dataPagePtr->ptr = nullptr;
+        if (!ResolveAssetPagePointers(PakAsset_t::HeadPage(pAsset, header()->version), PakAsset_t::DataPage(pAsset, header()->version), PakAsset_t::HeaderStructSize(pAsset, header()->version)))
+            m_rejectedAssets[i] = true;
 
         m_pAssetsInternal[i] = header()->version > 7 ? PakAsset_t( reinterpret_cast<PakAsset_v8_t*>(pAsset)) : PakAsset_t(reinterpret_cast<PakAsset_v6_t*>(pAsset));
     }
 
-    // process assets now.
-    ProcessAssets();
+    ValidateAssetReferences();
+
     return true;
 }
 #endif // #if !defined(PAKLOAD_PATCHING_V8) || !defined(PAKLOAD_PATCHING_V7) || defined(PAKLOAD_LOADING_V6)
@@ -311,7 +318,9 @@ const bool CPakFile::LoadNonPatched()
 template<class PakHdr, class PakAsset>
 const bool CPakFile::LoadAndPatchPakFileData()
 {
-    if (g_assetData.m_pakLoadStatusMap.count(header()->crc) != 0)
+    TRACE_ZONE("CPakFile::LoadAndPatchPakFileData");
+
+    if (!this->patchVerify && g_assetData.m_pakLoadStatusMap.count(header()->crc) != 0)
     {
         Log("Pakfile '%s' failed to load because its CRC was already recorded as being loaded.\n", GetFilePath().c_str());
 
@@ -338,6 +347,9 @@ const bool CPakFile::LoadAndPatchPakFileData()
 
         memcpy(patchDataBuffer.get(), this->header()->GetPatchStreamData(), patchDataHeader->patchDataStreamSize);
         ParsePatchEditStream(); // the uhhhhhhhhhhhhhhhhhh
+
+        if (!this->usePatchInterpreter)
+            DecodePatchOps();
     }
 
 
@@ -357,8 +369,12 @@ const bool CPakFile::LoadAndPatchPakFileData()
         const std::filesystem::path patchFilePath = std::filesystem::path(GetFilePath()).replace_filename(std::format("{}{}.rpak", this->getPakStem(), patchSuffix));
 
         PakFileLoadState_t loadState = {};
-        if (!ParseFromFile(patchFilePath.string(), loadState.fileBuffer))
-            assert(0); // [rexx]: i will deal with this later
+        size_t patchFileSize = 0ull;
+        if (!ParseFromFile(patchFilePath.string(), loadState.fileBuffer, patchFileSize))
+        {
+            g_assetData.Log_Error(this, "Failed to load patch file \"%s\"", patchFilePath.filename().string().c_str());
+            return false;
+        }
 
         // get PakHdr from the newly loaded and decompressed pak
         const PakHdr* const patchPakHdr = reinterpret_cast<const PakHdr*>(loadState.fileBuffer.get());
@@ -367,11 +383,12 @@ const bool CPakFile::LoadAndPatchPakFileData()
         // Save the initialised pak load state into the chain's loaded pakfiles vector.
         pakChain.at(static_cast<size_t>(i + 1)) = loadState;
 
-        if(patchPakHdr->crc != 0 && g_assetData.m_pakLoadStatusMap.count(patchPakHdr->crc) == 0)
-            g_assetData.m_pakLoadStatusMap.emplace(patchPakHdr->crc, true);
+        // recorded as loaded once the pak is registered, paks can be loading on other threads right now
+        if (patchPakHdr->crc != 0)
+            m_patchFileCrcs.push_back(patchPakHdr->crc);
     }
 
-    std::shared_ptr<char[]> combinedPakDataBuffer = std::make_shared<char[]>(combinedPakBufferSize);
+    std::shared_ptr<char[]> combinedPakDataBuffer = MemoryTracker::AllocSharedBuffer(eMemoryCategory::MEM_PAK_BUFFER, combinedPakBufferSize, true);
 
     // copy top patch header into the buffer initially so all other file copies can behave the same way
     *reinterpret_cast<PakHdr*>(combinedPakDataBuffer.get()) = *reinterpret_cast<const PakHdr*>(this->header()->pakPtr);
@@ -405,47 +422,58 @@ const bool CPakFile::LoadAndPatchPakFileData()
         return false;
     }
 
+    if (this->patchVerify)
+    {
+        for (int i = 0; i < PAK_MAX_SEGMENT_COLLECTIONS; ++i)
+        {
+            if (this->segmentCollections[i].buffer)
+                memset(this->segmentCollections[i].buffer, 0, this->segmentCollections[i].dataSize);
+        }
+    }
+
     // Loop until all pages have been patched correctly.
     // This has a fallback of 100 iterations just in case patching fails, so that we don't end up with an infinite loop
     // So far, this has never happened, but we might as well make sure it never causes an issue if it does
     int numIterations = 0;
-    while (!LoadAndPatchAssetData<PakAsset>())
     {
-        if (numIterations > 100)
+        TRACE_ZONE("CPakFile::LoadAndPatchAssetData");
+
+        while (!LoadAndPatchAssetData<PakAsset>())
         {
-            assert(0); // If this gets hit, patching has almost definitely failed.
-            return false;
-        }
+            if (numIterations > 100)
+            {
+                assert(0); // If this gets hit, patching has almost definitely failed.
+                return false;
+            }
 
-        numIterations++;
-    };
+            numIterations++;
+        };
+    }
+
+    // pointers in pages that were patched, the pages are all in their final place now
+    ResolvePagePointers(this->numPointersInProcessedPages, false);
 
     this->patchDataBuffer.reset();
+    std::vector<PatchOp_t>().swap(this->patchOps);
 
     m_pAssetsInternal = new PakAsset_t[assetCount()];
+    m_rejectedAssets.assign(assetCount(), false);
 
     for (int i = 0; i < assetCount(); ++i)
     {
         PakAsset* const pAsset = reinterpret_cast<PakAsset*>(this->sortedAssetPointers[i]);
 
-        // check if headPagePtr is potentially valid (this should always be true)
-        if (pAsset->headPagePtr.index != UINT32_MAX && pAsset->headPagePtr.offset != UINT32_MAX)
-            pAsset->headPagePtr.ptr = pageBuffers[pAsset->headPagePtr.index] + pAsset->headPagePtr.offset;
-        else
-            pAsset->headPagePtr.ptr = nullptr;
-
-        // check if dataPagePtr is potentially valid
-        if (pAsset->dataPagePtr.index != UINT32_MAX && pAsset->dataPagePtr.offset != UINT32_MAX)
-            pAsset->dataPagePtr.ptr = pageBuffers[pAsset->dataPagePtr.index] + pAsset->dataPagePtr.offset;
-        else
-            pAsset->dataPagePtr.ptr = nullptr;
+        if (!ResolveAssetPagePointers(&pAsset->headPagePtr, &pAsset->dataPagePtr, pAsset->headerStructSize))
+            m_rejectedAssets[i] = true;
 
         m_pAssetsInternal[i] = PakAsset_t(pAsset);
     }
 
+    ValidateAssetReferences();
+
     // Copy over the non-paged data from the combined buffer and then discard it, since all paged data will have been patched
     // into segment collection buffers by this point.
-    std::shared_ptr<char[]> finalHeaderDataBuffer = std::make_unique<char[]>(header()->GetNonPagedDataSize());
+    std::shared_ptr<char[]> finalHeaderDataBuffer = MemoryTracker::AllocSharedBuffer(eMemoryCategory::MEM_PAK_BUFFER, header()->GetNonPagedDataSize(), true);
     memcpy(finalHeaderDataBuffer.get(), m_Buf.get(), header()->GetNonPagedDataSize());
     m_Buf = finalHeaderDataBuffer;
 
@@ -494,26 +522,300 @@ const bool CPakFile::LoadAndPatchPakFileData()
         }
     }
 
-    ProcessAssets();
     return true;
 }
 #endif // #if defined(PAKLOAD_PATCHING_V8)  || defined(PAKLOAD_PATCHING_V7)
 
-const bool CPakFile::ParseFromFile(const std::string& filePath, std::shared_ptr<char[]>& buf)
+const bool CPakFile::ParseFromFile(const std::string& filePath, std::shared_ptr<char[]>& buf, size_t& bufSize)
 {
+    TRACE_ZONE("CPakFile::ParseFromFile");
+
 #if (PAKLOAD_DEBUG == PAKLOAD_DEBUG_LOG)
     Log("LOAD: parsing pak file from path: ('%s')\n", filePath.c_str());
 #endif // #if (PAKLOAD_DEBUG >= PAKLOAD_DEBUG_LOG)
 
-    if (!FileSystem::ReadFileData(filePath, &buf))
+    {
+        TRACE_ZONE("FileSystem::ReadFileData");
+
+        if (!FileSystem::ReadFileData(filePath, &buf, &bufSize))
+            return false;
+    }
+
+    if (!DecompressFileBuffer(buf.get(), bufSize, &buf, &bufSize))
+        return false;
+
+    return true;
+}
+
+const bool CPakFile::ValidateHeaderData(const size_t bufSize)
+{
+    const PakHdr_t* const hdr = header();
+
+    if (hdr->numSegments > PAK_MAX_SEGMENTS || hdr->patchCount < 0 || hdr->streamingFilesBufSize < 0 || hdr->optStreamingFilesBufSize < 0 || hdr->numPointers < 0
+        || hdr->numAssets < 0 || hdr->numGuidRefs < 0 || hdr->numDependencies < 0 || hdr->numExternalAssetRefs < 0 || hdr->externalAssetRefsSize < 0)
+    {
+        g_assetData.Log_Error(this, "Pak header has invalid table sizes");
+        return false;
+    }
+
+    // the patch data header has to be read to get the size of everything after it
+    if (hdr->patchCount > 0 && hdr->pakHdrSize + sizeof(PakPatchDataHdr_t) > bufSize)
+    {
+        g_assetData.Log_Error(this, "Pak is truncated, its patch header ends past the end of the file (%zu bytes)", bufSize);
         return false;
+    }
 
-    if (!DecompressFileBuffer(buf.get(), &buf))
+    const size_t headerDataSize = hdr->GetNonPagedDataSize() + hdr->GetPatchDataSize();
+
+    if (headerDataSize > bufSize)
+    {
+        g_assetData.Log_Error(this, "Pak is truncated, its headers need %zu bytes but the file only has %zu bytes", headerDataSize, bufSize);
         return false;
+    }
+
+    for (int i = 0; i < hdr->numPages; ++i)
+    {
+        const PakPageHdr_t* const page = &hdr->GetPageHeaders()[i];
+
+        if (page->segment < 0 || page->segment >= hdr->numSegments)
+        {
+            g_assetData.Log_Error(this, "Page %i is in segment %i, but the pak only has %i segments", i, page->segment, hdr->numSegments);
+            return false;
+        }
+    }
 
     return true;
 }
 
+void CPakFile::BucketPointersByPage()
+{
+    const uint32_t numPages = static_cast<uint32_t>(pageCount());
+    const int numPointers = pointerCount();
+
+    m_pagePointerStarts.assign(numPages + 1u, 0u);
+
+    for (int i = 0; i < numPointers; ++i)
+    {
+        const uint32_t page = static_cast<uint32_t>(m_pPointerHeaders[i].index);
+
+        if (page < numPages)
+            m_pagePointerStarts[page + 1u]++;
+    }
+
+    for (uint32_t i = 0u; i < numPages; ++i)
+        m_pagePointerStarts[i + 1u] += m_pagePointerStarts[i];
+
+    m_pagePointers.resize(m_pagePointerStarts[numPages]);
+
+    // counting sort keeps the pointers in each page in the order they are in the pointer headers
+    std::vector<uint32_t> nextPointer(m_pagePointerStarts.begin(), m_pagePointerStarts.end() - 1);
+
+    for (int i = 0; i < numPointers; ++i)
+    {
+        const uint32_t page = static_cast<uint32_t>(m_pPointerHeaders[i].index);
+
+        if (page < numPages)
+            m_pagePointers[nextPointer[page]++] = static_cast<uint32_t>(i);
+    }
+}
+
+// converts the first numPointers pointers from index-offset pairs into native pointers, one page at a time.
+// rebaseTargetPages is for paks that were loaded without their patches, their page indices count from the first page they contain
+void CPakFile::ResolvePagePointers(const int numPointers, const bool rebaseTargetPages)
+{
+    TRACE_ZONE("CPakFile::ResolvePagePointers");
+
+    BucketPointersByPage();
+
+    std::mutex invalidPointerMutex;
+
+    auto resolvePage = [this, numPointers, rebaseTargetPages, &invalidPointerMutex](const uint32_t page)
+    {
+        char* const pageBuffer = pageBuffers[page];
+
+        if (!pageBuffer)
+            return;
+
+        for (uint32_t i = m_pagePointerStarts[page]; i < m_pagePointerStarts[page + 1u]; ++i)
+        {
+            const uint32_t pointerIdx = m_pagePointers[i];
+
+            // pointers stay in order within their page
+            if (pointerIdx >= static_cast<uint32_t>(numPointers))
+                break;
+
+            const PakPointerHdr_t* const pHdr = &m_pPointerHeaders[pointerIdx];
+
+            // bounds are only checked here, resolved pointers are followed without any checks
+            if (!IsValidPageRange(pHdr->index, pHdr->offset, sizeof(PagePtr_t)))
+                continue;
+
+            PagePtr_t* const pPtr = reinterpret_cast<PagePtr_t*>(pageBuffer + pHdr->offset);
+
+            int targetPage = pPtr->index;
+
+            if (rebaseTargetPages)
+            {
+                targetPage -= firstPageIdx;
+
+                if (targetPage < 0)
+                    targetPage += pageCount();
+            }
+            else if (!pPtr->ptr)
+                continue;
+
+            if (!IsValidPageRange(targetPage, pPtr->offset, 0ull))
+            {
+                std::lock_guard<std::mutex> lock(invalidPointerMutex);
+
+                m_invalidPointers.push_back(reinterpret_cast<const char*>(pPtr));
+                pPtr->ptr = nullptr;
+
+                continue;
+            }
+
+            pPtr->ptr = pageBuffers[targetPage] + pPtr->offset;
+        }
+    };
+
+    const uint32_t numPages = static_cast<uint32_t>(std::min(pageBuffers.size(), m_pagePointerStarts.size() - 1ull));
+
+    // the pak is already being loaded next to other paks, so only use this pak's share of the parse threads
+    const uint32_t numThreads = std::min(std::max(static_cast<uint32_t>(PARSE_THREAD_COUNT) / std::max(static_cast<uint32_t>(PAK_LOAD_THREAD_COUNT), 1u), 1u), numPages);
+
+    // small paks resolve faster than the threads would take to start
+    if (numThreads <= 1u || numPointers < 0x10000)
+    {
+        for (uint32_t page = 0u; page < numPages; ++page)
+            resolvePage(page);
+
+        return;
+    }
+
+    std::atomic<uint32_t> pageIdx = 0u;
+
+    CParallelTask parallelResolveTask(numThreads);
+    parallelResolveTask.addTask([&resolvePage, &pageIdx, numPages]
+    {
+        for (uint32_t page = pageIdx++; page < numPages; page = pageIdx++)
+            resolvePage(page);
+    }, numThreads);
+
+    parallelResolveTask.execute();
+    parallelResolveTask.wait();
+}
+
+const bool CPakFile::ResolveAssetPagePointers(PagePtr_t* const headPagePtr, PagePtr_t* const dataPagePtr, const uint32_t headerStructSize)
+{
+    bool valid = true;
+
+    // check if headPagePtr is potentially valid (this should always be true)
+    if (headPagePtr->index != UINT32_MAX && headPagePtr->offset != UINT32_MAX)
+    {
+        if (IsValidPageRange(headPagePtr->index, headPagePtr->offset, headerStructSize))
+        {
+            headPagePtr->ptr = pageBuffers[headPagePtr->index] + headPagePtr->offset;
+        }
+        else
+        {
+            headPagePtr->ptr = nullptr;
+            valid = false;
+        }
+    }
+    else
+        headPagePtr->ptr = nullptr;
+
+    // check if dataPagePtr is potentially valid
+    if (dataPagePtr->index != UINT32_MAX && dataPagePtr->offset != UINT32_MAX)
+    {
+        if (IsValidPageRange(dataPagePtr->index, dataPagePtr->offset, 0ull))
+        {
+            dataPagePtr->ptr = pageBuffers[dataPagePtr->index] + dataPagePtr->offset;
+        }
+        else
+        {
+            dataPagePtr->ptr = nullptr;
+            valid = false;
+        }
+    }
+    else
+        dataPagePtr->ptr = nullptr;
+
+    return valid;
+}
+
+// rejects assets that point outside of the loaded pages, so a truncated or corrupted pak loses those assets
+// instead of crashing the asset loaders when they follow the pointers
+void CPakFile::ValidateAssetReferences()
+{
+    std::sort(m_invalidPointers.begin(), m_invalidPointers.end());
+
+    if (!m_invalidPointers.empty())
+        g_assetData.Log_Warning(this, "%lld pointers pointed outside of the pak's pages and have been cleared", m_invalidPointers.size());
+
+    for (int i = 0; i < assetCount(); ++i)
+    {
+        const PakAsset_t* const asset = &m_pAssetsInternal[i];
+        const char* error = nullptr;
+
+        if (m_rejectedAssets[i])
+        {
+            error = "its header or data is outside of the pak's pages";
+        }
+        else if (asset->headPagePtr.ptr && !m_invalidPointers.empty())
+        {
+            const auto it = std::lower_bound(m_invalidPointers.begin(), m_invalidPointers.end(), asset->headPagePtr.ptr);
+
+            if (it != m_invalidPointers.end() && *it < asset->headPagePtr.ptr + asset->headerStructSize)
+                error = "its header has a pointer that pointed outside of the pak's pages";
+        }
+
+        if (!error && asset->dependenciesCount > 0)
+        {
+            if (static_cast<size_t>(asset->dependenciesIndex) + asset->dependenciesCount > static_cast<size_t>(header()->numGuidRefs))
+            {
+                error = "its guid references are outside of the pak's guid reference table";
+            }
+            else
+            {
+                for (uint32_t ref = asset->dependenciesIndex; ref < asset->dependenciesIndex + asset->dependenciesCount; ++ref)
+                {
+                    if (!IsValidPageRange(m_pGuidRefHeaders[ref].index, m_pGuidRefHeaders[ref].offset, sizeof(AssetGuid_t)))
+                    {
+                        error = "one of its guid references is outside of the pak's pages";
+                        break;
+                    }
+                }
+            }
+        }
+
+        if (!error && asset->dependentsCount > 0)
+        {
+            if (static_cast<size_t>(asset->dependentsIndex) + asset->dependentsCount > static_cast<size_t>(header()->numDependencies))
+            {
+                error = "its dependents are outside of the pak's dependents table";
+            }
+            else
+            {
+                for (uint32_t dep = asset->dependentsIndex; dep < asset->dependentsIndex + asset->dependentsCount; ++dep)
+                {
+                    if (m_pDependentAssets[dep] < 0 || m_pDependentAssets[dep] >= assetCount())
+                    {
+                        error = "one of its dependents is not an asset in the pak";
+                        break;
+                    }
+                }
+            }
+        }
+
+        if (!error)
+            continue;
+
+        m_rejectedAssets[i] = true;
+        g_assetData.Log_Asset(eLogSeverity::LOG_SEV_ERROR, this, asset->guid, 0u, "Asset 0x%llX (%s) was not loaded because %s", asset->guid, fourCCToString(asset->type).c_str(), error);
+    }
+}
+
 const bool CPakFile::ParseStreamedFile(const std::string& fileName, bool opt)
 {
     // The end of the starpak path buffers is padded with null bytes to get back to (8 byte?) alignment
@@ -565,26 +867,53 @@ const bool CPakFile::ParseStreamedFile(const std::string& fileName, bool opt)
     return true;
 }
 
-const bool CPakFile::DecompressFileBuffer(const char* fileBuffer, std::shared_ptr<char[]>* outBuffer)
+const bool CPakFile::DecompressFileBuffer(const char* fileBuffer, const size_t fileSize, std::shared_ptr<char[]>* outBuffer, size_t* const outBufferSize)
 {
+    TRACE_ZONE("CPakFile::DecompressFileBuffer");
+
+    // magic and version
+    if (fileSize < sizeof(int) + sizeof(short))
+    {
+        g_assetData.Log_Error(this, "Pak file is too small to be a pak (%zu bytes)", fileSize);
+        return false;
+    }
+
     const short version = reinterpret_cast<const short*>(fileBuffer)[2];
 
     const PakHdr_t* header = nullptr;
+    size_t headerSize = 0ull;
 
     switch (version)
     {
     case 6: // no compression on 6
+    {
+        if (fileSize < sizeof(PakHdr_v6_t))
+        {
+            g_assetData.Log_Error(this, "Pak is truncated, the file is smaller than its header (%zu bytes)", fileSize);
+            return false;
+        }
+
+        *outBufferSize = fileSize;
         return true;
+    }
     case 7:
-        header = new PakHdr_t(reinterpret_cast<const PakHdr_v7_t*>(fileBuffer));
+        headerSize = sizeof(PakHdr_v7_t);
         break;
     case 8:
-        header = new PakHdr_t(reinterpret_cast<const PakHdr_v8_t*>(fileBuffer));
+        headerSize = sizeof(PakHdr_v8_t);
         break;
     default:
         return false;
     }
 
+    if (fileSize < headerSize)
+    {
+        g_assetData.Log_Error(this, "Pak is truncated, the file is smaller than its header (%zu bytes)", fileSize);
+        return false;
+    }
+
+    header = version == 7 ? new PakHdr_t(reinterpret_cast<const PakHdr_v7_t*>(fileBuffer)) : new PakHdr_t(reinterpret_cast<const PakHdr_v8_t*>(fileBuffer));
+
     if (header->magic != pakFileMagic)
     {
         g_assetData.Log_Error(this, "Invalid pak magic (expected %08X, got %08X)", pakFileMagic, header->magic);
@@ -592,15 +921,44 @@ const bool CPakFile::DecompressFileBuffer(const char* fileBuffer, std::shared_pt
         return false;
     }
 
+    // partially downloaded paks end up here, everything after this trusts the sizes in the header
+    if (header->dcmpSize < static_cast<__int64>(header->pakHdrSize) || header->cmpSize < 0)
+    {
+        g_assetData.Log_Error(this, "Pak header has invalid sizes (compressed %lld, decompressed %lld)", header->cmpSize, header->dcmpSize);
+        delete header;
+        return false;
+    }
+
     if ((header->flags & PAK_HEADER_FLAGS_COMPRESSED) == 0)
     {
+        if (static_cast<size_t>(header->dcmpSize) > fileSize)
+        {
+            g_assetData.Log_Error(this, "Pak is truncated, expected %lld bytes but the file only has %zu bytes", header->dcmpSize, fileSize);
+            delete header;
+            return false;
+        }
+
+        *outBufferSize = static_cast<size_t>(header->dcmpSize);
+
         delete header;
         return true;
     }
 
+    if (static_cast<size_t>(header->cmpSize) > fileSize)
+    {
+        g_assetData.Log_Error(this, "Pak is truncated, expected %lld bytes but the file only has %zu bytes", header->cmpSize, fileSize);
+        delete header;
+        return false;
+    }
+
+    // compressed data after the header, never more than the file actually has
+    const size_t availableDataSize = std::min(static_cast<size_t>(header->cmpSize), fileSize - header->pakHdrSize);
+
+    *outBufferSize = static_cast<size_t>(header->dcmpSize);
+
     if (header->flags & PAK_HEADER_FLAGS_RTECH_ENCODED) // standard pakfile compression
     {
-        std::shared_ptr<char[]> dcmpBuf = std::shared_ptr<char[]>(new char[header->dcmpSize] {});
+        std::shared_ptr<char[]> dcmpBuf = MemoryTracker::AllocSharedBuffer(eMemoryCategory::MEM_PAK_BUFFER, header->dcmpSize, true);
 
         RTech::PakDecompressContext_t context = {};
         uint64_t decodeSize = RTech::InitPakDecoder(&context, reinterpret_cast<const uint8_t*>(fileBuffer), PAK_DECODE_MASK, header->cmpSize, 0, header->pakHdrSize);
@@ -631,9 +989,9 @@ const bool CPakFile::DecompressFileBuffer(const char* fileBuffer, std::shared_pt
     else if (header->flags & PAK_HEADER_FLAGS_OODLE_ENCODED)
     {
         // [rika]: dcmpSize is decompressed pak's size (header & oodle compression), this buffer is for the decompresed pakfile.
-        std::shared_ptr<char[]> dcmpBuf = std::shared_ptr<char[]>(new char[header->dcmpSize] {});
+        std::shared_ptr<char[]> dcmpBuf = MemoryTracker::AllocSharedBuffer(eMemoryCategory::MEM_PAK_BUFFER, header->dcmpSize, true);
 
-        const size_t compressedDataSize = header->cmpSize; // [rika]: cmpSize is the size of all compresed data in the pakfile (does not include header).
+        const size_t compressedDataSize = availableDataSize; // [rika]: cmpSize is the size of all compresed data in the pakfile (does not include header).
 
         // allocate a buffer for just the compressed file data
         // since the oodle decomp util func needs just the compressed data
@@ -649,9 +1007,9 @@ const bool CPakFile::DecompressFileBuffer(const char* fileBuffer, std::shared_pt
 
         std::unique_ptr<char[]> data = RTech::DecompressStreamedBuffer(std::move(cmpBuf), decodeSize, eCompressionType::OODLE);
 
-        const uint64_t dcmpBufQWord = *reinterpret_cast<uint64_t*>(data.get());
+        const uint64_t dcmpBufQWord = data ? *reinterpret_cast<uint64_t*>(data.get()) : 0ull;
 
-        if (decodeSize == 0 || data.get() == nullptr || cmpBufQWord == dcmpBufQWord)
+        if (decodeSize == 0 || decodeSize > static_cast<uint64_t>(header->dcmpSize) - header->pakHdrSize || data.get() == nullptr || cmpBufQWord == dcmpBufQWord)
         {
             delete header;
             return false;
@@ -677,13 +1035,13 @@ const bool CPakFile::DecompressFileBuffer(const char* fileBuffer, std::shared_pt
     else if (header->flags & PAK_HEADER_FLAGS_ZSTD_ENCODED)
     {
         // ZSTD compression support
-        std::shared_ptr<char[]> dcmpBuf = std::shared_ptr<char[]>(new char[header->dcmpSize] {});
+        std::shared_ptr<char[]> dcmpBuf = MemoryTracker::AllocSharedBuffer(eMemoryCategory::MEM_PAK_BUFFER, header->dcmpSize, true);
 
         const char* compressedData = fileBuffer + header->pakHdrSize;
 
         // ZSTD frames have their own size in the header, use FindFrameCompressedSize to get it
-        const size_t frameCompressedSize = RTechZstd::FindFrameCompressedSize(compressedData, static_cast<size_t>(header->cmpSize));
-        if (frameCompressedSize == 0 || frameCompressedSize > static_cast<size_t>(header->cmpSize))
+        const size_t frameCompressedSize = RTechZstd::FindFrameCompressedSize(compressedData, availableDataSize);
+        if (frameCompressedSize == 0 || frameCompressedSize > availableDataSize)
         {
             g_assetData.Log_Error(this, "Failed to find ZSTD frame size (found: %zu, cmpSize: %lld)", frameCompressedSize, header->cmpSize);
             delete header;
@@ -820,9 +1178,11 @@ bool CPakFile::AllocateSegments()
         // to align themselves within this alignment.
         // Since all alignments must be a power of 2, data with smaller alignments will always be aligned when the alignment is greater.
         collection->buffer = reinterpret_cast<char*>(_aligned_malloc(collection->dataSize, collection->dataAlignment));
+        g_MemoryTracker.Alloc(eMemoryCategory::MEM_PAK_SEGMENTS, 0u, collection->dataSize);
     }
 
     this->pageBuffers.resize(this->pageCount());
+    this->pageSizes.resize(this->pageCount());
 
     for (int pageIdx = 0; pageIdx < this->pageCount(); ++pageIdx)
     {
@@ -844,10 +1204,14 @@ bool CPakFile::AllocateSegments()
 #endif
 
             this->pageBuffers[pageIdx] = this->segmentCollections[segment->GetType()].buffer + pageOffsetAligned;
-
+            this->pageSizes[pageIdx] = page->size;
         }
         else
+        {
+            // header pages are rebuilt into one collection, pointers into them are relative to its start
             this->pageBuffers[pageIdx] = this->segmentCollections[SegmentCollection_t::eType::SCT_HEAD].buffer;
+            this->pageSizes[pageIdx] = this->segmentCollections[SegmentCollection_t::eType::SCT_HEAD].dataSize;
+        }
 
         segmentNextPageOffsets[page->segment] = pageOffsetAligned + page->size;
     }
@@ -874,47 +1238,148 @@ bool CPakFile::AllocateSegments()
     return true;
 }
 
-const bool CPakFile::DecodePatchCommands()
+// reads the next command and its operand from the patch stream
+void CPakFile::DecodePatchOp(PatchOp_t& op)
+{
+    RBitRead* const bitbuf = &p.bitbuf;
+
+    bitbuf->ConsumeData(patchStreamCursor, bitbuf->BitsAvailable());
+
+    // advance patch data buffer by the number of bytes that have just been fetched
+    this->patchStreamCursor = &patchStreamCursor[bitbuf->BitsAvailable() >> 3];
+
+    // store the number of bits remaining to complete the data read
+    bitbuf->m_bitsUnoccupied = bitbuf->BitsAvailable() & 7; // number of bits above a whole byte
+
+    op.cmd = p.commands[bitbuf->ReadBits(6)];
+
+    bitbuf->DiscardBits(p.unk[bitbuf->ReadBits(6)]);
+
+    if (op.cmd <= 3u)
+    {
+        const int index = static_cast<int>(bitbuf->ReadBits(8));
+        const uint8_t bitExponent = p.unk2[index]; // number of stored bits for the data size
+
+        bitbuf->DiscardBits(p.unk3[index]);
+
+        op.numBytes = (1ull << bitExponent) + bitbuf->ReadBits(bitExponent);
+
+        bitbuf->DiscardBits(bitExponent);
+    }
+    else
+    {
+        op.numBytes = s_patchCmdToBytesToProcess[op.cmd];
+    }
+}
+
+// decodes every command before patching starts so applying them doesn't have to touch the bit reader.
+// the commands end where the replacement data starts, ApplyPatchOps keeps decoding if it ever runs past that
+void CPakFile::DecodePatchOps()
+{
+    TRACE_ZONE("CPakFile::DecodePatchOps");
+
+    const char* const bufferStart = patchDataBuffer.get();
+    const int64_t streamEndBits = static_cast<int64_t>(p.patchReplacementData - bufferStart) * 8;
+    const char* const lastRead = bufferStart + header()->GetPatchDataHeader()->patchDataStreamSize - sizeof(uint64_t);
+
+    // roughly two bytes per command
+    this->patchOps.clear();
+    this->patchOps.reserve(static_cast<size_t>(streamEndBits >> 4));
+    this->numAppliedPatchOps = 0ull;
+
+    // bits read so far, the bit reader holds the 64 bits before the cursor minus the ones it has discarded
+    while ((static_cast<int64_t>(patchStreamCursor - bufferStart) * 8) - 64 + p.bitbuf.BitsAvailable() < streamEndBits && patchStreamCursor <= lastRead)
+    {
+        PatchOp_t& op = this->patchOps.emplace_back();
+        DecodePatchOp(op);
+    }
+}
+
+const bool CPakFile::ApplyPatchOps()
 {
     if (!this->p.patchFunc)
         p.patchFunc = g_pakPatchApi[CMD_0];
 
-    RBitRead* const bitbuf = &p.bitbuf;
+    const char* const fileBuffer = m_Buf.get();
+
     while (p.patchDestinationSize + p.numBytesToSkip)
     {
-        int8_t cmd = 0;
         if (p.numBytesToPatch == 0)
         {
-            bitbuf->ConsumeData(patchStreamCursor, bitbuf->BitsAvailable());
+            if (this->numAppliedPatchOps == this->patchOps.size())
+            {
+                if (!patchStreamCursor)
+                    break;
 
-            // advance patch data buffer by the number of bytes that have just been fetched
-            this->patchStreamCursor = &patchStreamCursor[bitbuf->BitsAvailable() >> 3];
+                DecodePatchOp(this->patchOps.emplace_back());
+            }
 
-            // store the number of bits remaining to complete the data read
-            bitbuf->m_bitsUnoccupied = bitbuf->BitsAvailable() & 7; // number of bits above a whole byte
+            const PatchOp_t& op = this->patchOps[this->numAppliedPatchOps++];
 
-            cmd = p.commands[bitbuf->ReadBits(6)];
+            // commands 4 and 5 replace one byte and then copy 3 or 7 original bytes, 6 replaces two and copies 6. these make up most of a delta
+            // stream, so when they fit in the destination they are done as one fixed size copy of the original bytes with the new ones on top
+            if (op.cmd >= CMD_4 && op.cmd <= CMD_6 && p.numBytesToSkip == 0)
+            {
+                const size_t numNewBytes = op.cmd == CMD_6 ? 2ull : 1ull;
+                const size_t numBytes = numNewBytes + op.numBytes;
 
-            bitbuf->DiscardBits(p.unk[bitbuf->ReadBits(6)]);
+                if (p.patchDestinationSize >= numBytes && p.numRemainingFileBufferBytes >= numBytes)
+                {
+                    if (numBytes == 8ull)
+                        memcpy(p.patchDestination, fileBuffer + p.offsetInFileBuffer, 8ull);
+                    else
+                        memcpy(p.patchDestination, fileBuffer + p.offsetInFileBuffer, 4ull);
+
+                    if (numNewBytes == 2ull)
+                        memcpy(p.patchDestination, p.patchReplacementData, 2ull);
+                    else
+                        *p.patchDestination = *p.patchReplacementData;
+
+                    p.patchReplacementData += numNewBytes;
+                    p.patchDestination += numBytes;
+                    p.patchDestinationSize -= numBytes;
+                    p.offsetInFileBuffer += numBytes;
+                    p.numRemainingFileBufferBytes -= numBytes;
+
+                    // same state the interpreter leaves behind
+                    p.patchFunc = g_pakPatchApi[CMD_0];
+
+                    continue;
+                }
+            }
 
-            // get the next patch function to execute
-            p.patchFunc = g_pakPatchApi[cmd];
+            p.patchFunc = g_pakPatchApi[op.cmd];
+            p.numBytesToPatch = op.numBytes;
+        }
 
-            if (cmd <= 3u)
-            {
-                const int index = static_cast<int>(bitbuf->ReadBits(8));
-                const uint8_t bitExponent = p.unk2[index]; // number of stored bits for the data size
+#if defined(ASSERTS)
+        const SegmentCollection_t* const collection = &segmentCollections[m_pSegmentHeaders[p.patchDestinationSegment].GetType()];
 
-                bitbuf->DiscardBits(p.unk3[index]);
+        assertm(p.patchDestination + p.patchDestinationSize <= collection->buffer + collection->dataSize, "Patch operation attempted to write beyond the end of the segment collection buffer");
+#endif
+        if (!p.patchFunc(this, &p.numRemainingFileBufferBytes))
+            break;
+    }
 
-                p.numBytesToPatch = (1ull << bitExponent) + bitbuf->ReadBits(bitExponent);
+    return p.patchDestinationSize == 0;
+}
 
-                bitbuf->DiscardBits(bitExponent);
-            }
-            else
-            {
-                p.numBytesToPatch = s_patchCmdToBytesToProcess[cmd];
-            }
+// the original patch interpreter, decodes each command as it gets to it
+const bool CPakFile::DecodePatchCommands()
+{
+    if (!this->p.patchFunc)
+        p.patchFunc = g_pakPatchApi[CMD_0];
+
+    while (p.patchDestinationSize + p.numBytesToSkip)
+    {
+        if (p.numBytesToPatch == 0)
+        {
+            PatchOp_t op;
+            DecodePatchOp(op);
+
+            // get the next patch function to execute
+            p.patchFunc = g_pakPatchApi[op.cmd];
+            p.numBytesToPatch = op.numBytes;
         }
 
 #if (PAKLOAD_DEBUG == PAKLOAD_DEBUG_VERBOSE)
@@ -979,7 +1444,9 @@ void CPakFile::CalculateLoadedAssetTypeInfo()
 #endif // #ifdef ASSERTS
 
         assetType->assetCount++;
-        assetType->headerSize = headerStructSize;
+
+        // take the largest so a corrupted header size can't make patching write past this type's part of the header collection
+        assetType->headerSize = std::max(assetType->headerSize, headerStructSize);
 
         assetType->version = version;
     }
@@ -990,53 +1457,257 @@ void CPakFile::SortAssetsByHeaderPointer()
 {
     assertm(this->sortedAssetPointers.empty(), "already sorted asset pointers.");
 
-    this->sortedAssetPointers.resize(this->assetCount());
-    std::vector<PakAsset*> tempAssetPointers(this->assetCount());
+    const int numAssets = this->assetCount();
 
-    auto sortAssetFunc = [this](PakAsset* const a, PakAsset* const b)
-    {
-#define SWAP_DWORDS(num) ((num >> 32) | ((num & 0xFFFFFFFF) << 32))
-        return SWAP_DWORDS(reinterpret_cast<size_t>(a->headPagePtr.ptr)) < SWAP_DWORDS(reinterpret_cast<size_t>(b->headPagePtr.ptr));
-#undef SWAP_DWORDS
-    };
+    // headers are ordered by page index then offset, as one key so they can be radix sorted
+    std::vector<uint64_t> keys(numAssets);
+    std::vector<uint32_t> order(numAssets);
 
     int numAssetsInNewPages = 0;
-    for (int i = 0; i < this->assetCount(); ++i)
+    for (int i = 0; i < numAssets; ++i)
     {
-        PakAsset* const asset = reinterpret_cast<PakAsset*>(this->rawAsset(i));
-        this->sortedAssetPointers.at(i) = asset;
+        const PakAsset* const asset = reinterpret_cast<const PakAsset*>(this->rawAsset(i));
+
+        keys[i] = (static_cast<uint64_t>(static_cast<uint32_t>(asset->headPagePtr.index)) << 32) | static_cast<uint32_t>(asset->headPagePtr.offset);
+        order[i] = static_cast<uint32_t>(i);
 
         if (this->firstPageIdx != 0 && asset->headPagePtr.index >= this->firstPageIdx)
             numAssetsInNewPages++;
     }
 
-    // sort once to group all assets that use new pages together
-    std::sort(reinterpret_cast<std::vector<PakAsset*>*>(&this->sortedAssetPointers)->begin(), reinterpret_cast<std::vector<PakAsset*>*>(&this->sortedAssetPointers)->end(), sortAssetFunc);
+    RadixSortByKey64(keys, order);
 
-    const int numOldAssets = this->assetCount() - numAssetsInNewPages;
+    const int numOldAssets = numAssets - numAssetsInNewPages;
 
-    // copy all of the assets in new pages to the front of the vector
-    memcpy(
-        tempAssetPointers.data(),
-        this->sortedAssetPointers.data() + numOldAssets,
-        sizeof(PakAsset*) * numAssetsInNewPages
-    );
+    // assets in new pages go at the front, followed by the assets in old pages
+    this->sortedAssetPointers.resize(numAssets);
 
-    // copy all of the assets in old pages to the back of the vector
-    memcpy(
-        tempAssetPointers.data() + numAssetsInNewPages,
-        this->sortedAssetPointers.data(),
-        sizeof(PakAsset*) * numOldAssets
-    );
+    for (int i = 0; i < numAssetsInNewPages; ++i)
+        this->sortedAssetPointers[i] = this->rawAsset(order[numOldAssets + i]);
 
-    memcpy(
-        this->sortedAssetPointers.data(),
-        tempAssetPointers.data(),
-        sizeof(void*) * assetCount()
-    );
+    for (int i = 0; i < numOldAssets; ++i)
+        this->sortedAssetPointers[numAssetsInNewPages + i] = this->rawAsset(order[i]);
 }
 #endif // #if defined(PAKLOAD_PATCHING_ANY)
 
+void RunPakFixupBenchmark()
+{
+    size_t numPaks = 0ull;
+    size_t numPointers = 0ull;
+    double sortMs = 0.0;
+    double radixMs = 0.0;
+    double bucketMs = 0.0;
+    uint32_t numMismatched = 0u;
+
+    for (CAssetContainer* const container : g_assetData.v_assetContainers)
+    {
+        if (container->GetContainerType() != CAsset::ContainerType::PAK)
+            continue;
+
+        CPakFile* const pak = static_cast<CPakFile*>(container);
+        const int pointerCount = pak->pointerCount();
+
+        if (!pak->GetPointerHeaders() || pointerCount <= 0)
+            continue;
+
+        std::vector<uint64_t> keys(pointerCount);
+        std::vector<uint32_t> order(pointerCount);
+
+        for (int i = 0; i < pointerCount; ++i)
+        {
+            const PakPointerHdr_t& hdr = pak->GetPointerHeaders()[i];
+
+            keys[i] = (static_cast<uint64_t>(static_cast<uint32_t>(hdr.index)) << 32) | static_cast<uint32_t>(hdr.offset);
+            order[i] = static_cast<uint32_t>(i);
+        }
+
+        // comparison sort on the same keys, ties broken by index so both sorts have one valid answer
+        std::vector<std::pair<uint64_t, uint32_t>> pairs(pointerCount);
+        for (int i = 0; i < pointerCount; ++i)
+            pairs[i] = { keys[i], order[i] };
+
+        auto startTime = std::chrono::high_resolution_clock::now();
+        std::sort(pairs.begin(), pairs.end());
+        sortMs += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
+
+        startTime = std::chrono::high_resolution_clock::now();
+        RadixSortByKey64(keys, order);
+        radixMs += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
+
+        for (int i = 0; i < pointerCount; ++i)
+        {
+            if (pairs[i].first != keys[i] || pairs[i].second != order[i])
+            {
+                numMismatched++;
+                break;
+            }
+        }
+
+        // rebuilds the same buckets the pak already has
+        startTime = std::chrono::high_resolution_clock::now();
+        pak->BucketPointersByPage();
+        bucketMs += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
+
+        numPaks++;
+        numPointers += static_cast<size_t>(pointerCount);
+    }
+
+    if (!numPaks)
+        return;
+
+    printf("PAK FIXUP BENCHMARK: %llu paks, %llu pointers, std::sort %.2f ms, radix sort %.2f ms, page buckets %.2f ms, %u mismatched\n", numPaks, numPointers, sortMs, radixMs, bucketMs, numMismatched);
+}
+
+#if defined(PAKLOAD_PATCHING_ANY)
+// finds the segment collection a resolved pointer points into, pointers can't be compared directly between two loads of a pak
+static bool PakPatchVerify_LocatePointer(const SegmentCollection_t* const collections, const char* const ptr, int& collectionIdx, size_t& offset)
+{
+    for (int i = 0; i < PAK_MAX_SEGMENT_COLLECTIONS; ++i)
+    {
+        const char* const buffer = collections[i].buffer;
+
+        if (buffer && ptr >= buffer && ptr <= buffer + collections[i].dataSize)
+        {
+            collectionIdx = i;
+            offset = static_cast<size_t>(ptr - buffer);
+
+            return true;
+        }
+    }
+
+    return false;
+}
+#endif // #if defined(PAKLOAD_PATCHING_ANY)
+
+void RunPakPatchVerify()
+{
+#if defined(PAKLOAD_PATCHING_ANY)
+    std::vector<std::string> paths;
+
+    for (CAssetContainer* const container : g_assetData.v_assetContainers)
+    {
+        if (container->GetContainerType() != CAsset::ContainerType::PAK)
+            continue;
+
+        const CPakFile* const pak = static_cast<const CPakFile*>(container);
+
+        if (pak->header()->version >= 7 && pak->patchCount() > 0)
+            paths.push_back(pak->GetFilePath().string());
+    }
+
+    if (paths.empty())
+        return;
+
+    // compares the patched segment data of two loads of the same pak, with resolved pointers compared by where they point
+    auto comparePaks = [](const CPakFile* const a, const CPakFile* const b) -> bool
+    {
+        if (a->numPointersInProcessedPages != b->numPointersInProcessedPages || a->m_invalidPointers.size() != b->m_invalidPointers.size())
+            return false;
+
+        if (memcmp(a->m_pPointerHeaders, b->m_pPointerHeaders, sizeof(PakPointerHdr_t) * a->pointerCount()) != 0)
+            return false;
+
+        std::vector<size_t> pointerSlots[PAK_MAX_SEGMENT_COLLECTIONS];
+
+        for (int i = 0; i < a->numPointersInProcessedPages; ++i)
+        {
+            const PakPointerHdr_t& hdr = a->m_pPointerHeaders[i];
+
+            // never resolved, these are compared like the rest of the data
+            if (!a->IsValidPageRange(hdr.index, hdr.offset, sizeof(PagePtr_t)))
+                continue;
+
+            const char* const slotA = a->pageBuffers[hdr.index] + hdr.offset;
+            const char* const slotB = b->pageBuffers[hdr.index] + hdr.offset;
+
+            int collectionIdx = -1;
+            size_t slotOffset = 0ull;
+            if (!PakPatchVerify_LocatePointer(a->segmentCollections, slotA, collectionIdx, slotOffset))
+                continue;
+
+            pointerSlots[collectionIdx].push_back(slotOffset);
+
+            const char* const ptrA = *reinterpret_cast<const char* const*>(slotA);
+            const char* const ptrB = *reinterpret_cast<const char* const*>(slotB);
+
+            int targetA = -1, targetB = -1;
+            size_t targetOffsetA = 0ull, targetOffsetB = 0ull;
+
+            const bool foundA = ptrA && PakPatchVerify_LocatePointer(a->segmentCollections, ptrA, targetA, targetOffsetA);
+            const bool foundB = ptrB && PakPatchVerify_LocatePointer(b->segmentCollections, ptrB, targetB, targetOffsetB);
+
+            if (foundA != foundB || (!foundA && memcmp(slotA, slotB, sizeof(PagePtr_t)) != 0) || targetA != targetB || targetOffsetA != targetOffsetB)
+                return false;
+        }
+
+        for (int i = 0; i < PAK_MAX_SEGMENT_COLLECTIONS; ++i)
+        {
+            const SegmentCollection_t& collectionA = a->segmentCollections[i];
+            const SegmentCollection_t& collectionB = b->segmentCollections[i];
+
+            if (collectionA.dataSize != collectionB.dataSize || !collectionA.buffer != !collectionB.buffer)
+                return false;
+
+            if (!collectionA.buffer)
+                continue;
+
+            std::vector<size_t>& slots = pointerSlots[i];
+            std::sort(slots.begin(), slots.end());
+
+            // everything between the pointers has to match exactly
+            size_t offset = 0ull;
+            for (const size_t slot : slots)
+            {
+                if (slot > offset && memcmp(collectionA.buffer + offset, collectionB.buffer + offset, slot - offset) != 0)
+                    return false;
+
+                offset = std::max(offset, slot + sizeof(PagePtr_t));
+            }
+
+            if (collectionA.dataSize > offset && memcmp(collectionA.buffer + offset, collectionB.buffer + offset, collectionA.dataSize - offset) != 0)
+                return false;
+        }
+
+        return true;
+    };
+
+    size_t numMatched = 0ull;
+    double opsMs = 0.0;
+    double interpreterMs = 0.0;
+
+    for (const std::string& path : paths)
+    {
+        // one pak at a time, both copies of a big pak are already a lot of memory
+        std::unique_ptr<CPakFile> opsPak = std::make_unique<CPakFile>();
+        std::unique_ptr<CPakFile> interpreterPak = std::make_unique<CPakFile>();
+
+        opsPak->SetPatchVerifyMode(false);
+        interpreterPak->SetPatchVerifyMode(true);
+
+        auto startTime = std::chrono::high_resolution_clock::now();
+        const bool opsLoaded = opsPak->LoadFileBuffer(path);
+        opsMs += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
+
+        startTime = std::chrono::high_resolution_clock::now();
+        const bool interpreterLoaded = interpreterPak->LoadFileBuffer(path);
+        interpreterMs += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
+
+        if (!opsLoaded || !interpreterLoaded)
+        {
+            printf("PAK PATCH VERIFY: %s failed to load (ops %s, interpreter %s)\n", path.c_str(), opsLoaded ? "ok" : "failed", interpreterLoaded ? "ok" : "failed");
+            continue;
+        }
+
+        if (comparePaks(opsPak.get(), interpreterPak.get()))
+            numMatched++;
+        else
+            printf("PAK PATCH VERIFY: %s patched differently\n", path.c_str());
+    }
+
+    printf("PAK PATCH VERIFY: %llu of %llu patched paks identical, op list %.1f ms, interpreter %.1f ms (load and patch)\n", numMatched, paths.size(), opsMs, interpreterMs);
+#endif // #if defined(PAKLOAD_PATCHING_ANY)
+}
+
 static std::vector<uint32_t> postLoadOrder =
 {
     'rtxt', // Texture first.
@@ -1053,10 +1724,18 @@ static std::vector<uint32_t> postLoadOrder =
 
 };
 
+const size_t GetPakAssetPostLoadOrder(const uint32_t type)
+{
+    // types that aren't in the custom order go after everything that is
+    return static_cast<size_t>(std::distance(postLoadOrder.begin(), std::ranges::find(postLoadOrder, type)));
+}
+
 static std::unordered_map<AssetType_t, std::string> s_ParsedPrefixes(63);
 
 void CPakFile::HandleOwnPostLoad()
 {
+    TRACE_ZONE("CPakFile::HandleOwnPostLoad");
+
     struct TypeRange_t
     {
         uint32_t type;
@@ -1117,8 +1796,13 @@ void CPakFile::HandleOwnPostLoad()
                             continue;
 
                         CAsset* pakAsset = this->m_pAssetsProcessed[assetToProcess];
-                        // temp
-                        it->second.postLoadFunc(pakAsset->GetContainerFile<CAssetContainer>(), pakAsset);
+                        {
+                            TRACE_ZONE_TYPE("PostLoad", range.type);
+                            MEMORY_TYPE_SCOPE(range.type);
+
+                            // temp
+                            it->second.postLoadFunc(pakAsset->GetContainerFile<CAssetContainer>(), pakAsset);
+                        }
                         pakAsset->SetPostLoadStatus(true);
 
                         // External asset post-load callbacks
@@ -1167,6 +1851,9 @@ void CPakFile::HandleOwnPostLoad()
                     CAsset* const pakAsset = this->m_pAssetsProcessed[assetToProcess];
                     if (auto it = g_assetData.m_assetTypeBindings.find(pakAsset->GetAssetType()); it != g_assetData.m_assetTypeBindings.end() && it->second.postLoadFunc)
                     {
+                        TRACE_ZONE_TYPE("PostLoad", it->first);
+                        MEMORY_TYPE_SCOPE(it->first);
+
                         //it->second.postLoadFunc(pAssetLookup->m_asset->pak(), pAssetLookup->m_asset);
                         // temp
                         it->second.postLoadFunc(pakAsset->GetContainerFile<CAssetContainer>(), pakAsset);
@@ -1202,6 +1889,8 @@ void CPakFile::HandleOwnPostLoad()
 
 void CPakFile::ProcessAssets()
 {
+    TRACE_ZONE("CPakFile::ProcessAssets");
+
     // prepare the parallel task with max threads to be used.
     CParallelTask parallelLoadTask(PARSE_THREAD_COUNT);
     CParallelTask parallelProcessTask(PARSE_THREAD_COUNT);
@@ -1219,6 +1908,10 @@ void CPakFile::ProcessAssets()
             if (assetToProcess >= cpyAssetCount)
                 continue;
 
+            // assets that point outside of the pages were already reported when the pak was loaded
+            if (m_rejectedAssets[assetToProcess])
+                continue;
+
             // its okay to access m_pAssetsInternal here without a mutex, we won't currently be writing to it while this it processing.
             PakAsset_t* const pAsset = &m_pAssetsInternal[assetToProcess];
 
@@ -1236,7 +1929,11 @@ void CPakFile::ProcessAssets()
                 if (auto it = g_assetData.m_assetTypeBindings.find(pAsset->type); it != g_assetData.m_assetTypeBindings.end())
                 {
                     if (it->second.loadFunc)
+                    {
+                        TRACE_ZONE_TYPE("Load", pAsset->type);
+                        MEMORY_TYPE_SCOPE(pAsset->type);
                         it->second.loadFunc(this, asset);
+                    }
                 }
             }, 1u);
             
@@ -1273,24 +1970,7 @@ void CPakFile::ProcessAssets()
     // we pre-sort each pak for post load callbacks by certain priority order.
     std::sort(g_assetData.v_assets.begin(), g_assetData.v_assets.end(), [](const CGlobalAssetData::AssetLookup_t& a, const CGlobalAssetData::AssetLookup_t& b)
     {
-        const auto itA = std::find(postLoadOrder.begin(), postLoadOrder.end(), a.m_asset->GetAssetType());
-        const auto itB = std::find(postLoadOrder.begin(), postLoadOrder.end(), b.m_asset->GetAssetType());
-
-        // if both types are found in the custom order, compare their positions.
-        if (itA != postLoadOrder.end() && itB != postLoadOrder.end())
-        {
-            return std::distance(postLoadOrder.begin(), itA) < std::distance(postLoadOrder.begin(), itB);
-        }
-
-        // handle cases where types are not in the custom order.
-        if (itA == postLoadOrder.end())
-        {
-            return false; // 'a' is placed after 'b'.
-        }
-        else 
-        {
-            return true; // 'b' is placed after 'a'.
-        }
+        return GetPakAssetPostLoadOrder(a.m_asset->GetAssetType()) < GetPakAssetPostLoadOrder(b.m_asset->GetAssetType());
     });
 
     parallelLoadTask.wait();
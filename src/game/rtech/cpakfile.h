@@ -658,19 +658,42 @@ public:
 
     const CAsset::ContainerType GetContainerType() const { return CAsset::ContainerType::PAK; };
 
-    const bool ParseFileBuffer(const std::string& path);
-    const bool DecompressFileBuffer(const char* fileBuffer, std::shared_ptr<char[]>* outBuffer);
+    // loads, decompresses and patches the pak without registering its assets, paks can be loaded like this on several threads at once.
+    // ProcessAssets has to be called afterwards, from one thread at a time.
+    const bool LoadFileBuffer(const std::string& path);
+    const bool ParseFileBuffer(const std::string& path); // LoadFileBuffer followed by ProcessAssets
+    void ProcessAssets();
+
+    // crcs of the lower patch files that were combined into this pak
+    inline const std::vector<uint64_t>& GetPatchFileCrcs() const { return m_patchFileCrcs; };
+
+    // fileSize is the size of fileBuffer, outBufferSize is set to the size of the buffer the pak ends up in
+    const bool DecompressFileBuffer(const char* fileBuffer, const size_t fileSize, std::shared_ptr<char[]>* outBuffer, size_t* const outBufferSize);
+
+    friend void RunPakFixupBenchmark();
 
 #if defined(PAKLOAD_PATCHING_ANY)
 public:
     typedef bool(*PatchFunc_t)(CPakFile* const pak, size_t* const numRemainingFileBufferBytes);
 
+    // one decoded command from the patch stream
+    struct PatchOp_t
+    {
+        size_t numBytes;
+        int8_t cmd;
+    };
+
+    // for comparing the patch engines: segment buffers are zeroed so bytes that never get patched match, and useInterpreter picks the
+    // original command at a time interpreter over the decoded op list. paks loaded like this skip the loaded crc check and must never be registered
+    inline void SetPatchVerifyMode(const bool useInterpreter) { patchVerify = true; usePatchInterpreter = useInterpreter; };
+
     friend bool PatchCmd_0(CPakFile* const pak, size_t* const numRemainingFileBufferBytes);
     friend bool PatchCmd_1(CPakFile* const pak, size_t* const numRemainingFileBufferBytes);
     friend bool PatchCmd_2(CPakFile* const pak, size_t* const numRemainingFileBufferBytes);
     friend bool PatchCmd_3(CPakFile* const pak, size_t* const numRemainingFileBufferBytes);
     friend bool PatchCmd_4_5(CPakFile* const pak, size_t* const numRemainingFileBufferBytes);
     friend bool PatchCmd_6(CPakFile* const pak, size_t* const numRemainingFileBufferBytes);
+    friend void RunPakPatchVerify();
 #endif // #if defined(PAKLOAD_PATCHING_ANY)
 
 private:
@@ -686,6 +709,13 @@ private:
     // versions of this pak file to bring their data to the latest version.
     std::shared_ptr<char[]> patchDataBuffer;
 
+    // the whole command stream, decoded before patching starts
+    std::vector<PatchOp_t> patchOps;
+    size_t numAppliedPatchOps;
+
+    bool usePatchInterpreter;
+    bool patchVerify;
+
     // large buffers containing all segment/page data of each type (head, cpu, temp)
     SegmentCollection_t segmentCollections[4];
 #endif // #if defined(PAKLOAD_PATCHING_ANY)
@@ -731,8 +761,9 @@ protected:
     // Number of pages that have been patched into their respective segment collections.
     int numProcessedPages;
 
-    // Number of page pointers that have been converted from INDEX-OFFSET pairs into native pointers.
-    int numResolvedPointers;
+    // Number of page pointers in pages that have been patched. They are converted from INDEX-OFFSET pairs into native pointers
+    // once every page has been patched.
+    int numPointersInProcessedPages;
 
     // Number of page pointers that have been adjusted for the move from a dedicated page into their type's allocated
     // header data in the "HEADER" segment collection
@@ -755,7 +786,7 @@ protected:
 
     void SetPatchCommand(const int8_t cmd);
 
-    const int ResolvePointers();
+    const int FindFirstPointerInUnprocessedPages();
     template<class PakAsset> const int FindNextAssetWithUnpatchedPages();
     template<class PakAsset> bool ProcessNextPage();
 
@@ -788,19 +819,38 @@ private:
 
     // vector of pointers to the start of each page
     std::vector<char*> pageBuffers;
+    std::vector<size_t> pageSizes; // bytes that can be addressed from the start of each page
     int firstPageIdx;
 
+    std::vector<const char*> m_invalidPointers; // locations of pointers that pointed outside of the pages, cleared when resolving them
+
+    // pointer header indices grouped by the page the pointer is in, the pointers in page i start at m_pagePointerStarts[i]
+    std::vector<uint32_t> m_pagePointerStarts;
+    std::vector<uint32_t> m_pagePointers;
+    std::vector<bool> m_rejectedAssets; // assets with data outside of the pages, these are not registered
+
     std::shared_ptr<char[]> m_Buf;
 
+    std::vector<uint64_t> m_patchFileCrcs;
+
 private:
 
     // Populates CPakFile members from file
-    const bool ParseFromFile(const std::string& filePath, std::shared_ptr<char[]>& buf);
+    const bool ParseFromFile(const std::string& filePath, std::shared_ptr<char[]>& buf, size_t& bufSize);
+    const bool ValidateHeaderData(const size_t bufSize);
+
+    void BucketPointersByPage();
+    void ResolvePagePointers(const int numPointers, const bool rebaseTargetPages);
+    const bool ResolveAssetPagePointers(PagePtr_t* const headPagePtr, PagePtr_t* const dataPagePtr, const uint32_t headerStructSize);
+    void ValidateAssetReferences();
     const bool ParseStreamedFile(const std::string& fileName, bool opt);
 
 #if defined(PAKLOAD_PATCHING_ANY)
     void ParsePatchEditStream();
+    void DecodePatchOp(PatchOp_t& op);
+    void DecodePatchOps();
     const bool DecodePatchCommands();
+    const bool ApplyPatchOps();
 
     void CreateHeaderSegmentCollection();
     bool AllocateSegments();
@@ -810,7 +860,7 @@ private:
     const bool ParsePakFileHeader(const char* buf);
 
 #if !defined(PAKLOAD_PATCHING_ANY) || defined(PAKLOAD_LOADING_V6)
-    const bool LoadNonPatched();
+    const bool LoadNonPatched(const size_t bufSize);
 #endif // #if !defined(PAKLOAD_PATCHING_ANY) || defined(PAKLOAD_LOADING_V6)
 #if defined(PAKLOAD_PATCHING_ANY)
     template<class PakAsset> const bool LoadAndPatchAssetData();
@@ -832,8 +882,6 @@ private:
     }
 #endif // #if defined(PAKLOAD_PATCHING_ANY)
 
-    void ProcessAssets();
-
     void HandleOwnPostLoad();
 
 public:
@@ -849,6 +897,7 @@ public:
         return vPak->at(idx).get();
     }
 
+    inline const std::vector<CAsset*>& GetProcessedAssets() const { return m_pAssetsProcessed; };
     inline const int* const dependents() const { return m_pDependentAssets; }; // [rika]: TEMP! rexx is gonna kill me!!!
     inline const PakGuidRefHdr_t* const guidRefs() const { return m_pGuidRefHeaders; };
 
@@ -859,6 +908,18 @@ public:
     inline int patchCount() const { return m_pHeader->patchCount; };
     inline int firstPageIndex() const { return firstPageIdx; };
 
+    // true if size bytes at offset are inside the loaded page. pointers are checked with this once when they are resolved,
+    // anything that made it through can be followed without checks
+    inline const bool IsValidPageRange(const int index, const int offset, const size_t size) const
+    {
+        if (static_cast<uint32_t>(index) >= pageBuffers.size() || !pageBuffers[index])
+            return false;
+
+        const size_t pageSize = pageSizes[index];
+
+        return static_cast<uint32_t>(offset) <= pageSize && size <= pageSize - static_cast<uint32_t>(offset);
+    }
+
     inline void* getPointerToPageOffset(const PagePtr_t& pagePointer)
     {
         assert(pagePointer.index < pageBuffers.size());
@@ -918,7 +979,38 @@ public:
         const int numPtrs = m_pHeader->numPointers;
         const auto& pages = pageBuffers;
 
-        for (int i = 0; i < numPtrs; i++)
+        // only the pointers in the head and cpu pages can be in range, the page buckets are in pointer header order
+        // so merging them keeps the fixups in the same order as a full scan
+        std::vector<uint32_t> candidates;
+        if (m_pagePointerStarts.size() == static_cast<size_t>(m_pHeader->numPages) + 1ull)
+        {
+            auto pageBucket = [this](const int adjPageIdx, std::vector<uint32_t>& out)
+            {
+                if (adjPageIdx < 0 || adjPageIdx >= m_pHeader->numPages)
+                    return;
+
+                const int pageIdx = (adjPageIdx + firstPageIdx) % m_pHeader->numPages;
+                out.insert(out.end(), m_pagePointers.begin() + m_pagePointerStarts[pageIdx], m_pagePointers.begin() + m_pagePointerStarts[pageIdx + 1]);
+            };
+
+            std::vector<uint32_t> headPointers;
+            std::vector<uint32_t> cpuPointers;
+            pageBucket(headPageIndex, headPointers);
+
+            if (cpuPageIndex >= 0 && cpuPageIndex != headPageIndex)
+                pageBucket(cpuPageIndex, cpuPointers);
+
+            candidates.reserve(headPointers.size() + cpuPointers.size());
+            std::merge(headPointers.begin(), headPointers.end(), cpuPointers.begin(), cpuPointers.end(), std::back_inserter(candidates));
+        }
+        else
+        {
+            candidates.reserve(numPtrs);
+            for (int i = 0; i < numPtrs; i++)
+                candidates.push_back(static_cast<uint32_t>(i));
+        }
+
+        for (const uint32_t i : candidates)
         {
             const PakPointerHdr_t& ptrHdr = m_pPointerHeaders[i];
 
@@ -1057,7 +1149,7 @@ template<class PakAsset>
 bool CPakFile::ProcessNextPage()
 {
     // resolve pointers in all of the newly processed pages
-    this->numShiftedPointers = this->numResolvedPointers = this->ResolvePointers();
+    this->numShiftedPointers = this->numPointersInProcessedPages = this->FindFirstPointerInUnprocessedPages();
 
     // get the correct value of numProcessedAssets according to the number of processed pages
     this->FindNextAssetWithUnpatchedPages<PakAsset>();
@@ -1114,7 +1206,7 @@ const bool CPakFile::LoadAndPatchAssetData()
             continue;
         }
 
-        if (!this->DecodePatchCommands())
+        if (!(this->usePatchInterpreter ? this->DecodePatchCommands() : this->ApplyPatchOps()))
         {
             assertm(false, "failed to decode patch command");
             return false;
@@ -1430,5 +1522,14 @@ private:
 };
 
 
+// times the pointer fixup sorts and page bucketing on every loaded pak
+void RunPakFixupBenchmark();
+
+// position of an asset type in the order paks post load their assets, g_assetData.v_assets is kept sorted by this
+const size_t GetPakAssetPostLoadOrder(const uint32_t type);
+
+// reloads every loaded patched pak with both patch engines and checks that they patch the same bytes
+void RunPakPatchVerify();
+
 // used for type init funcs
 typedef void(*PakTypeInitFunc_t)(void);
@@ -11,28 +11,20 @@ void CPakFile::SetPatchCommand(const int8_t cmd)
     this->p.patchFunc = g_pakPatchApi[cmd];
 }
 
-const int CPakFile::ResolvePointers()
+// pointers are sorted by the order their pages are patched in, so this only has to look at the pointers in the newly patched pages.
+// the pointers are resolved by ResolvePagePointers once patching is done, shifting header pointers needs them as index-offset pairs
+const int CPakFile::FindFirstPointerInUnprocessedPages()
 {
     int pointerIdx = 0;
-    for (pointerIdx = this->numResolvedPointers; pointerIdx < this->pointerCount(); ++pointerIdx)
+    for (pointerIdx = this->numPointersInProcessedPages; pointerIdx < this->pointerCount(); ++pointerIdx)
     {
-        PagePtr_t* const curPointer = &this->m_pPointerHeaders[pointerIdx];
+        const PagePtr_t* const curPointer = &this->m_pPointerHeaders[pointerIdx];
         int curCount = curPointer->index - this->firstPageIdx;
         if (curCount < 0)  // get the index of the page in relation to the order that it will be loaded
             curCount += this->pageCount();
 
         if (curCount >= this->numProcessedPages)
             break;
-
-        if (curPointer->index >= this->pageBuffers.size())
-            continue;
-
-        PagePtr_t* const ptr = reinterpret_cast<PagePtr_t*>(this->pageBuffers[curPointer->index] + curPointer->offset);
-
-        if (ptr->index >= this->pageBuffers.size() || !ptr->ptr)
-            continue;
-
-        ptr->ptr = this->pageBuffers[ptr->index] + ptr->offset;
     }
 
     return pointerIdx;
@@ -2,12 +2,34 @@
 #include "pch.h"
 #include "bvh.h"
 
+#include <thirdparty/imgui/misc/imgui_utility.h>
+
 //BEGIN_NAMESPACE(apex)
 
 static void R_ParseBVHNode(CollisionModel_t& colModel, const int nodeIndex, const BVHModel_t* pModel);
 
 //inline std::map<uint32_t, int> s_MaskMap{};
 
+// packed vertices are relative to the collision header's origin
+inline Vector Coll_DecodePackedVertex(const PackedVector& packed, const float scale, const Vector& origin)
+{
+	return Vector(
+		packed.x * 0xFFFF * scale + origin.x,
+		packed.y * 0xFFFF * scale + origin.y,
+		packed.z * 0xFFFF * scale + origin.z
+	);
+}
+
+// fourth corner of the parallelogram made by the three quad vertices
+inline Vector Coll_QuadFourthVertex(const Vector& a, const Vector& b, const Vector& c)
+{
+	return Vector(
+		a.x + (b.x - a.x) + (c.x - a.x),
+		a.y + (b.y - a.y) + (c.y - a.y),
+		a.z + (b.z - a.z) + (c.z - a.z)
+	);
+}
+
 static void Coll_ParseTriLeaf4(CollisionModel_t& colModel, const dbvhleaf_poly_t* pLeaf, const Vector* pVertices, const uint32_t contents)
 {
 	const dbvhtri_t* triData = reinterpret_cast<const dbvhtri_t*>(&pLeaf[1]);
@@ -20,11 +42,7 @@ static void Coll_ParseTriLeaf4(CollisionModel_t& colModel, const dbvhleaf_poly_t
 
 		baseVert += tri.vertAIndex;
 
-		Triangle t{ pVertices[baseVert], pVertices[baseVert + 1 + tri.vertBIndex], pVertices[baseVert + 1 + tri.vertCIndex] };
-
-		t.flags = contents;
-
-		colModel.tris.emplace_back(t);
+		colModel.AddTri(pVertices[baseVert], pVertices[baseVert + 1 + tri.vertBIndex], pVertices[baseVert + 1 + tri.vertCIndex], contents);
 	}
 }
 
@@ -39,31 +57,13 @@ static void Coll_ParseTriPackedLeaf5(CollisionModel_t& colModel, const dbvhleaf_
 		const dbvhtri_t& tri = triData[i];
 
 		baseVert += tri.vertAIndex;
-		PackedVector p1 = pVertices[baseVert];
-		PackedVector p2 = pVertices[baseVert + 1 + tri.vertBIndex];
-		PackedVector p3 = pVertices[baseVert + 1 + tri.vertCIndex];
-
-		Triangle t{
-			Vector(
-				p1.x * 0xFFFF * scale + origin.x,
-				p1.y * 0xFFFF * scale + origin.y,
-				p1.z * 0xFFFF * scale + origin.z
-			),
-			Vector(
-				p2.x * 0xFFFF * scale + origin.x,
-				p2.y * 0xFFFF * scale + origin.y,
-				p2.z * 0xFFFF * scale + origin.z
-			),
-			Vector(
-				p3.x * 0xFFFF * scale + origin.x,
-				p3.y * 0xFFFF * scale + origin.y,
-				p3.z * 0xFFFF * scale + origin.z
-			),
-		};
 
-		t.flags = contents;
-
-		colModel.tris.emplace_back(t);
+		colModel.AddTri(
+			Coll_DecodePackedVertex(pVertices[baseVert], scale, origin),
+			Coll_DecodePackedVertex(pVertices[baseVert + 1 + tri.vertBIndex], scale, origin),
+			Coll_DecodePackedVertex(pVertices[baseVert + 1 + tri.vertCIndex], scale, origin),
+			contents
+		);
 	}
 }
 
@@ -79,21 +79,11 @@ static void Coll_ParseQuadLeaf6(CollisionModel_t& colModel, const dbvhleaf_poly_
 
 		baseVert += quad.vertAIndex;
 
-		Quad q{};
-
-		q.a = pVertices[baseVert];
-		q.b = pVertices[baseVert + 1 + quad.vertBIndex];
-		q.c = pVertices[baseVert + 1 + quad.vertCIndex];
+		const Vector& a = pVertices[baseVert];
+		const Vector& b = pVertices[baseVert + 1 + quad.vertBIndex];
+		const Vector& c = pVertices[baseVert + 1 + quad.vertCIndex];
 
-		q.d = Vector(
-			q.a.x + (q.b.x - q.a.x) + (q.c.x - q.a.x),
-			q.a.y + (q.b.y - q.a.y) + (q.c.y - q.a.y),
-			q.a.z + (q.b.z - q.a.z) + (q.c.z - q.a.z)
-		);
-
-		q.flags = contents;
-
-		colModel.quads.emplace_back(q);
+		colModel.AddQuad(a, b, c, Coll_QuadFourthVertex(a, b, c), contents);
 	}
 }
 
@@ -108,37 +98,12 @@ static void Coll_ParseQuadPackedLeaf7(CollisionModel_t& colModel, const dbvhleaf
 		const dbvhquad_t& quad = quadData[i];
 
 		baseVert += quad.vertAIndex;
-		PackedVector p1 = pVertices[baseVert];
-		PackedVector p2 = pVertices[baseVert + 1 + quad.vertBIndex];
-		PackedVector p3 = pVertices[baseVert + 1 + quad.vertCIndex];
-
-		Quad q{};
 
-		q.a = Vector(
-			p1.x * 0xFFFF * scale + origin.x,
-			p1.y * 0xFFFF * scale + origin.y,
-			p1.z * 0xFFFF * scale + origin.z
-		);
-		q.b = Vector(
-			p2.x * 0xFFFF * scale + origin.x,
-			p2.y * 0xFFFF * scale + origin.y,
-			p2.z * 0xFFFF * scale + origin.z
-		);
-		q.c = Vector(
-			p3.x * 0xFFFF * scale + origin.x,
-			p3.y * 0xFFFF * scale + origin.y,
-			p3.z * 0xFFFF * scale + origin.z
-		);
+		const Vector a = Coll_DecodePackedVertex(pVertices[baseVert], scale, origin);
+		const Vector b = Coll_DecodePackedVertex(pVertices[baseVert + 1 + quad.vertBIndex], scale, origin);
+		const Vector c = Coll_DecodePackedVertex(pVertices[baseVert + 1 + quad.vertCIndex], scale, origin);
 
-		q.d = Vector(
-			q.a.x + (q.b.x - q.a.x) + (q.c.x - q.a.x),
-			q.a.y + (q.b.y - q.a.y) + (q.c.y - q.a.y),
-			q.a.z + (q.b.z - q.a.z) + (q.c.z - q.a.z)
-		);
-
-		q.flags = contents;
-
-		colModel.quads.emplace_back(q);
+		colModel.AddQuad(a, b, c, Coll_QuadFourthVertex(a, b, c), contents);
 	}
 }
 
@@ -271,6 +236,128 @@ static void R_ParseBVHNode(CollisionModel_t& colModel, int nodeIndex, const BVHM
 	Coll_HandleNodeChildType(colModel, contents, nodeIndex, startNode->child3Type, startNode->index3, pModel);
 }
 
+// a child of a node that still has to be parsed
+struct BVHChild_t
+{
+	uint32_t contents;
+	int nodeType;
+	int index;
+};
+
+// same as R_ParseBVHNode, but defers the children so they can be parsed elsewhere
+static void Coll_SplitBVHNode(std::vector<BVHChild_t>& children, const int nodeIndex, const BVHModel_t* pModel)
+{
+	const dbvhnode_t* startNode = &pModel->nodes[nodeIndex];
+	const uint32_t contents = pModel->masks[startNode->cmIndex];
+
+	children.push_back({ contents, static_cast<int>(startNode->child0Type), static_cast<int>(startNode->index0) });
+	children.push_back({ contents, static_cast<int>(startNode->child1Type), static_cast<int>(startNode->index1) });
+	children.push_back({ contents, static_cast<int>(startNode->child2Type), static_cast<int>(startNode->index2) });
+	children.push_back({ contents, static_cast<int>(startNode->child3Type), static_cast<int>(startNode->index3) });
+}
+
+void Coll_ParseBVH(CollisionModel_t& colModel, const BVHModel_t* pModel)
+{
+	// max levels of the tree split up before giving up on getting enough subtrees, trees this unbalanced are tiny anyway
+	constexpr int maxSplitDepth = 6;
+	// subtrees per thread, they vary a lot in size so have a few per thread to even out the work
+	constexpr size_t subtreesPerThread = 4ull;
+
+	std::vector<BVHChild_t> subtrees;
+	Coll_SplitBVHNode(subtrees, 0, pModel);
+
+	const uint32_t numThreads = CThread::GetNestedExportThreadBudget(UINT32_MAX);
+
+	// nodes are split in place so the subtrees stay in the same order the tree would be walked in on one thread
+	size_t numNodeSubtrees = 0ull;
+	for (int depth = 0; numThreads > 1u && depth < maxSplitDepth; depth++)
+	{
+		numNodeSubtrees = std::ranges::count(subtrees, static_cast<int>(dbvhchildtype_e::NODE), &BVHChild_t::nodeType);
+
+		if (numNodeSubtrees == 0ull || numNodeSubtrees >= numThreads * subtreesPerThread)
+			break;
+
+		std::vector<BVHChild_t> split;
+		split.reserve(subtrees.size() + (numNodeSubtrees * 3));
+
+		for (const BVHChild_t& child : subtrees)
+		{
+			if (child.nodeType == dbvhchildtype_e::NODE)
+				Coll_SplitBVHNode(split, child.index, pModel);
+			else
+				split.push_back(child);
+		}
+
+		subtrees.swap(split);
+	}
+
+	if (numNodeSubtrees < numThreads)
+	{
+		for (const BVHChild_t& child : subtrees)
+			Coll_HandleNodeChildType(colModel, child.contents, -1, child.nodeType, child.index, pModel);
+
+		return;
+	}
+
+	// every subtree gets its own model, then they're appended in tree order so the output doesn't depend on which thread finished first
+	std::vector<CollisionModel_t> subtreeModels(subtrees.size());
+
+	ParallelFor(subtrees.size(), numThreads, [&](const size_t i)
+		{
+			const BVHChild_t& child = subtrees[i];
+			Coll_HandleNodeChildType(subtreeModels[i], child.contents, -1, child.nodeType, child.index, pModel);
+		});
+
+	for (const CollisionModel_t& subtreeModel : subtreeModels)
+		colModel.Append(subtreeModel);
+}
+
+const uint32_t CollisionModel_t::AddVertex(const Vector& vert)
+{
+	// -0.0f and 0.0f compare equal but have different bits, make them the same vertex
+	const float x = vert.x == 0.0f ? 0.0f : vert.x;
+	const float y = vert.y == 0.0f ? 0.0f : vert.y;
+	const float z = vert.z == 0.0f ? 0.0f : vert.z;
+
+	VertexKey_t key;
+	memcpy(&key.x, &x, sizeof(uint32_t));
+	memcpy(&key.y, &y, sizeof(uint32_t));
+	memcpy(&key.z, &z, sizeof(uint32_t));
+
+	const auto it = vertexMap.try_emplace(key, static_cast<uint32_t>(verts.size()));
+
+	if (it.second)
+		verts.emplace_back(x, y, z);
+
+	return it.first->second;
+}
+
+void CollisionModel_t::AddTri(const Vector& a, const Vector& b, const Vector& c, const uint32_t flags)
+{
+	tris.push_back({ AddVertex(a), AddVertex(b), AddVertex(c), flags });
+}
+
+void CollisionModel_t::AddQuad(const Vector& a, const Vector& b, const Vector& c, const Vector& d, const uint32_t flags)
+{
+	quads.push_back({ AddVertex(a), AddVertex(b), AddVertex(c), AddVertex(d), flags });
+}
+
+void CollisionModel_t::Append(const CollisionModel_t& other)
+{
+	// other's vertices are already unique, so only need remapping to ours
+	std::vector<uint32_t> remap(other.verts.size());
+	for (size_t i = 0; i < other.verts.size(); i++)
+		remap[i] = AddVertex(other.verts[i]);
+
+	tris.reserve(tris.size() + other.tris.size());
+	for (const CollisionTri_t& tri : other.tris)
+		tris.push_back({ remap[tri.a], remap[tri.b], remap[tri.c], tri.flags });
+
+	quads.reserve(quads.size() + other.quads.size());
+	for (const CollisionQuad_t& quad : other.quads)
+		quads.push_back({ remap[quad.a], remap[quad.b], remap[quad.c], remap[quad.d], quad.flags });
+}
+
 
 #pragma pack(push, 1)
 struct stlheader_t
@@ -301,97 +388,165 @@ inline Vector normal(Vector p1, Vector p2, Vector p3) {
 
 bool CollisionModel_t::exportSTL(const std::filesystem::path& outPath)
 {
-	std::ofstream out(outPath, std::ios::out | std::ios::binary);
+	StreamIO outFile(outPath, eStreamIOMode::Write);
 
-	if (!out.is_open())
+	if (!outFile.W())
 		return false;
 
+	std::ofstream& out = *outFile.W();
+
 	// They seem to not be in the right spot yet, so might not want to export for now
 	//bool include_packed = false;
 
-	size_t numTris = this->tris.size() + this->quads.size() * 2;
+	const size_t numTris = NumTriangles();
 
-	size_t stlFileSize = sizeof(stlheader_t) + (sizeof(stltri_t) * numTris);
-	char* stlBuf = new char[stlFileSize];
+	const size_t stlFileSize = sizeof(stlheader_t) + (sizeof(stltri_t) * numTris);
+	std::unique_ptr<char[]> stlBuf = std::make_unique<char[]>(stlFileSize);
 
-	stlheader_t* pStlHeader = reinterpret_cast<stlheader_t*>(stlBuf);
+	stlheader_t* pStlHeader = reinterpret_cast<stlheader_t*>(stlBuf.get());
 	stltri_t* pStlTris = reinterpret_cast<stltri_t*>(&pStlHeader[1]);
 
+	auto writeTri = [this, pStlTris](const size_t i, const uint32_t a, const uint32_t b, const uint32_t c)
+		{
+			stltri_t& stlTri = pStlTris[i];
+
+			stlTri.nml = normal(verts[a], verts[b], verts[c]);
+			stlTri.a = verts[a];
+			stlTri.b = verts[b];
+			stlTri.c = verts[c];
+			stlTri.flags = 0;
+		};
+
 	size_t i = 0;
-	for (Triangle& tri : this->tris)
-	{
-		stltri_t& stlTri = pStlTris[i];
-		i++;
-
-		stlTri.nml = normal(tri.a, tri.b, tri.c);
-		stlTri.a = tri.a;
-		stlTri.b = tri.b;
-		stlTri.c = tri.c;
-		stlTri.flags = 0;
-	}
+	for (const CollisionTri_t& tri : this->tris)
+		writeTri(i++, tri.a, tri.b, tri.c);
 
-	for (Quad& quad : this->quads)
+	for (const CollisionQuad_t& quad : this->quads)
 	{
-		stltri_t& triA = pStlTris[i];
-		i++;
-
-		triA.nml = normal(quad.a, quad.b, quad.c);
-		triA.a = quad.a;
-		triA.b = quad.b;
-		triA.c = quad.c;
-		triA.flags = 0;
-
-		stltri_t& triB = pStlTris[i];
-		i++;
-
-		triB.nml = normal(quad.b, quad.d, quad.c);
-		triB.a = quad.b;
-		triB.b = quad.d;
-		triB.c = quad.c;
-		triB.flags = 0;
+		writeTri(i++, quad.a, quad.b, quad.c);
+		writeTri(i++, quad.b, quad.d, quad.c);
 	}
 
-	memset(stlBuf, 0, sizeof(stlheader_t));
+	memset(stlBuf.get(), 0, sizeof(stlheader_t));
 	pStlHeader->numTris = (unsigned int)numTris;
 
-	out.write(stlBuf, stlFileSize);
-	delete[] stlBuf;
+	out.write(stlBuf.get(), stlFileSize);
 
 	return !out.fail();
 }
 
+// quads are written as polygons in the same winding as the two triangles exportSTL splits them into
 bool CollisionModel_t::exportOBJ(const std::filesystem::path& outFile)
 {
-	std::ofstream out(outFile, std::ios::out | std::ios::binary);
+	StreamIO outStream(outFile, eStreamIOMode::Write);
 
-	if (!out.is_open())
+	if (!outStream.W())
 		return false;
 
-	out << "# " << this->tris.size() << " tris\no tris\n";
+	std::ofstream& out = *outStream.W();
 
-	printf("Writing tris...\n");
-	for (Triangle& tri : this->tris)
+	// formatting into one buffer and writing it out in large chunks is a lot faster than going through the stream for every value
+	constexpr size_t flushSize = 1024ull * 1024ull;
+
+	std::string buf;
+	buf.reserve(flushSize + 256ull);
+
+	auto flush = [&out, &buf](const bool force)
+		{
+			if (!force && buf.size() < flushSize)
+				return;
+
+			out.write(buf.data(), buf.size());
+			buf.clear();
+		};
+
+	std::format_to(std::back_inserter(buf), "# {} verts\n", verts.size());
+	for (const Vector& vert : verts)
 	{
-		out
-			<< "v " << tri.a.x << " " << tri.a.y << " " << tri.a.z << "\n"
-			<< "v " << tri.b.x << " " << tri.b.y << " " << tri.b.z << "\n"
-			<< "v " << tri.c.x << " " << tri.c.y << " " << tri.c.z << "\n"
-			<< "f -3 -2 -1\n";
+		std::format_to(std::back_inserter(buf), "v {} {} {}\n", vert.x, vert.y, vert.z);
+		flush(false);
 	}
 
-	out << "\n# " << this->quads.size() << " quads\no quads\n";
+	// obj indices start at 1
+	std::format_to(std::back_inserter(buf), "\n# {} tris\no tris\n", tris.size());
+	for (const CollisionTri_t& tri : tris)
+	{
+		std::format_to(std::back_inserter(buf), "f {} {} {}\n", tri.a + 1, tri.b + 1, tri.c + 1);
+		flush(false);
+	}
 
-	printf("Writing quads...\n");
-	for (Quad& quad : this->quads)
+	std::format_to(std::back_inserter(buf), "\n# {} quads\no quads\n", quads.size());
+	for (const CollisionQuad_t& quad : quads)
 	{
-		out
-			<< "v " << quad.a.x << " " << quad.a.y << " " << quad.a.z << "\n"
-			<< "v " << quad.b.x << " " << quad.b.y << " " << quad.b.z << "\n"
-			<< "v " << quad.c.x << " " << quad.c.y << " " << quad.c.z << "\n"
-			<< "v " << quad.d.x << " " << quad.d.y << " " << quad.d.z << "\n"
-			<< "f -3 -4 -2 -1\n";
+		std::format_to(std::back_inserter(buf), "f {} {} {} {}\n", quad.a + 1, quad.b + 1, quad.d + 1, quad.c + 1);
+		flush(false);
 	}
 
+	flush(true);
+
+	return !out.fail();
+}
+
+// binary little endian ply, every face has the contents mask of the leaf it came from
+bool CollisionModel_t::exportPLY(const std::filesystem::path& outFile)
+{
+	static_assert(sizeof(Vector) == sizeof(float) * 3);
+
+	StreamIO outStream(outFile, eStreamIOMode::Write);
+
+	if (!outStream.W())
+		return false;
+
+	std::ofstream& out = *outStream.W();
+
+	const std::string header = std::format(
+		"ply\n"
+		"format binary_little_endian 1.0\n"
+		"comment {} tris, {} quads\n"
+		"element vertex {}\n"
+		"property float x\n"
+		"property float y\n"
+		"property float z\n"
+		"element face {}\n"
+		"property list uchar uint vertex_indices\n"
+		"property uint contents\n"
+		"end_header\n",
+		tris.size(), quads.size(), verts.size(), tris.size() + quads.size());
+
+	out.write(header.data(), header.size());
+	out.write(reinterpret_cast<const char*>(verts.data()), verts.size() * sizeof(Vector));
+
+	// count byte + indices + contents
+	constexpr size_t triFaceSize = sizeof(uint8_t) + (sizeof(uint32_t) * 3) + sizeof(uint32_t);
+	constexpr size_t quadFaceSize = sizeof(uint8_t) + (sizeof(uint32_t) * 4) + sizeof(uint32_t);
+
+	const size_t facesSize = (tris.size() * triFaceSize) + (quads.size() * quadFaceSize);
+	std::unique_ptr<char[]> faceBuf = std::make_unique<char[]>(facesSize);
+
+	char* curpos = faceBuf.get();
+	auto writeFace = [&curpos](const std::initializer_list<uint32_t> indices, const uint32_t contents)
+		{
+			*curpos++ = static_cast<char>(indices.size());
+
+			for (const uint32_t index : indices)
+			{
+				memcpy(curpos, &index, sizeof(uint32_t));
+				curpos += sizeof(uint32_t);
+			}
+
+			memcpy(curpos, &contents, sizeof(uint32_t));
+			curpos += sizeof(uint32_t);
+		};
+
+	for (const CollisionTri_t& tri : tris)
+		writeFace({ tri.a, tri.b, tri.c }, tri.flags);
+
+	for (const CollisionQuad_t& quad : quads)
+		writeFace({ quad.a, quad.b, quad.d, quad.c }, quad.flags);
+
+	assertm(curpos == faceBuf.get() + facesSize, "ply face size mismatch");
+	out.write(faceBuf.get(), facesSize);
+
 	return !out.fail();
 }
 
@@ -1,21 +1,23 @@
 #pragma once
 #include <set>
 
-struct Triangle
+// indices into CollisionModel_t::verts
+struct CollisionTri_t
 {
-	Vector a;
-	Vector b;
-	Vector c;
+	uint32_t a;
+	uint32_t b;
+	uint32_t c;
 
 	uint32_t flags;
 };
 
-struct Quad
+// d is the fourth corner of the parallelogram made by a, b, and c
+struct CollisionQuad_t
 {
-	Vector a;
-	Vector b;
-	Vector c;
-	Vector d;
+	uint32_t a;
+	uint32_t b;
+	uint32_t c;
+	uint32_t d;
 
 	uint32_t flags;
 };
@@ -26,13 +28,47 @@ struct PackedVector // TODO: move elsewhere
 };
 
 // intermediate data for exporting a model of some bsp data
+// vertices are deduplicated by position as primitives are added, so the tris and quads index a shared vertex buffer
 struct CollisionModel_t
 {
-	std::vector<Triangle> tris;
-	std::vector<Quad> quads;
+	std::vector<Vector> verts;
+	std::vector<CollisionTri_t> tris;
+	std::vector<CollisionQuad_t> quads;
+
+	const uint32_t AddVertex(const Vector& vert);
+	void AddTri(const Vector& a, const Vector& b, const Vector& c, const uint32_t flags);
+	void AddQuad(const Vector& a, const Vector& b, const Vector& c, const Vector& d, const uint32_t flags);
+
+	// appends another model's primitives, deduplicating its vertices against the ones we already have
+	void Append(const CollisionModel_t& other);
+
+	inline const size_t NumTriangles() const { return tris.size() + (quads.size() * 2); }
 
 	bool exportSTL(const std::filesystem::path& out);
 	bool exportOBJ(const std::filesystem::path& out);
+	bool exportPLY(const std::filesystem::path& out);
+
+private:
+	// exact position, -0.0 and 0.0 are the same vertex
+	struct VertexKey_t
+	{
+		uint32_t x, y, z;
+
+		inline const bool operator==(const VertexKey_t& other) const { return x == other.x && y == other.y && z == other.z; }
+	};
+
+	struct VertexKeyHasher_t
+	{
+		inline size_t operator()(const VertexKey_t& key) const
+		{
+			uint64_t hash = (static_cast<uint64_t>(key.x) * 0x9E3779B185EBCA87ull) ^ (static_cast<uint64_t>(key.y) * 0xC2B2AE3D27D4EB4Full) ^ (static_cast<uint64_t>(key.z) * 0x165667B19E3779F9ull);
+			hash ^= hash >> 29;
+
+			return static_cast<size_t>(hash);
+		}
+	};
+
+	std::unordered_map<VertexKey_t, uint32_t, VertexKeyHasher_t> vertexMap;
 };
 
 struct dbvhaxis_t
@@ -143,4 +179,8 @@ struct BVHModel_t
 	bool filterAND;
 };
 
-extern void Coll_HandleNodeChildType(CollisionModel_t& colModel, uint32_t contents, int parentNodeIndex, int nodeType, int index, const BVHModel_t* pModel);
\ No newline at end of file
+extern void Coll_HandleNodeChildType(CollisionModel_t& colModel, uint32_t contents, int parentNodeIndex, int nodeType, int index, const BVHModel_t* pModel);
+
+// parses the whole tree under the root node (0) into colModel, large trees have their subtrees parsed in parallel
+// output is identical to parsing the tree on one thread
+extern void Coll_ParseBVH(CollisionModel_t& colModel, const BVHModel_t* pModel);
\ No newline at end of file
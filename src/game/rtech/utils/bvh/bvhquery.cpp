@@ -0,0 +1,787 @@
+#include "pch.h"
+#include "bvhquery.h"
+
+#include <game/asset.h>
+#include <game/rtech/utils/utils.h>
+#include <thirdparty/imgui/misc/imgui_utility.h>
+
+#include <immintrin.h>
+#include <random>
+#include <chrono>
+
+//
+// BUILD
+//
+
+void CCollisionQuery::AddBVH(const BVHModel_t* const pModel)
+{
+	// decode every primitive, filtering is done by the queries
+	BVHModel_t buildModel = *pModel;
+	buildModel.maskFilter = 0u;
+	buildModel.filterExclusive = true;
+	buildModel.filterAND = false;
+
+	Vector mins(FLT_MAX, FLT_MAX, FLT_MAX);
+	Vector maxs(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+	uint32_t contents = 0u;
+
+	m_roots.push_back(BuildNode(&buildModel, 0, mins, maxs, contents));
+
+	m_mins = Vector(std::min(m_mins.x, mins.x), std::min(m_mins.y, mins.y), std::min(m_mins.z, mins.z));
+	m_maxs = Vector(std::max(m_maxs.x, maxs.x), std::max(m_maxs.y, maxs.y), std::max(m_maxs.z, maxs.z));
+}
+
+const int32_t CCollisionQuery::BuildNode(const BVHModel_t* const pModel, const int nodeIndex, Vector& mins, Vector& maxs, uint32_t& contents)
+{
+	const dbvhnode_t* const node = &pModel->nodes[nodeIndex];
+	const uint32_t nodeContents = pModel->masks[node->cmIndex];
+
+	const int childTypes[4] = { static_cast<int>(node->child0Type), static_cast<int>(node->child1Type), static_cast<int>(node->child2Type), static_cast<int>(node->child3Type) };
+	const int childIndices[4] = { static_cast<int>(node->index0), static_cast<int>(node->index1), static_cast<int>(node->index2), static_cast<int>(node->index3) };
+
+	// reserve our slot first, children get written after us
+	const int32_t queryNodeIndex = static_cast<int32_t>(m_nodes.size());
+	m_nodes.emplace_back();
+
+	Node_t queryNode = {};
+
+	for (int i = 0; i < 4; i++)
+	{
+		Vector childMins(FLT_MAX, FLT_MAX, FLT_MAX);
+		Vector childMaxs(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+		uint32_t childContents = 0u;
+		int32_t child = s_InvalidChild;
+
+		if (childTypes[i] == dbvhchildtype_e::NODE)
+		{
+			child = BuildNode(pModel, childIndices[i], childMins, childMaxs, childContents);
+		}
+		else if (childTypes[i] != dbvhchildtype_e::NO_CHILD)
+		{
+			CollisionModel_t leafModel;
+			Coll_HandleNodeChildType(leafModel, nodeContents, nodeIndex, childTypes[i], childIndices[i], pModel);
+
+			if (leafModel.NumTriangles() > 0ull)
+				child = BuildLeaf(leafModel, childMins, childMaxs, childContents);
+		}
+
+		queryNode.minX[i] = childMins.x;
+		queryNode.minY[i] = childMins.y;
+		queryNode.minZ[i] = childMins.z;
+		queryNode.maxX[i] = childMaxs.x;
+		queryNode.maxY[i] = childMaxs.y;
+		queryNode.maxZ[i] = childMaxs.z;
+		queryNode.contents[i] = childContents;
+		queryNode.children[i] = child;
+
+		mins = Vector(std::min(mins.x, childMins.x), std::min(mins.y, childMins.y), std::min(mins.z, childMins.z));
+		maxs = Vector(std::max(maxs.x, childMaxs.x), std::max(maxs.y, childMaxs.y), std::max(maxs.z, childMaxs.z));
+		contents |= childContents;
+	}
+
+	m_nodes[queryNodeIndex] = queryNode;
+
+	return queryNodeIndex;
+}
+
+const int32_t CCollisionQuery::BuildLeaf(const CollisionModel_t& leafModel, Vector& mins, Vector& maxs, uint32_t& contents)
+{
+	const Leaf_t leaf = { static_cast<uint32_t>(m_tris.size()), static_cast<uint32_t>(leafModel.NumTriangles()) };
+
+	auto addTri = [&](const uint32_t a, const uint32_t b, const uint32_t c, const uint32_t flags)
+		{
+			const Vector& v0 = leafModel.verts[a];
+			const Vector& v1 = leafModel.verts[b];
+			const Vector& v2 = leafModel.verts[c];
+
+			m_tris.push_back({ v0, Vector(v1.x - v0.x, v1.y - v0.y, v1.z - v0.z), Vector(v2.x - v0.x, v2.y - v0.y, v2.z - v0.z), flags });
+
+			contents |= flags;
+		};
+
+	// same split as the stl export
+	for (const CollisionTri_t& tri : leafModel.tris)
+		addTri(tri.a, tri.b, tri.c, tri.flags);
+
+	for (const CollisionQuad_t& quad : leafModel.quads)
+	{
+		addTri(quad.a, quad.b, quad.c, quad.flags);
+		addTri(quad.b, quad.d, quad.c, quad.flags);
+	}
+
+	for (const Vector& vert : leafModel.verts)
+	{
+		mins = Vector(std::min(mins.x, vert.x), std::min(mins.y, vert.y), std::min(mins.z, vert.z));
+		maxs = Vector(std::max(maxs.x, vert.x), std::max(maxs.y, vert.y), std::max(maxs.z, vert.z));
+	}
+
+	m_leafs.push_back(leaf);
+
+	return ~static_cast<int32_t>(m_leafs.size() - 1);
+}
+
+//
+// QUERIES
+//
+
+// children of a node with any contents in the mask, as a 4 bit mask
+static inline int ChildContentsMask(const uint32_t* const contents, const uint32_t contentsMask)
+{
+	return ((contents[0] & contentsMask) ? 1 : 0) | ((contents[1] & contentsMask) ? 2 : 0) | ((contents[2] & contentsMask) ? 4 : 0) | ((contents[3] & contentsMask) ? 8 : 0);
+}
+
+// stack depth needed is at most three entries per tree level plus the root, native trees are nowhere near this deep
+static constexpr int s_MaxTraversalStack = 256;
+
+void CCollisionQuery::TraceRay(const CollisionRay_t& ray, CollisionTrace_t& trace) const
+{
+	const float dir[3] = { ray.end.x - ray.start.x, ray.end.y - ray.start.y, ray.end.z - ray.start.z };
+
+	trace.fraction = 1.0f;
+	trace.endPos = ray.end;
+	trace.normal = Vector(0.0f, 0.0f, 0.0f);
+	trace.contents = 0u;
+	trace.hit = false;
+
+	const Tri_t* hitTri = nullptr;
+
+	// a huge inverse instead of infinity for axis aligned rays, infinity * 0 would give nan when the ray starts on a bounds plane
+	auto safeInverse = [](const float d) -> float { return fabsf(d) > 1e-30f ? 1.0f / d : 1e30f; };
+
+	const __m128 originX = _mm_set1_ps(ray.start.x);
+	const __m128 originY = _mm_set1_ps(ray.start.y);
+	const __m128 originZ = _mm_set1_ps(ray.start.z);
+	const __m128 invDirX = _mm_set1_ps(safeInverse(dir[0]));
+	const __m128 invDirY = _mm_set1_ps(safeInverse(dir[1]));
+	const __m128 invDirZ = _mm_set1_ps(safeInverse(dir[2]));
+
+	struct StackEntry_t
+	{
+		int32_t child;
+		float tNear;
+	};
+
+	StackEntry_t stack[s_MaxTraversalStack];
+
+	for (const int32_t root : m_roots)
+	{
+		int stackSize = 0;
+		stack[stackSize++] = { root, 0.0f };
+
+		while (stackSize > 0)
+		{
+			const StackEntry_t entry = stack[--stackSize];
+
+			// something closer has been hit since this was pushed
+			if (entry.tNear > trace.fraction)
+				continue;
+
+			if (entry.child < 0)
+			{
+				const Leaf_t& leaf = m_leafs[~entry.child];
+
+				for (uint32_t i = leaf.firstTri; i < leaf.firstTri + leaf.numTris; i++)
+				{
+					const Tri_t& tri = m_tris[i];
+
+					if (!(tri.contents & ray.contentsMask))
+						continue;
+
+					// moller-trumbore, hits both sides
+					const float p[3] = { dir[1] * tri.e2.z - dir[2] * tri.e2.y, dir[2] * tri.e2.x - dir[0] * tri.e2.z, dir[0] * tri.e2.y - dir[1] * tri.e2.x };
+					const float det = tri.e1.x * p[0] + tri.e1.y * p[1] + tri.e1.z * p[2];
+
+					if (fabsf(det) < 1e-12f)
+						continue;
+
+					const float invDet = 1.0f / det;
+					const float s[3] = { ray.start.x - tri.v0.x, ray.start.y - tri.v0.y, ray.start.z - tri.v0.z };
+
+					const float u = (s[0] * p[0] + s[1] * p[1] + s[2] * p[2]) * invDet;
+					if (u < 0.0f || u > 1.0f)
+						continue;
+
+					const float q[3] = { s[1] * tri.e1.z - s[2] * tri.e1.y, s[2] * tri.e1.x - s[0] * tri.e1.z, s[0] * tri.e1.y - s[1] * tri.e1.x };
+
+					const float v = (dir[0] * q[0] + dir[1] * q[1] + dir[2] * q[2]) * invDet;
+					if (v < 0.0f || u + v > 1.0f)
+						continue;
+
+					const float t = (tri.e2.x * q[0] + tri.e2.y * q[1] + tri.e2.z * q[2]) * invDet;
+					if (t < 0.0f || t >= trace.fraction)
+						continue;
+
+					trace.fraction = t;
+					hitTri = &tri;
+				}
+
+				continue;
+			}
+
+			const Node_t& node = m_nodes[entry.child];
+
+			// slab test against all four children
+			const __m128 t1X = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.minX), originX), invDirX);
+			const __m128 t2X = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.maxX), originX), invDirX);
+			const __m128 t1Y = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.minY), originY), invDirY);
+			const __m128 t2Y = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.maxY), originY), invDirY);
+			const __m128 t1Z = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.minZ), originZ), invDirZ);
+			const __m128 t2Z = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.maxZ), originZ), invDirZ);
+
+			__m128 tNear = _mm_max_ps(_mm_max_ps(_mm_min_ps(t1X, t2X), _mm_min_ps(t1Y, t2Y)), _mm_max_ps(_mm_min_ps(t1Z, t2Z), _mm_setzero_ps()));
+			const __m128 tFar = _mm_min_ps(_mm_min_ps(_mm_max_ps(t1X, t2X), _mm_max_ps(t1Y, t2Y)), _mm_min_ps(_mm_max_ps(t1Z, t2Z), _mm_set1_ps(trace.fraction)));
+
+			const int hitMask = _mm_movemask_ps(_mm_cmple_ps(tNear, tFar)) & ChildContentsMask(node.contents, ray.contentsMask);
+
+			if (!hitMask)
+				continue;
+
+			alignas(16) float tNears[4];
+			_mm_store_ps(tNears, tNear);
+
+			// push the furthest child first so the nearest one is visited first
+			StackEntry_t hitChildren[4];
+			int numHitChildren = 0;
+
+			for (int i = 0; i < 4; i++)
+			{
+				if (!(hitMask & (1 << i)))
+					continue;
+
+				StackEntry_t child = { node.children[i], tNears[i] };
+
+				int j = numHitChildren++;
+				for (; j > 0 && hitChildren[j - 1].tNear < child.tNear; j--)
+					hitChildren[j] = hitChildren[j - 1];
+
+				hitChildren[j] = child;
+			}
+
+			assertm(stackSize + numHitChildren <= s_MaxTraversalStack, "collision traversal stack overflow");
+			for (int i = 0; i < numHitChildren && stackSize < s_MaxTraversalStack; i++)
+				stack[stackSize++] = hitChildren[i];
+		}
+	}
+
+	if (!hitTri)
+		return;
+
+	Vector normal(hitTri->e1.y * hitTri->e2.z - hitTri->e1.z * hitTri->e2.y, hitTri->e1.z * hitTri->e2.x - hitTri->e1.x * hitTri->e2.z, hitTri->e1.x * hitTri->e2.y - hitTri->e1.y * hitTri->e2.x);
+
+	const float length = sqrtf(normal.x * normal.x + normal.y * normal.y + normal.z * normal.z);
+	const float facing = (normal.x * dir[0] + normal.y * dir[1] + normal.z * dir[2]) > 0.0f ? -1.0f : 1.0f;
+	const float scale = length > 0.0f ? facing / length : 0.0f;
+
+	trace.normal = Vector(normal.x * scale, normal.y * scale, normal.z * scale);
+	trace.endPos = Vector(ray.start.x + dir[0] * trace.fraction, ray.start.y + dir[1] * trace.fraction, ray.start.z + dir[2] * trace.fraction);
+	trace.contents = hitTri->contents;
+	trace.hit = true;
+}
+
+void CCollisionQuery::TraceRays(const CollisionRay_t* const rays, CollisionTrace_t* const traces, const size_t numRays, const uint32_t numThreads) const
+{
+	// rays are handed out in blocks so threads aren't fighting over the counter
+	constexpr size_t raysPerBlock = 256ull;
+
+	const size_t numBlocks = (numRays + raysPerBlock - 1) / raysPerBlock;
+
+	ParallelFor(numBlocks, numThreads, [&](const size_t block)
+		{
+			const size_t end = std::min((block + 1) * raysPerBlock, numRays);
+
+			for (size_t i = block * raysPerBlock; i < end; i++)
+				TraceRay(rays[i], traces[i]);
+		});
+}
+
+template <typename LeafFunc_t>
+void CCollisionQuery::OverlapLeafs(const Vector& mins, const Vector& maxs, const uint32_t contentsMask, const LeafFunc_t& leafFunc) const
+{
+	const __m128 queryMinX = _mm_set1_ps(mins.x);
+	const __m128 queryMinY = _mm_set1_ps(mins.y);
+	const __m128 queryMinZ = _mm_set1_ps(mins.z);
+	const __m128 queryMaxX = _mm_set1_ps(maxs.x);
+	const __m128 queryMaxY = _mm_set1_ps(maxs.y);
+	const __m128 queryMaxZ = _mm_set1_ps(maxs.z);
+
+	int32_t stack[s_MaxTraversalStack];
+
+	for (const int32_t root : m_roots)
+	{
+		int stackSize = 0;
+		stack[stackSize++] = root;
+
+		while (stackSize > 0)
+		{
+			const int32_t child = stack[--stackSize];
+
+			if (child < 0)
+			{
+				leafFunc(m_leafs[~child]);
+				continue;
+			}
+
+			const Node_t& node = m_nodes[child];
+
+			// child.mins <= query.maxs && child.maxs >= query.mins on every axis
+			__m128 overlap = _mm_and_ps(_mm_cmple_ps(_mm_load_ps(node.minX), queryMaxX), _mm_cmpge_ps(_mm_load_ps(node.maxX), queryMinX));
+			overlap = _mm_and_ps(overlap, _mm_and_ps(_mm_cmple_ps(_mm_load_ps(node.minY), queryMaxY), _mm_cmpge_ps(_mm_load_ps(node.maxY), queryMinY)));
+			overlap = _mm_and_ps(overlap, _mm_and_ps(_mm_cmple_ps(_mm_load_ps(node.minZ), queryMaxZ), _mm_cmpge_ps(_mm_load_ps(node.maxZ), queryMinZ)));
+
+			const int overlapMask = _mm_movemask_ps(overlap) & ChildContentsMask(node.contents, contentsMask);
+
+			assertm(stackSize + 4 <= s_MaxTraversalStack, "collision traversal stack overflow");
+			for (int i = 0; i < 4 && stackSize < s_MaxTraversalStack; i++)
+			{
+				if (overlapMask & (1 << i))
+					stack[stackSize++] = node.children[i];
+			}
+		}
+	}
+}
+
+// separating axis test (akenine-moller), vertices relative to the box center
+static bool TriBoxOverlap(const float* const halfSize, const float v[3][3])
+{
+	const float e[3][3] =
+	{
+		{ v[1][0] - v[0][0], v[1][1] - v[0][1], v[1][2] - v[0][2] },
+		{ v[2][0] - v[1][0], v[2][1] - v[1][1], v[2][2] - v[1][2] },
+		{ v[0][0] - v[2][0], v[0][1] - v[2][1], v[0][2] - v[2][2] },
+	};
+
+	// the nine edge cross axis tests
+	for (int edge = 0; edge < 3; edge++)
+	{
+		for (int axis = 0; axis < 3; axis++)
+		{
+			const int a1 = (axis + 1) % 3;
+			const int a2 = (axis + 2) % 3;
+
+			// axis x edge
+			const float n[3] = {
+				axis == 0 ? 0.0f : (axis == 1 ? e[edge][2] : -e[edge][1]),
+				axis == 1 ? 0.0f : (axis == 0 ? -e[edge][2] : e[edge][0]),
+				axis == 2 ? 0.0f : (axis == 0 ? e[edge][1] : -e[edge][0]),
+			};
+
+			const float p0 = n[0] * v[0][0] + n[1] * v[0][1] + n[2] * v[0][2];
+			const float p1 = n[0] * v[1][0] + n[1] * v[1][1] + n[2] * v[1][2];
+			const float p2 = n[0] * v[2][0] + n[1] * v[2][1] + n[2] * v[2][2];
+
+			const float radius = halfSize[a1] * fabsf(n[a1]) + halfSize[a2] * fabsf(n[a2]);
+
+			if (std::min({ p0, p1, p2 }) > radius || std::max({ p0, p1, p2 }) < -radius)
+				return false;
+		}
+	}
+
+	// the box's faces
+	for (int axis = 0; axis < 3; axis++)
+	{
+		if (std::min({ v[0][axis], v[1][axis], v[2][axis] }) > halfSize[axis] || std::max({ v[0][axis], v[1][axis], v[2][axis] }) < -halfSize[axis])
+			return false;
+	}
+
+	// the triangle's plane
+	const float normal[3] = { e[0][1] * e[1][2] - e[0][2] * e[1][1], e[0][2] * e[1][0] - e[0][0] * e[1][2], e[0][0] * e[1][1] - e[0][1] * e[1][0] };
+	const float d = normal[0] * v[0][0] + normal[1] * v[0][1] + normal[2] * v[0][2];
+	const float radius = halfSize[0] * fabsf(normal[0]) + halfSize[1] * fabsf(normal[1]) + halfSize[2] * fabsf(normal[2]);
+
+	return fabsf(d) <= radius;
+}
+
+void CCollisionQuery::OverlapAABB(const Vector& mins, const Vector& maxs, const uint32_t contentsMask, CollisionOverlap_t& overlap) const
+{
+	overlap.numTriangles = 0u;
+	overlap.contents = 0u;
+
+	const float center[3] = { (mins.x + maxs.x) * 0.5f, (mins.y + maxs.y) * 0.5f, (mins.z + maxs.z) * 0.5f };
+	const float halfSize[3] = { (maxs.x - mins.x) * 0.5f, (maxs.y - mins.y) * 0.5f, (maxs.z - mins.z) * 0.5f };
+
+	OverlapLeafs(mins, maxs, contentsMask, [&](const Leaf_t& leaf)
+		{
+			for (uint32_t i = leaf.firstTri; i < leaf.firstTri + leaf.numTris; i++)
+			{
+				const Tri_t& tri = m_tris[i];
+
+				if (!(tri.contents & contentsMask))
+					continue;
+
+				const float v[3][3] =
+				{
+					{ tri.v0.x - center[0], tri.v0.y - center[1], tri.v0.z - center[2] },
+					{ tri.v0.x + tri.e1.x - center[0], tri.v0.y + tri.e1.y - center[1], tri.v0.z + tri.e1.z - center[2] },
+					{ tri.v0.x + tri.e2.x - center[0], tri.v0.y + tri.e2.y - center[1], tri.v0.z + tri.e2.z - center[2] },
+				};
+
+				if (!TriBoxOverlap(halfSize, v))
+					continue;
+
+				overlap.numTriangles++;
+				overlap.contents |= tri.contents;
+			}
+		});
+}
+
+// closest point on a triangle to the origin (ericson, real-time collision detection 5.1.5), vertices relative to the point
+static float TriPointDistanceSqr(const float a[3], const float b[3], const float c[3])
+{
+	auto dot = [](const float* x, const float* y) { return x[0] * y[0] + x[1] * y[1] + x[2] * y[2]; };
+	auto lengthSqr = [&dot](const float* x) { return dot(x, x); };
+
+	const float ab[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+	const float ac[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+	const float ap[3] = { -a[0], -a[1], -a[2] };
+
+	const float d1 = dot(ab, ap);
+	const float d2 = dot(ac, ap);
+	if (d1 <= 0.0f && d2 <= 0.0f)
+		return lengthSqr(a);
+
+	const float bp[3] = { -b[0], -b[1], -b[2] };
+	const float d3 = dot(ab, bp);
+	const float d4 = dot(ac, bp);
+	if (d3 >= 0.0f && d4 <= d3)
+		return lengthSqr(b);
+
+	auto pointSqr = [&](const float v, const float w)
+		{
+			const float p[3] = { a[0] + ab[0] * v + ac[0] * w, a[1] + ab[1] * v + ac[1] * w, a[2] + ab[2] * v + ac[2] * w };
+			return lengthSqr(p);
+		};
+
+	const float vc = d1 * d4 - d3 * d2;
+	if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f)
+		return pointSqr(d1 / (d1 - d3), 0.0f);
+
+	const float cp[3] = { -c[0], -c[1], -c[2] };
+	const float d5 = dot(ab, cp);
+	const float d6 = dot(ac, cp);
+	if (d6 >= 0.0f && d5 <= d6)
+		return lengthSqr(c);
+
+	const float vb = d5 * d2 - d1 * d6;
+	if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f)
+		return pointSqr(0.0f, d2 / (d2 - d6));
+
+	const float va = d3 * d6 - d5 * d4;
+	if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f)
+	{
+		const float w = (d4 - d3) / ((d4 - d3) + (d5 - d6));
+		return pointSqr(1.0f - w, w);
+	}
+
+	const float denom = va + vb + vc;
+	if (denom == 0.0f) // degenerate, a vertex is as good as anything
+		return std::min({ lengthSqr(a), lengthSqr(b), lengthSqr(c) });
+
+	return pointSqr(vb / denom, vc / denom);
+}
+
+void CCollisionQuery::OverlapSphere(const Vector& center, const float radius, const uint32_t contentsMask, CollisionOverlap_t& overlap) const
+{
+	overlap.numTriangles = 0u;
+	overlap.contents = 0u;
+
+	const float radiusSqr = radius * radius;
+
+	// the box around the sphere culls the tree, triangles get the exact test
+	OverlapLeafs(Vector(center.x - radius, center.y - radius, center.z - radius), Vector(center.x + radius, center.y + radius, center.z + radius), contentsMask, [&](const Leaf_t& leaf)
+		{
+			for (uint32_t i = leaf.firstTri; i < leaf.firstTri + leaf.numTris; i++)
+			{
+				const Tri_t& tri = m_tris[i];
+
+				if (!(tri.contents & contentsMask))
+					continue;
+
+				const float a[3] = { tri.v0.x - center.x, tri.v0.y - center.y, tri.v0.z - center.z };
+				const float b[3] = { a[0] + tri.e1.x, a[1] + tri.e1.y, a[2] + tri.e1.z };
+				const float c[3] = { a[0] + tri.e2.x, a[1] + tri.e2.y, a[2] + tri.e2.z };
+
+				if (TriPointDistanceSqr(a, b, c) > radiusSqr)
+					continue;
+
+				overlap.numTriangles++;
+				overlap.contents |= tri.contents;
+			}
+		});
+}
+
+//
+// QUERY FILES
+//
+
+// Query files are plain text, one query per line. Blank lines and lines starting with '#' are skipped.
+//   model <asset name or 0xGUID>                     queries after this run against this model's collision
+//   ray <start x y z> <end x y z> [contents mask]
+//   box <mins x y z> <maxs x y z> [contents mask]
+//   sphere <center x y z> <radius> [contents mask]
+// Contents masks are hex and default to everything. Every query writes one line, prefixed with its line number:
+//   <line> ray hit <fraction> <end x y z> <normal x y z> <contents> | <line> ray miss
+//   <line> box|sphere <triangles> <contents>
+//   <line> error <message>
+
+struct CollisionQueryLine_t
+{
+	enum eType : uint8_t
+	{
+		RAY,
+		BOX,
+		SPHERE,
+		INVALID,
+	};
+
+	uint32_t lineNumber;
+	eType type;
+
+	const CCollisionQuery* query;
+	size_t rayIndex; // into the model's batch
+
+	float values[6];
+	uint32_t contentsMask;
+
+	std::string error;
+};
+
+static CAsset* FindCollisionQueryAsset(const std::string& name)
+{
+	const uint64_t guid = (name.starts_with("0x") || name.starts_with("0X")) ? strtoull(name.c_str() + 2, nullptr, 16) : RTech::StringToGuid(name.c_str());
+
+	return g_assetData.FindAssetByGUID(guid);
+}
+
+static void RunCollisionQueryBenchmark(const std::string& name, const CCollisionQuery& query, const uint32_t numThreads)
+{
+	constexpr size_t numRays = 1000000ull;
+
+	// rays between random points in (a little past) the model's bounds, so most of them pass through something
+	const Vector size(query.Maxs().x - query.Mins().x, query.Maxs().y - query.Mins().y, query.Maxs().z - query.Mins().z);
+	const Vector mins(query.Mins().x - size.x * 0.1f, query.Mins().y - size.y * 0.1f, query.Mins().z - size.z * 0.1f);
+
+	std::mt19937 rng(0x52535821u);
+	std::uniform_real_distribution<float> dist(0.0f, 1.2f);
+
+	auto randomPoint = [&]() { return Vector(mins.x + size.x * dist(rng), mins.y + size.y * dist(rng), mins.z + size.z * dist(rng)); };
+
+	std::vector<CollisionRay_t> rays(numRays);
+	for (CollisionRay_t& ray : rays)
+		ray = { randomPoint(), randomPoint(), 0xFFFFFFFFu };
+
+	std::vector<CollisionTrace_t> traces(numRays);
+
+	auto timeTraces = [&](const uint32_t threads) -> double
+		{
+			const auto startTime = std::chrono::high_resolution_clock::now();
+			query.TraceRays(rays.data(), traces.data(), numRays, threads);
+			return std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - startTime).count();
+		};
+
+	const double singleTime = timeTraces(1u);
+	const double batchTime = timeTraces(numThreads);
+
+	const size_t numHits = std::ranges::count(traces, true, &CollisionTrace_t::hit);
+
+	printf("COLLISION BENCHMARK: %s: %llu triangles, %llu nodes, %.1f%% of rays hit\n", name.c_str(), query.NumTriangles(), query.NumNodes(), static_cast<double>(numHits) * 100.0 / static_cast<double>(numRays));
+	printf("COLLISION BENCHMARK: %s: %.2f million rays/s on 1 thread, %.2f million rays/s on %u threads\n", name.c_str(),
+		static_cast<double>(numRays) / singleTime / 1000000.0, static_cast<double>(numRays) / batchTime / 1000000.0, numThreads);
+}
+
+bool HandleCollisionQueryFile(const std::filesystem::path& queryPath, const char* const outPath, const bool runBenchmark)
+{
+	std::ifstream in(queryPath);
+
+	if (!in.is_open())
+	{
+		printf("COLLISION: Failed to open query file \"%s\"\n", queryPath.string().c_str());
+		return false;
+	}
+
+	// collision is only built for models the file uses, once each
+	std::unordered_map<CAsset*, std::unique_ptr<CCollisionQuery>> queries;
+	std::vector<std::pair<std::string, const CCollisionQuery*>> benchmarkQueries;
+
+	struct RayBatch_t
+	{
+		std::vector<CollisionRay_t> rays;
+		std::vector<CollisionTrace_t> traces;
+	};
+
+	std::unordered_map<const CCollisionQuery*, RayBatch_t> rayBatches;
+	std::vector<CollisionQueryLine_t> lines;
+
+	const CCollisionQuery* curQuery = nullptr;
+	std::string curModelError = "no model selected";
+
+	std::string line;
+	for (uint32_t lineNumber = 1; std::getline(in, line); lineNumber++)
+	{
+		std::istringstream stream(line);
+
+		std::string command;
+		if (!(stream >> command) || command.starts_with("#"))
+			continue;
+
+		if (command == "model")
+		{
+			std::string name;
+			stream >> name;
+
+			curQuery = nullptr;
+
+			CAsset* const asset = FindCollisionQueryAsset(name);
+			if (!asset)
+			{
+				curModelError = std::format("model \"{}\" is not loaded", name);
+				continue;
+			}
+
+			auto it = queries.find(asset);
+			if (it == queries.end())
+			{
+				std::unique_ptr<CCollisionQuery> query = std::make_unique<CCollisionQuery>();
+
+				if (!GetModelCollisionQuery(asset, *query) || query->IsEmpty())
+					query.reset();
+				else
+					benchmarkQueries.emplace_back(name, query.get());
+
+				it = queries.emplace(asset, std::move(query)).first;
+			}
+
+			curQuery = it->second.get();
+			curModelError = std::format("model \"{}\" has no bvh collision", name);
+
+			continue;
+		}
+
+		CollisionQueryLine_t& query = lines.emplace_back();
+		query.lineNumber = lineNumber;
+		query.query = curQuery;
+		query.rayIndex = 0ull;
+		query.contentsMask = 0xFFFFFFFFu;
+
+		int numValues = 0;
+		if (command == "ray")
+		{
+			query.type = CollisionQueryLine_t::RAY;
+			numValues = 6;
+		}
+		else if (command == "box")
+		{
+			query.type = CollisionQueryLine_t::BOX;
+			numValues = 6;
+		}
+		else if (command == "sphere")
+		{
+			query.type = CollisionQueryLine_t::SPHERE;
+			numValues = 4;
+		}
+		else
+		{
+			query.type = CollisionQueryLine_t::INVALID;
+			query.error = std::format("unknown query \"{}\"", command);
+			continue;
+		}
+
+		for (int i = 0; i < numValues; i++)
+		{
+			if (!(stream >> query.values[i]))
+			{
+				query.type = CollisionQueryLine_t::INVALID;
+				query.error = std::format("{} expects {} values", command, numValues);
+				break;
+			}
+		}
+
+		std::string mask;
+		if (stream >> mask)
+			query.contentsMask = static_cast<uint32_t>(strtoul(mask.c_str(), nullptr, 16));
+
+		if (query.type != CollisionQueryLine_t::INVALID && !curQuery)
+		{
+			query.type = CollisionQueryLine_t::INVALID;
+			query.error = curModelError;
+		}
+
+		// rays are traced in one batch per model once the whole file is read
+		if (query.type == CollisionQueryLine_t::RAY)
+		{
+			RayBatch_t& batch = rayBatches[curQuery];
+
+			query.rayIndex = batch.rays.size();
+			batch.rays.push_back({ Vector(query.values[0], query.values[1], query.values[2]), Vector(query.values[3], query.values[4], query.values[5]), query.contentsMask });
+		}
+	}
+
+	const uint32_t numThreads = std::max(UtilsConfig->exportThreadCount, 1u);
+
+	for (auto& [query, batch] : rayBatches)
+	{
+		batch.traces.resize(batch.rays.size());
+		query->TraceRays(batch.rays.data(), batch.traces.data(), batch.rays.size(), numThreads);
+	}
+
+	std::string results;
+	results.reserve(lines.size() * 64ull);
+
+	for (const CollisionQueryLine_t& query : lines)
+	{
+		switch (query.type)
+		{
+		case CollisionQueryLine_t::RAY:
+		{
+			const CollisionTrace_t& trace = rayBatches.find(query.query)->second.traces[query.rayIndex];
+
+			if (trace.hit)
+			{
+				results.append(std::format("{} ray hit {} {} {} {} {} {} {} 0x{:X}\n", query.lineNumber, trace.fraction,
+					trace.endPos.x, trace.endPos.y, trace.endPos.z, trace.normal.x, trace.normal.y, trace.normal.z, trace.contents));
+			}
+			else
+				results.append(std::format("{} ray miss\n", query.lineNumber));
+
+			break;
+		}
+		case CollisionQueryLine_t::BOX:
+		case CollisionQueryLine_t::SPHERE:
+		{
+			CollisionOverlap_t overlap;
+
+			if (query.type == CollisionQueryLine_t::BOX)
+				query.query->OverlapAABB(Vector(query.values[0], query.values[1], query.values[2]), Vector(query.values[3], query.values[4], query.values[5]), query.contentsMask, overlap);
+			else
+				query.query->OverlapSphere(Vector(query.values[0], query.values[1], query.values[2]), query.values[3], query.contentsMask, overlap);
+
+			results.append(std::format("{} {} {} 0x{:X}\n", query.lineNumber, query.type == CollisionQueryLine_t::BOX ? "box" : "sphere", overlap.numTriangles, overlap.contents));
+
+			break;
+		}
+		case CollisionQueryLine_t::INVALID:
+		{
+			results.append(std::format("{} error {}\n", query.lineNumber, query.error));
+
+			break;
+		}
+		}
+	}
+
+	if (outPath)
+	{
+		std::ofstream out(outPath, std::ios::out | std::ios::binary);
+		out.write(results.data(), results.size());
+	}
+	else
+		fwrite(results.data(), sizeof(char), results.size(), stdout);
+
+	printf("COLLISION: Ran %llu queries from \"%s\" against %llu models\n", lines.size(), queryPath.string().c_str(), benchmarkQueries.size());
+
+	if (runBenchmark)
+	{
+		for (const auto& [name, query] : benchmarkQueries)
+			RunCollisionQueryBenchmark(name, *query, CThread::GetConCurrentThreads());
+	}
+
+	return true;
+}
@@ -0,0 +1,115 @@
+#pragma once
+#include <game/rtech/utils/bvh/bvh.h>
+
+#include <cfloat>
+
+class CAsset;
+
+// Spatial queries (raycasts, box/sphere overlaps) over bvh4 collision
+// Keeps the native tree's shape (four children per node, leaves where the native leaves are) so contents masks can cull whole subtrees,
+// with child bounds stored four wide so a ray or box is tested against every child of a node at once.
+// Child bounds are computed from the decoded leaf primitives rather than read from the native nodes, so queries agree exactly with
+// what gets exported.
+
+struct CollisionRay_t
+{
+	Vector start;
+	Vector end;
+
+	uint32_t contentsMask; // only primitives with any of these contents are hit
+};
+
+struct CollisionTrace_t
+{
+	float fraction; // how far from start to end the ray got, 1.0 if nothing was hit
+	Vector endPos;
+	Vector normal; // of the hit triangle, facing against the ray
+
+	uint32_t contents; // of the hit triangle
+	bool hit;
+};
+
+struct CollisionOverlap_t
+{
+	uint32_t numTriangles; // overlapping triangles, quads are two
+	uint32_t contents; // all contents of the overlapping triangles
+};
+
+class CCollisionQuery
+{
+public:
+	CCollisionQuery() : m_mins(FLT_MAX, FLT_MAX, FLT_MAX), m_maxs(-FLT_MAX, -FLT_MAX, -FLT_MAX) {};
+
+	// decodes the tree under the root node (0), models with more than one collision header add each of them
+	void AddBVH(const BVHModel_t* const pModel);
+
+	inline const bool IsEmpty() const { return m_tris.empty(); }
+	inline const size_t NumTriangles() const { return m_tris.size(); }
+	inline const size_t NumNodes() const { return m_nodes.size(); }
+
+	// bounds of everything in the model
+	inline const Vector& Mins() const { return m_mins; }
+	inline const Vector& Maxs() const { return m_maxs; }
+
+	// closest hit along the ray
+	void TraceRay(const CollisionRay_t& ray, CollisionTrace_t& trace) const;
+	void TraceRays(const CollisionRay_t* const rays, CollisionTrace_t* const traces, const size_t numRays, const uint32_t numThreads) const;
+
+	void OverlapAABB(const Vector& mins, const Vector& maxs, const uint32_t contentsMask, CollisionOverlap_t& overlap) const;
+	void OverlapSphere(const Vector& center, const float radius, const uint32_t contentsMask, CollisionOverlap_t& overlap) const;
+
+private:
+	// child references are node indices, or ~leaf index for leaves
+	static constexpr int32_t s_InvalidChild = INT32_MIN;
+
+	struct alignas(16) Node_t
+	{
+		float minX[4];
+		float minY[4];
+		float minZ[4];
+		float maxX[4];
+		float maxY[4];
+		float maxZ[4];
+
+		uint32_t contents[4]; // everything under this child, empty children have none so they never pass a contents mask
+		int32_t children[4];
+	};
+
+	struct Leaf_t
+	{
+		uint32_t firstTri;
+		uint32_t numTris;
+	};
+
+	// edges are precomputed for the ray test
+	struct Tri_t
+	{
+		Vector v0;
+		Vector e1;
+		Vector e2;
+
+		uint32_t contents;
+	};
+
+	const int32_t BuildNode(const BVHModel_t* const pModel, const int nodeIndex, Vector& mins, Vector& maxs, uint32_t& contents);
+	const int32_t BuildLeaf(const CollisionModel_t& leafModel, Vector& mins, Vector& maxs, uint32_t& contents);
+
+	// calls leafFunc for every leaf whose bounds overlap the box and has any contents in the mask
+	template <typename LeafFunc_t>
+	void OverlapLeafs(const Vector& mins, const Vector& maxs, const uint32_t contentsMask, const LeafFunc_t& leafFunc) const;
+
+	std::vector<Node_t> m_nodes;
+	std::vector<Leaf_t> m_leafs;
+	std::vector<Tri_t> m_tris;
+	std::vector<int32_t> m_roots; // one per collision header
+
+	Vector m_mins;
+	Vector m_maxs;
+};
+
+// builds a query for a model asset's bvh collision, returns false if the asset isn't a model or has none
+bool GetModelCollisionQuery(CAsset* const asset, CCollisionQuery& query);
+
+// runs every query in a text file against the loaded models and writes one result line per query
+// see bvhquery.cpp for the file format
+bool HandleCollisionQueryFile(const std::filesystem::path& queryPath, const char* const outPath, const bool runBenchmark);
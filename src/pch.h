@@ -25,6 +25,8 @@
 #include <functional>
 #include <ranges>
 #include <mutex>
+#include <atomic>
+#include <condition_variable>
 #include <variant>
 
 #ifndef NOMINMAX
@@ -38,9 +40,12 @@
 
 #include <core/utils/crc32.h>
 #include <core/utils/utils_general.h>
+#include <core/utils/exportarchive.h>
 #include <core/utils/fileio.h>
 #include <core/utils/thread.h>
+#include <core/utils/memtracker.h>
 #include <core/utils/ramen.h>
+#include <core/utils/profiler.h>
 
 #define STREAMIO
 
@@ -78,6 +78,7 @@ static void UtilSettings_ReadLine(ImGuiContext* const ctx, ImGuiSettingsHandler*
         uint32_t i;
         ImGuiReadSetting("ExportThreads=%u", cfg->exportThreadCount, i, uint32_t);
         ImGuiReadSetting("ParseThreads=%u", cfg->parseThreadCount, i, uint32_t);
+        ImGuiReadSetting("PakLoadThreads=%u", cfg->pakLoadThreadCount, i, uint32_t);
         ImGuiReadSetting("CompressionLevel=%u", cfg->compressionLevel, i, uint32_t);
 
         int checkUpdates = 0;
@@ -94,6 +95,7 @@ static void UtilSettings_WriteAll(ImGuiContext* const ctx, ImGuiSettingsHandler*
     buf->appendf("[%s][utils]\n", handler->TypeName );
     buf->appendf("ExportThreads=%u\n", UtilsConfig->exportThreadCount);
     buf->appendf("ParseThreads=%u\n", UtilsConfig->parseThreadCount);
+    buf->appendf("PakLoadThreads=%u\n", UtilsConfig->pakLoadThreadCount);
     buf->appendf("CompressionLevel=%u\n", UtilsConfig->compressionLevel);
     buf->appendf("CheckForUpdatesOnStartup=%d\n", UtilsConfig->checkForUpdatesOnStartup ? 1 : 0);
     buf->append("\n");
@@ -750,6 +752,7 @@ ImGuiHandler::ImGuiHandler()
     // need at least one thread.
     cfg.exportThreadCount = 1u;
     cfg.parseThreadCount = std::max(totalThreadCount >> 1u, 1u);
+    cfg.pakLoadThreadCount = std::clamp(totalThreadCount >> 2u, 1u, 4u);
 
     // standard config setting for compression
     cfg.compressionLevel = eCompressionLevel::CMPR_LVL_VERYFAST;
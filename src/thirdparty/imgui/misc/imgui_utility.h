@@ -165,6 +165,7 @@ public:
     {
         uint32_t parseThreadCount;
         uint32_t exportThreadCount;
+        uint32_t pakLoadThreadCount; // paks that are loaded at the same time, each pak still uses the parse threads for its assets
         uint32_t compressionLevel;
         bool checkForUpdatesOnStartup = false;
     } cfg;